@@ -50,7 +50,7 @@ namespace b3::common {
     int64_t minTradeVol{0};          // Minimum trade volume
 
     // ===== Options/Derivatives (if applicable) =====
-    uint32_t underlyingSecurityId{0}; // Underlying security ID for derivatives
+    uint64_t underlyingSecurityId{0}; // Underlying SecurityID for derivatives (64-bit, as on the wire)
     std::string underlyingSymbol;    // Underlying symbol
     uint32_t maturityDate{0};        // Maturity date (days since epoch or YYYYMMDD)
     uint8_t putOrCall{0};            // Put (0) or Call (1) for options
@@ -86,6 +86,8 @@ namespace b3::common {
     std::string securityDesc;        // Security description/name
 
     InstrumentData() = default;
+
+    bool operator==(const InstrumentData &) const = default;
   };
 
 } // namespace b3::common
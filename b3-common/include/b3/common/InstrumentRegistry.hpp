@@ -1,6 +1,10 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
 #include <shared_mutex>
 #include <string>
 #include <string_view>
@@ -34,8 +38,28 @@ namespace b3::common {
     }
   };
 
+  /**
+   * @brief Cambios aplicados por una escritura al registry (alta / modificación).
+   *
+   * `version` es la versión del registry después del cambio. Los instrumentos nuevos reciben
+   * índices densos consecutivos a partir de `firstNewDense` (en el orden de `added`); los
+   * existentes conservan el suyo.
+   */
+  struct RegistryDelta {
+    std::uint64_t version{0};
+    std::uint32_t firstNewDense{0};
+    std::vector<InstrumentId> added;
+    std::vector<InstrumentId> changed;
+
+    bool empty() const noexcept { return added.empty() && changed.empty(); }
+  };
+
   class InstrumentRegistry final {
    public:
+    static constexpr std::uint32_t kNoDenseIndex = UINT32_MAX;
+
+    using DeltaListener = std::function<void(const RegistryDelta &)>;
+
     InstrumentRegistry() = default;
     InstrumentRegistry(const InstrumentRegistry &) = delete;
     InstrumentRegistry &operator=(const InstrumentRegistry &) = delete;
@@ -46,25 +70,64 @@ namespace b3::common {
       auto it = byId_.find(iid);
       if (it == byId_.end())
         return nullptr;
-      return &it->second.symbol;
+      return &it->second.data->symbol;
     }
 
     // iid -> full instrument data
+    // El puntero sigue siendo válido si el instrumento se actualiza después (las versiones
+    // reemplazadas no se liberan): los lectores sin lock nunca ven memoria reciclada.
     const InstrumentData *tryResolveData(InstrumentId iid) const noexcept {
       std::shared_lock<std::shared_mutex> lock(mu_);
       auto it = byId_.find(iid);
       if (it == byId_.end())
         return nullptr;
-      return &it->second;
+      return it->second.data;
     }
 
-    // symbol -> iid
-    const InstrumentId *tryResolveId(std::string_view symbol) const noexcept {
+    // symbol -> iid, por valor: un cambio de definición re-inserta el nodo de bySymbol_, así que
+    // un puntero al mapa no sobrevive al lock.
+    std::optional<InstrumentId> tryResolveId(std::string_view symbol) const noexcept {
       std::shared_lock<std::shared_mutex> lock(mu_);
       auto it = bySymbol_.find(symbol); // ✅ No temp string (heterogeneous lookup)
       if (it == bySymbol_.end())
-        return nullptr;
-      return &it->second;
+        return std::nullopt;
+      return it->second;
+    }
+
+    // iid -> índice denso estable [0, denseSize()), asignado en orden de alta y nunca reusado
+    std::uint32_t denseIndexOf(InstrumentId iid) const noexcept {
+      std::shared_lock<std::shared_mutex> lock(mu_);
+      auto it = byId_.find(iid);
+      return it == byId_.end() ? kNoDenseIndex : it->second.dense;
+    }
+
+    InstrumentId instrumentAtDense(std::uint32_t index) const noexcept {
+      std::shared_lock<std::shared_mutex> lock(mu_);
+      return index < denseIds_.size() ? denseIds_[index] : 0;
+    }
+
+    std::uint32_t denseSize() const noexcept {
+      std::shared_lock<std::shared_mutex> lock(mu_);
+      return static_cast<std::uint32_t>(denseIds_.size());
+    }
+
+    // Sube en cada escritura que cambia algo (upsert idéntico = sin cambio de versión).
+    std::uint64_t version() const noexcept { return version_.load(std::memory_order_acquire); }
+
+    // Versiones reemplazadas retenidas (ver tryResolveData).
+    std::size_t retiredVersions() const noexcept {
+      std::shared_lock<std::shared_mutex> lock(mu_);
+      return storage_.size() - byId_.size();
+    }
+
+    /**
+     * @brief Registra un callback de cambios. Se invoca en el thread que escribe, fuera del lock
+     *        del registry (puede leerlo), una vez por escritura con cambios. Registrar antes de
+     *        empezar a escribir; no hay unsubscribe.
+     */
+    void addDeltaListener(DeltaListener listener) {
+      std::lock_guard<std::mutex> lock(listenersMu_);
+      listeners_.push_back(std::move(listener));
     }
 
     // Legacy API: upsert with symbol only (creates minimal InstrumentData)
@@ -76,89 +139,53 @@ namespace b3::common {
     }
 
     // Full API: upsert with complete instrument data
-    void upsertFull(InstrumentId iid, InstrumentData data) {
-      if (iid == 0 || data.symbol.empty())
-        return;
-
-      // Ensure securityId matches iid
-      data.securityId = iid;
-
-      std::unique_lock<std::shared_mutex> lock(mu_);
-
-      // si el iid ya existía con otro símbolo, limpiamos reverse map viejo
-      auto itOld = byId_.find(iid);
-      if (itOld != byId_.end()) {
-        auto itRevOld = bySymbol_.find(itOld->second.symbol);
-        if (itRevOld != bySymbol_.end() && itRevOld->second == iid)
-          bySymbol_.erase(itRevOld);
+    RegistryDelta upsertFull(InstrumentId iid, InstrumentData data) {
+      RegistryDelta delta;
+      {
+        std::unique_lock<std::shared_mutex> lock(mu_);
+        delta.firstNewDense = static_cast<std::uint32_t>(denseIds_.size());
+        storeLocked(iid, std::move(data), delta);
+        commitLocked(delta);
       }
-
-      // si el símbolo ya existía apuntando a otro iid, lo pisamos (última gana)
-      const std::string &symbol = data.symbol;
-      bySymbol_[symbol] = iid;
-      byId_[iid] = std::move(data);
+      notify(delta);
+      return delta;
     }
 
     // bulkUpsert with symbol only (legacy, for backward compatibility)
     // begin/end must iterate pairs (InstrumentId, std::string)
     template <class It>
-    void bulkUpsert(It begin, It end) {
-      std::unique_lock<std::shared_mutex> lock(mu_);
-
-      for (auto it = begin; it != end; ++it) {
-        const InstrumentId iid = static_cast<InstrumentId>(it->first);
-        const std::string &symRef = it->second;
-
-        if (iid == 0 || symRef.empty())
-          continue;
-
-        // remover reverse viejo si iid ya existía
-        auto itOld = byId_.find(iid);
-        if (itOld != byId_.end()) {
-          auto itRevOld = bySymbol_.find(itOld->second.symbol);
-          if (itRevOld != bySymbol_.end() && itRevOld->second == iid)
-            bySymbol_.erase(itRevOld);
+    RegistryDelta bulkUpsert(It begin, It end) {
+      RegistryDelta delta;
+      {
+        std::unique_lock<std::shared_mutex> lock(mu_);
+        delta.firstNewDense = static_cast<std::uint32_t>(denseIds_.size());
+        for (auto it = begin; it != end; ++it) {
+          // Create minimal InstrumentData with symbol
+          InstrumentData data;
+          data.symbol = it->second;
+          storeLocked(static_cast<InstrumentId>(it->first), std::move(data), delta);
         }
-
-        // Create minimal InstrumentData with symbol
-        InstrumentData data;
-        data.securityId = iid;
-        data.symbol = symRef;
-
-        // insertar / actualizar ambos
-        bySymbol_[symRef] = iid;
-        byId_[iid] = std::move(data);
+        commitLocked(delta);
       }
+      notify(delta);
+      return delta;
     }
 
     // bulkUpsertFull with complete instrument data
     // begin/end must iterate pairs (InstrumentId, InstrumentData)
+    // Un solo lock y una sola notificación para todo el lote (deltas intradiarios).
     template <class It>
-    void bulkUpsertFull(It begin, It end) {
-      std::unique_lock<std::shared_mutex> lock(mu_);
-
-      for (auto it = begin; it != end; ++it) {
-        const InstrumentId iid = static_cast<InstrumentId>(it->first);
-        InstrumentData data = it->second;
-
-        if (iid == 0 || data.symbol.empty())
-          continue;
-
-        // Ensure securityId matches iid
-        data.securityId = iid;
-
-        // remover reverse viejo si iid ya existía
-        auto itOld = byId_.find(iid);
-        if (itOld != byId_.end()) {
-          auto itRevOld = bySymbol_.find(itOld->second.symbol);
-          if (itRevOld != bySymbol_.end() && itRevOld->second == iid)
-            bySymbol_.erase(itRevOld);
-        }
-
-        const std::string &symbol = data.symbol;
-        bySymbol_[symbol] = iid;
-        byId_[iid] = std::move(data);
+    RegistryDelta bulkUpsertFull(It begin, It end) {
+      RegistryDelta delta;
+      {
+        std::unique_lock<std::shared_mutex> lock(mu_);
+        delta.firstNewDense = static_cast<std::uint32_t>(denseIds_.size());
+        for (auto it = begin; it != end; ++it)
+          storeLocked(static_cast<InstrumentId>(it->first), it->second, delta);
+        commitLocked(delta);
       }
+      notify(delta);
+      return delta;
     }
 
     std::size_t size() const noexcept {
@@ -171,8 +198,8 @@ namespace b3::common {
       std::vector<std::pair<InstrumentId, std::string>> out;
       std::shared_lock<std::shared_mutex> lock(mu_);
       out.reserve(byId_.size());
-      for (const auto &[iid, data] : byId_) {
-        out.emplace_back(iid, data.symbol);
+      for (const auto &[iid, entry] : byId_) {
+        out.emplace_back(iid, entry.data->symbol);
       }
       return out;
     }
@@ -182,16 +209,74 @@ namespace b3::common {
       std::vector<std::pair<InstrumentId, InstrumentData>> out;
       std::shared_lock<std::shared_mutex> lock(mu_);
       out.reserve(byId_.size());
-      for (const auto &[iid, data] : byId_) {
-        out.emplace_back(iid, data);
+      for (const auto &[iid, entry] : byId_) {
+        out.emplace_back(iid, *entry.data);
       }
       return out;
     }
 
    private:
+    struct Entry {
+      const InstrumentData *data{nullptr}; // versión vigente (en storage_)
+      std::uint32_t dense{kNoDenseIndex};
+    };
+
+    // Requiere lock exclusivo. Idéntico a lo vigente = no-op (el loop de SecDefs se repite).
+    void storeLocked(InstrumentId iid, InstrumentData data, RegistryDelta &delta) {
+      if (iid == 0 || data.symbol.empty())
+        return;
+
+      // Ensure securityId matches iid
+      data.securityId = iid;
+
+      auto itOld = byId_.find(iid);
+      if (itOld != byId_.end()) {
+        if (*itOld->second.data == data)
+          return;
+        // si el iid ya existía con otro símbolo, limpiamos reverse map viejo
+        auto itRevOld = bySymbol_.find(itOld->second.data->symbol);
+        if (itRevOld != bySymbol_.end() && itRevOld->second == iid)
+          bySymbol_.erase(itRevOld);
+        delta.changed.push_back(iid);
+      } else {
+        itOld = byId_.emplace(iid, Entry{nullptr, static_cast<std::uint32_t>(denseIds_.size())})
+                    .first;
+        denseIds_.push_back(iid);
+        delta.added.push_back(iid);
+      }
+
+      // Append-only: la versión anterior queda viva para punteros ya entregados
+      storage_.push_back(std::move(data));
+      itOld->second.data = &storage_.back();
+
+      // si el símbolo ya existía apuntando a otro iid, lo pisamos (última gana)
+      bySymbol_[storage_.back().symbol] = iid;
+    }
+
+    void commitLocked(RegistryDelta &delta) noexcept {
+      if (delta.empty()) {
+        delta.version = version_.load(std::memory_order_relaxed);
+        return;
+      }
+      delta.version = version_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    }
+
+    void notify(const RegistryDelta &delta) {
+      if (delta.empty())
+        return;
+      std::lock_guard<std::mutex> lock(listenersMu_);
+      for (const auto &l : listeners_) l(delta);
+    }
+
     mutable std::shared_mutex mu_;
-    std::unordered_map<InstrumentId, InstrumentData> byId_; // Changed from string to InstrumentData
+    std::deque<InstrumentData> storage_; // append-only: direcciones estables
+    std::unordered_map<InstrumentId, Entry> byId_;
     std::unordered_map<std::string, InstrumentId, StringHash, StringEqual> bySymbol_;
+    std::vector<InstrumentId> denseIds_; // índice denso -> iid
+    std::atomic<std::uint64_t> version_{0};
+
+    std::mutex listenersMu_;
+    std::vector<DeltaListener> listeners_;
   };
 
 } // namespace b3::common
@@ -11,8 +11,10 @@ namespace b3::md {
 
     uint64_t instrumentId{0};
     uint64_t exchangeTsNs{0};
+    uint64_t rptSeq{0}; // RptSeq del libro (sequence_number en el wire: detección de gaps)
     uint8_t bidCount{0};
     uint8_t askCount{0};
+    uint8_t flags{0};   // OrdersSnapshot::kBookInvalid / kBookRefresh
 
     Level bids[N]{};
     Level asks[N]{};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+namespace b3::md {
+
+  // Flag "libro desactualizado" por instrumento (onOrderBookOutOfDate / gap de RptSeq hasta que
+  // OnixS lo recupere). Lock-free: lo escriben y leen los feed threads de OnixS (varios, pero
+  // OnixS serializa callbacks por libro) sin locks en el hot path.
+  //
+  // Open-addressing fijo como ShardOverrideTable: las entradas no se borran (el set de
+  // instrumentos está acotado), solo cambia el flag. Con staleCount() == 0 el hot path no busca.
+  class BookStaleTable final {
+   public:
+    static constexpr uint32_t kMaxProbes = 32;
+
+    explicit BookStaleTable(uint32_t capacityPow2 = 16384)
+        : mask_(capacityPow2 - 1), entries_(std::make_unique<Entry[]>(capacityPow2)) {
+      if (capacityPow2 < 2 || (capacityPow2 & (capacityPow2 - 1)) != 0)
+        throw std::invalid_argument("BookStaleTable: capacity must be a power of two");
+    }
+
+    BookStaleTable(const BookStaleTable &) = delete;
+    BookStaleTable &operator=(const BookStaleTable &) = delete;
+
+    // Hot path (cada update de libro): casi siempre sale por el contador global.
+    bool isStale(uint64_t instrumentId) const noexcept {
+      if (stale_.load(std::memory_order_acquire) == 0)
+        return false;
+      const Entry *e = find(instrumentId);
+      return e && e->stale.load(std::memory_order_acquire);
+    }
+
+    // true si pasó de fresco a stale (el llamador publica el marcador una sola vez).
+    // false si ya estaba stale o la tabla está llena (overflow()).
+    bool markStale(uint64_t instrumentId) noexcept {
+      Entry *e = findOrInsert(instrumentId);
+      if (!e) {
+        overflow_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      if (e->stale.exchange(true, std::memory_order_acq_rel))
+        return false;
+      stale_.fetch_add(1, std::memory_order_release);
+      return true;
+    }
+
+    // true si estaba stale (recuperado). Un marcador pendiente se descarta: sale el refresh.
+    bool clear(uint64_t instrumentId) noexcept {
+      Entry *e = const_cast<Entry *>(find(instrumentId));
+      if (!e || !e->stale.exchange(false, std::memory_order_acq_rel))
+        return false;
+      e->markerPending.store(false, std::memory_order_relaxed);
+      stale_.fetch_sub(1, std::memory_order_release);
+      return true;
+    }
+
+    // El marcador "book invalid" no se pudo publicar (cola llena): queda pendiente mientras el
+    // libro siga stale y el próximo evento del libro lo reintenta.
+    void setMarkerPending(uint64_t instrumentId) noexcept {
+      if (Entry *e = const_cast<Entry *>(find(instrumentId)))
+        e->markerPending.store(true, std::memory_order_relaxed);
+    }
+
+    // true si había un marcador pendiente (el llamador lo reintenta).
+    bool takeMarkerPending(uint64_t instrumentId) noexcept {
+      Entry *e = const_cast<Entry *>(find(instrumentId));
+      return e && e->markerPending.load(std::memory_order_relaxed) &&
+             e->markerPending.exchange(false, std::memory_order_acq_rel);
+    }
+
+    uint32_t staleCount() const noexcept { return stale_.load(std::memory_order_relaxed); }
+    uint64_t overflow() const noexcept { return overflow_.load(std::memory_order_relaxed); }
+
+   private:
+    static constexpr uint64_t kKnuth = 11400714819323198485ull;
+
+    struct Entry {
+      std::atomic<uint64_t> iid{0};
+      std::atomic<bool> stale{false};
+      std::atomic<bool> markerPending{false};
+    };
+
+    uint32_t home(uint64_t instrumentId) const noexcept {
+      return static_cast<uint32_t>((instrumentId * kKnuth) >> 32) & mask_;
+    }
+
+    const Entry *find(uint64_t instrumentId) const noexcept {
+      if (instrumentId == 0)
+        return nullptr;
+      uint32_t i = home(instrumentId);
+      for (uint32_t p = 0; p < kMaxProbes; ++p, i = (i + 1) & mask_) {
+        const uint64_t key = entries_[i].iid.load(std::memory_order_acquire);
+        if (key == instrumentId)
+          return &entries_[i];
+        if (key == 0)
+          return nullptr;
+      }
+      return nullptr;
+    }
+
+    // Varios escritores (un feed thread por libro): el slot libre se toma con CAS.
+    Entry *findOrInsert(uint64_t instrumentId) noexcept {
+      if (instrumentId == 0)
+        return nullptr;
+      uint32_t i = home(instrumentId);
+      for (uint32_t p = 0; p < kMaxProbes; ++p, i = (i + 1) & mask_) {
+        uint64_t key = entries_[i].iid.load(std::memory_order_acquire);
+        if (key == 0 && entries_[i].iid.compare_exchange_strong(key, instrumentId,
+                                                                 std::memory_order_acq_rel))
+          return &entries_[i];
+        if (key == instrumentId)
+          return &entries_[i];
+      }
+      return nullptr;
+    }
+
+    const uint32_t mask_;
+    std::unique_ptr<Entry[]> entries_;
+    std::atomic<uint32_t> stale_{0};
+    std::atomic<uint64_t> overflow_{0};
+  };
+
+} // namespace b3::md
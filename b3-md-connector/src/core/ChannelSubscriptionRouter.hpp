@@ -0,0 +1,69 @@
+#pragma once
+
+#include "IMarketDataHandler.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace b3::md {
+
+  /**
+   * @brief IMarketDataHandler que reparte subscribe/unsubscribe entre varios canales UMDF.
+   *
+   * Cada canal tiene su propio Handler de OnixS, pero el registry y el subscription server son
+   * uno solo: el iid se manda al Handler del canal que lo definió (`owns`). Un iid que ningún
+   * canal reclama (p.ej. llegó por un delta que todavía no se flusheó) va a todos los canales;
+   * OnixS ignora los que no son suyos.
+   *
+   * Las rutas se agregan antes de arrancar el subscription server.
+   */
+  class ChannelSubscriptionRouter final : public IMarketDataHandler {
+   public:
+    using OwnsFn = std::function<bool(uint64_t)>;
+
+    void add(OwnsFn owns, IMarketDataHandler &handler) {
+      routes_.push_back({std::move(owns), &handler});
+    }
+
+    size_t routes() const noexcept { return routes_.size(); }
+
+    void subscribe(uint64_t instrumentId) override {
+      route(instrumentId, [](IMarketDataHandler &h, uint64_t iid) { h.subscribe(iid); });
+    }
+
+    void unsubscribe(uint64_t instrumentId) override {
+      route(instrumentId, [](IMarketDataHandler &h, uint64_t iid) { h.unsubscribe(iid); });
+    }
+
+    uint64_t unrouted() const noexcept { return unrouted_.load(std::memory_order_relaxed); }
+
+   private:
+    struct Route {
+      OwnsFn owns;
+      IMarketDataHandler *handler;
+    };
+
+    template <typename Op>
+    void route(uint64_t iid, Op op) {
+      if (routes_.size() == 1) {
+        op(*routes_.front().handler, iid);
+        return;
+      }
+      for (auto &r : routes_) {
+        if (r.owns(iid)) {
+          op(*r.handler, iid);
+          return;
+        }
+      }
+      unrouted_.fetch_add(1, std::memory_order_relaxed);
+      for (auto &r : routes_) op(*r.handler, iid);
+    }
+
+    std::vector<Route> routes_;
+    std::atomic<uint64_t> unrouted_{0};
+  };
+
+} // namespace b3::md
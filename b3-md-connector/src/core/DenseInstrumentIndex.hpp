@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace b3::md {
+
+  // instrumentId -> índice denso [0, size()) asignado en orden de llegada, para guardar estado
+  // por instrumento en arrays planos (stats, estado) en vez de mapas.
+  // Single thread (el dueño de la tabla). Open-addressing fijo como InstrumentRateTracker:
+  // sin alloc ni borrado en hot path. instrumentId 0 = slot libre.
+  class DenseInstrumentIndex final {
+   public:
+    static constexpr uint32_t kNone = UINT32_MAX;
+    static constexpr uint32_t kMaxProbes = 32;
+
+    // maxInstruments: tope de índices; la tabla hash usa 2x (potencia de 2) para probes cortos.
+    explicit DenseInstrumentIndex(uint32_t maxInstruments = 8192)
+        : maxInstruments_(maxInstruments), mask_(tableSizeFor(maxInstruments) - 1),
+          slots_(std::make_unique<Slot[]>(mask_ + 1)) {
+      if (maxInstruments == 0)
+        throw std::invalid_argument("DenseInstrumentIndex: maxInstruments == 0");
+      ids_.reserve(maxInstruments);
+    }
+
+    DenseInstrumentIndex(const DenseInstrumentIndex &) = delete;
+    DenseInstrumentIndex &operator=(const DenseInstrumentIndex &) = delete;
+
+    uint32_t find(uint64_t instrumentId) const noexcept {
+      if (instrumentId == 0)
+        return kNone;
+      uint32_t i = slotFor(instrumentId);
+      for (uint32_t p = 0; p < kMaxProbes; ++p, i = (i + 1) & mask_) {
+        const Slot &s = slots_[i];
+        if (s.iid == instrumentId)
+          return s.index;
+        if (s.iid == 0)
+          return kNone;
+      }
+      return kNone;
+    }
+
+    // kNone si la tabla está llena (o demasiadas colisiones): el llamador cuenta el drop.
+    uint32_t findOrInsert(uint64_t instrumentId) noexcept {
+      if (instrumentId == 0)
+        return kNone;
+      uint32_t i = slotFor(instrumentId);
+      for (uint32_t p = 0; p < kMaxProbes; ++p, i = (i + 1) & mask_) {
+        Slot &s = slots_[i];
+        if (s.iid == instrumentId)
+          return s.index;
+        if (s.iid == 0) {
+          if (ids_.size() >= maxInstruments_)
+            return kNone;
+          s.iid = instrumentId;
+          s.index = static_cast<uint32_t>(ids_.size());
+          ids_.push_back(instrumentId); // reservado en el ctor: no realoca
+          return s.index;
+        }
+      }
+      return kNone;
+    }
+
+    uint64_t instrumentAt(uint32_t index) const noexcept { return ids_[index]; }
+    uint32_t size() const noexcept { return static_cast<uint32_t>(ids_.size()); }
+    uint32_t capacity() const noexcept { return maxInstruments_; }
+
+   private:
+    static constexpr uint64_t kKnuth = 11400714819323198485ull;
+
+    struct Slot {
+      uint64_t iid{0};
+      uint32_t index{0};
+    };
+
+    static uint32_t tableSizeFor(uint32_t n) noexcept {
+      uint32_t size = 2;
+      while (size < n * 2u && size < (1u << 30)) size <<= 1;
+      return size;
+    }
+
+    uint32_t slotFor(uint64_t instrumentId) const noexcept {
+      return static_cast<uint32_t>((instrumentId * kKnuth) >> 32) & mask_;
+    }
+
+    const uint32_t maxInstruments_;
+    const uint32_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    std::vector<uint64_t> ids_;
+  };
+
+} // namespace b3::md
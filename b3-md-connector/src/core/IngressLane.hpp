@@ -0,0 +1,209 @@
+#pragma once
+
+#include "QueueMemory.hpp"
+#include "SnapshotQueueSpsc.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace b3::md {
+
+  // Lane de ingreso del thread productor actual.
+  //
+  // Cada worker tiene una SPSC por lane; un thread que hace tryEnqueue() siempre escribe en
+  // SU lane, así varios feed threads de OnixS pueden alimentar el mismo shard sin romper el
+  // contrato single-producer. Los threads que nunca se bindean usan la lane 0 (caso único
+  // productor: feed engine default/single, tests).
+  //
+  // Es thread_local de proceso: un thread tiene la misma lane en todos los pipelines.
+  inline constexpr uint32_t kNoIngressLane = UINT32_MAX;
+
+  inline thread_local uint32_t tlsIngressLane = 0;
+
+  enum class IngressPush : uint8_t {
+    Ok = 0,
+    Full = 1,   // la SPSC de la lane está llena
+    NoLane = 2, // thread no registrado (o más feed threads que lanes)
+  };
+
+  /**
+   * @brief Lanes de ingreso de un consumer: una SPSC por lane, mergeadas por ticket.
+   *
+   * Lo usan MdPublishWorker, MdTradeLane (uno por shard), MdStateLane y el journal.
+   * El ticket es monotónico por set y se toma ANTES del push. Si OnixS entrega dos updates del
+   * mismo instrumento desde threads distintos, el segundo callback empieza después de que el
+   * primero terminó (el Handler serializa por libro) => ticket(primero) < ticket(segundo), y
+   * pick() devuelve siempre el head de menor ticket: FIFO por instrumento.
+   *
+   * Las colas se crean con first-touch diferido: el consumer llama firstTouch() desde su thread.
+   */
+  template <typename T, size_t CapacityPow2>
+  class IngressLaneSet final {
+   public:
+    struct Slot {
+      uint64_t ticket{0};
+      T value{};
+    };
+
+    using Queue = SnapshotQueueSpsc<Slot, CapacityPow2>;
+
+    IngressLaneSet(uint32_t laneCount, QueueConfig queue) {
+      if (laneCount == 0)
+        throw std::invalid_argument("IngressLaneSet: laneCount == 0");
+      lanes_.reserve(laneCount);
+      for (uint32_t l = 0; l < laneCount; ++l)
+        lanes_.emplace_back(
+            std::make_unique<Queue>(queue.capacity, queue.hugePages, /*deferFirstTouch=*/true));
+    }
+
+    IngressLaneSet(const IngressLaneSet &) = delete;
+    IngressLaneSet &operator=(const IngressLaneSet &) = delete;
+
+    // Producer: solo el thread dueño de `lane`. fill(T&) escribe directo en el slot.
+    template <typename Fill>
+    IngressPush tryPushWith(uint32_t lane, Fill &&fill) noexcept {
+      if (lane >= lanes_.size())
+        return IngressPush::NoLane; // dropear: nunca compartir una SPSC entre productores
+
+      // Con una sola lane no hay merge: el ticket no se usa y evitamos el RMW compartido.
+      const uint64_t ticket =
+          lanes_.size() == 1 ? 0 : nextTicket_.fetch_add(1, std::memory_order_relaxed);
+
+      const bool ok = lanes_[lane]->try_push_with([&](Slot &slot) noexcept {
+        slot.ticket = ticket;
+        fill(slot.value);
+      });
+      return ok ? IngressPush::Ok : IngressPush::Full;
+    }
+
+    IngressPush tryPush(uint32_t lane, const T &value) noexcept {
+      return tryPushWith(lane, [&](T &slot) noexcept { slot = value; });
+    }
+
+    // Merge justo (orden de llegada global por ticket) que preserva FIFO por instrumento.
+    // Un candidato visto en la pasada k se confirma con una pasada k+1: sus predecesores
+    // happen-before de la acquire que lo vio, así que en k+1 ya son visibles y, siendo cada lane
+    // monotónica en ticket, aparecerían como head con ticket menor. -1 = todas vacías.
+    int pick() const noexcept {
+      if (lanes_.size() == 1)
+        return lanes_[0]->front() ? 0 : -1;
+
+      int best = minHeadLane();
+      while (best >= 0) {
+        const int again = minHeadLane(); // best sigue ahí: solo este thread consume
+        if (again == best)
+          return best;
+        best = again;
+      }
+      return -1;
+    }
+
+    // Consumer: el head de `lane` (precondición: pick() la devolvió). Válido hasta pop().
+    const T &front(int lane) const noexcept {
+      return lanes_[static_cast<size_t>(lane)]->front()->value;
+    }
+
+    void pop(int lane) noexcept { lanes_[static_cast<size_t>(lane)]->pop(); }
+
+    // Desde el thread consumer, antes de que escriba ningún producer.
+    void firstTouch() noexcept {
+      for (auto &q : lanes_) q->firstTouch();
+    }
+
+    uint64_t queuedApprox() const noexcept {
+      uint64_t n = 0;
+      for (const auto &q : lanes_) n += q->size_approx();
+      return n;
+    }
+
+    size_t memoryBytes() const noexcept {
+      size_t n = 0;
+      for (const auto &q : lanes_) n += q->memoryBytes();
+      return n;
+    }
+
+    uint32_t size() const noexcept { return static_cast<uint32_t>(lanes_.size()); }
+    const Queue &lane(size_t i) const noexcept { return *lanes_[i]; }
+
+   private:
+    // Lane cuyo head tiene el menor ticket (-1 si todas vacías).
+    int minHeadLane() const noexcept {
+      int best = -1;
+      uint64_t bestTicket = 0;
+      for (size_t i = 0; i < lanes_.size(); ++i) {
+        const Slot *h = lanes_[i]->front();
+        if (h && (best < 0 || h->ticket < bestTicket)) {
+          best = static_cast<int>(i);
+          bestTicket = h->ticket;
+        }
+      }
+      return best;
+    }
+
+    std::vector<std::unique_ptr<Queue>> lanes_;
+    alignas(64) std::atomic<uint64_t> nextTicket_{0};
+  };
+
+  /**
+   * @brief Thread consumer de lanes de ingreso: start/stop idempotentes, logger asíncrono y
+   *        espera del first-touch.
+   *
+   * El body corre en el thread nuevo y llama markTouched() después del firstTouch() de sus
+   * colas; start() vuelve recién ahí, así ningún producer escribe antes de que las páginas
+   * estén mapeadas desde el thread consumer. El dueño llama stop() en su destructor (el body
+   * usa sus miembros).
+   */
+  template <typename Logger>
+  class IngressConsumer final {
+   public:
+    IngressConsumer() = default;
+    IngressConsumer(const IngressConsumer &) = delete;
+    IngressConsumer &operator=(const IngressConsumer &) = delete;
+
+    template <typename Body>
+    void start(Body &&body) {
+      bool expected = false;
+      if (!running_.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+        return;
+
+      logger_.start();
+      drainOnStop_.store(true, std::memory_order_relaxed);
+      touched_.store(false, std::memory_order_relaxed);
+      thread_ = std::thread(std::forward<Body>(body));
+
+      while (!touched_.load(std::memory_order_acquire)) std::this_thread::yield();
+    }
+
+    // drain = el body sigue hasta vaciar sus colas (ver drainOnStop()).
+    void stop(bool drain = true) {
+      drainOnStop_.store(drain, std::memory_order_relaxed);
+      running_.store(false, std::memory_order_release);
+      if (thread_.joinable())
+        thread_.join();
+      logger_.stop();
+    }
+
+    void markTouched() noexcept { touched_.store(true, std::memory_order_release); }
+
+    bool running() const noexcept { return running_.load(std::memory_order_acquire); }
+    bool drainOnStop() const noexcept { return drainOnStop_.load(std::memory_order_relaxed); }
+
+    Logger &logger() noexcept { return logger_; }
+    const Logger &logger() const noexcept { return logger_; }
+
+   private:
+    Logger logger_;
+
+    std::atomic<bool> running_{false};
+    std::atomic<bool> drainOnStop_{true};
+    std::atomic<bool> touched_{false};
+    std::thread thread_{};
+  };
+
+} // namespace b3::md
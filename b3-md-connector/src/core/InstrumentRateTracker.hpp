@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+namespace b3::md {
+
+  // Contador de eventos por instrumento de UN worker (single writer: el thread del worker).
+  // Tabla open-addressing fija, sin alloc ni borrado en hot path; cualquier thread puede leer
+  // (forEach) para calcular tasas por diferencia entre muestras (rebalancer).
+  // instrumentId 0 = slot libre (0 no es un SecurityID válido).
+  class InstrumentRateTracker final {
+   public:
+    static constexpr uint32_t kMaxProbes = 16;
+
+    explicit InstrumentRateTracker(uint32_t capacityPow2 = 4096)
+        : mask_(capacityPow2 - 1), slots_(std::make_unique<Slot[]>(capacityPow2)) {
+      if (capacityPow2 < 2 || (capacityPow2 & (capacityPow2 - 1)) != 0)
+        throw std::invalid_argument("InstrumentRateTracker: capacity must be a power of two");
+    }
+
+    InstrumentRateTracker(const InstrumentRateTracker &) = delete;
+    InstrumentRateTracker &operator=(const InstrumentRateTracker &) = delete;
+
+    // Hot path (worker thread): no throw, no alloc.
+    void record(uint64_t instrumentId) noexcept {
+      if (instrumentId == 0)
+        return;
+      uint32_t i = static_cast<uint32_t>((instrumentId * kKnuth) >> 32) & mask_;
+      for (uint32_t p = 0; p < kMaxProbes; ++p, i = (i + 1) & mask_) {
+        Slot &s = slots_[i];
+        const uint64_t key = s.iid.load(std::memory_order_relaxed);
+        if (key == instrumentId) {
+          s.count.store(s.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+          return;
+        }
+        if (key == 0) {
+          s.count.store(1, std::memory_order_relaxed);
+          s.iid.store(instrumentId, std::memory_order_release);
+          return;
+        }
+      }
+      untracked_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // f(instrumentId, totalCount). Lecturas relaxed: valores aproximados, monotónicos.
+    template <typename F>
+    void forEach(F &&f) const {
+      for (uint32_t i = 0; i <= mask_; ++i) {
+        const uint64_t key = slots_[i].iid.load(std::memory_order_acquire);
+        if (key != 0)
+          f(key, slots_[i].count.load(std::memory_order_relaxed));
+      }
+    }
+
+    uint64_t untracked() const noexcept { return untracked_.load(std::memory_order_relaxed); }
+
+   private:
+    static constexpr uint64_t kKnuth = 11400714819323198485ull;
+
+    struct Slot {
+      std::atomic<uint64_t> iid{0};
+      std::atomic<uint64_t> count{0};
+    };
+
+    const uint32_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<uint64_t> untracked_{0};
+  };
+
+} // namespace b3::md
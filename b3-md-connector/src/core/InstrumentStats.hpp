@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+namespace b3::md {
+
+  // Estadísticas de sesión de un instrumento (MdStatsEngine). Precios en mantissa de 4 decimales,
+  // válidos solo si el bit correspondiente de `flags` está prendido.
+  struct InstrumentStats {
+    enum Flag : uint16_t {
+      HasOpen = 1u << 0,
+      HasHigh = 1u << 1,
+      HasLow = 1u << 2,
+      HasLast = 1u << 3,
+      HasClose = 1u << 4,
+      HasSettlement = 1u << 5,
+      OpenFromExchange = 1u << 6, // OpeningPrice_15 manda sobre el primer trade
+    };
+
+    uint64_t instrumentId{0};
+
+    int64_t open{0};
+    int64_t high{0};
+    int64_t low{0};
+    int64_t last{0};
+    int64_t lastQty{0};
+    int64_t close{0};
+    int64_t settlement{0};
+
+    int64_t volume{0};   // cantidad operada (trades - busts)
+    double notional{0};  // sum(precio * cantidad), precio en unidades (no mantissa)
+    uint64_t tradeCount{0};
+
+    uint64_t lastTransactNs{0};
+    uint32_t lastRptSeq{0};
+    uint32_t firstTradeId{0}; // rango de TradeIDs contados (Trade_53): un bust fuera no descuenta
+    uint32_t lastTradeId{0};
+    uint16_t session{0};      // época de TradeEvent::session con la que se armó
+    uint16_t flags{0};
+    bool dirty{false};
+
+    bool has(Flag f) const noexcept { return (flags & f) != 0; }
+
+    // VWAP en unidades de precio; 0 sin volumen.
+    double vwap() const noexcept {
+      return volume > 0 ? notional / static_cast<double>(volume) : 0.0;
+    }
+  };
+
+  static_assert(std::is_trivially_copyable_v<InstrumentStats>);
+
+} // namespace b3::md
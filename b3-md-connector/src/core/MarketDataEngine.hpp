@@ -1,7 +1,14 @@
 #pragma once
 
+#include "BookStaleTable.hpp"
+#include "MarketStateEvent.hpp"
+#include "MdInlinePublisher.hpp"
 #include "MdPublishPipeline.hpp"
+#include "MdStateLane.hpp"
+#include "MdTradeLane.hpp"
 #include "OrdersSnapshot.hpp"
+#include "SnapshotJournal.hpp"
+#include "TradeEvent.hpp"
 #include "../onixs/OnixsOrdersSnapshotBuilder.hpp"
 
 #include <atomic>
@@ -20,6 +27,91 @@ namespace b3::md {
     // - si no lo seteás: publica siempre (modo legacy / tests)
     void setRegistryReadyFlag(const std::atomic<bool> *ready) noexcept { registryReady_ = ready; }
 
+    // Captura opcional: cada snapshot ACEPTADO por el pipeline se copia al journal
+    // (cola SPSC por lane + writer en background; lleno => drop en el journal, no acá).
+    void setCaptureJournal(SnapshotJournalWriter *journal) noexcept { journal_ = journal; }
+
+    // Modo inline opcional (md.publish.inline): los books (y marcadores stale) se publican en el
+    // thread del callback en vez de encolarse en el pipeline. Un solo feed thread por publisher.
+    void setInlinePublisher(MdInlinePublisher *inlinePublisher) noexcept {
+      inline_ = inlinePublisher;
+    }
+
+    // Lane de trades opcional (nullptr = trades descartados). Mismo hash de shard que los books.
+    // También recibe los precios estadísticos del exchange (TradeKind::*Price) para MdStatsEngine.
+    void setTradeLane(MdTradeLane *trades) noexcept { trades_ = trades; }
+
+    void onTrade(const TradeEvent &trade) noexcept {
+      if (!trades_)
+        return;
+
+      if (registryReady_ && !registryReady_->load(std::memory_order_acquire)) {
+        gatedDrops_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+
+      TradeEvent t = trade;
+      t.session = session_.load(std::memory_order_relaxed);
+      if (!trades_->tryEnqueue(pipeline_.homeShard(trade.instrumentId), t))
+        tradeDrops_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // ChannelReset_11: el canal arranca de cero. Los eventos siguientes llevan otra época y
+    // MdStatsEngine reinicia cada instrumento al ver la primera (FIFO por instrumento alcanza,
+    // sin ordenar el reset contra los demás shards).
+    void onSessionReset() noexcept {
+      session_.fetch_add(1, std::memory_order_relaxed);
+      sessionResets_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t sessionResets() const noexcept {
+      return sessionResets_.load(std::memory_order_relaxed);
+    }
+
+    // Lane de estado de mercado opcional (nullptr = eventos de status/subasta/bandas descartados).
+    void setStateLane(MdStateLane *state) noexcept { state_ = state; }
+
+    void onMarketState(const MarketStateEvent &e) noexcept {
+      if (!state_)
+        return;
+
+      if (registryReady_ && !registryReady_->load(std::memory_order_acquire)) {
+        gatedDrops_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+
+      if (!state_->tryEnqueue(e))
+        stateDrops_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Libros desactualizados opcional (nullptr = onOrderBookOutOfDate solo se cuenta).
+    void setBookStaleTable(BookStaleTable *stale) noexcept { stale_ = stale; }
+
+    // OnixS onSnapshotRecoveryStarted/Finished: mientras dura, los libros stale no se publican
+    // (se están reconstruyendo desde el snapshot: serían parciales).
+    void setSnapshotRecovery(bool active) noexcept {
+      snapshotRecovery_.store(active, std::memory_order_release);
+    }
+
+    // onOrderBookOutOfDate / gap de RptSeq: marca el libro stale y publica UNA vez el marcador
+    // "book invalid" por el mismo shard que el libro (queda ordenado después del último update).
+    // Los updates siguientes se suprimen hasta la recuperación; el primero que pasa sale como
+    // refresh completo (OrdersSnapshot::kBookRefresh). Si el marcador no entra en la cola queda
+    // pendiente y lo reintenta el próximo evento del libro mientras siga stale.
+    void onBookOutOfDate(uint64_t instrumentId, uint64_t rptSeq, uint64_t nowNs) noexcept {
+      if (!stale_)
+        return;
+      if (registryReady_ && !registryReady_->load(std::memory_order_acquire))
+        return; // todavía no se publicó nada de este libro
+      if (!stale_->markStale(instrumentId)) {
+        if (stale_->takeMarkerPending(instrumentId))
+          publishStaleMarker(instrumentId, rptSeq, nowNs);
+        return;
+      }
+      staleMarked_.fetch_add(1, std::memory_order_relaxed);
+      publishStaleMarker(instrumentId, rptSeq, nowNs);
+    }
+
     void onOrderBookUpdated(const ::OnixS::B3::MarketData::UMDF::OrderBook &book,
                             uint64_t nowNs) noexcept {
       // Strict gating
@@ -28,11 +120,21 @@ namespace b3::md {
         return;
       }
 
+      uint8_t flags = 0;
+      if (!admitBook(static_cast<uint64_t>(book.instrumentId()), nowNs, flags))
+        return;
+
       OrdersSnapshot snapshot{};
       b3::md::onixs::OnixsOrdersSnapshotBuilder::buildFromBook(book, nowNs, snapshot);
+      snapshot.flags = flags;
 
-      if (!pipeline_.tryEnqueue(snapshot))
+      if (!publishBook(snapshot)) {
         drops_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+
+      if (journal_)
+        (void)journal_->tryAppend(snapshot, nowNs);
     }
 
     // Testing-only: inject pre-built snapshot (bypasses OnixS book parsing)
@@ -43,19 +145,101 @@ namespace b3::md {
         return;
       }
 
-      if (!pipeline_.tryEnqueue(snapshot))
-        drops_.fetch_add(1, std::memory_order_relaxed);
+      uint8_t flags = 0;
+      if (!admitBook(snapshot.instrumentId, snapshot.exchangeTsNs, flags))
+        return;
+      if (flags != 0) {
+        OrdersSnapshot refresh = snapshot;
+        refresh.flags = flags;
+        enqueueTestSnapshot(refresh);
+        return;
+      }
+      enqueueTestSnapshot(snapshot);
     }
 
     uint64_t drops() const noexcept { return drops_.load(std::memory_order_relaxed); }
     uint64_t gatedDrops() const noexcept { return gatedDrops_.load(std::memory_order_relaxed); }
+    uint64_t tradeDrops() const noexcept { return tradeDrops_.load(std::memory_order_relaxed); }
+    uint64_t stateDrops() const noexcept { return stateDrops_.load(std::memory_order_relaxed); }
+    uint64_t staleMarked() const noexcept { return staleMarked_.load(std::memory_order_relaxed); }
+    uint64_t staleSuppressed() const noexcept {
+      return staleSuppressed_.load(std::memory_order_relaxed);
+    }
+    uint64_t staleRecovered() const noexcept {
+      return staleRecovered_.load(std::memory_order_relaxed);
+    }
+    uint64_t staleMarkerDrops() const noexcept {
+      return staleMarkerDrops_.load(std::memory_order_relaxed);
+    }
 
    private:
+    bool publishBook(const OrdersSnapshot &snapshot) noexcept {
+      return inline_ ? inline_->publish(snapshot) : pipeline_.tryEnqueue(snapshot);
+    }
+
+    void publishStaleMarker(uint64_t instrumentId, uint64_t rptSeq, uint64_t nowNs) noexcept {
+      OrdersSnapshot marker{};
+      marker.instrumentId = instrumentId;
+      marker.exchangeTsNs = nowNs;
+      marker.rptSeq = rptSeq;
+      marker.flags = OrdersSnapshot::kBookInvalid;
+
+      if (!publishBook(marker)) {
+        staleMarkerDrops_.fetch_add(1, std::memory_order_relaxed);
+        stale_->setMarkerPending(instrumentId);
+        return;
+      }
+      if (journal_)
+        (void)journal_->tryAppend(marker, nowNs);
+    }
+
+    // false = libro stale en recuperación (suprimido). flags = kBookRefresh si se recuperó ahora.
+    bool admitBook(uint64_t instrumentId, uint64_t nowNs, uint8_t &flags) noexcept {
+      if (!stale_ || !stale_->isStale(instrumentId))
+        return true;
+      if (snapshotRecovery_.load(std::memory_order_acquire)) {
+        staleSuppressed_.fetch_add(1, std::memory_order_relaxed);
+        if (stale_->takeMarkerPending(instrumentId))
+          publishStaleMarker(instrumentId, 0, nowNs);
+        return false;
+      }
+      // OnixS: el primer onOrderBookUpdated después de OutOfDate deja el libro al día
+      if (stale_->clear(instrumentId)) {
+        flags = OrdersSnapshot::kBookRefresh;
+        staleRecovered_.fetch_add(1, std::memory_order_relaxed);
+      }
+      return true;
+    }
+
+    void enqueueTestSnapshot(const OrdersSnapshot &snapshot) noexcept {
+      if (!publishBook(snapshot)) {
+        drops_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+
+      if (journal_)
+        (void)journal_->tryAppend(snapshot, journal::nowNsSystem());
+    }
+
     MdPublishPipeline &pipeline_;
+    MdInlinePublisher *inline_{nullptr};
     const std::atomic<bool> *registryReady_{nullptr};
+    SnapshotJournalWriter *journal_{nullptr};
+    MdTradeLane *trades_{nullptr};
+    MdStateLane *state_{nullptr};
+    BookStaleTable *stale_{nullptr};
+    std::atomic<bool> snapshotRecovery_{false};
+    std::atomic<uint16_t> session_{0}; // época de sesión que se estampa en cada TradeEvent
 
     std::atomic<uint64_t> drops_{0};
     std::atomic<uint64_t> gatedDrops_{0};
+    std::atomic<uint64_t> tradeDrops_{0};
+    std::atomic<uint64_t> stateDrops_{0};
+    std::atomic<uint64_t> staleMarked_{0};
+    std::atomic<uint64_t> staleSuppressed_{0};
+    std::atomic<uint64_t> staleRecovered_{0};
+    std::atomic<uint64_t> staleMarkerDrops_{0};
+    std::atomic<uint64_t> sessionResets_{0};
   };
 
 } // namespace b3::md
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+namespace b3::md {
+
+  enum class MarketStateKind : uint8_t {
+    SecurityStatus = 0,     // SecurityStatus_3 (instrumento)
+    GroupPhase = 1,         // SecurityGroupPhase_10 (grupo)
+    AuctionImbalance = 2,   // AuctionImbalance_19
+    TheoreticalOpening = 3, // TheoreticalOpeningPrice_16
+    PriceBand = 4,          // PriceBand_22
+    QuantityBand = 5,       // QuantityBand_21
+  };
+
+  // Valores B3 de SecurityTradingStatus / TradingSessionSubID (mismos números que FIX 326).
+  inline constexpr uint8_t kB3StatusPause = 2;
+  inline constexpr uint8_t kB3StatusClose = 4;
+  inline constexpr uint8_t kB3StatusOpen = 17;
+  inline constexpr uint8_t kB3StatusForbidden = 18;
+  inline constexpr uint8_t kB3StatusUnknown = 20;
+  inline constexpr uint8_t kB3StatusReserved = 21;
+  inline constexpr uint8_t kB3StatusFinalClosingCall = 101;
+
+  // SecurityTradingEvent: el instrumento vuelve a seguir la fase de su grupo.
+  inline constexpr uint8_t kB3EventRejoinsGroup = 102;
+
+  /**
+   * @brief Evento de estado de mercado copiado en el callback de OnixS (POD, sin heap).
+   *
+   * Qué campos valen depende de kind:
+   * - SecurityStatus: instrumentId, status, tradingEvent
+   * - GroupPhase: group, status (TradingSessionSubID), tradingEvent
+   * - AuctionImbalance: instrumentId, qty (con signo: + compradores, - vendedores), deleted
+   * - TheoreticalOpening: instrumentId, price, qty, deleted
+   * - PriceBand: instrumentId, price (low), price2 (high), price3 (referencia), flags kHas*
+   * - QuantityBand: instrumentId, qty (promedio diario), qty2 (máximo por trade)
+   * Precios en mantissa de 4 decimales.
+   */
+  struct MarketStateEvent {
+    static constexpr uint8_t kHasPrice = 1u << 0;
+    static constexpr uint8_t kHasPrice2 = 1u << 1;
+    static constexpr uint8_t kHasPrice3 = 1u << 2;
+    static constexpr uint8_t kHasQty = 1u << 3;
+    static constexpr uint8_t kHasQty2 = 1u << 4;
+
+    uint64_t instrumentId{0};
+    int64_t price{0};
+    int64_t price2{0};
+    int64_t price3{0};
+    int64_t qty{0};
+    int64_t qty2{0};
+    uint64_t transactTimeNs{0};
+    uint32_t rptSeq{0};
+
+    char group[4]{}; // SecurityGroup (3 chars + '\0')
+    MarketStateKind kind{MarketStateKind::SecurityStatus};
+    uint8_t status{0};
+    uint8_t tradingEvent{0};
+    uint8_t flags{0};
+    bool deleted{false};
+  };
+
+  static_assert(std::is_trivially_copyable_v<MarketStateEvent>);
+  static_assert(sizeof(MarketStateEvent) <= 72);
+
+} // namespace b3::md
@@ -0,0 +1,313 @@
+#pragma once
+
+#include "DenseInstrumentIndex.hpp"
+#include "MarketStateEvent.hpp"
+
+#include <b3/common/InstrumentRegistry.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace b3::md {
+
+  // Lo que se publica de un instrumento: si cambia algo de acá, sale un mensaje.
+  struct PublishedMarketState {
+    uint8_t status{0};        // efectivo: propio (SecurityStatus_3) o el de su grupo
+    uint8_t tradingEvent{0};
+    bool hasTop{false};
+    bool hasImbalance{false};
+    bool hasBand{false};
+    bool hasQtyBand{false};
+    int64_t topPrice{0};      // TheoreticalOpeningPrice_16
+    int64_t topQty{0};
+    int64_t imbalanceQty{0};  // + compradores / - vendedores
+    int64_t bandLow{0};       // PriceBand_22 (0 = sin límite)
+    int64_t bandHigh{0};
+    int64_t bandRef{0};
+    int64_t avgDailyQty{0};   // QuantityBand_21
+    int64_t maxTradeVol{0};
+
+    bool operator==(const PublishedMarketState &) const = default;
+  };
+
+  struct InstrumentMarketState {
+    static constexpr uint16_t kNoGroup = UINT16_MAX;
+
+    uint64_t instrumentId{0};
+    PublishedMarketState view{};
+    uint8_t ownStatus{0};      // último SecurityStatus_3 (0 = nunca)
+    bool followsGroup{true};   // hasta que llegue un status propio / tras "rejoin group"
+    uint16_t group{kNoGroup};  // índice en la tabla de grupos
+    uint32_t lastRptSeq{0};
+    uint64_t lastTransactNs{0};
+  };
+
+  struct GroupMarketState {
+    char name[4]{};
+    uint8_t phase{0}; // TradingSessionSubID
+    uint8_t tradingEvent{0};
+    uint64_t lastTransactNs{0};
+  };
+
+  /**
+   * @brief Tabla de estado de mercado por instrumento (índice denso) y por grupo.
+   *
+   * La escribe un solo thread (MdStateLane) y la leen otros (query de late joiners en el
+   * subscription server). Es una lane de baja tasa: un mutex alcanza y mantiene las lecturas
+   * consistentes. Detecta cambios: apply() devuelve solo los instrumentos cuya vista publicable
+   * cambió (un cambio de fase de grupo puede tocar varios).
+   */
+  class MarketStateTable final {
+   public:
+    static constexpr uint32_t kMaxGroups = 256;
+
+    struct ApplyResult {
+      bool groupChanged{false};
+      uint16_t group{InstrumentMarketState::kNoGroup};
+    };
+
+    explicit MarketStateTable(uint32_t maxInstruments = 8192,
+                              const b3::common::InstrumentRegistry *registry = nullptr)
+        : index_(maxInstruments), registry_(registry) {
+      states_.reserve(maxInstruments);
+      lastPublished_.reserve(maxInstruments);
+    }
+
+    MarketStateTable(const MarketStateTable &) = delete;
+    MarketStateTable &operator=(const MarketStateTable &) = delete;
+
+    // Writer thread. changed: índices densos cuya vista publicable cambió (se agrega, no se limpia).
+    ApplyResult apply(const MarketStateEvent &e, std::vector<uint32_t> &changed) {
+      std::lock_guard<std::mutex> g(mu_);
+      ApplyResult r{};
+
+      if (e.kind == MarketStateKind::GroupPhase) {
+        const uint16_t gi = findOrInsertGroup(e.group);
+        if (gi == InstrumentMarketState::kNoGroup) {
+          ++overflow_;
+          return r;
+        }
+        GroupMarketState &gs = groups_[gi];
+        r.group = gi;
+        r.groupChanged = gs.phase != e.status || gs.tradingEvent != e.tradingEvent;
+        gs.phase = e.status;
+        gs.tradingEvent = e.tradingEvent;
+        if (e.transactTimeNs)
+          gs.lastTransactNs = e.transactTimeNs;
+
+        for (uint32_t i = 0; i < states_.size(); ++i) {
+          InstrumentMarketState &st = states_[i];
+          if (st.group == InstrumentMarketState::kNoGroup)
+            resolveGroup(st);
+          if (st.group == gi && st.followsGroup && refresh(st))
+            changed.push_back(i);
+        }
+        return r;
+      }
+
+      const uint32_t idx = index_.findOrInsert(e.instrumentId);
+      if (idx == DenseInstrumentIndex::kNone) {
+        ++overflow_;
+        return r;
+      }
+      if (idx == states_.size()) {
+        states_.emplace_back();
+        states_.back().instrumentId = e.instrumentId;
+      }
+
+      InstrumentMarketState &st = states_[idx];
+      if (st.group == InstrumentMarketState::kNoGroup)
+        resolveGroup(st);
+
+      PublishedMarketState &v = st.view;
+      switch (e.kind) {
+      case MarketStateKind::SecurityStatus:
+        st.ownStatus = e.status;
+        st.followsGroup = e.tradingEvent == kB3EventRejoinsGroup;
+        v.tradingEvent = e.tradingEvent;
+        break;
+      case MarketStateKind::AuctionImbalance:
+        v.hasImbalance = !e.deleted && (e.flags & MarketStateEvent::kHasQty);
+        v.imbalanceQty = v.hasImbalance ? e.qty : 0;
+        break;
+      case MarketStateKind::TheoreticalOpening:
+        v.hasTop = !e.deleted && (e.flags & MarketStateEvent::kHasPrice);
+        v.topPrice = v.hasTop ? e.price : 0;
+        v.topQty = v.hasTop && (e.flags & MarketStateEvent::kHasQty) ? e.qty : 0;
+        break;
+      case MarketStateKind::PriceBand:
+        v.hasBand = true;
+        if (e.flags & MarketStateEvent::kHasPrice)
+          v.bandLow = e.price;
+        if (e.flags & MarketStateEvent::kHasPrice2)
+          v.bandHigh = e.price2;
+        if (e.flags & MarketStateEvent::kHasPrice3)
+          v.bandRef = e.price3;
+        break;
+      case MarketStateKind::QuantityBand:
+        v.hasQtyBand = true;
+        if (e.flags & MarketStateEvent::kHasQty)
+          v.avgDailyQty = e.qty;
+        if (e.flags & MarketStateEvent::kHasQty2)
+          v.maxTradeVol = e.qty2;
+        break;
+      case MarketStateKind::GroupPhase:
+        break;
+      }
+
+      if (e.rptSeq)
+        st.lastRptSeq = e.rptSeq;
+      if (e.transactTimeNs)
+        st.lastTransactNs = e.transactTimeNs;
+
+      if (refresh(st))
+        changed.push_back(idx);
+      return r;
+    }
+
+    // Cualquier thread: copia del estado de un instrumento. Uno sin eventos propios (sin fila)
+    // toma la fase de su grupo del registry, que es lo que le aplica. false si no hay ninguno.
+    bool snapshot(uint64_t instrumentId, InstrumentMarketState &out) const {
+      std::lock_guard<std::mutex> g(mu_);
+      const uint32_t idx = index_.find(instrumentId);
+      if (idx != DenseInstrumentIndex::kNone) {
+        out = states_[idx];
+        return true;
+      }
+
+      const uint16_t gi = registryGroupOf(instrumentId);
+      if (gi == InstrumentMarketState::kNoGroup || groups_[gi].phase == 0)
+        return false;
+      out = InstrumentMarketState{};
+      out.instrumentId = instrumentId;
+      out.group = gi;
+      out.view.status = groups_[gi].phase;
+      out.view.tradingEvent = groups_[gi].tradingEvent;
+      out.lastTransactNs = groups_[gi].lastTransactNs;
+      return true;
+    }
+
+    bool snapshotAt(uint32_t index, InstrumentMarketState &out) const {
+      std::lock_guard<std::mutex> g(mu_);
+      if (index >= states_.size())
+        return false;
+      out = states_[index];
+      return true;
+    }
+
+    bool groupAt(uint16_t group, GroupMarketState &out) const {
+      std::lock_guard<std::mutex> g(mu_);
+      if (group >= groupCount_)
+        return false;
+      out = groups_[group];
+      return true;
+    }
+
+    // f(const InstrumentMarketState&) bajo lock: no llamar de vuelta a la tabla.
+    template <typename F>
+    void forEach(F &&f) const {
+      std::lock_guard<std::mutex> g(mu_);
+      for (const auto &st : states_) f(st);
+    }
+
+    // Delta intradiario del registry: un instrumento modificado puede haber cambiado de grupo;
+    // se vuelve a resolver en su próximo evento. Las altas se resuelven solas al primer evento.
+    void onRegistryDelta(const b3::common::RegistryDelta &delta) {
+      std::lock_guard<std::mutex> g(mu_);
+      for (uint64_t iid : delta.changed) {
+        const uint32_t idx = index_.find(iid);
+        if (idx != DenseInstrumentIndex::kNone && idx < states_.size())
+          states_[idx].group = InstrumentMarketState::kNoGroup;
+      }
+    }
+
+    uint32_t instruments() const {
+      std::lock_guard<std::mutex> g(mu_);
+      return static_cast<uint32_t>(states_.size());
+    }
+
+    uint32_t groups() const {
+      std::lock_guard<std::mutex> g(mu_);
+      return groupCount_;
+    }
+
+    uint64_t overflow() const {
+      std::lock_guard<std::mutex> g(mu_);
+      return overflow_;
+    }
+
+   private:
+    // Recalcula el status efectivo; true si la vista publicable cambió desde la última vez.
+    bool refresh(InstrumentMarketState &st) noexcept {
+      uint8_t status = st.ownStatus;
+      if (st.followsGroup && st.group != InstrumentMarketState::kNoGroup &&
+          groups_[st.group].phase != 0)
+        status = groups_[st.group].phase;
+      st.view.status = status;
+
+      const uint32_t idx = static_cast<uint32_t>(&st - states_.data());
+      if (idx >= lastPublished_.size())
+        lastPublished_.resize(idx + 1);
+      if (lastPublished_[idx] == st.view)
+        return false;
+      lastPublished_[idx] = st.view;
+      return true;
+    }
+
+    // Nombre del grupo del instrumento según el registry. false si no tiene.
+    bool registryGroupName(uint64_t instrumentId, char (&name)[4]) const {
+      if (!registry_)
+        return false;
+      const auto *data = registry_->tryResolveData(instrumentId);
+      if (!data || data->securityGroup.empty())
+        return false;
+      std::memcpy(name, data->securityGroup.data(), std::min<size_t>(3, data->securityGroup.size()));
+      return true;
+    }
+
+    // Grupo ya conocido del instrumento (sin alta): kNoGroup si no hay.
+    uint16_t registryGroupOf(uint64_t instrumentId) const {
+      char name[4]{};
+      return registryGroupName(instrumentId, name) ? findGroup(name)
+                                                   : InstrumentMarketState::kNoGroup;
+    }
+
+    void resolveGroup(InstrumentMarketState &st) {
+      char name[4]{};
+      if (registryGroupName(st.instrumentId, name))
+        st.group = findOrInsertGroup(name);
+    }
+
+    uint16_t findGroup(const char *name) const noexcept {
+      for (uint32_t i = 0; i < groupCount_; ++i)
+        if (std::strncmp(groups_[i].name, name, 3) == 0)
+          return static_cast<uint16_t>(i);
+      return InstrumentMarketState::kNoGroup;
+    }
+
+    uint16_t findOrInsertGroup(const char *name) noexcept {
+      if (const uint16_t gi = findGroup(name); gi != InstrumentMarketState::kNoGroup)
+        return gi;
+      if (groupCount_ >= kMaxGroups || name[0] == '\0')
+        return InstrumentMarketState::kNoGroup;
+      std::memcpy(groups_[groupCount_].name, name, 3);
+      groups_[groupCount_].name[3] = '\0';
+      return static_cast<uint16_t>(groupCount_++);
+    }
+
+    mutable std::mutex mu_;
+    DenseInstrumentIndex index_;
+    const b3::common::InstrumentRegistry *registry_;
+
+    std::vector<InstrumentMarketState> states_;        // por índice denso
+    std::vector<PublishedMarketState> lastPublished_;  // última vista publicada (change detection)
+    std::array<GroupMarketState, kMaxGroups> groups_{};
+    uint32_t groupCount_{0};
+    uint64_t overflow_{0};
+  };
+
+} // namespace b3::md
@@ -11,6 +11,8 @@ namespace b3::md {
 inline void aggregateMboWindowToMbpTopN(const OrdersSnapshot& in, BookSnapshot& out) noexcept {
     out.instrumentId = in.instrumentId;
     out.exchangeTsNs = in.exchangeTsNs;
+    out.rptSeq = in.rptSeq;
+    out.flags = in.flags;
     out.bidCount = 0;
     out.askCount = 0;
 
@@ -40,14 +42,22 @@ inline void aggregateMboWindowToMbpTopN(const OrdersSnapshot& in, BookSnapshot&
         }
     };
 
+    // Ventana ordenada mejor -> peor: con DEPTH niveles armados, seguimos sumando órdenes del
+    // último nivel y cortamos recién en el primer precio nuevo.
+    auto full = [](const Level* levels, uint8_t count, int64_t priceMantissa) noexcept {
+        return count == BookSnapshot::DEPTH &&
+               static_cast<int64_t>(levels[count - 1].price) != priceMantissa;
+    };
+
     // BID side
     {
         
         const uint16_t n = in.bidsCopied; // // solo lo copiado porque hubo descartes de raw donde order == market
-        for (uint16_t i = 0; i < n && out.bidCount < BookSnapshot::DEPTH; ++i) {
+        for (uint16_t i = 0; i < n; ++i) {
             const auto& e = in.bids[i];
             if (e.qty == 0) continue;
             if (e.priceMantissa == 0) continue;
+            if (full(out.bids, out.bidCount, e.priceMantissa)) break;
 
             add_level(out.bids, out.bidCount, e.priceMantissa, e.qty);
         }
@@ -56,10 +66,11 @@ inline void aggregateMboWindowToMbpTopN(const OrdersSnapshot& in, BookSnapshot&
     // ASK side
     {
         const uint16_t n = in.asksCopied; // solo lo copiado porque hubo descartes de raw donde order == market
-        for (uint16_t i = 0; i < n && out.askCount < BookSnapshot::DEPTH; ++i) {
+        for (uint16_t i = 0; i < n; ++i) {
             const auto& e = in.asks[i];
             if (e.qty == 0) continue;
             if (e.priceMantissa == 0) continue;
+            if (full(out.asks, out.askCount, e.priceMantissa)) break;
 
             add_level(out.asks, out.askCount, e.priceMantissa, e.qty);
         }
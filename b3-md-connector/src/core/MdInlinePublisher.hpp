@@ -0,0 +1,72 @@
+#pragma once
+
+#include "BookSnapshot.hpp"
+#include "MboToMbpAggregator.hpp"
+#include "OrdersSnapshot.hpp"
+
+#include "../mapping/InstrumentTopicMapper.hpp"
+#include "../mapping/MdSnapshotMapper.hpp"
+#include "../publishing/IPublishSink.hpp"
+#include "../publishing/SerializedEnvelope.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace b3::md {
+
+  /**
+   * @brief Publicación inline de books: agregación MBO->MBP, topic, serialización y envío en el
+   *        thread que llama (el callback de OnixS), sin SPSC de shard, worker ni concentrator.
+   *
+   * Mismos componentes que MdPublishWorker::run() (aggregateMboWindowToMbpTopN, topic mapper,
+   * MdSnapshotMapper), así que el wire es idéntico. Pensado para pocos instrumentos y un solo
+   * feed thread: el estado (BookSnapshot + envelope) es de este objeto, NO es thread-safe.
+   * Todo el costo de serializar y mandar lo paga el feed thread.
+   */
+  class MdInlinePublisher final {
+   public:
+    MdInlinePublisher(const mapping::MdSnapshotMapper &mapper,
+                      const mapping::InstrumentTopicMapper &topicMapper,
+                      publishing::IPublishSink &sink)
+        : mapper_(mapper), topicMapper_(topicMapper), sink_(sink),
+          ev_(std::make_unique<publishing::SerializedEnvelope>()) {}
+
+    MdInlinePublisher(const MdInlinePublisher &) = delete;
+    MdInlinePublisher &operator=(const MdInlinePublisher &) = delete;
+
+    bool publish(const OrdersSnapshot &s) noexcept {
+      aggregateMboWindowToMbpTopN(s, mbp_);
+
+      auto [topicPtr, topicLen] = topicMapper_.getTopic(s.instrumentId);
+      if (!topicPtr || topicLen == 0 ||
+          !mapper_.mapToSerializedEnvelope(mbp_, *ev_, topicPtr, topicLen)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      ev_->sourceTsNs = mbp_.exchangeTsNs;
+
+      if (!sink_.tryPublish(0, *ev_)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      published_.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+
+    uint64_t published() const noexcept { return published_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+
+   private:
+    const mapping::MdSnapshotMapper &mapper_;
+    const mapping::InstrumentTopicMapper &topicMapper_;
+    publishing::IPublishSink &sink_;
+
+    BookSnapshot mbp_{};
+    std::unique_ptr<publishing::SerializedEnvelope> ev_; // 16KB: fuera del objeto
+
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> dropped_{0};
+  };
+
+} // namespace b3::md
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "MdPublishWorker.hpp"
+#include "IngressLane.hpp"
+#include "ShardOverrideTable.hpp"
 #include "OrdersSnapshot.hpp"
 
 #include <cstdint>
@@ -22,6 +24,14 @@ public:
         if (workers_.empty()) {
             throw std::invalid_argument("MdPublishPipeline: workers empty");
         }
+        for (const auto& w : workers_) {
+            if (w->laneCount() != workers_.front()->laneCount()) {
+                throw std::invalid_argument("MdPublishPipeline: workers with different laneCount");
+            }
+        }
+        for (auto& w : workers_) {
+            w->attachRebalancing(&overrides_, &workers_);
+        }
     }
 
     MdPublishPipeline(const MdPublishPipeline&) = delete;
@@ -50,14 +60,79 @@ public:
     // Hot path: no throw, no alloc.
     // Devuelve false si se dropeó (cola llena).
     bool tryEnqueue(const OrdersSnapshot& snapshot) noexcept {
-        const uint32_t shard = shardFor(snapshot.instrumentId);
+        const uint32_t shard = currentShard(snapshot.instrumentId);
         return workers_[shard]->tryEnqueue(snapshot);
     }
 
+    // Shard actual: override del rebalancer si existe, si no el hash.
+    uint32_t currentShard(uint64_t instrumentId) const noexcept {
+        uint32_t shard = 0;
+        if (overrides_.size() != 0 && overrides_.lookup(instrumentId, shard) && shard < workers_.size()) {
+            return shard;
+        }
+        return shardFor(instrumentId);
+    }
+
+    // Shard por hash, sin overrides del rebalancer: ruteo estable para lanes que no hacen
+    // handoff (trades), así el FIFO por instrumento no depende de los movimientos de books.
+    uint32_t homeShard(uint64_t instrumentId) const noexcept { return shardFor(instrumentId); }
+
+    // Rebalancer: mueve un instrumento a otro shard (drain-and-handoff, ver MdPublishWorker).
+    // false si ya está ahí, si hay un handoff en curso o si la tabla de overrides está llena.
+    bool moveInstrument(uint64_t instrumentId, uint32_t toShard) noexcept {
+        if (toShard >= workers_.size() || overrides_.pendingHandoffs() != 0) {
+            return false;
+        }
+        const uint32_t from = currentShard(instrumentId);
+        if (from == toShard) {
+            return false;
+        }
+        if (!overrides_.route(instrumentId, toShard, from)) {
+            return false;
+        }
+        workers_[toShard]->expectHandoff(instrumentId); // completa aunque no lleguen eventos
+        return true;
+    }
+
+    bool handoffPending() const noexcept { return overrides_.pendingHandoffs() != 0; }
+    uint32_t overrideCount() const noexcept { return overrides_.size(); }
+
+    MdPublishWorker& worker(uint32_t shard) noexcept { return *workers_[shard]; }
+    const MdPublishWorker& worker(uint32_t shard) const noexcept { return *workers_[shard]; }
+
     uint32_t shardCount() const noexcept {
         return static_cast<uint32_t>(workers_.size());
     }
 
+    uint32_t laneCount() const noexcept {
+        return workers_.front()->laneCount();
+    }
+
+    // Asigna la próxima lane libre al thread que llama (feed thread de OnixS al arrancar).
+    // Devuelve false si ya no quedan lanes: ese thread queda sin lane y sus enqueues se dropean
+    // (contados en laneRejected) en lugar de compartir una SPSC con otro productor.
+    bool bindCurrentThreadToLane() noexcept {
+        const uint32_t lane = nextLane_.fetch_add(1, std::memory_order_relaxed);
+        if (lane >= laneCount()) {
+            tlsIngressLane = kNoIngressLane;
+            return false;
+        }
+        tlsIngressLane = lane;
+        return true;
+    }
+
+    size_t queueMemoryBytes() const noexcept {
+        size_t n = 0;
+        for (const auto& w : workers_) n += w->queueMemoryBytes();
+        return n;
+    }
+
+    uint64_t laneRejected() const noexcept {
+        uint64_t n = 0;
+        for (const auto& w : workers_) n += w->laneRejected();
+        return n;
+    }
+
 private:
     // Hash multiplicativo para mejorar distribución si instrumentId tiene patrones.
     static constexpr uint64_t kKnuth = 11400714819323198485ull;
@@ -68,8 +143,11 @@ private:
     }
 
 private:
+    // Declarada antes que workers_: los workers la referencian hasta destruirse.
+    ShardOverrideTable overrides_{};
     std::vector<std::unique_ptr<MdPublishWorker>> workers_;
     std::atomic<bool> started_{false};
+    std::atomic<uint32_t> nextLane_{0};
 };
 
 } // namespace b3::md
@@ -1,14 +1,18 @@
 #pragma once
 
-#include "SnapshotQueueSpsc.hpp"
+#include "IngressLane.hpp"
 #include "BookSnapshot.hpp"
 #include "OrdersSnapshot.hpp"
 #include "MboToMbpAggregator.hpp"
+#include "InstrumentRateTracker.hpp"
+#include "PublishThrottle.hpp"
+#include "ShardOverrideTable.hpp"
 
 #include "../mapping/MdSnapshotMapper.hpp"
 #include "../telemetry/SpdlogLogPublisher.hpp"
 #include "../telemetry/LogEvent.hpp"
 #include "../publishing/IPublishSink.hpp"
+#include "../publishing/ISerializeStage.hpp"
 #include "../mapping/InstrumentTopicMapper.hpp"
 
 #include <atomic>
@@ -17,6 +21,9 @@
 #include <string>
 #include <thread>
 #include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
 
 namespace b3::md {
 
@@ -25,46 +32,215 @@ namespace b3::md {
     static constexpr size_t kQueueCapacity = 4096;
     static constexpr size_t kLogQueueCapacity = 1024;
 
+    // laneCount = cantidad de threads productores (feed threads de OnixS) que pueden
+    // encolar en este shard. Una SPSC por lane; el worker las mergea por ticket.
+    // queue = capacidad por lane + hugepages; el thread del worker hace el first-touch.
     MdPublishWorker(uint32_t shardId, b3::md::mapping::MdSnapshotMapper &mapper,
                     publishing::IPublishSink &sink,
-                    const b3::md::mapping::InstrumentTopicMapper &topicMapper)
-        : shardId_(shardId), mapper_(mapper), sink_(sink), topicMapper_(topicMapper) {}
+                    const b3::md::mapping::InstrumentTopicMapper &topicMapper,
+                    uint32_t laneCount = 1, QueueConfig queue = {kQueueCapacity, false})
+        : shardId_(shardId), lanes_(laneCount, queue), mapper_(mapper), sink_(sink),
+          topicMapper_(topicMapper) {}
 
     MdPublishWorker(const MdPublishWorker &) = delete;
     MdPublishWorker &operator=(const MdPublishWorker &) = delete;
 
-    void start() {
-      bool expected = false;
-      if (!running_.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
-        return;
+    // Vuelve después del first-touch de las lanes (ver IngressConsumer).
+    void start() { consumer_.start([this] { run(); }); }
 
-      logger_.start();
-      drainOnStop_.store(true, std::memory_order_relaxed);
-      thread_ = std::thread([this] { run(); });
-    }
+    void stop(bool drain = true) { consumer_.stop(drain); }
 
-    void stop(bool drain = true) {
-      drainOnStop_.store(drain, std::memory_order_relaxed);
-      running_.store(false, std::memory_order_release);
-      if (thread_.joinable())
-        thread_.join();
-      logger_.stop();
+    // Hot path: encola en la lane del thread que llama (ver IngressLane.hpp).
+    bool tryEnqueue(const OrdersSnapshot &snapshot) noexcept {
+      return tryEnqueue(snapshot, tlsIngressLane);
     }
 
-    bool tryEnqueue(const OrdersSnapshot &snapshot) noexcept {
-      if (queue_.try_push(snapshot)) {
+    bool tryEnqueue(const OrdersSnapshot &snapshot, uint32_t lane) noexcept {
+      const IngressPush r = lanes_.tryPush(lane, snapshot);
+      if (r == IngressPush::Ok) {
         enqueued_.fetch_add(1, std::memory_order_relaxed);
         return true;
       }
+      if (r == IngressPush::NoLane) // thread no registrado (o más feed threads que lanes)
+        laneRejected_.fetch_add(1, std::memory_order_relaxed);
       dropped_.fetch_add(1, std::memory_order_relaxed);
       return false;
     }
 
     uint64_t enqueued() const noexcept { return enqueued_.load(std::memory_order_relaxed); }
     uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
-    uint64_t published() const noexcept { return published_.load(std::memory_order_relaxed); }
+    // Con etapa de serialización cuenta lo que la etapa ya entregó al sink, no lo encolado.
+    uint64_t published() const noexcept {
+      return published_.load(std::memory_order_relaxed) +
+             (stage_ ? stage_->publishedCount(shardId_) : 0);
+    }
+    uint64_t laneRejected() const noexcept { return laneRejected_.load(std::memory_order_relaxed); }
+    uint32_t laneCount() const noexcept { return lanes_.size(); }
+    uint32_t queueCapacity() const noexcept { return lanes_.lane(0).capacity(); }
+
+    size_t queueMemoryBytes() const noexcept { return lanes_.memoryBytes(); }
+
+    QueueBacking queueBacking() const noexcept { return lanes_.lane(0).backing(); }
+
+    // Rebalanceo: tabla de rutas + peers del pipeline (para el fence del handoff).
+    // Llamar antes de start(); el pipeline lo hace en su ctor.
+    void attachRebalancing(ShardOverrideTable *overrides,
+                           const std::vector<std::unique_ptr<MdPublishWorker>> *peers) {
+      overrides_ = overrides;
+      peers_ = peers;
+      fence_.assign(lanes_.size(), 0);
+      parked_ = std::make_unique<OrdersSnapshot>();
+    }
+
+    // Pipeline (moveInstrument): `instrumentId` acaba de rutearse a este shard. Si no llega
+    // ningún evento suyo, el worker arma el fence solo pasado kHandoffQuietGrace y completa el
+    // handoff igual (un instrumento quieto no deja el rebalanceo trabado).
+    void expectHandoff(uint64_t instrumentId) noexcept {
+      expectedHandoffAtNs_.store(nowNsSteady(), std::memory_order_relaxed);
+      expectedHandoff_.store(instrumentId, std::memory_order_release);
+    }
+
+    // Serialización paralela: el worker entrega el BookSnapshot a la etapa en vez de
+    // serializar y publicar él mismo. Llamar antes de start(). nullptr = modo inline.
+    void attachSerializeStage(publishing::ISerializeStage *stage) noexcept { stage_ = stage; }
+
+    // Stream throttleado adicional (md.throttle.intervals_ms): el último book de cada
+    // instrumento a lo sumo cada intervalNs, bajo topic "<prefix><SYMBOL>". El stream completo
+    // no cambia. Llamar antes de start(); solo sin etapa de serialización (el payload lleva el
+    // símbolo puro y el topic el prefijo, cosa que la etapa no separa).
+    void addThrottle(uint64_t intervalNs, std::string prefix, uint32_t capacityPow2 = 4096) {
+      if (prefix.empty() || prefix.size() >= publishing::SerializedEnvelope::kMaxTopic)
+        throw std::invalid_argument("MdPublishWorker: invalid throttle topic prefix");
+      throttles_.push_back(
+          {std::make_unique<PublishThrottle>(intervalNs, capacityPow2), std::move(prefix)});
+    }
+
+    size_t throttleCount() const noexcept { return throttles_.size(); }
+    const PublishThrottle &throttle(size_t i) const noexcept { return *throttles_[i].throttle; }
+    const std::string &throttlePrefix(size_t i) const noexcept { return throttles_[i].prefix; }
+    uint64_t throttleDropped() const noexcept {
+      return throttleDropped_.load(std::memory_order_relaxed);
+    }
+
+    // Eventos publicados por instrumento (lo lee el rebalancer desde su thread).
+    const InstrumentRateTracker &rates() const noexcept { return rates_; }
+
+    uint64_t handoffs() const noexcept { return handoffs_.load(std::memory_order_relaxed); }
+    uint64_t handoffTimeouts() const noexcept {
+      return handoffTimeouts_.load(std::memory_order_relaxed);
+    }
+    // Books del instrumento en handoff reemplazados por uno más nuevo mientras esperaba.
+    uint64_t handoffConflated() const noexcept {
+      return handoffConflated_.load(std::memory_order_relaxed);
+    }
+
+    // Fence entre shards: posición de push por lane / si ya se publicó todo hasta ahí.
+    // (publish ocurre antes de pop(), así que "popped" implica "entregado al sink")
+    void capturePushed(std::vector<uint32_t> &out) const {
+      for (size_t i = 0; i < lanes_.size(); ++i) out[i] = lanes_.lane(i).pushedCount();
+    }
+
+    bool publishedUpTo(const std::vector<uint32_t> &pushed) const noexcept {
+      for (size_t i = 0; i < lanes_.size(); ++i) {
+        if (static_cast<int32_t>(lanes_.lane(i).poppedCount() - pushed[i]) < 0)
+          return false;
+      }
+      return true;
+    }
+
+    // Mismo fence aguas abajo: con etapa de serialización es su secuencia (serializers +
+    // reorder del concentrator), si no la del sink.
+    uint64_t acceptedMark() const noexcept {
+      return stage_ ? stage_->acceptedCount(shardId_) : sink_.acceptedCount(shardId_);
+    }
+
+    bool deliveredUpTo(uint64_t accepted) const noexcept {
+      return stage_ ? stage_->deliveredUpTo(shardId_, accepted)
+                    : sink_.deliveredUpTo(shardId_, accepted);
+    }
 
    private:
+    using Lanes = IngressLaneSet<OrdersSnapshot, kQueueCapacity>;
+
+    static constexpr uint64_t kHandoffTimeoutNs = 500'000'000ull;
+    static constexpr uint64_t kHandoffQuietGraceNs = 10'000'000ull;
+
+    // Drain-and-handoff (lado destino). El instrumento fue ruteado de `from` a este shard.
+    // Cuando vemos su PRIMER evento nuevo, todo lo previo ya está encolado en `from` (OnixS
+    // serializa callbacks por libro): el fence es la posición de push actual de `from` más lo
+    // que `from` ya le pasó al sink. Sin eventos, el fence se arma pasado kHandoffQuietGraceNs
+    // desde la ruta (ningún producer tarda eso entre el lookup y el push).
+    // Nunca se espera en el hot path: el evento se estaciona (ver run()) y el fence se
+    // consulta sin bloquear en cada pasada del loop. Un handoff a la vez => sin espera circular.
+    void armHandoff(uint64_t instrumentId, uint32_t from, uint64_t steadyNs) noexcept {
+      handoff_ = Handoff{instrumentId, from, 0, steadyNs + kHandoffTimeoutNs, true};
+      if (!peers_ || from >= peers_->size() || from == shardId_)
+        return; // sin origen que esperar: handoffReady() da true
+      const MdPublishWorker &src = *(*peers_)[from];
+      src.capturePushed(fence_);
+      handoff_.accepted = src.acceptedMark();
+    }
+
+    // true si el origen ya publicó y entregó hasta el fence (o venció el timeout, contado).
+    bool handoffReady(uint64_t steadyNs) noexcept {
+      const uint32_t from = handoff_.from;
+      if (!peers_ || from >= peers_->size() || from == shardId_)
+        return true;
+      const MdPublishWorker &src = *(*peers_)[from];
+      if (src.publishedUpTo(fence_) && src.deliveredUpTo(handoff_.accepted))
+        return true;
+      if (steadyNs < handoff_.deadlineNs)
+        return false;
+      handoffTimeouts_.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+
+    // Handoff sin eventos: arma el fence del instrumento esperado pasado el grace.
+    void maybeArmQuietHandoff(uint64_t steadyNs) noexcept {
+      const uint64_t iid = expectedHandoff_.load(std::memory_order_acquire);
+      if (iid == 0 ||
+          steadyNs - expectedHandoffAtNs_.load(std::memory_order_relaxed) < kHandoffQuietGraceNs)
+        return;
+      uint32_t from = ShardOverrideTable::kNoShard;
+      if (overrides_->pendingHandoff(iid, shardId_, from)) {
+        armHandoff(iid, from, steadyNs);
+      } else {
+        uint64_t seen = iid; // ya completado (o ruteado a otro lado): olvidarlo
+        expectedHandoff_.compare_exchange_strong(seen, 0, std::memory_order_relaxed);
+      }
+    }
+
+    struct ThrottleStream {
+      std::unique_ptr<PublishThrottle> throttle;
+      std::string prefix;
+    };
+
+    static uint64_t nowNsSteady() noexcept {
+      const auto now = std::chrono::steady_clock::now().time_since_epoch();
+      return static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+    }
+
+    // Book que sale por un stream throttleado: payload con el símbolo puro (igual que el stream
+    // completo), topic con el prefijo del stream.
+    void publishThrottled(const ThrottleStream &ts, const BookSnapshot &b,
+                          publishing::SerializedEnvelope &ev) noexcept {
+      auto [topicPtr, topicLen] = topicMapper_.getTopic(b.instrumentId);
+      const size_t prefixedLen = ts.prefix.size() + topicLen;
+      if (!topicPtr || topicLen == 0 || prefixedLen > publishing::SerializedEnvelope::kMaxTopic ||
+          !mapper_.mapToSerializedEnvelope(b, ev, topicPtr, topicLen)) {
+        throttleDropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      std::memcpy(ev.topic + ts.prefix.size(), topicPtr, topicLen);
+      std::memcpy(ev.topic, ts.prefix.data(), ts.prefix.size());
+      ev.topicLen = static_cast<uint8_t>(prefixedLen);
+      ev.sourceTsNs = b.exchangeTsNs;
+      ev.flags = publishing::SerializedEnvelope::kDirectOnly; // ni batch ni ring shm
+      if (!sink_.tryPublish(shardId_, ev))
+        throttleDropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+
     static uint64_t nowNsSystem() noexcept {
       const auto now = std::chrono::system_clock::now().time_since_epoch();
       return static_cast<uint64_t>(
@@ -79,7 +255,7 @@ namespace b3::md {
       e.component = telemetry::Component::Worker;
       e.code = telemetry::Code::Startup;
       e.shard = static_cast<uint16_t>(shardId_);
-      (void)logger_.try_publish(e);
+      (void)consumer_.logger().try_publish(e);
     }
 
     void logShutdown(uint64_t nowNs) noexcept {
@@ -89,9 +265,9 @@ namespace b3::md {
       e.component = telemetry::Component::Worker;
       e.code = telemetry::Code::Shutdown;
       e.shard = static_cast<uint16_t>(shardId_);
-      e.arg0 = published_.load(std::memory_order_relaxed);
+      e.arg0 = published();
       e.arg1 = dropped_.load(std::memory_order_relaxed);
-      (void)logger_.try_publish(e);
+      (void)consumer_.logger().try_publish(e);
     }
 
     void emitHealth(uint64_t nowNs, uint64_t qsz, uint64_t dEnq, uint64_t dPub) noexcept {
@@ -103,7 +279,7 @@ namespace b3::md {
       e.shard = static_cast<uint16_t>(shardId_);
       e.arg0 = qsz;
       e.arg1 = ((dEnq & 0xFFFFFFFFull) << 32) | (dPub & 0xFFFFFFFFull);
-      (void)logger_.try_publish(e);
+      (void)consumer_.logger().try_publish(e);
     }
 
     void emitDrops(uint64_t nowNs, uint64_t deltaDrops, uint64_t totalDrops) noexcept {
@@ -115,7 +291,7 @@ namespace b3::md {
       e.shard = static_cast<uint16_t>(shardId_);
       e.arg0 = deltaDrops;
       e.arg1 = totalDrops;
-      (void)logger_.try_publish(e);
+      (void)consumer_.logger().try_publish(e);
     }
 
     void emitQueueSaturated(uint64_t nowNs, uint64_t qsz, uint64_t deltaDrops,
@@ -128,7 +304,7 @@ namespace b3::md {
       e.shard = static_cast<uint16_t>(shardId_);
       e.arg0 = qsz;
       e.arg1 = ((deltaDrops & 0xFFFFFFFFull) << 32) | (totalDrops & 0xFFFFFFFFull);
-      (void)logger_.try_publish(e);
+      (void)consumer_.logger().try_publish(e);
     }
 
     void emitLogDrops(uint64_t nowNs, uint64_t deltaLogDrops, uint64_t totalLogDrops) noexcept {
@@ -140,7 +316,7 @@ namespace b3::md {
       e.shard = static_cast<uint16_t>(shardId_);
       e.arg0 = deltaLogDrops;
       e.arg1 = totalLogDrops;
-      (void)logger_.try_publish(e);
+      (void)consumer_.logger().try_publish(e);
     }
 
     void maybeLogHealthTick(uint64_t nowNs) noexcept {
@@ -149,9 +325,9 @@ namespace b3::md {
       nextHealthNs_ = nowNs + kHealthEveryNs;
 
       const uint64_t enq = enqueued_.load(std::memory_order_relaxed);
-      const uint64_t pub = published_.load(std::memory_order_relaxed);
+      const uint64_t pub = published();
       const uint64_t drop = dropped_.load(std::memory_order_relaxed);
-      const uint64_t qsz = static_cast<uint64_t>(queue_.size_approx());
+      const uint64_t qsz = lanes_.queuedApprox();
 
       const uint64_t dEnq = enq - lastEnq_;
       const uint64_t dPub = pub - lastPub_;
@@ -168,7 +344,7 @@ namespace b3::md {
         emitQueueSaturated(nowNs, qsz, dDrop, drop);
       }
 
-      const uint64_t logDrop = logger_.dropped();
+      const uint64_t logDrop = consumer_.logger().dropped();
       const uint64_t dLogDrop = logDrop - lastLogDrop_;
       lastLogDrop_ = logDrop;
 
@@ -179,7 +355,6 @@ namespace b3::md {
     void run() noexcept {
       using namespace std::chrono_literals;
 
-      OrdersSnapshot raw{};
       BookSnapshot mbp{};
       std::string outBuffer;
       outBuffer.reserve(512);
@@ -189,12 +364,51 @@ namespace b3::md {
       lastEnq_ = lastPub_ = lastDrop_ = 0;
       lastLogDrop_ = 0;
 
+      lanes_.firstTouch();
+      consumer_.markTouched();
+
       logStartup(nowNs);
 
+      // Streams throttleados: envelope propio (el emit puede correr dentro de publish_one)
+      std::unique_ptr<publishing::SerializedEnvelope> throttledEv;
+      if (!throttles_.empty())
+        throttledEv = std::make_unique<publishing::SerializedEnvelope>();
+
+      // Handoff listo: primero sale el book estacionado, después se libera la ruta (así ningún
+      // moveInstrument() nuevo ve el handoff cerrado con un book todavía sin publicar).
+      auto complete_handoff = [&](uint64_t steadyNs, auto &&publish) {
+        if (handoff_.parked) {
+          rates_.record(parked_->instrumentId);
+          publish(*parked_);
+        }
+        const uint64_t iid = handoff_.instrumentId;
+        handoff_ = Handoff{};
+        handoffs_.fetch_add(1, std::memory_order_relaxed);
+        overrides_->completeHandoff(iid);
+        uint64_t seen = iid;
+        expectedHandoff_.compare_exchange_strong(seen, 0, std::memory_order_relaxed);
+        for (auto &ts : throttles_) ts.throttle->deferNext(iid, steadyNs);
+      };
+
+      auto advance_throttles = [&](uint64_t steadyNs) {
+        for (auto &ts : throttles_)
+          ts.throttle->advance(
+              steadyNs, [&](const BookSnapshot &b) { publishThrottled(ts, b, *throttledEv); });
+      };
+
       auto publish_one = [&](const OrdersSnapshot &s) {
         // 0) aggregate MBO -> MBP top N (ordenes to niveles de precio)
         aggregateMboWindowToMbpTopN(s, mbp);
 
+        // 0') streams throttleados (guardan/agendan el último book; stale/refresh salen ya)
+        if (!throttles_.empty()) {
+          const uint64_t steadyNs = nowNsSteady();
+          for (auto &ts : throttles_)
+            ts.throttle->offer(mbp, steadyNs, [&](const BookSnapshot &b) {
+              publishThrottled(ts, b, *throttledEv);
+            });
+        }
+
         outBuffer.clear();
         publishing::SerializedEnvelope ev{};
 
@@ -205,11 +419,20 @@ namespace b3::md {
           return;
         }
 
+        // 2') Parallel mode: serialization + publish happen in the stage, in shard order
+        if (stage_) {
+          if (!stage_->trySubmit(shardId_, mbp, topicPtr, topicLen)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+          }
+          return; // published lo cuenta la etapa cuando el envelope sale
+        }
+
         // 2) Serialize payload + write topic (only if serialization succeeds)
         if (!mapper_.mapToSerializedEnvelope(mbp, ev, topicPtr, topicLen)) {
           dropped_.fetch_add(1, std::memory_order_relaxed);
           return;
         }
+        ev.sourceTsNs = mbp.exchangeTsNs; // latencia end-to-end (probe del concentrator)
 
         // 3) Publish serialized envelope
         if (!sink_.tryPublish(shardId_, ev)) {
@@ -220,16 +443,57 @@ namespace b3::md {
         published_.fetch_add(1, std::memory_order_relaxed);
       };
 
-      while (running_.load(std::memory_order_acquire) ||
-             (drainOnStop_.load(std::memory_order_relaxed) && queue_.size_approx() > 0)) {
+      // Handoff: fence armado, sin bloquear. El destino sigue con el resto de sus instrumentos.
+      auto poll_handoff = [&] {
+        if (!overrides_ || overrides_->pendingHandoffs() == 0)
+          return;
+        const uint64_t steadyNs = nowNsSteady();
+        if (!handoff_.armed)
+          maybeArmQuietHandoff(steadyNs);
+        if (handoff_.armed && handoffReady(steadyNs))
+          complete_handoff(steadyNs, publish_one);
+      };
+
+      while (consumer_.running() ||
+             (consumer_.drainOnStop() && (lanes_.queuedApprox() > 0 || handoff_.armed))) {
         bool didWork = false;
 
-        while (queue_.try_pop(raw)) {
+        for (int lane = lanes_.pick(); lane >= 0; lane = lanes_.pick()) {
           didWork = true;
+          // Publicamos directo desde el slot del ring: el productor no lo pisa hasta pop().
+          const OrdersSnapshot &raw = lanes_.front(lane);
           nowNs = raw.exchangeTsNs; // heartbeat “del feed” cuando hay data
+
+          uint32_t from = ShardOverrideTable::kNoShard;
+          if (overrides_ && overrides_->pendingHandoffs() != 0 &&
+              overrides_->pendingHandoff(raw.instrumentId, shardId_, from)) {
+            const uint64_t steadyNs = nowNsSteady();
+            if (!handoff_.armed || handoff_.instrumentId != raw.instrumentId)
+              armHandoff(raw.instrumentId, from, steadyNs);
+            if (!handoffReady(steadyNs)) {
+              // El origen todavía no entregó lo previo: estacionar el book (gana el último; es
+              // un libro completo, así que el reemplazado solo se pierde como intermedio).
+              if (handoff_.parked)
+                handoffConflated_.fetch_add(1, std::memory_order_relaxed);
+              *parked_ = raw;
+              handoff_.parked = true;
+              rates_.record(raw.instrumentId);
+              lanes_.pop(lane);
+              continue;
+            }
+            complete_handoff(steadyNs, publish_one);
+          }
+
+          rates_.record(raw.instrumentId);
           publish_one(raw);
+          lanes_.pop(lane);
         }
 
+        poll_handoff();
+
+        if (!throttles_.empty())
+          advance_throttles(nowNsSteady()); // vencimientos también sin tráfico
+
         if (!didWork) {
           nowNs = nowNsSystem(); // heartbeat “local” cuando está idle
           std::this_thread::sleep_for(1ms);
@@ -238,6 +502,10 @@ namespace b3::md {
         maybeLogHealthTick(nowNs);
       }
 
+      // Último valor garantizado: lo pendiente sale antes de terminar
+      for (auto &ts : throttles_)
+        ts.throttle->flushAll([&](const BookSnapshot &b) { publishThrottled(ts, b, *throttledEv); });
+
       logShutdown(nowNs);
     }
 
@@ -246,20 +514,44 @@ namespace b3::md {
 
     const uint32_t shardId_;
 
-    SnapshotQueueSpsc<OrdersSnapshot, kQueueCapacity> queue_;
+    Lanes lanes_;
 
     mapping::MdSnapshotMapper &mapper_;
     publishing::IPublishSink &sink_;
+    publishing::ISerializeStage *stage_{nullptr}; // modo serialización paralela
 
-    telemetry::SpdlogLogPublisher<kLogQueueCapacity> logger_;
-
-    std::atomic<bool> running_{false};
-    std::atomic<bool> drainOnStop_{true};
-    std::thread thread_{};
+    IngressConsumer<telemetry::SpdlogLogPublisher<kLogQueueCapacity>> consumer_;
 
     std::atomic<uint64_t> enqueued_{0};
     std::atomic<uint64_t> dropped_{0};
     std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> laneRejected_{0};
+
+    std::vector<ThrottleStream> throttles_;
+    std::atomic<uint64_t> throttleDropped_{0};
+
+    // Rebalanceo
+    InstrumentRateTracker rates_{};
+    ShardOverrideTable *overrides_{nullptr};
+    const std::vector<std::unique_ptr<MdPublishWorker>> *peers_{nullptr};
+    std::vector<uint32_t> fence_{};
+    std::atomic<uint64_t> handoffs_{0};
+    std::atomic<uint64_t> handoffTimeouts_{0};
+    std::atomic<uint64_t> handoffConflated_{0};
+
+    // Handoff en curso (solo el thread del worker)
+    struct Handoff {
+      uint64_t instrumentId{0};
+      uint32_t from{ShardOverrideTable::kNoShard};
+      uint64_t accepted{0};   // fence aguas abajo del origen
+      uint64_t deadlineNs{0}; // steady
+      bool armed{false};
+      bool parked{false};     // parked_ tiene un book del instrumento sin publicar
+    };
+    Handoff handoff_{};
+    std::unique_ptr<OrdersSnapshot> parked_{};
+    std::atomic<uint64_t> expectedHandoff_{0};
+    std::atomic<uint64_t> expectedHandoffAtNs_{0};
 
     uint64_t nextHealthNs_{0};
     uint64_t lastEnq_{0};
@@ -0,0 +1,274 @@
+#pragma once
+
+#include "IngressLane.hpp"
+#include "MarketStateEvent.hpp"
+#include "MarketStateTable.hpp"
+
+#include "../mapping/InstrumentTopicMapper.hpp"
+#include "../mapping/MdSnapshotMapper.hpp"
+#include "../publishing/CompactEnvelope.hpp"
+#include "../publishing/IPublishSink.hpp"
+#include "../telemetry/LogEvent.hpp"
+#include "../telemetry/SpdlogLogPublisher.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace b3::md {
+
+  /**
+   * @brief Lane de estado de mercado: status, fases de grupo, subastas y bandas.
+   *
+   * Baja tasa. Una SPSC por lane de ingreso (IngressLaneSet, merge por ticket) y un thread que
+   * aplica cada evento a MarketStateTable y publica SOLO lo que cambió, por
+   * IPublishSink::kStateChannel. Si el sink rechaza (cola llena), el instrumento/grupo queda
+   * pendiente (una sola vez) y se reintenta con el estado vigente: un halt no se pierde.
+   */
+  class MdStateLane final {
+   public:
+    static constexpr size_t kQueueCapacity = 1024;
+    static constexpr size_t kLogQueueCapacity = 256;
+
+    MdStateLane(MarketStateTable &table, mapping::MdSnapshotMapper &mapper,
+                publishing::IPublishSink &sink, const mapping::InstrumentTopicMapper &topicMapper,
+                uint32_t laneCount = 1, QueueConfig queue = {kQueueCapacity, false},
+                uint32_t channel = publishing::kStateChannel)
+        : table_(table), mapper_(mapper), sink_(sink), topicMapper_(topicMapper),
+          channel_(channel), lanes_(laneCount, queue) {
+      changed_.reserve(1024);
+      pending_.reserve(1024);
+      retry_.reserve(1024);
+    }
+
+    ~MdStateLane() { stop(false); }
+
+    MdStateLane(const MdStateLane &) = delete;
+    MdStateLane &operator=(const MdStateLane &) = delete;
+
+    void start() { consumer_.start([this] { run(); }); }
+
+    void stop(bool drain = true) { consumer_.stop(drain); }
+
+    // Hot path (callback OnixS): encola en la lane del thread que llama.
+    bool tryEnqueue(const MarketStateEvent &e) noexcept { return tryEnqueue(e, tlsIngressLane); }
+
+    bool tryEnqueue(const MarketStateEvent &e, uint32_t lane) noexcept {
+      const IngressPush r = lanes_.tryPush(lane, e);
+      if (r == IngressPush::Ok) {
+        enqueued_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+      if (r == IngressPush::NoLane)
+        laneRejected_.fetch_add(1, std::memory_order_relaxed);
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    uint64_t enqueued() const noexcept { return enqueued_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t published() const noexcept { return published_.load(std::memory_order_relaxed); }
+    uint64_t unchanged() const noexcept { return unchanged_.load(std::memory_order_relaxed); }
+    uint64_t laneRejected() const noexcept { return laneRejected_.load(std::memory_order_relaxed); }
+    uint32_t laneCount() const noexcept { return lanes_.size(); }
+
+    size_t queueMemoryBytes() const noexcept { return lanes_.memoryBytes(); }
+
+   private:
+    using Lanes = IngressLaneSet<MarketStateEvent, kQueueCapacity>;
+
+    // Pendiente de publicar: instrumento (índice denso) o grupo.
+    struct Pending {
+      bool group{false};
+      uint32_t index{0};
+    };
+
+    // true = publicado o descartable (sin topic); false = reintentar.
+    bool publishInstrument(uint32_t index) noexcept {
+      InstrumentMarketState st;
+      if (!table_.snapshotAt(index, st))
+        return true;
+      auto [topicPtr, topicLen] = topicMapper_.getTopic(st.instrumentId);
+      if (!topicPtr || topicLen == 0 || !mapper_.mapStateToEnvelope(st, ev_, topicPtr, topicLen)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+      ev_.sourceTsNs = 0;
+      return send();
+    }
+
+    bool publishGroup(uint16_t group) noexcept {
+      GroupMarketState gs;
+      if (!table_.groupAt(group, gs))
+        return true;
+      if (!mapper_.mapGroupStateToEnvelope(gs, ev_)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+      ev_.sourceTsNs = 0;
+      return send();
+    }
+
+    bool send() noexcept {
+      if (!sink_.tryPublishPriority(channel_, ev_))
+        return false;
+      published_.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+
+    // Bit "ya está en pending_" por instrumento/grupo: un instrumento que cambia muchas veces
+    // con el sink lleno queda una sola vez (el reintento publica el estado vigente igual).
+    uint8_t &pendingBit(Pending p) {
+      if (p.group)
+        return groupPending_[p.index];
+      if (p.index >= instrumentPending_.size())
+        instrumentPending_.resize(p.index + 1, 0);
+      return instrumentPending_[p.index];
+    }
+
+    void publishOrDefer(Pending p) {
+      uint8_t &bit = pendingBit(p);
+      if (bit)
+        return; // ya se reintenta al final de la vuelta
+      const bool ok = p.group ? publishGroup(static_cast<uint16_t>(p.index))
+                              : publishInstrument(p.index);
+      if (!ok) {
+        bit = 1;
+        pending_.push_back(p);
+      }
+    }
+
+    void retryPending() {
+      if (pending_.empty())
+        return;
+      retry_.swap(pending_);
+      for (const Pending &p : retry_) {
+        pendingBit(p) = 0;
+        publishOrDefer(p);
+      }
+      retry_.clear();
+    }
+
+    void process(const MarketStateEvent &e) {
+      changed_.clear();
+      const auto r = table_.apply(e, changed_);
+      if (r.groupChanged)
+        publishOrDefer({true, r.group});
+      if (!r.groupChanged && changed_.empty())
+        unchanged_.fetch_add(1, std::memory_order_relaxed);
+      for (uint32_t idx : changed_) publishOrDefer({false, idx});
+    }
+
+    static uint64_t nowNsSystem() noexcept {
+      const auto now = std::chrono::system_clock::now().time_since_epoch();
+      return static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+    }
+
+    void emit(telemetry::LogLevel level, telemetry::Code code, uint64_t nowNs, uint64_t arg0,
+              uint64_t arg1) noexcept {
+      telemetry::LogEvent e{};
+      e.tsNs = nowNs;
+      e.level = level;
+      e.component = telemetry::Component::MarketState;
+      e.code = code;
+      e.arg0 = arg0;
+      e.arg1 = arg1;
+      (void)consumer_.logger().try_publish(e);
+    }
+
+    void maybeLogHealthTick(uint64_t nowNs) noexcept {
+      if (nowNs < nextHealthNs_)
+        return;
+      nextHealthNs_ = nowNs + kHealthEveryNs;
+
+      const uint64_t pub = published_.load(std::memory_order_relaxed);
+      const uint64_t drop = dropped_.load(std::memory_order_relaxed);
+      emit(telemetry::LogLevel::Health, telemetry::Code::HealthTick, nowNs, pub - lastPub_,
+           pending_.size());
+      if (drop != lastDrop_)
+        emit(telemetry::LogLevel::Health, telemetry::Code::Drops, nowNs, drop - lastDrop_, drop);
+      lastPub_ = pub;
+      lastDrop_ = drop;
+    }
+
+    void run() noexcept {
+      using namespace std::chrono_literals;
+
+      lanes_.firstTouch();
+      consumer_.markTouched();
+
+      uint64_t nowNs = nowNsSystem();
+      nextHealthNs_ = nowNs + kHealthEveryNs;
+      emit(telemetry::LogLevel::Info, telemetry::Code::Startup, nowNs, lanes_.size(), 0);
+
+      try {
+        uint32_t idleSpins = 0;
+        while (consumer_.running() || (consumer_.drainOnStop() && lanes_.queuedApprox() > 0)) {
+          bool didWork = false;
+          for (int lane = lanes_.pick(); lane >= 0; lane = lanes_.pick()) {
+            didWork = true;
+            process(lanes_.front(lane));
+            lanes_.pop(lane);
+          }
+          retryPending();
+
+          if (didWork) {
+            idleSpins = 0;
+          } else if (++idleSpins < kSpinIdle) {
+            std::this_thread::yield();
+          } else {
+            std::this_thread::sleep_for(200us);
+          }
+
+          nowNs = nowNsSystem();
+          maybeLogHealthTick(nowNs);
+        }
+      } catch (...) {
+        // bad_alloc en la tabla / pending: la lane se apaga, el resto del pipeline sigue
+        emit(telemetry::LogLevel::Error, telemetry::Code::Drops, nowNsSystem(), 0,
+             dropped_.load(std::memory_order_relaxed));
+      }
+
+      emit(telemetry::LogLevel::Info, telemetry::Code::Shutdown, nowNsSystem(),
+           published_.load(std::memory_order_relaxed), dropped_.load(std::memory_order_relaxed));
+    }
+
+    static constexpr uint64_t kHealthEveryNs = 5'000'000'000ull;
+    static constexpr uint32_t kSpinIdle = 200; // lane de baja tasa: pasa rápido a sleeps
+
+    MarketStateTable &table_;
+    mapping::MdSnapshotMapper &mapper_;
+    publishing::IPublishSink &sink_;
+    const mapping::InstrumentTopicMapper &topicMapper_;
+    const uint32_t channel_;
+
+    Lanes lanes_;
+
+    // Solo el thread de la lane
+    std::vector<uint32_t> changed_;
+    std::vector<Pending> pending_;
+    std::vector<Pending> retry_;
+    std::vector<uint8_t> instrumentPending_;
+    std::array<uint8_t, MarketStateTable::kMaxGroups> groupPending_{};
+    publishing::CompactEnvelope ev_{};
+
+    IngressConsumer<telemetry::SpdlogLogPublisher<kLogQueueCapacity>> consumer_;
+
+    std::atomic<uint64_t> enqueued_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> unchanged_{0};
+    std::atomic<uint64_t> laneRejected_{0};
+
+    uint64_t nextHealthNs_{0};
+    uint64_t lastPub_{0};
+    uint64_t lastDrop_{0};
+  };
+
+} // namespace b3::md
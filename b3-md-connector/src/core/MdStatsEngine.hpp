@@ -0,0 +1,285 @@
+#pragma once
+
+#include "DenseInstrumentIndex.hpp"
+#include "InstrumentStats.hpp"
+#include "TradeEvent.hpp"
+
+#include "../mapping/InstrumentTopicMapper.hpp"
+#include "../mapping/MdSnapshotMapper.hpp"
+#include "../publishing/CompactEnvelope.hpp"
+#include "../publishing/IPublishSink.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace b3::md {
+
+  /**
+   * @brief Estadísticas de sesión por instrumento (open/high/low/last, VWAP, volumen, #trades),
+   * calculadas una sola vez acá en vez de en cada consumidor.
+   *
+   * Single thread: la alimenta y la publica el consumer de MdTradeLane (apply + maybePublish),
+   * así que trades, busts y precios del exchange llegan en FIFO por instrumento sin otra cola.
+   * Estado en arrays planos por índice denso (DenseInstrumentIndex); cada cambio marca el
+   * instrumento dirty y el timer publica solo los dirty por IPublishSink::kStatsChannel.
+   *
+   * Reglas:
+   * - Trade_53: volumen, notional, #trades, last, high/low; open = primer trade salvo que ya
+   *   haya llegado OpeningPrice_15.
+   * - ForwardTrade_54 (termo): no forma precio ni volumen de sesión, se ignora (su TradeID se
+   *   recuerda en una ventana de kForwardMemory para que su bust tampoco descuente).
+   * - TradeBust_57: descuenta volumen/notional/#trades solo si el TradeID está en el rango de los
+   *   trades contados del instrumento y no es un termo (un bust de algo que nunca se sumó, p.ej.
+   *   anterior a la conexión, se cuenta en bustsIgnored). high/low/last no se pueden deshacer
+   *   sin historial: quedan hasta que el exchange los corrija (HighPrice_24 / LowPrice_25).
+   * - Precios del exchange (15/24/25/17/28) pisan el valor; DELETE lo limpia.
+   * - Sesión: un evento con otra época (TradeEvent::session, cambia con ChannelReset_11) reinicia
+   *   el instrumento antes de aplicarse.
+   */
+  class MdStatsEngine final {
+   public:
+    static constexpr uint32_t kDefaultMaxInstruments = 65536; // security list completa (opciones)
+    static constexpr uint64_t kDefaultIntervalNs = 1'000'000'000ull;
+    static constexpr uint32_t kForwardMemory = 1024; // últimos termos recordados (busts)
+
+    MdStatsEngine(mapping::MdSnapshotMapper &mapper, publishing::IPublishSink &sink,
+                  const mapping::InstrumentTopicMapper &topicMapper,
+                  uint64_t publishIntervalNs = kDefaultIntervalNs,
+                  uint32_t maxInstruments = kDefaultMaxInstruments,
+                  uint32_t channel = publishing::kStatsChannel)
+        : mapper_(mapper), sink_(sink), topicMapper_(topicMapper),
+          intervalNs_(publishIntervalNs), channel_(channel), index_(maxInstruments) {
+      stats_.reserve(maxInstruments);
+      dirty_.reserve(maxInstruments);
+    }
+
+    MdStatsEngine(const MdStatsEngine &) = delete;
+    MdStatsEngine &operator=(const MdStatsEngine &) = delete;
+
+    // Consumer thread. No throw, no alloc (vectores reservados al tope de instrumentos).
+    void apply(const TradeEvent &e) noexcept {
+      if (e.kind == TradeKind::ForwardTrade) {
+        forwards_[forwardPos_++ % kForwardMemory] = {e.instrumentId, e.tradeId};
+        return;
+      }
+
+      const uint32_t idx = index_.findOrInsert(e.instrumentId);
+      if (idx == DenseInstrumentIndex::kNone) {
+        overflow_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      if (idx == stats_.size()) {
+        stats_.emplace_back();
+        stats_.back().instrumentId = e.instrumentId;
+      }
+
+      InstrumentStats &st = stats_[idx];
+      using Flag = InstrumentStats::Flag;
+
+      if (st.session != e.session)
+        resetSession(st, e.session);
+
+      switch (e.kind) {
+      case TradeKind::Trade: {
+        const int64_t px = e.priceMantissa;
+        ++st.tradeCount;
+        st.volume += e.qty;
+        st.notional += (static_cast<double>(px) / 10000.0) * static_cast<double>(e.qty);
+        st.last = px;
+        st.lastQty = e.qty;
+        if (!st.has(Flag::HasOpen)) {
+          st.open = px;
+          st.flags |= Flag::HasOpen;
+        }
+        st.high = st.has(Flag::HasHigh) ? std::max(st.high, px) : px;
+        st.low = st.has(Flag::HasLow) ? std::min(st.low, px) : px;
+        st.flags |= Flag::HasLast | Flag::HasHigh | Flag::HasLow;
+        if (e.tradeId != 0) {
+          if (st.firstTradeId == 0 || e.tradeId < st.firstTradeId)
+            st.firstTradeId = e.tradeId;
+          st.lastTradeId = std::max(st.lastTradeId, e.tradeId);
+        }
+        break;
+      }
+      case TradeKind::Bust:
+        if (!counted(st, e)) {
+          bustsIgnored_.fetch_add(1, std::memory_order_relaxed);
+          return;
+        }
+        if (st.tradeCount > 0)
+          --st.tradeCount;
+        st.volume = std::max<int64_t>(0, st.volume - e.qty);
+        st.notional -= (static_cast<double>(e.priceMantissa) / 10000.0) *
+                       static_cast<double>(e.qty);
+        if (st.volume == 0 || st.notional < 0)
+          st.notional = 0;
+        break;
+      case TradeKind::OpeningPrice:
+        setExchangePrice(st, st.open, Flag::HasOpen, e);
+        if (e.deleted)
+          st.flags &= static_cast<uint16_t>(~Flag::OpenFromExchange);
+        else
+          st.flags |= Flag::OpenFromExchange;
+        break;
+      case TradeKind::HighPrice:
+        setExchangePrice(st, st.high, Flag::HasHigh, e);
+        break;
+      case TradeKind::LowPrice:
+        setExchangePrice(st, st.low, Flag::HasLow, e);
+        break;
+      case TradeKind::ClosingPrice:
+        setExchangePrice(st, st.close, Flag::HasClose, e);
+        break;
+      case TradeKind::SettlementPrice:
+        setExchangePrice(st, st.settlement, Flag::HasSettlement, e);
+        break;
+      case TradeKind::ForwardTrade:
+        return;
+      }
+
+      if (e.rptSeq != 0)
+        st.lastRptSeq = e.rptSeq;
+      if (e.transactTimeNs != 0)
+        st.lastTransactNs = e.transactTimeNs;
+      applied_.fetch_add(1, std::memory_order_relaxed);
+
+      if (!st.dirty) {
+        st.dirty = true;
+        dirty_.push_back(idx);
+      }
+    }
+
+    // Consumer thread: publica los dirty si venció el intervalo. Devuelve cuántos publicó.
+    uint32_t maybePublish(uint64_t nowNs) noexcept {
+      if (nowNs < nextPublishNs_)
+        return 0;
+      nextPublishNs_ = nowNs + intervalNs_;
+      return flush();
+    }
+
+    // Publica todos los dirty ya (shutdown / tests). Si el sink rechaza, queda dirty y reintenta.
+    uint32_t flush() noexcept {
+      uint32_t sent = 0;
+      size_t keep = 0;
+      for (size_t i = 0; i < dirty_.size(); ++i) {
+        const uint32_t idx = dirty_[i];
+        InstrumentStats &st = stats_[idx];
+        const Outcome r = publishOne(st);
+        if (r == Outcome::Retry) {
+          dirty_[keep++] = idx;
+          continue;
+        }
+        st.dirty = false;
+        sent += r == Outcome::Sent ? 1u : 0u;
+      }
+      dirty_.resize(keep);
+      return sent;
+    }
+
+    // Snapshot de un instrumento (consumer thread / tests). nullptr si nunca se vio.
+    const InstrumentStats *find(uint64_t instrumentId) const noexcept {
+      const uint32_t idx = index_.find(instrumentId);
+      return idx == DenseInstrumentIndex::kNone ? nullptr : &stats_[idx];
+    }
+
+    uint32_t instruments() const noexcept { return index_.size(); }
+    size_t dirtyCount() const noexcept { return dirty_.size(); }
+
+    uint64_t applied() const noexcept { return applied_.load(std::memory_order_relaxed); }
+    uint64_t published() const noexcept { return published_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t overflow() const noexcept { return overflow_.load(std::memory_order_relaxed); }
+    uint64_t retried() const noexcept { return retried_.load(std::memory_order_relaxed); }
+    uint64_t bustsIgnored() const noexcept { return bustsIgnored_.load(std::memory_order_relaxed); }
+    uint64_t sessionResets() const noexcept {
+      return sessionResets_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    // Sesión nueva: todo de cero salvo la identidad y el estado de publicación (si estaba dirty
+    // sigue en dirty_; si no, el evento que dispara el reset lo marca).
+    void resetSession(InstrumentStats &st, uint16_t session) noexcept {
+      const uint64_t iid = st.instrumentId;
+      const bool dirty = st.dirty;
+      st = InstrumentStats{};
+      st.instrumentId = iid;
+      st.dirty = dirty;
+      st.session = session;
+      sessionResets_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // ¿El bust anula un trade que se sumó? Busts son raros: el scan lineal de termos alcanza.
+    bool counted(const InstrumentStats &st, const TradeEvent &e) const noexcept {
+      if (e.tradeId == 0 || st.firstTradeId == 0 || e.tradeId < st.firstTradeId ||
+          e.tradeId > st.lastTradeId)
+        return false;
+      for (const auto &f : forwards_) {
+        if (f.tradeId == e.tradeId && f.instrumentId == e.instrumentId)
+          return false;
+      }
+      return true;
+    }
+
+    static void setExchangePrice(InstrumentStats &st, int64_t &field, InstrumentStats::Flag f,
+                                 const TradeEvent &e) noexcept {
+      if (e.deleted) {
+        st.flags &= static_cast<uint16_t>(~f);
+        field = 0;
+        return;
+      }
+      field = e.priceMantissa;
+      st.flags |= f;
+    }
+
+    enum class Outcome : uint8_t { Sent, Dropped, Retry };
+
+    Outcome publishOne(const InstrumentStats &st) noexcept {
+      auto [topicPtr, topicLen] = topicMapper_.getTopic(st.instrumentId);
+      if (!topicPtr || topicLen == 0 || !mapper_.mapStatsToEnvelope(st, ev_, topicPtr, topicLen)) {
+        // Sin topic (todavía) o no serializa: no se reintenta hasta el próximo cambio
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return Outcome::Dropped;
+      }
+      ev_.sourceTsNs = 0; // publicación por timer: no entra en la latencia end-to-end
+
+      if (!sink_.tryPublishPriority(channel_, ev_)) {
+        retried_.fetch_add(1, std::memory_order_relaxed); // queda dirty: no es un drop
+        return Outcome::Retry;
+      }
+      published_.fetch_add(1, std::memory_order_relaxed);
+      return Outcome::Sent;
+    }
+
+    mapping::MdSnapshotMapper &mapper_;
+    publishing::IPublishSink &sink_;
+    const mapping::InstrumentTopicMapper &topicMapper_;
+    const uint64_t intervalNs_;
+    const uint32_t channel_;
+
+    DenseInstrumentIndex index_;
+    std::vector<InstrumentStats> stats_; // por índice denso
+    std::vector<uint32_t> dirty_;        // índices con cambios sin publicar
+    publishing::CompactEnvelope ev_{};
+
+    struct ForwardKey {
+      uint64_t instrumentId{0};
+      uint32_t tradeId{0};
+    };
+    std::array<ForwardKey, kForwardMemory> forwards_{}; // ring de termos recientes
+    uint64_t forwardPos_{0};
+
+    uint64_t nextPublishNs_{0};
+
+    std::atomic<uint64_t> applied_{0};
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> overflow_{0};
+    std::atomic<uint64_t> retried_{0};
+    std::atomic<uint64_t> bustsIgnored_{0};
+    std::atomic<uint64_t> sessionResets_{0};
+  };
+
+} // namespace b3::md
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "IngressLane.hpp"
+#include "MdStatsEngine.hpp"
+#include "TradeEvent.hpp"
+
+#include "../mapping/InstrumentTopicMapper.hpp"
+#include "../mapping/MdSnapshotMapper.hpp"
+#include "../publishing/CompactEnvelope.hpp"
+#include "../publishing/IPublishSink.hpp"
+#include "../telemetry/LogEvent.hpp"
+#include "../telemetry/SpdlogLogPublisher.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace b3::md {
+
+  /**
+   * @brief Lane de trades: colas y thread propios, separados del pipeline de books.
+   *
+   * Un trade nunca queda detrás del backlog de libros: tiene sus SPSC (shard × lane de ingreso,
+   * slots de 64 bytes), un consumer dedicado que no duerme 1ms al quedar idle (spin/yield y
+   * recién después sleeps cortos) y publica por la lane prioritaria del sink
+   * (IPublishSink::tryPublishPriority), que el concentrator drena antes que los books.
+   *
+   * FIFO por instrumento: el shard sale del mismo hash que los books (homeShard, sin overrides)
+   * y dentro del shard las lanes se mergean por ticket (IngressLaneSet, igual que
+   * MdPublishWorker).
+   *
+   * Opcional: MdStatsEngine corre en este mismo thread (setStats antes de start): recibe cada
+   * evento en orden, incluidos los precios del exchange que no se publican como trade.
+   */
+  class MdTradeLane final {
+   public:
+    static constexpr size_t kQueueCapacity = 1024;
+    static constexpr size_t kLogQueueCapacity = 256;
+    static constexpr uint32_t kBatchPerShard = 32;
+
+    MdTradeLane(uint32_t shardCount, mapping::MdSnapshotMapper &mapper,
+                publishing::IPublishSink &sink, const mapping::InstrumentTopicMapper &topicMapper,
+                uint32_t laneCount = 1, QueueConfig queue = {kQueueCapacity, false},
+                uint32_t channel = publishing::kTradeChannel)
+        : mapper_(mapper), sink_(sink), topicMapper_(topicMapper), channel_(channel) {
+      if (shardCount == 0 || laneCount == 0)
+        throw std::invalid_argument("MdTradeLane: shardCount/laneCount == 0");
+      shards_.reserve(shardCount);
+      for (uint32_t s = 0; s < shardCount; ++s)
+        shards_.emplace_back(std::make_unique<Lanes>(laneCount, queue));
+    }
+
+    ~MdTradeLane() { stop(false); }
+
+    MdTradeLane(const MdTradeLane &) = delete;
+    MdTradeLane &operator=(const MdTradeLane &) = delete;
+
+    // Antes de start(). nullptr = sin stats.
+    void setStats(MdStatsEngine *stats) noexcept { stats_ = stats; }
+    // Antes de start(). false = solo stats (md.trades=0 con md.stats=1).
+    void setPublishTrades(bool on) noexcept { publishTrades_ = on; }
+
+    void start() { consumer_.start([this] { run(); }); }
+
+    void stop(bool drain = true) { consumer_.stop(drain); }
+
+    // Hot path (callback OnixS): encola en la lane del thread que llama.
+    bool tryEnqueue(uint32_t shard, const TradeEvent &trade) noexcept {
+      return tryEnqueue(shard, trade, tlsIngressLane);
+    }
+
+    bool tryEnqueue(uint32_t shard, const TradeEvent &trade, uint32_t lane) noexcept {
+      if (shard >= shards_.size()) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      const IngressPush r = shards_[shard]->tryPush(lane, trade);
+      if (r == IngressPush::Ok) {
+        enqueued_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+      if (r == IngressPush::NoLane) // thread no registrado (ver IngressLane.hpp)
+        laneRejected_.fetch_add(1, std::memory_order_relaxed);
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    uint64_t enqueued() const noexcept { return enqueued_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t published() const noexcept { return published_.load(std::memory_order_relaxed); }
+    uint64_t laneRejected() const noexcept { return laneRejected_.load(std::memory_order_relaxed); }
+    uint32_t shardCount() const noexcept { return static_cast<uint32_t>(shards_.size()); }
+    uint32_t laneCount() const noexcept { return shards_.front()->size(); }
+
+    size_t queueMemoryBytes() const noexcept {
+      size_t n = 0;
+      for (const auto &s : shards_) n += s->memoryBytes();
+      return n;
+    }
+
+   private:
+    using Lanes = IngressLaneSet<TradeEvent, kQueueCapacity>;
+
+    uint64_t queuedApprox() const noexcept {
+      uint64_t n = 0;
+      for (const auto &s : shards_) n += s->queuedApprox();
+      return n;
+    }
+
+    void process(const TradeEvent &t, publishing::CompactEnvelope &ev) noexcept {
+      if (publishTrades_ && isTradeKind(t.kind))
+        publishOne(t, ev);
+      if (stats_)
+        stats_->apply(t);
+    }
+
+    void publishOne(const TradeEvent &t, publishing::CompactEnvelope &ev) noexcept {
+      auto [topicPtr, topicLen] = topicMapper_.getTopic(t.instrumentId);
+      if (!topicPtr || topicLen == 0 || !mapper_.mapTradeToEnvelope(t, ev, topicPtr, topicLen)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      ev.sourceTsNs = t.recvTsNs;
+
+      if (!sink_.tryPublishPriority(channel_, ev)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      published_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static uint64_t nowNsSystem() noexcept {
+      const auto now = std::chrono::system_clock::now().time_since_epoch();
+      return static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+    }
+
+    void emit(telemetry::LogLevel level, telemetry::Code code, uint64_t nowNs, uint64_t arg0,
+              uint64_t arg1) noexcept {
+      telemetry::LogEvent e{};
+      e.tsNs = nowNs;
+      e.level = level;
+      e.component = telemetry::Component::Trades;
+      e.code = code;
+      e.arg0 = arg0;
+      e.arg1 = arg1;
+      (void)consumer_.logger().try_publish(e);
+    }
+
+    void maybeLogHealthTick(uint64_t nowNs) noexcept {
+      if (nowNs < nextHealthNs_)
+        return;
+      nextHealthNs_ = nowNs + kHealthEveryNs;
+
+      const uint64_t pub = published_.load(std::memory_order_relaxed);
+      const uint64_t drop = dropped_.load(std::memory_order_relaxed);
+      emit(telemetry::LogLevel::Health, telemetry::Code::HealthTick, nowNs, pub - lastPub_,
+           queuedApprox());
+      if (drop != lastDrop_)
+        emit(telemetry::LogLevel::Health, telemetry::Code::Drops, nowNs, drop - lastDrop_, drop);
+      lastPub_ = pub;
+      lastDrop_ = drop;
+    }
+
+    void run() noexcept {
+      using namespace std::chrono_literals;
+
+      for (auto &s : shards_) s->firstTouch();
+      consumer_.markTouched();
+
+      publishing::CompactEnvelope ev{};
+      uint64_t nowNs = nowNsSystem();
+      nextHealthNs_ = nowNs + kHealthEveryNs;
+      emit(telemetry::LogLevel::Info, telemetry::Code::Startup, nowNs, shards_.size(),
+           laneCount());
+
+      uint32_t idleSpins = 0;
+      while (consumer_.running() || (consumer_.drainOnStop() && queuedApprox() > 0)) {
+        bool didWork = false;
+
+        for (auto &sp : shards_) {
+          Lanes &s = *sp;
+          for (uint32_t k = 0; k < kBatchPerShard; ++k) {
+            const int lane = s.pick();
+            if (lane < 0)
+              break;
+            didWork = true;
+            process(s.front(lane), ev);
+            s.pop(lane);
+          }
+        }
+
+        if (didWork) {
+          idleSpins = 0;
+        } else if (++idleSpins < kSpinIdle) {
+          std::this_thread::yield();
+        } else {
+          std::this_thread::sleep_for(50us);
+        }
+
+        nowNs = nowNsSystem();
+        if (stats_)
+          stats_->maybePublish(nowNs);
+        maybeLogHealthTick(nowNs);
+      }
+
+      if (stats_)
+        stats_->flush();
+
+      emit(telemetry::LogLevel::Info, telemetry::Code::Shutdown, nowNsSystem(),
+           published_.load(std::memory_order_relaxed), dropped_.load(std::memory_order_relaxed));
+    }
+
+   private:
+    static constexpr uint64_t kHealthEveryNs = 5'000'000'000ull;
+    static constexpr uint32_t kSpinIdle = 2000; // yields antes de pasar a sleeps de 50us
+
+    mapping::MdSnapshotMapper &mapper_;
+    publishing::IPublishSink &sink_;
+    const mapping::InstrumentTopicMapper &topicMapper_;
+    const uint32_t channel_;
+    MdStatsEngine *stats_{nullptr};
+    bool publishTrades_{true};
+
+    std::vector<std::unique_ptr<Lanes>> shards_;
+
+    IngressConsumer<telemetry::SpdlogLogPublisher<kLogQueueCapacity>> consumer_;
+
+    std::atomic<uint64_t> enqueued_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> laneRejected_{0};
+
+    uint64_t nextHealthNs_{0};
+    uint64_t lastPub_{0};
+    uint64_t lastDrop_{0};
+  };
+
+} // namespace b3::md
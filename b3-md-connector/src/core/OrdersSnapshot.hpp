@@ -14,6 +14,10 @@ namespace b3::md {
   struct OrdersSnapshot {
     static constexpr size_t K = 256;
 
+    // flags
+    static constexpr uint8_t kBookInvalid = 1u << 0; // marcador: libro desactualizado, sin órdenes
+    static constexpr uint8_t kBookRefresh = 1u << 1; // primer libro completo tras la recuperación
+
     struct OrderEntry {         // todo:verificar prefision
       int64_t priceMantissa{0}; // precio con 4 decimales (mantissa)
       int64_t qty{0};           // Quantity (Int64)
@@ -38,6 +42,8 @@ namespace b3::md {
     uint8_t bidTruncated{0};
     uint8_t askTruncated{0};
 
+    uint8_t flags{0}; // kBookInvalid / kBookRefresh
+
     OrderEntry bids[K]{};
     OrderEntry asks[K]{};
   };
@@ -0,0 +1,238 @@
+#pragma once
+
+#include "BookSnapshot.hpp"
+#include "OrdersSnapshot.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+namespace b3::md {
+
+  /**
+   * @brief Conflación por tiempo de UN stream throttleado, por instrumento (single thread: el
+   *        worker dueño).
+   *
+   * A lo sumo un book por instrumento cada `intervalNs`, y el último valor siempre sale:
+   * - Sin emisión reciente: el book sale en el momento (leading edge).
+   * - Dentro del intervalo: se guarda el último y se agenda en la rueda para
+   *   lastEmit + interval (trailing edge). Los que llegan mientras está agendado lo pisan.
+   * - kBookInvalid / kBookRefresh no se conflacionan nunca: salen en el momento y descartan el
+   *   pendiente (el marcador invalida lo anterior; el refresh lo reemplaza).
+   *
+   * Timer wheel de ticks fijos con listas intrusivas (prev/next por slot): agendar, cancelar y
+   * vencer son O(1), sin alloc en hot path. Como ningún deadline queda más lejos que un
+   * intervalo, la rueda tiene > interval/tick buckets y no hace falta contar vueltas.
+   *
+   * Tabla open-addressing fija (como InstrumentRateTracker); un instrumento que no entra no se
+   * throttlea (sale todo) y se cuenta en untracked().
+   */
+  class PublishThrottle final {
+   public:
+    static constexpr uint32_t kMaxProbes = 16;
+    static constexpr uint64_t kDefaultTickNs = 1'000'000; // 1ms
+
+    explicit PublishThrottle(uint64_t intervalNs, uint32_t capacityPow2 = 4096,
+                             uint64_t tickNs = kDefaultTickNs)
+        : intervalNs_(intervalNs), tickNs_(tickNs), mask_(capacityPow2 - 1),
+          slots_(std::make_unique<Slot[]>(capacityPow2)) {
+      if (intervalNs == 0 || tickNs == 0)
+        throw std::invalid_argument("PublishThrottle: interval and tick must be > 0");
+      if (capacityPow2 < 2 || (capacityPow2 & (capacityPow2 - 1)) != 0)
+        throw std::invalid_argument("PublishThrottle: capacity must be a power of two");
+
+      uint32_t buckets = 2;
+      while (buckets < intervalNs / tickNs + 2) buckets <<= 1;
+      wheelMask_ = buckets - 1;
+      wheel_ = std::make_unique<int32_t[]>(buckets);
+      for (uint32_t i = 0; i < buckets; ++i) wheel_[i] = kNil;
+    }
+
+    PublishThrottle(const PublishThrottle &) = delete;
+    PublishThrottle &operator=(const PublishThrottle &) = delete;
+
+    uint64_t intervalNs() const noexcept { return intervalNs_; }
+
+    // Book nuevo del instrumento. emit(const BookSnapshot&) si tiene que salir ya.
+    template <typename Emit>
+    void offer(const BookSnapshot &b, uint64_t nowNs, Emit &&emit) noexcept {
+      offered_.fetch_add(1, std::memory_order_relaxed);
+      advance(nowNs, emit); // la rueda al día antes de agendar contra curTick_
+
+      Slot *s = find(b.instrumentId);
+      if (!s) {
+        untracked_.fetch_add(1, std::memory_order_relaxed);
+        doEmit(b, emit);
+        return;
+      }
+
+      if (b.flags & (OrdersSnapshot::kBookInvalid | OrdersSnapshot::kBookRefresh)) {
+        if (s->pending)
+          unlink(*s);
+        s->lastEmitNs = nowNs;
+        s->emitted = true;
+        doEmit(b, emit);
+        return;
+      }
+
+      if (s->pending) {
+        s->latest = b;
+        conflated_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+
+      if (!s->emitted || nowNs - s->lastEmitNs >= intervalNs_) {
+        s->lastEmitNs = nowNs;
+        s->emitted = true;
+        doEmit(b, emit);
+        return;
+      }
+
+      s->latest = b;
+      schedule(*s, s->lastEmitNs + intervalNs_);
+    }
+
+    // Vence los buckets hasta nowNs. Llamar seguido (cada evento / vuelta idle del worker).
+    template <typename Emit>
+    void advance(uint64_t nowNs, Emit &&emit) noexcept {
+      const uint64_t nowTick = nowNs / tickNs_;
+      if (!started_) {
+        started_ = true;
+        curTick_ = nowTick;
+        return;
+      }
+      if (nowTick <= curTick_)
+        return;
+      // Atrasado más de una vuelta: cada bucket se visita una sola vez (todo lo agendado vence).
+      uint64_t from = curTick_ + 1;
+      if (nowTick - curTick_ > wheelMask_ + 1)
+        from = nowTick - wheelMask_;
+      for (uint64_t t = from; t <= nowTick; ++t) {
+        int32_t &head = wheel_[t & wheelMask_];
+        while (head != kNil) {
+          Slot &s = slots_[static_cast<uint32_t>(head)];
+          unlink(s);
+          s.lastEmitNs = nowNs;
+          doEmit(s.latest, emit);
+        }
+      }
+      curTick_ = nowTick;
+    }
+
+    // Emite todo lo pendiente (stop del worker).
+    template <typename Emit>
+    void flushAll(Emit &&emit) noexcept {
+      for (uint32_t b = 0; b <= wheelMask_; ++b) {
+        while (wheel_[b] != kNil) {
+          Slot &s = slots_[static_cast<uint32_t>(wheel_[b])];
+          unlink(s);
+          doEmit(s.latest, emit);
+        }
+      }
+    }
+
+    // Rebalanceo: el instrumento acaba de llegar de otro shard, cuyo throttle puede tener un
+    // pendiente todavía. El próximo book se agenda (no sale en el momento) para no adelantarse.
+    void deferNext(uint64_t instrumentId, uint64_t nowNs) noexcept {
+      if (Slot *s = find(instrumentId); s && !s->pending) {
+        s->lastEmitNs = nowNs;
+        s->emitted = true;
+      }
+    }
+
+    uint32_t pendingCount() const noexcept { return pending_; }
+
+    uint64_t offered() const noexcept { return offered_.load(std::memory_order_relaxed); }
+    uint64_t emitted() const noexcept { return emitted_.load(std::memory_order_relaxed); }
+    // Books pisados por uno más nuevo antes de salir.
+    uint64_t conflated() const noexcept { return conflated_.load(std::memory_order_relaxed); }
+    uint64_t untracked() const noexcept { return untracked_.load(std::memory_order_relaxed); }
+
+   private:
+    static constexpr uint64_t kKnuth = 11400714819323198485ull;
+    static constexpr int32_t kNil = -1;
+
+    struct Slot {
+      uint64_t iid{0};
+      uint64_t lastEmitNs{0};
+      int32_t prev{kNil};
+      int32_t next{kNil};
+      uint32_t bucket{0};
+      bool pending{false};
+      bool emitted{false};
+      BookSnapshot latest{};
+    };
+
+    template <typename Emit>
+    void doEmit(const BookSnapshot &b, Emit &emit) noexcept {
+      emit(b);
+      emitted_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // instrumentId 0 = slot libre. Inserta si no está.
+    Slot *find(uint64_t instrumentId) noexcept {
+      if (instrumentId == 0)
+        return nullptr;
+      uint32_t i = static_cast<uint32_t>((instrumentId * kKnuth) >> 32) & mask_;
+      for (uint32_t p = 0; p < kMaxProbes; ++p, i = (i + 1) & mask_) {
+        Slot &s = slots_[i];
+        if (s.iid == instrumentId)
+          return &s;
+        if (s.iid == 0) {
+          s.iid = instrumentId;
+          return &s;
+        }
+      }
+      return nullptr;
+    }
+
+    void schedule(Slot &s, uint64_t deadlineNs) noexcept {
+      // ceil: nunca antes del deadline; y siempre después del tick actual (ya procesado)
+      uint64_t tick = (deadlineNs + tickNs_ - 1) / tickNs_;
+      if (tick <= curTick_)
+        tick = curTick_ + 1;
+      const uint32_t b = static_cast<uint32_t>(tick & wheelMask_);
+      const int32_t idx = static_cast<int32_t>(&s - slots_.get());
+
+      s.bucket = b;
+      s.prev = kNil;
+      s.next = wheel_[b];
+      if (s.next != kNil)
+        slots_[static_cast<uint32_t>(s.next)].prev = idx;
+      wheel_[b] = idx;
+      s.pending = true;
+      ++pending_;
+    }
+
+    void unlink(Slot &s) noexcept {
+      if (s.prev != kNil)
+        slots_[static_cast<uint32_t>(s.prev)].next = s.next;
+      else
+        wheel_[s.bucket] = s.next;
+      if (s.next != kNil)
+        slots_[static_cast<uint32_t>(s.next)].prev = s.prev;
+      s.prev = s.next = kNil;
+      s.pending = false;
+      --pending_;
+    }
+
+    const uint64_t intervalNs_;
+    const uint64_t tickNs_;
+    const uint32_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    uint32_t wheelMask_{0};
+    std::unique_ptr<int32_t[]> wheel_;
+    uint64_t curTick_{0};
+    bool started_{false};
+    uint32_t pending_{0};
+
+    // Contadores: los escribe el worker, los lee main en el shutdown.
+    std::atomic<uint64_t> offered_{0};
+    std::atomic<uint64_t> emitted_{0};
+    std::atomic<uint64_t> conflated_{0};
+    std::atomic<uint64_t> untracked_{0};
+  };
+
+} // namespace b3::md
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace b3::md {
+
+  // Qué memoria terminó respaldando una cola (para el reporte de startup).
+  enum class QueueBacking : uint8_t {
+    Regular = 0,         // páginas de 4KB
+    TransparentHuge = 1, // mmap + madvise(MADV_HUGEPAGE): THP si el kernel lo permite
+    HugeTlb = 2,         // MAP_HUGETLB (2MB reservadas en /proc/sys/vm/nr_hugepages)
+  };
+
+  inline const char *toString(QueueBacking b) noexcept {
+    switch (b) {
+      case QueueBacking::Regular:         return "regular";
+      case QueueBacking::TransparentHuge: return "thp";
+      case QueueBacking::HugeTlb:         return "hugetlb";
+      default:                            return "unknown";
+    }
+  }
+
+  // Tamaño/backing de una cola SPSC, configurable sin recompilar.
+  struct QueueConfig {
+    uint32_t capacity{4096};  // elementos; se redondea a potencia de 2
+    bool hugePages{false};    // intentar 2MB hugepages (fallback transparente)
+  };
+
+  inline uint32_t roundUpPow2(uint32_t v) noexcept {
+    if (v <= 2)
+      return 2;
+    --v;
+    v |= v >> 1;
+    v |= v >> 2;
+    v |= v >> 4;
+    v |= v >> 8;
+    v |= v >> 16;
+    return v + 1;
+  }
+
+  /**
+   * @brief Storage crudo (zero-filled) para el ring de una cola SPSC.
+   *
+   * - hugePages: MAP_HUGETLB con tamaño redondeado a 2MB; si no hay hugepages reservadas cae a
+   *   mmap normal + MADV_HUGEPAGE; fuera de Linux, operator new alineado.
+   * - No toca la memoria: firstTouch() escribe una vez por página desde el thread que la va a
+   *   usar (consumer), así el fault ocurre en startup y en el nodo NUMA correcto.
+   * - Contabilidad global por backing para el reporte de memoria en startup.
+   */
+  class QueueMemory final {
+   public:
+    static constexpr size_t kHugePageSize = 2u * 1024u * 1024u;
+    static constexpr size_t kPageSize = 4096;
+
+    QueueMemory(size_t bytes, bool hugePages) {
+      if (bytes == 0)
+        throw std::invalid_argument("QueueMemory: bytes == 0");
+
+#if defined(__linux__)
+      if (hugePages) {
+        const size_t rounded = (bytes + kHugePageSize - 1) & ~(kHugePageSize - 1);
+        void *p = ::mmap(nullptr, rounded, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+          init(p, rounded, QueueBacking::HugeTlb);
+          return;
+        }
+      }
+
+      const size_t rounded = (bytes + kPageSize - 1) & ~(kPageSize - 1);
+      void *p = ::mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (p == MAP_FAILED)
+        throw std::bad_alloc();
+
+      QueueBacking backing = QueueBacking::Regular;
+      if (hugePages && ::madvise(p, rounded, MADV_HUGEPAGE) == 0)
+        backing = QueueBacking::TransparentHuge;
+      init(p, rounded, backing);
+#else
+      (void)hugePages;
+      void *p = ::operator new(bytes, std::align_val_t{64});
+      std::memset(p, 0, bytes);
+      init(p, bytes, QueueBacking::Regular);
+#endif
+    }
+
+    QueueMemory(const QueueMemory &) = delete;
+    QueueMemory &operator=(const QueueMemory &) = delete;
+
+    ~QueueMemory() {
+      accounted(backing_).fetch_sub(bytes_, std::memory_order_relaxed);
+#if defined(__linux__)
+      ::munmap(data_, bytes_);
+#else
+      ::operator delete(data_, std::align_val_t{64});
+#endif
+    }
+
+    void *data() const noexcept { return data_; }
+    size_t mappedBytes() const noexcept { return bytes_; }
+    QueueBacking backing() const noexcept { return backing_; }
+
+    // Fuerza el fault de cada página (idempotente en efecto; barato después de la primera vez).
+    void firstTouch() noexcept {
+      volatile unsigned char *p = static_cast<volatile unsigned char *>(data_);
+      for (size_t off = 0; off < bytes_; off += kPageSize) p[off] = 0;
+    }
+
+    // Bytes mapeados por colas vivas, por backing / total.
+    static uint64_t liveBytes(QueueBacking b) noexcept {
+      return accounted(b).load(std::memory_order_relaxed);
+    }
+
+    static uint64_t liveBytesTotal() noexcept {
+      return liveBytes(QueueBacking::Regular) + liveBytes(QueueBacking::TransparentHuge) +
+             liveBytes(QueueBacking::HugeTlb);
+    }
+
+   private:
+    static std::atomic<uint64_t> &accounted(QueueBacking b) noexcept {
+      static std::atomic<uint64_t> bytes[3]{};
+      return bytes[static_cast<size_t>(b)];
+    }
+
+    void init(void *p, size_t bytes, QueueBacking backing) noexcept {
+      data_ = p;
+      bytes_ = bytes;
+      backing_ = backing;
+      accounted(backing_).fetch_add(bytes_, std::memory_order_relaxed);
+    }
+
+   private:
+    void *data_{nullptr};
+    size_t bytes_{0};
+    QueueBacking backing_{QueueBacking::Regular};
+  };
+
+} // namespace b3::md
@@ -0,0 +1,532 @@
+#pragma once
+
+#include <b3/common/InstrumentData.hpp>
+#include <b3/common/InstrumentRegistry.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace b3::md {
+
+  /**
+   * @brief Cache binario de la security list (InstrumentData commiteado) para arrancar rápido.
+   *
+   * Un restart intradiario espera un loop SequenceReset→SequenceReset completo antes de
+   * publicar. Con el cache del mismo día/canal el registry se carga al inicio y el loop en vivo
+   * solo reconcilia en background.
+   *
+   * Formato (little endian, alineado a 8 bytes, mmap-able):
+   *   SecurityListCacheHeader (64B)
+   *   SecurityListCacheRecord[count] (campos numéricos + refs a strings)
+   *   strings (blob, sin terminadores)
+   *
+   * Se escribe a `<path>.tmp` y se renombra: un lector nunca ve un archivo a medio escribir.
+   */
+  struct SecurityListCacheKey {
+    uint32_t tradingDate{0}; // YYYYMMDD
+    uint32_t channel{0};
+  };
+
+  struct SecurityListCacheHeader {
+    static constexpr char kMagic[8] = {'B', '3', 'M', 'D', 'S', 'E', 'C', '1'};
+    static constexpr uint32_t kVersion = 2; // 2: underlyingSecurityId de 64 bits
+
+    char magic[8]{};
+    uint32_t version{0};
+    uint32_t headerBytes{0};
+    uint32_t recordBytes{0};
+    uint32_t count{0};
+    uint32_t tradingDate{0};
+    uint32_t channel{0};
+    uint64_t stringsBytes{0};
+    uint64_t checksum{0}; // FNV-1a 64 de records + strings
+    uint64_t createdNs{0};
+    uint64_t reserved{0};
+  };
+  static_assert(sizeof(SecurityListCacheHeader) == 64);
+
+  struct SecurityListCacheStr {
+    uint32_t offset{0};
+    uint32_t len{0};
+  };
+
+  struct SecurityListCacheRecord {
+    enum Str : uint32_t {
+      kSymbol,
+      kSecurityExchange,
+      kAsset,
+      kSecurityType,
+      kSecurityGroup,
+      kCfiCode,
+      kMarketSegmentId,
+      kUnderlyingSymbol,
+      kSettlementType,
+      kCurrency,
+      kIsin,
+      kSecurityDesc,
+      kStrCount
+    };
+
+    uint64_t securityId{0};
+    int64_t minPriceIncrement{0};
+    int64_t minPriceIncrementAmount{0};
+    int64_t strikePrice{0};
+    int64_t minOrderQty{0};
+    int64_t maxOrderQty{0};
+    int64_t lotSize{0};
+    int64_t minTradeVol{0};
+    int64_t highLimitPrice{0};
+    int64_t lowLimitPrice{0};
+    int64_t maxPriceVariation{0};
+    uint64_t securityTradingEventTimestamp{0};
+    uint64_t underlyingSecurityId{0};
+
+    uint32_t governanceIndicator{0};
+    uint32_t maturityDate{0};
+    uint32_t theoreticalOpeningPrice{0};
+
+    uint8_t securityMatchType{0};
+    uint8_t securityTradingStatus{0};
+    uint8_t strikeReportingCurrency{0};
+    uint8_t putOrCall{0};
+    uint8_t exerciseStyle{0};
+    uint8_t corporateActionEventId{0};
+    uint8_t highLimitPriceType{0};
+    uint8_t lowLimitPriceType{0};
+    uint8_t productComplex{0};
+    uint8_t isMultileg{0};
+    uint8_t hasCorporateAction{0};
+    uint8_t pad[1]{};
+
+    SecurityListCacheStr str[kStrCount]{};
+  };
+  static_assert(sizeof(SecurityListCacheRecord) == 224);
+  static_assert(sizeof(SecurityListCacheRecord) % 8 == 0);
+
+  enum class SecurityListCacheStatus : uint8_t {
+    Loaded,
+    Missing,
+    BadFormat,
+    WrongDate,
+    WrongChannel,
+    Corrupt,
+  };
+
+  inline const char *toString(SecurityListCacheStatus s) noexcept {
+    switch (s) {
+      case SecurityListCacheStatus::Loaded:
+        return "loaded";
+      case SecurityListCacheStatus::Missing:
+        return "missing";
+      case SecurityListCacheStatus::BadFormat:
+        return "bad_format";
+      case SecurityListCacheStatus::WrongDate:
+        return "wrong_date";
+      case SecurityListCacheStatus::WrongChannel:
+        return "wrong_channel";
+      case SecurityListCacheStatus::Corrupt:
+        return "corrupt";
+    }
+    return "unknown";
+  }
+
+  namespace seccache {
+
+    inline uint64_t fnv1a(const unsigned char *p, size_t n,
+                          uint64_t h = 14695981039346656037ull) noexcept {
+      for (size_t i = 0; i < n; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+      }
+      return h;
+    }
+
+    // Fecha de trading B3 (YYYYMMDD) en hora de São Paulo (UTC-3, sin horario de verano).
+    inline uint32_t tradingDateToday(int utcOffsetMinutes = -180) noexcept {
+      using namespace std::chrono;
+      const auto local = system_clock::now() + minutes(utcOffsetMinutes);
+      const year_month_day ymd{floor<days>(local)};
+      return static_cast<uint32_t>(static_cast<int>(ymd.year())) * 10000u +
+             static_cast<uint32_t>(static_cast<unsigned>(ymd.month())) * 100u +
+             static_cast<uint32_t>(static_cast<unsigned>(ymd.day()));
+    }
+
+    inline SecurityListCacheRecord encode(uint64_t iid, const common::InstrumentData &d,
+                                          std::string &blob) {
+      SecurityListCacheRecord r{};
+      r.securityId = iid;
+      r.minPriceIncrement = d.minPriceIncrement;
+      r.minPriceIncrementAmount = d.minPriceIncrementAmount;
+      r.strikePrice = d.strikePrice;
+      r.minOrderQty = d.minOrderQty;
+      r.maxOrderQty = d.maxOrderQty;
+      r.lotSize = d.lotSize;
+      r.minTradeVol = d.minTradeVol;
+      r.highLimitPrice = d.highLimitPrice;
+      r.lowLimitPrice = d.lowLimitPrice;
+      r.maxPriceVariation = d.maxPriceVariation;
+      r.securityTradingEventTimestamp = d.securityTradingEventTimestamp;
+      r.governanceIndicator = d.governanceIndicator;
+      r.underlyingSecurityId = d.underlyingSecurityId;
+      r.maturityDate = d.maturityDate;
+      r.theoreticalOpeningPrice = d.theoreticalOpeningPrice;
+      r.securityMatchType = d.securityMatchType;
+      r.securityTradingStatus = d.securityTradingStatus;
+      r.strikeReportingCurrency = d.strikeReportingCurrency;
+      r.putOrCall = d.putOrCall;
+      r.exerciseStyle = d.exerciseStyle;
+      r.corporateActionEventId = d.corporateActionEventId;
+      r.highLimitPriceType = d.highLimitPriceType;
+      r.lowLimitPriceType = d.lowLimitPriceType;
+      r.productComplex = d.productComplex;
+      r.isMultileg = d.isMultileg ? 1 : 0;
+      r.hasCorporateAction = d.hasCorporateAction ? 1 : 0;
+
+      // Mismo orden que SecurityListCacheRecord::Str
+      const std::string *s[SecurityListCacheRecord::kStrCount] = {
+          &d.symbol,           &d.securityExchange, &d.asset,          &d.securityType,
+          &d.securityGroup,    &d.cfiCode,          &d.marketSegmentId, &d.underlyingSymbol,
+          &d.settlementType,   &d.currency,         &d.isin,           &d.securityDesc};
+      for (uint32_t i = 0; i < SecurityListCacheRecord::kStrCount; ++i) {
+        r.str[i].offset = static_cast<uint32_t>(blob.size());
+        r.str[i].len = static_cast<uint32_t>(s[i]->size());
+        blob.append(*s[i]);
+      }
+      return r;
+    }
+
+    // false si algún string cae fuera del blob (archivo inconsistente).
+    inline bool decode(const SecurityListCacheRecord &r, const char *blob, uint64_t blobBytes,
+                       common::InstrumentData &d) {
+      d = common::InstrumentData{};
+      d.securityId = r.securityId;
+      d.minPriceIncrement = r.minPriceIncrement;
+      d.minPriceIncrementAmount = r.minPriceIncrementAmount;
+      d.strikePrice = r.strikePrice;
+      d.minOrderQty = r.minOrderQty;
+      d.maxOrderQty = r.maxOrderQty;
+      d.lotSize = r.lotSize;
+      d.minTradeVol = r.minTradeVol;
+      d.highLimitPrice = r.highLimitPrice;
+      d.lowLimitPrice = r.lowLimitPrice;
+      d.maxPriceVariation = r.maxPriceVariation;
+      d.securityTradingEventTimestamp = r.securityTradingEventTimestamp;
+      d.governanceIndicator = r.governanceIndicator;
+      d.underlyingSecurityId = r.underlyingSecurityId;
+      d.maturityDate = r.maturityDate;
+      d.theoreticalOpeningPrice = r.theoreticalOpeningPrice;
+      d.securityMatchType = r.securityMatchType;
+      d.securityTradingStatus = r.securityTradingStatus;
+      d.strikeReportingCurrency = r.strikeReportingCurrency;
+      d.putOrCall = r.putOrCall;
+      d.exerciseStyle = r.exerciseStyle;
+      d.corporateActionEventId = r.corporateActionEventId;
+      d.highLimitPriceType = r.highLimitPriceType;
+      d.lowLimitPriceType = r.lowLimitPriceType;
+      d.productComplex = r.productComplex;
+      d.isMultileg = r.isMultileg != 0;
+      d.hasCorporateAction = r.hasCorporateAction != 0;
+
+      std::string *s[SecurityListCacheRecord::kStrCount] = {
+          &d.symbol,           &d.securityExchange, &d.asset,          &d.securityType,
+          &d.securityGroup,    &d.cfiCode,          &d.marketSegmentId, &d.underlyingSymbol,
+          &d.settlementType,   &d.currency,         &d.isin,           &d.securityDesc};
+      for (uint32_t i = 0; i < SecurityListCacheRecord::kStrCount; ++i) {
+        const uint64_t end = static_cast<uint64_t>(r.str[i].offset) + r.str[i].len;
+        if (end > blobBytes)
+          return false;
+        s[i]->assign(blob + r.str[i].offset, r.str[i].len);
+      }
+      return true;
+    }
+
+    inline bool writeAll(int fd, const void *p, size_t n) noexcept {
+      const char *c = static_cast<const char *>(p);
+      while (n > 0) {
+        const ssize_t w = ::write(fd, c, n);
+        if (w < 0)
+          return false;
+        c += w;
+        n -= static_cast<size_t>(w);
+      }
+      return true;
+    }
+
+  } // namespace seccache
+
+  /**
+   * @brief Escribe el cache (tmp + fsync + rename). false ante cualquier error de IO: el cache es
+   *        una optimización de arranque, nunca un motivo para frenar el conector.
+   *
+   * Los items sin iid o sin símbolo no se escriben; `written` (opcional) recibe los records que
+   * quedaron en el archivo.
+   */
+  inline bool writeSecurityListCache(
+      const std::string &path, SecurityListCacheKey key,
+      const std::vector<std::pair<common::InstrumentId, common::InstrumentData>> &items,
+      uint32_t *written = nullptr) {
+    std::vector<SecurityListCacheRecord> records;
+    records.reserve(items.size());
+    std::string blob;
+    blob.reserve(items.size() * 48);
+    for (const auto &[iid, data] : items) {
+      if (iid == 0 || data.symbol.empty())
+        continue;
+      records.push_back(seccache::encode(iid, data, blob));
+    }
+
+    const size_t recordsBytes = records.size() * sizeof(SecurityListCacheRecord);
+
+    SecurityListCacheHeader h{};
+    std::memcpy(h.magic, SecurityListCacheHeader::kMagic, sizeof(h.magic));
+    h.version = SecurityListCacheHeader::kVersion;
+    h.headerBytes = sizeof(SecurityListCacheHeader);
+    h.recordBytes = sizeof(SecurityListCacheRecord);
+    h.count = static_cast<uint32_t>(records.size());
+    h.tradingDate = key.tradingDate;
+    h.channel = key.channel;
+    h.stringsBytes = blob.size();
+    h.checksum = seccache::fnv1a(reinterpret_cast<const unsigned char *>(blob.data()), blob.size(),
+                                 seccache::fnv1a(reinterpret_cast<const unsigned char *>(
+                                                     records.data()),
+                                                 recordsBytes));
+    h.createdNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                            std::chrono::system_clock::now().time_since_epoch())
+                                            .count());
+
+    const std::string tmp = path + ".tmp";
+    const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+      return false;
+
+    const bool ok = seccache::writeAll(fd, &h, sizeof(h)) &&
+                    seccache::writeAll(fd, records.data(), recordsBytes) &&
+                    seccache::writeAll(fd, blob.data(), blob.size()) && ::fsync(fd) == 0;
+    ::close(fd);
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+      (void)std::remove(tmp.c_str());
+      return false;
+    }
+    if (written)
+      *written = h.count;
+    return true;
+  }
+
+  /**
+   * @brief Lectura del cache (mmap read-only). No lanza: status() dice si se puede usar.
+   *        Solo es válido para el mismo día de trading y canal que lo escribió.
+   */
+  class SecurityListCacheReader final {
+   public:
+    SecurityListCacheReader(const std::string &path, SecurityListCacheKey expected) {
+      const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0) {
+        status_ = SecurityListCacheStatus::Missing;
+        return;
+      }
+
+      struct stat st {};
+      if (::fstat(fd, &st) != 0 ||
+          static_cast<size_t>(st.st_size) < sizeof(SecurityListCacheHeader)) {
+        ::close(fd);
+        status_ = SecurityListCacheStatus::BadFormat;
+        return;
+      }
+      size_ = static_cast<size_t>(st.st_size);
+
+      void *p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      ::close(fd);
+      if (p == MAP_FAILED) {
+        size_ = 0;
+        status_ = SecurityListCacheStatus::BadFormat;
+        return;
+      }
+      map_ = static_cast<const unsigned char *>(p);
+
+      status_ = validate(expected);
+    }
+
+    SecurityListCacheReader(const SecurityListCacheReader &) = delete;
+    SecurityListCacheReader &operator=(const SecurityListCacheReader &) = delete;
+
+    ~SecurityListCacheReader() {
+      if (map_)
+        ::munmap(const_cast<unsigned char *>(map_), size_);
+    }
+
+    SecurityListCacheStatus status() const noexcept { return status_; }
+    bool ok() const noexcept { return status_ == SecurityListCacheStatus::Loaded; }
+    const SecurityListCacheHeader &header() const noexcept { return header_; }
+    uint32_t count() const noexcept { return ok() ? header_.count : 0; }
+
+    // Records en el mapping (alineados: headerBytes y recordBytes son múltiplos de 8).
+    const SecurityListCacheRecord &record(uint32_t i) const noexcept {
+      return reinterpret_cast<const SecurityListCacheRecord *>(map_ + header_.headerBytes)[i];
+    }
+
+    bool decode(uint32_t i, common::InstrumentData &out) const {
+      if (i >= count())
+        return false;
+      return seccache::decode(record(i), blobPtr(), header_.stringsBytes, out);
+    }
+
+    // Decodifica todo en el formato de InstrumentRegistry::bulkUpsertFull.
+    std::vector<std::pair<common::InstrumentId, common::InstrumentData>> loadAll() const {
+      std::vector<std::pair<common::InstrumentId, common::InstrumentData>> out;
+      out.reserve(count());
+      common::InstrumentData d;
+      for (uint32_t i = 0; i < count(); ++i)
+        if (decode(i, d))
+          out.emplace_back(d.securityId, std::move(d));
+      return out;
+    }
+
+   private:
+    const char *blobPtr() const noexcept {
+      return reinterpret_cast<const char *>(map_ + header_.headerBytes +
+                                            static_cast<size_t>(header_.count) *
+                                                header_.recordBytes);
+    }
+
+    SecurityListCacheStatus validate(SecurityListCacheKey expected) noexcept {
+      std::memcpy(&header_, map_, sizeof(header_));
+      if (std::memcmp(header_.magic, SecurityListCacheHeader::kMagic, sizeof(header_.magic)) != 0 ||
+          header_.version != SecurityListCacheHeader::kVersion ||
+          header_.headerBytes != sizeof(SecurityListCacheHeader) ||
+          header_.recordBytes != sizeof(SecurityListCacheRecord))
+        return SecurityListCacheStatus::BadFormat;
+
+      if (header_.tradingDate != expected.tradingDate)
+        return SecurityListCacheStatus::WrongDate;
+      if (header_.channel != expected.channel)
+        return SecurityListCacheStatus::WrongChannel;
+
+      const uint64_t recordsBytes = static_cast<uint64_t>(header_.count) * header_.recordBytes;
+      if (header_.headerBytes + recordsBytes + header_.stringsBytes != size_)
+        return SecurityListCacheStatus::Corrupt;
+
+      const uint64_t sum = seccache::fnv1a(map_ + header_.headerBytes,
+                                           recordsBytes + header_.stringsBytes);
+      if (sum != header_.checksum)
+        return SecurityListCacheStatus::Corrupt;
+      return SecurityListCacheStatus::Loaded;
+    }
+
+    const unsigned char *map_{nullptr};
+    size_t size_{0};
+    SecurityListCacheHeader header_{};
+    SecurityListCacheStatus status_{SecurityListCacheStatus::Missing};
+  };
+
+  /**
+   * @brief Persiste el registry cuando el loop de SecurityDefinitions en vivo cierra.
+   *
+   * Thread propio de baja prioridad: espera `loopComplete` (B3InstrumentRegistryListener), toma
+   * snapshotAllFull() y escribe el cache. Después reescribe cuando cambia registry.version()
+   * (altas intradiarias), como mucho una vez por `minInterval`. El callback de OnixS nunca hace IO.
+   */
+  class SecurityListCacheSaver final {
+   public:
+    // Qué se persiste (default: el registry entero). Varios canales sobre un mismo registry:
+    // cada saver escribe solo los instrumentos de su canal.
+    using Source = std::function<std::vector<std::pair<common::InstrumentId, common::InstrumentData>>()>;
+
+    SecurityListCacheSaver(std::string path, SecurityListCacheKey key,
+                           const common::InstrumentRegistry &registry,
+                           const std::atomic<bool> &loopComplete,
+                           std::chrono::milliseconds minInterval = std::chrono::seconds(5))
+        : path_(std::move(path)), key_(key), registry_(registry), loopComplete_(loopComplete),
+          minInterval_(minInterval) {}
+
+    ~SecurityListCacheSaver() { stop(); }
+
+    SecurityListCacheSaver(const SecurityListCacheSaver &) = delete;
+    SecurityListCacheSaver &operator=(const SecurityListCacheSaver &) = delete;
+
+    // Llamar antes de start().
+    void setSource(Source source) { source_ = std::move(source); }
+
+    void start() {
+      bool expected = false;
+      if (!running_.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+        return;
+      thread_ = std::thread([this] { run(); });
+    }
+
+    void stop() {
+      running_.store(false, std::memory_order_release);
+      if (thread_.joinable())
+        thread_.join();
+    }
+
+    bool saved() const noexcept { return saves_.load(std::memory_order_acquire) > 0; }
+    uint32_t saves() const noexcept { return saves_.load(std::memory_order_acquire); }
+    uint32_t failures() const noexcept { return failures_.load(std::memory_order_relaxed); }
+    uint32_t savedCount() const noexcept { return savedCount_.load(std::memory_order_relaxed); }
+    const std::string &path() const noexcept { return path_; }
+
+   private:
+    void save(uint64_t version) noexcept {
+      try {
+        const auto items = source_ ? source_() : registry_.snapshotAllFull();
+        uint32_t written = 0;
+        if (writeSecurityListCache(path_, key_, items, &written)) {
+          savedVersion_ = version;
+          savedCount_.store(written, std::memory_order_relaxed);
+          saves_.fetch_add(1, std::memory_order_release);
+          return;
+        }
+      } catch (...) {
+      }
+      // Error de IO: se reintenta en el próximo intervalo
+      failures_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void run() noexcept {
+      using namespace std::chrono_literals;
+      auto nextSave = std::chrono::steady_clock::now();
+      while (running_.load(std::memory_order_acquire)) {
+        const auto now = std::chrono::steady_clock::now();
+        if (loopComplete_.load(std::memory_order_acquire) && now >= nextSave) {
+          // version leída antes del snapshot: un cambio concurrente fuerza otra escritura
+          const uint64_t version = registry_.version();
+          if (saves_.load(std::memory_order_relaxed) == 0 || version != savedVersion_) {
+            save(version);
+            nextSave = now + minInterval_;
+          }
+        }
+        std::this_thread::sleep_for(100ms);
+      }
+    }
+
+    const std::string path_;
+    const SecurityListCacheKey key_;
+    const common::InstrumentRegistry &registry_;
+    const std::atomic<bool> &loopComplete_;
+    const std::chrono::milliseconds minInterval_;
+    Source source_{};
+
+    std::atomic<bool> running_{false};
+    std::atomic<uint32_t> saves_{0};
+    std::atomic<uint32_t> failures_{0};
+    std::atomic<uint32_t> savedCount_{0};
+    uint64_t savedVersion_{0}; // solo el thread del saver
+    std::thread thread_{};
+  };
+
+} // namespace b3::md
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <b3/common/InstrumentRegistry.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace b3::md {
+
+  /**
+   * @brief Filtros de una consulta de security list. Campo vacío / 0 = sin filtro; los filtros se
+   *        combinan con AND.
+   */
+  struct SecurityListQuery {
+    std::string symbol;                     // exacto
+    std::string symbolPrefix;               // "PETR" -> PETR3, PETR4, PETRK300...
+    std::string marketSegmentId;
+    std::vector<std::string> securityTypes; // códigos B3 (InstrumentData::securityType), OR
+    std::string cfiCode;
+    std::string securityExchange;
+    uint64_t underlyingSecurityId{0};
+    uint32_t maturityFrom{0};               // inclusive (mismo formato que maturityDate)
+    uint32_t maturityTo{0};                 // inclusive; 0 = abierto
+
+    // Paginación sobre el resultado ordenado por símbolo
+    uint32_t offset{0};
+    uint32_t limit{0}; // 0 = sin límite
+
+    bool unfiltered() const noexcept {
+      return symbol.empty() && symbolPrefix.empty() && marketSegmentId.empty() &&
+             securityTypes.empty() && cfiCode.empty() && securityExchange.empty() &&
+             underlyingSecurityId == 0 && maturityFrom == 0 && maturityTo == 0;
+    }
+  };
+
+  struct SecurityListPage {
+    std::vector<uint32_t> rows; // filas de SecurityListIndex, en orden de símbolo
+    uint32_t total{0};          // matches antes de offset/limit
+    bool last{true};            // no quedan matches después de esta página
+  };
+
+  /**
+   * @brief Security list ordenada por símbolo con índices secundarios (segmento, tipo, subyacente,
+   *        vencimiento). Inmutable: se arma una vez por versión del registry y se comparte.
+   *
+   * Una consulta arranca del índice más selectivo que aplique (rango de prefijo, lista por
+   * segmento/tipo/subyacente o rango de vencimientos) y valida el resto de los filtros sólo sobre
+   * esos candidatos. Instrumentos sin símbolo no se indexan (tampoco salían en la lista).
+   */
+  class SecurityListIndex final {
+   public:
+    using Item = std::pair<b3::common::InstrumentId, b3::common::InstrumentData>;
+
+    SecurityListIndex() = default;
+
+    explicit SecurityListIndex(std::vector<Item> items) : items_(std::move(items)) {
+      std::erase_if(items_, [](const Item &it) { return it.second.symbol.empty(); });
+      std::sort(items_.begin(), items_.end(), [](const Item &a, const Item &b) {
+        return a.second.symbol < b.second.symbol;
+      });
+
+      for (uint32_t row = 0; row < items_.size(); ++row) {
+        const auto &d = items_[row].second;
+        if (!d.marketSegmentId.empty())
+          bySegment_[d.marketSegmentId].push_back(row);
+        if (!d.securityType.empty())
+          byType_[d.securityType].push_back(row);
+        if (d.underlyingSecurityId != 0)
+          byUnderlying_[d.underlyingSecurityId].push_back(row);
+        if (d.maturityDate != 0)
+          byMaturity_.push_back(row);
+      }
+      std::stable_sort(byMaturity_.begin(), byMaturity_.end(), [this](uint32_t a, uint32_t b) {
+        return items_[a].second.maturityDate < items_[b].second.maturityDate;
+      });
+    }
+
+    uint32_t size() const noexcept { return static_cast<uint32_t>(items_.size()); }
+    b3::common::InstrumentId id(uint32_t row) const noexcept { return items_[row].first; }
+    const b3::common::InstrumentData &data(uint32_t row) const noexcept {
+      return items_[row].second;
+    }
+
+    // Fila del símbolo exacto, o size() si no está.
+    uint32_t findSymbol(std::string_view symbol) const noexcept {
+      const auto [lo, hi] = prefixRange(symbol);
+      return (lo < hi && items_[lo].second.symbol == symbol) ? lo : size();
+    }
+
+    // Filas [first, second) cuyo símbolo empieza con `prefix`.
+    std::pair<uint32_t, uint32_t> prefixRange(std::string_view prefix) const noexcept {
+      const auto lo = std::lower_bound(
+          items_.begin(), items_.end(), prefix,
+          [](const Item &it, std::string_view p) { return std::string_view(it.second.symbol) < p; });
+      auto hi = lo;
+      while (hi != items_.end() && std::string_view(hi->second.symbol).starts_with(prefix))
+        ++hi;
+      return {static_cast<uint32_t>(lo - items_.begin()), static_cast<uint32_t>(hi - items_.begin())};
+    }
+
+    // Derivativos de un subyacente (filas en orden de símbolo).
+    const std::vector<uint32_t> &derivativesOf(uint64_t underlyingSecurityId) const noexcept {
+      auto it = byUnderlying_.find(underlyingSecurityId);
+      return it == byUnderlying_.end() ? kNone : it->second;
+    }
+
+    SecurityListPage select(const SecurityListQuery &q) const {
+      SecurityListPage page;
+      std::vector<uint32_t> matches;
+
+      const auto keep = [&](uint32_t row) {
+        if (matchesAll(items_[row].second, q))
+          matches.push_back(row);
+      };
+
+      // Candidatos: la fuente más chica entre los índices que aplican
+      uint32_t rangeLo = 0;
+      uint32_t rangeHi = size();
+      if (!q.symbol.empty()) {
+        rangeLo = findSymbol(q.symbol);
+        rangeHi = rangeLo < size() ? rangeLo + 1 : rangeLo;
+      } else if (!q.symbolPrefix.empty()) {
+        std::tie(rangeLo, rangeHi) = prefixRange(q.symbolPrefix);
+      }
+
+      const std::vector<uint32_t> *list = nullptr;
+      const auto consider = [&](const std::vector<uint32_t> &candidates) {
+        if (!list || candidates.size() < list->size())
+          list = &candidates;
+      };
+      if (!q.marketSegmentId.empty())
+        consider(lookup(bySegment_, q.marketSegmentId));
+      if (q.securityTypes.size() == 1)
+        consider(lookup(byType_, q.securityTypes.front()));
+      if (q.underlyingSecurityId != 0)
+        consider(derivativesOf(q.underlyingSecurityId));
+
+      std::pair<uint32_t, uint32_t> maturity{0, 0};
+      const bool byMaturity = q.maturityFrom != 0 || q.maturityTo != 0;
+      if (byMaturity)
+        maturity = maturityRange(q.maturityFrom, q.maturityTo);
+
+      const size_t rangeSize = rangeHi - rangeLo;
+      const size_t listSize = list ? list->size() : SIZE_MAX;
+      const size_t maturitySize = byMaturity ? maturity.second - maturity.first : SIZE_MAX;
+
+      if (listSize <= rangeSize && listSize <= maturitySize) {
+        for (uint32_t row : *list)
+          keep(row);
+      } else if (maturitySize < rangeSize) {
+        for (uint32_t i = maturity.first; i < maturity.second; ++i)
+          keep(byMaturity_[i]);
+        std::sort(matches.begin(), matches.end()); // vuelve a orden de símbolo
+      } else {
+        for (uint32_t row = rangeLo; row < rangeHi; ++row)
+          keep(row);
+      }
+
+      page.total = static_cast<uint32_t>(matches.size());
+      const uint32_t first = std::min(q.offset, page.total);
+      const uint32_t count =
+          q.limit == 0 ? page.total - first : std::min(q.limit, page.total - first);
+      page.rows.assign(matches.begin() + first, matches.begin() + first + count);
+      page.last = first + count >= page.total;
+      return page;
+    }
+
+   private:
+    using RowMap =
+        std::unordered_map<std::string, std::vector<uint32_t>, b3::common::StringHash,
+                           b3::common::StringEqual>;
+
+    inline static const std::vector<uint32_t> kNone{};
+
+    static const std::vector<uint32_t> &lookup(const RowMap &map, std::string_view key) {
+      auto it = map.find(key);
+      return it == map.end() ? kNone : it->second;
+    }
+
+    static bool matchesAll(const b3::common::InstrumentData &d, const SecurityListQuery &q) {
+      if (!q.symbol.empty() && d.symbol != q.symbol)
+        return false;
+      if (!q.symbolPrefix.empty() && !std::string_view(d.symbol).starts_with(q.symbolPrefix))
+        return false;
+      if (!q.marketSegmentId.empty() && d.marketSegmentId != q.marketSegmentId)
+        return false;
+      if (!q.securityTypes.empty() &&
+          std::find(q.securityTypes.begin(), q.securityTypes.end(), d.securityType) ==
+              q.securityTypes.end())
+        return false;
+      if (!q.cfiCode.empty() && d.cfiCode != q.cfiCode)
+        return false;
+      if (!q.securityExchange.empty() && d.securityExchange != q.securityExchange)
+        return false;
+      if (q.underlyingSecurityId != 0 && d.underlyingSecurityId != q.underlyingSecurityId)
+        return false;
+      if (q.maturityFrom != 0 || q.maturityTo != 0) {
+        if (d.maturityDate == 0 || d.maturityDate < q.maturityFrom)
+          return false;
+        if (q.maturityTo != 0 && d.maturityDate > q.maturityTo)
+          return false;
+      }
+      return true;
+    }
+
+    // Posiciones [first, second) en byMaturity_ con vencimiento en [from, to]
+    std::pair<uint32_t, uint32_t> maturityRange(uint32_t from, uint32_t to) const {
+      const auto mat = [this](uint32_t row) { return items_[row].second.maturityDate; };
+      const auto lo = std::lower_bound(byMaturity_.begin(), byMaturity_.end(), from,
+                                       [&](uint32_t row, uint32_t v) { return mat(row) < v; });
+      const auto hi =
+          to == 0 ? byMaturity_.end()
+                  : std::upper_bound(lo, byMaturity_.end(), to,
+                                     [&](uint32_t v, uint32_t row) { return v < mat(row); });
+      return {static_cast<uint32_t>(lo - byMaturity_.begin()),
+              static_cast<uint32_t>(hi - byMaturity_.begin())};
+    }
+
+    std::vector<Item> items_;
+    RowMap bySegment_;
+    RowMap byType_;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> byUnderlying_;
+    std::vector<uint32_t> byMaturity_; // filas con vencimiento, ordenadas por maturityDate
+  };
+
+} // namespace b3::md
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+namespace b3::md {
+
+  // Tabla de ruteo instrumento -> shard que pisa el hash de Knuth (instrumentos movidos por
+  // el rebalancer). Lock-free para lectura desde producers y workers.
+  //
+  // Escritores: el rebalancer (alta/cambio de ruta) y el worker destino (completeHandoff).
+  // Las entradas no se borran: devolver un instrumento a su shard "natural" es otra ruta más.
+  //
+  // Handoff: route() deja fromShard = shard anterior. Hasta que el worker destino confirme que
+  // el origen publicó todo lo previo (completeHandoff), la entrada queda "pendiente". El destino
+  // lo confirma desde su loop aunque el instrumento no tenga eventos nuevos (ver MdPublishWorker).
+  class ShardOverrideTable final {
+   public:
+    static constexpr uint32_t kNoShard = UINT32_MAX;
+    static constexpr uint32_t kMaxProbes = 32;
+
+    explicit ShardOverrideTable(uint32_t capacityPow2 = 1024)
+        : mask_(capacityPow2 - 1), entries_(std::make_unique<Entry[]>(capacityPow2)) {
+      if (capacityPow2 < 2 || (capacityPow2 & (capacityPow2 - 1)) != 0)
+        throw std::invalid_argument("ShardOverrideTable: capacity must be a power of two");
+    }
+
+    ShardOverrideTable(const ShardOverrideTable &) = delete;
+    ShardOverrideTable &operator=(const ShardOverrideTable &) = delete;
+
+    // Hot path: true si hay override (shard = destino actual).
+    bool lookup(uint64_t instrumentId, uint32_t &shard) const noexcept {
+      const Entry *e = find(instrumentId);
+      if (!e)
+        return false;
+      shard = e->shard.load(std::memory_order_acquire);
+      return true;
+    }
+
+    // Worker destino: true si el instrumento está ruteado a `me` con handoff pendiente.
+    bool pendingHandoff(uint64_t instrumentId, uint32_t me, uint32_t &fromShard) const noexcept {
+      const Entry *e = find(instrumentId);
+      if (!e || e->shard.load(std::memory_order_acquire) != me)
+        return false;
+      fromShard = e->fromShard.load(std::memory_order_acquire);
+      return fromShard != kNoShard;
+    }
+
+    // Rebalancer: cambia la ruta. false si la tabla está llena.
+    bool route(uint64_t instrumentId, uint32_t toShard, uint32_t fromShard) noexcept {
+      Entry *e = findOrInsertSlot(instrumentId);
+      if (!e)
+        return false;
+
+      pending_.fetch_add(1, std::memory_order_relaxed);
+      // fromShard antes que shard: quien vea la ruta nueva (acquire) ve también el origen.
+      e->fromShard.store(fromShard, std::memory_order_release);
+      e->shard.store(toShard, std::memory_order_release);
+
+      if (e->iid.load(std::memory_order_relaxed) != instrumentId) {
+        e->iid.store(instrumentId, std::memory_order_release); // publica la entrada nueva
+        size_.fetch_add(1, std::memory_order_release);
+      }
+      return true;
+    }
+
+    // Worker destino: el origen ya drenó todo lo previo a la ruta nueva.
+    void completeHandoff(uint64_t instrumentId) noexcept {
+      Entry *e = const_cast<Entry *>(find(instrumentId));
+      if (e && e->fromShard.exchange(kNoShard, std::memory_order_acq_rel) != kNoShard)
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    uint32_t size() const noexcept { return size_.load(std::memory_order_acquire); }
+    uint32_t pendingHandoffs() const noexcept { return pending_.load(std::memory_order_relaxed); }
+
+   private:
+    static constexpr uint64_t kKnuth = 11400714819323198485ull;
+
+    struct Entry {
+      std::atomic<uint64_t> iid{0};
+      std::atomic<uint32_t> shard{0};
+      std::atomic<uint32_t> fromShard{kNoShard};
+    };
+
+    uint32_t home(uint64_t instrumentId) const noexcept {
+      return static_cast<uint32_t>((instrumentId * kKnuth) >> 32) & mask_;
+    }
+
+    const Entry *find(uint64_t instrumentId) const noexcept {
+      uint32_t i = home(instrumentId);
+      for (uint32_t p = 0; p < kMaxProbes; ++p, i = (i + 1) & mask_) {
+        const uint64_t key = entries_[i].iid.load(std::memory_order_acquire);
+        if (key == instrumentId)
+          return &entries_[i];
+        if (key == 0)
+          return nullptr;
+      }
+      return nullptr;
+    }
+
+    // Single writer (rebalancer): slot existente o primer slot libre de la secuencia de probing.
+    Entry *findOrInsertSlot(uint64_t instrumentId) noexcept {
+      if (instrumentId == 0)
+        return nullptr;
+      uint32_t i = home(instrumentId);
+      for (uint32_t p = 0; p < kMaxProbes; ++p, i = (i + 1) & mask_) {
+        const uint64_t key = entries_[i].iid.load(std::memory_order_relaxed);
+        if (key == instrumentId || key == 0)
+          return &entries_[i];
+      }
+      return nullptr;
+    }
+
+   private:
+    const uint32_t mask_;
+    std::unique_ptr<Entry[]> entries_;
+    std::atomic<uint32_t> size_{0};
+    std::atomic<uint32_t> pending_{0};
+  };
+
+} // namespace b3::md
@@ -0,0 +1,211 @@
+#pragma once
+
+#include "MdPublishPipeline.hpp"
+
+#include "../telemetry/LogEvent.hpp"
+#include "../telemetry/SpdlogLogPublisher.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace b3::md {
+
+  struct RebalanceConfig {
+    uint32_t intervalMs{1000};     // período de muestreo de tasas
+    double imbalanceRatio{1.5};    // mover solo si load(max) > ratio * load(min)
+    uint64_t minEventsPerSec{2000}; // por debajo de esto en el shard más cargado, no hacer nada
+    uint32_t cooldownIntervals{2}; // intervalos a esperar después de un handoff completo
+  };
+
+  /**
+   * @brief Rebalanceo de instrumentos calientes entre shards (thread propio, fuera del hot path).
+   *
+   * Cada intervalo lee los InstrumentRateTracker de los workers, calcula la tasa por instrumento
+   * y la carga por shard. Si el shard más cargado supera `imbalanceRatio` veces al menos cargado,
+   * mueve UN instrumento (el que más achica la diferencia sin invertirla) vía
+   * MdPublishPipeline::moveInstrument(). Un solo handoff en curso a la vez.
+   */
+  class ShardRebalancer final {
+   public:
+    static constexpr size_t kLogQueueCapacity = 1024;
+
+    struct Move {
+      uint64_t instrumentId{0};
+      uint32_t from{0};
+      uint32_t to{0};
+      uint64_t rate{0}; // eventos por intervalo
+    };
+
+    ShardRebalancer(MdPublishPipeline &pipeline, RebalanceConfig cfg)
+        : pipeline_(pipeline), cfg_(cfg), prev_(pipeline.shardCount()),
+          rates_(pipeline.shardCount()), load_(pipeline.shardCount(), 0) {}
+
+    ShardRebalancer(const ShardRebalancer &) = delete;
+    ShardRebalancer &operator=(const ShardRebalancer &) = delete;
+
+    ~ShardRebalancer() { stop(); }
+
+    void start() {
+      bool expected = false;
+      if (!running_.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+        return;
+      logger_.start();
+      thread_ = std::thread([this] { run(); });
+    }
+
+    void stop() {
+      {
+        std::lock_guard<std::mutex> g(m_);
+        running_.store(false, std::memory_order_release);
+      }
+      cv_.notify_all();
+      if (thread_.joinable())
+        thread_.join();
+      logger_.stop();
+    }
+
+    uint64_t moves() const noexcept { return moves_.load(std::memory_order_relaxed); }
+
+    // Decisión pura: shard más / menos cargado y el candidato del más cargado que minimiza
+    // max(load) después del movimiento (rate < gap, lo más cerca posible de gap/2).
+    static bool planMove(const std::vector<uint64_t> &shardLoad,
+                         const std::vector<std::vector<std::pair<uint64_t, uint64_t>>> &ratesByShard,
+                         double imbalanceRatio, uint64_t minLoad, Move &out) noexcept {
+      if (shardLoad.size() < 2)
+        return false;
+
+      uint32_t maxS = 0, minS = 0;
+      for (uint32_t s = 1; s < shardLoad.size(); ++s) {
+        if (shardLoad[s] > shardLoad[maxS])
+          maxS = s;
+        if (shardLoad[s] < shardLoad[minS])
+          minS = s;
+      }
+
+      const uint64_t hi = shardLoad[maxS];
+      const uint64_t lo = shardLoad[minS];
+      if (maxS == minS || hi < minLoad || static_cast<double>(hi) <= imbalanceRatio * static_cast<double>(lo))
+        return false;
+
+      const uint64_t gap = hi - lo;
+      uint64_t bestScore = 0;
+      bool found = false;
+      for (const auto &[iid, rate] : ratesByShard[maxS]) {
+        if (rate == 0 || rate >= gap)
+          continue;
+        const uint64_t score = std::min(rate, gap - rate);
+        if (!found || score > bestScore) {
+          found = true;
+          bestScore = score;
+          out = Move{iid, maxS, minS, rate};
+        }
+      }
+      return found;
+    }
+
+    // Un muestreo + (eventualmente) un movimiento. Público para tests (sin thread).
+    bool step() {
+      const uint32_t shards = pipeline_.shardCount();
+      for (uint32_t s = 0; s < shards; ++s) {
+        rates_[s].clear();
+        uint64_t load = 0;
+        auto &prev = prev_[s];
+        pipeline_.worker(s).rates().forEach([&](uint64_t iid, uint64_t count) {
+          uint64_t &last = prev[iid];
+          const uint64_t delta = count - last;
+          last = count;
+          if (delta) {
+            rates_[s].emplace_back(iid, delta);
+            load += delta;
+          }
+        });
+        load_[s] = load;
+      }
+
+      if (pipeline_.handoffPending()) {
+        cooldown_ = cfg_.cooldownIntervals;
+        return false;
+      }
+      if (cooldown_ > 0) {
+        --cooldown_;
+        return false;
+      }
+
+      const uint64_t minLoad = cfg_.minEventsPerSec * cfg_.intervalMs / 1000;
+      Move mv{};
+      if (!planMove(load_, rates_, cfg_.imbalanceRatio, minLoad, mv))
+        return false;
+      if (!pipeline_.moveInstrument(mv.instrumentId, mv.to))
+        return false;
+
+      moves_.fetch_add(1, std::memory_order_relaxed);
+      cooldown_ = cfg_.cooldownIntervals;
+      logMove(mv);
+      return true;
+    }
+
+   private:
+    static uint64_t nowNsSystem() noexcept {
+      const auto now = std::chrono::system_clock::now().time_since_epoch();
+      return static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+    }
+
+    void logMove(const Move &mv) noexcept {
+      telemetry::LogEvent e{};
+      e.tsNs = nowNsSystem();
+      e.level = telemetry::LogLevel::Info;
+      e.component = telemetry::Component::Pipeline;
+      e.code = telemetry::Code::ShardRebalanced;
+      e.instrumentId = mv.instrumentId;
+      e.shard = static_cast<uint16_t>(mv.to);
+      e.arg0 = mv.from;
+      e.arg1 = mv.rate;
+      (void)logger_.try_publish(e);
+    }
+
+    void run() noexcept {
+      try {
+        std::unique_lock<std::mutex> lk(m_);
+        while (running_.load(std::memory_order_acquire)) {
+          cv_.wait_for(lk, std::chrono::milliseconds(cfg_.intervalMs),
+                       [this] { return !running_.load(std::memory_order_acquire); });
+          if (!running_.load(std::memory_order_acquire))
+            break;
+          lk.unlock();
+          (void)step();
+          lk.lock();
+        }
+      } catch (...) {
+        // noexcept: swallow (bad_alloc en los mapas de muestreo)
+      }
+    }
+
+   private:
+    MdPublishPipeline &pipeline_;
+    const RebalanceConfig cfg_;
+
+    // Estado del thread del rebalancer (o del test que llama step())
+    std::vector<std::unordered_map<uint64_t, uint64_t>> prev_;
+    std::vector<std::vector<std::pair<uint64_t, uint64_t>>> rates_;
+    std::vector<uint64_t> load_;
+    uint32_t cooldown_{0};
+
+    std::atomic<uint64_t> moves_{0};
+
+    telemetry::SpdlogLogPublisher<kLogQueueCapacity> logger_;
+    std::atomic<bool> running_{false};
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::thread thread_{};
+  };
+
+} // namespace b3::md
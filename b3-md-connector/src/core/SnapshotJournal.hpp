@@ -0,0 +1,434 @@
+#pragma once
+
+#include "IngressLane.hpp"
+#include "OrdersSnapshot.hpp"
+#include "QueueMemory.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace b3::md {
+
+  /**
+   * @brief Journal de captura de OrdersSnapshot (formato en disco + writer + reader).
+   *
+   * Formato (little endian, todo alineado a 8 bytes):
+   *   JournalFileHeader (64B)
+   *   { JournalRecordHeader (16B) | JournalSnapshotHead (48B) | bids[bidsCopied] | asks[asksCopied] }*
+   *
+   * Encoding "prefix-only": de los arrays K=256 solo se escriben las entradas copiadas, así un
+   * libro típico ocupa cientos de bytes en vez de los ~8KB del struct. Un record con
+   * `bytes == 0` (cola del archivo no escrita) o que no entra en el archivo termina la lectura.
+   */
+  struct JournalFileHeader {
+    static constexpr char kMagic[8] = {'B', '3', 'M', 'D', 'J', 'N', 'L', '1'};
+    static constexpr uint32_t kVersion = 1;
+
+    char magic[8]{};
+    uint32_t version{0};
+    uint32_t headerBytes{0};
+    uint64_t createdNs{0};
+    uint64_t reserved[5]{};
+  };
+  static_assert(sizeof(JournalFileHeader) == 64);
+
+  struct JournalRecordHeader {
+    uint32_t bytes{0};    // payload (head + entries), sin este header
+    uint32_t reserved{0};
+    uint64_t captureNs{0}; // reloj de sistema al aceptar el snapshot (pace del replay)
+  };
+  static_assert(sizeof(JournalRecordHeader) == 16);
+
+  struct JournalSnapshotHead {
+    uint64_t instrumentId{0};
+    uint64_t exchangeTsNs{0};
+    uint64_t rptSeq{0};
+    uint64_t channelSeq{0};
+    uint16_t bidCountRaw{0};
+    uint16_t askCountRaw{0};
+    uint16_t bidsCopied{0};
+    uint16_t asksCopied{0};
+    uint8_t bidTruncated{0};
+    uint8_t askTruncated{0};
+    uint8_t flags{0}; // OrdersSnapshot::flags (era padding: journals viejos leen 0)
+    uint8_t pad[5]{};
+  };
+  static_assert(sizeof(JournalSnapshotHead) == 48);
+
+  namespace journal {
+
+    using Entry = OrdersSnapshot::OrderEntry;
+
+    inline size_t encodedSize(const OrdersSnapshot &s) noexcept {
+      return sizeof(JournalSnapshotHead) + (size_t{s.bidsCopied} + s.asksCopied) * sizeof(Entry);
+    }
+
+    // dst debe tener encodedSize(s) bytes. Devuelve los bytes escritos.
+    inline size_t encode(const OrdersSnapshot &s, unsigned char *dst) noexcept {
+      JournalSnapshotHead h{};
+      h.instrumentId = s.instrumentId;
+      h.exchangeTsNs = s.exchangeTsNs;
+      h.rptSeq = s.rptSeq;
+      h.channelSeq = s.channelSeq;
+      h.bidCountRaw = s.bidCountRaw;
+      h.askCountRaw = s.askCountRaw;
+      h.bidsCopied = s.bidsCopied;
+      h.asksCopied = s.asksCopied;
+      h.bidTruncated = s.bidTruncated;
+      h.askTruncated = s.askTruncated;
+      h.flags = s.flags;
+
+      std::memcpy(dst, &h, sizeof(h));
+      size_t off = sizeof(h);
+      std::memcpy(dst + off, s.bids, size_t{s.bidsCopied} * sizeof(Entry));
+      off += size_t{s.bidsCopied} * sizeof(Entry);
+      std::memcpy(dst + off, s.asks, size_t{s.asksCopied} * sizeof(Entry));
+      off += size_t{s.asksCopied} * sizeof(Entry);
+      return off;
+    }
+
+    // false si el payload está truncado o es inconsistente. Las entradas fuera del prefijo
+    // quedan en cero (igual que un snapshot recién construido).
+    inline bool decode(const unsigned char *src, size_t len, OrdersSnapshot &out) noexcept {
+      if (len < sizeof(JournalSnapshotHead))
+        return false;
+
+      JournalSnapshotHead h{};
+      std::memcpy(&h, src, sizeof(h));
+      if (h.bidsCopied > OrdersSnapshot::K || h.asksCopied > OrdersSnapshot::K)
+        return false;
+      if (len != sizeof(h) + (size_t{h.bidsCopied} + h.asksCopied) * sizeof(Entry))
+        return false;
+
+      // Solo resetea el prefijo que ensucia el snapshot anterior (out se reusa en el replay)
+      const size_t oldBids = out.bidsCopied <= OrdersSnapshot::K ? out.bidsCopied : OrdersSnapshot::K;
+      const size_t oldAsks = out.asksCopied <= OrdersSnapshot::K ? out.asksCopied : OrdersSnapshot::K;
+
+      out.instrumentId = h.instrumentId;
+      out.exchangeTsNs = h.exchangeTsNs;
+      out.rptSeq = h.rptSeq;
+      out.channelSeq = h.channelSeq;
+      out.bidCountRaw = h.bidCountRaw;
+      out.askCountRaw = h.askCountRaw;
+      out.bidsCopied = h.bidsCopied;
+      out.asksCopied = h.asksCopied;
+      out.bidTruncated = h.bidTruncated;
+      out.askTruncated = h.askTruncated;
+      out.flags = h.flags;
+
+      size_t off = sizeof(h);
+      std::memcpy(out.bids, src + off, size_t{h.bidsCopied} * sizeof(Entry));
+      off += size_t{h.bidsCopied} * sizeof(Entry);
+      std::memcpy(out.asks, src + off, size_t{h.asksCopied} * sizeof(Entry));
+
+      for (size_t i = h.bidsCopied; i < oldBids; ++i) out.bids[i] = Entry{};
+      for (size_t i = h.asksCopied; i < oldAsks; ++i) out.asks[i] = Entry{};
+      return true;
+    }
+
+    inline size_t align8(size_t n) noexcept { return (n + 7u) & ~size_t{7}; }
+
+    inline uint64_t nowNsSystem() noexcept {
+      const auto now = std::chrono::system_clock::now().time_since_epoch();
+      return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+    }
+
+  } // namespace journal
+
+  struct JournalConfig {
+    std::string path;
+    uint32_t lanes{1};                   // = lanes de ingreso del pipeline (feed threads)
+    QueueConfig queue{1024, false};      // por lane, slots de ~8KB
+    size_t growBytes{256u * 1024u * 1024u}; // el archivo crece (ftruncate + mremap) de a este tamaño
+  };
+
+  /**
+   * @brief Writer del journal: el hot path solo copia el snapshot en una SPSC por lane;
+   *        un thread de background codifica y escribe en el archivo mapeado.
+   *
+   * - tryAppend(): no bloquea, no aloca. Cola llena => drop + counter (el journal NUNCA frena
+   *   el feed). Thread sin lane (más feed threads que lanes) => drop.
+   * - Con varias lanes cada slot lleva un ticket global y el writer mergea por ticket: el orden
+   *   del archivo es el orden de aceptación (FIFO por instrumento intacto).
+   * - stop(): drena, trunca el archivo al tamaño escrito y cierra. Idempotente.
+   */
+  class SnapshotJournalWriter final {
+   public:
+    explicit SnapshotJournalWriter(JournalConfig cfg) : cfg_(std::move(cfg)) {
+      if (cfg_.path.empty())
+        throw std::invalid_argument("SnapshotJournalWriter: empty path");
+      if (cfg_.lanes == 0)
+        cfg_.lanes = 1;
+      if (cfg_.growBytes < kMinGrowBytes)
+        cfg_.growBytes = kMinGrowBytes;
+      lanes_ = std::make_unique<Lanes>(cfg_.lanes, cfg_.queue);
+    }
+
+    SnapshotJournalWriter(const SnapshotJournalWriter &) = delete;
+    SnapshotJournalWriter &operator=(const SnapshotJournalWriter &) = delete;
+
+    ~SnapshotJournalWriter() { stop(); }
+
+    // Abre/crea el archivo (lo trunca) y arranca el writer. Lanza si no puede abrir/mapear.
+    void start() {
+      bool expected = false;
+      if (!running_.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+        return;
+
+      try {
+        openFile();
+      } catch (...) {
+        running_.store(false, std::memory_order_release);
+        throw;
+      }
+
+      touched_.store(false, std::memory_order_release);
+      thread_ = std::thread([this] { run(); });
+      while (!touched_.load(std::memory_order_acquire)) std::this_thread::yield();
+    }
+
+    void stop() noexcept {
+      running_.store(false, std::memory_order_release);
+      if (thread_.joinable())
+        thread_.join();
+      closeFile();
+    }
+
+    // Hot path (feed thread, lane = tlsIngressLane)
+    bool tryAppend(const OrdersSnapshot &s, uint64_t captureNs) noexcept {
+      const IngressPush r = lanes_->tryPushWith(tlsIngressLane, [&](Entry &e) noexcept {
+        e.captureNs = captureNs;
+        e.snapshot = s;
+      });
+      if (r != IngressPush::Ok) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      accepted_.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+
+    const std::string &path() const noexcept { return cfg_.path; }
+    uint64_t accepted() const noexcept { return accepted_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t written() const noexcept { return written_.load(std::memory_order_relaxed); }
+    uint64_t writeErrors() const noexcept { return writeErrors_.load(std::memory_order_relaxed); }
+    uint64_t bytesWritten() const noexcept { return bytesWritten_.load(std::memory_order_relaxed); }
+
+    size_t queueMemoryBytes() const noexcept { return lanes_->memoryBytes(); }
+
+   private:
+    struct Entry {
+      uint64_t captureNs{0};
+      OrdersSnapshot snapshot{};
+    };
+
+    using Lanes = IngressLaneSet<Entry, 1024>;
+
+    static constexpr size_t kMinGrowBytes = 1u * 1024u * 1024u; // >> un record máximo (~8KB)
+
+    void openFile() {
+      fd_ = ::open(cfg_.path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+      if (fd_ < 0)
+        throw std::runtime_error("SnapshotJournalWriter: cannot open " + cfg_.path);
+
+      if (!remap(cfg_.growBytes)) {
+        ::close(fd_);
+        fd_ = -1;
+        throw std::runtime_error("SnapshotJournalWriter: cannot map " + cfg_.path);
+      }
+
+      JournalFileHeader h{};
+      std::memcpy(h.magic, JournalFileHeader::kMagic, sizeof(h.magic));
+      h.version = JournalFileHeader::kVersion;
+      h.headerBytes = sizeof(JournalFileHeader);
+      h.createdNs = journal::nowNsSystem();
+      std::memcpy(map_, &h, sizeof(h));
+      offset_ = sizeof(h);
+    }
+
+    // Crece el archivo y el mapping a newSize (el contenido ya escrito se conserva).
+    bool remap(size_t newSize) noexcept {
+      if (::ftruncate(fd_, static_cast<off_t>(newSize)) != 0)
+        return false;
+
+      void *p = map_ ? ::mremap(map_, mapSize_, newSize, MREMAP_MAYMOVE)
+                     : ::mmap(nullptr, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+      if (p == MAP_FAILED)
+        return false;
+
+      map_ = static_cast<unsigned char *>(p);
+      mapSize_ = newSize;
+      return true;
+    }
+
+    void closeFile() noexcept {
+      if (fd_ < 0)
+        return;
+      if (map_) {
+        ::munmap(map_, mapSize_);
+        map_ = nullptr;
+        mapSize_ = 0;
+      }
+      (void)::ftruncate(fd_, static_cast<off_t>(offset_));
+      ::close(fd_);
+      fd_ = -1;
+    }
+
+    void writeOne(const Entry &slot) noexcept {
+      const size_t payload = journal::encodedSize(slot.snapshot);
+      const size_t total = journal::align8(sizeof(JournalRecordHeader) + payload);
+
+      if (offset_ + total > mapSize_ && !remap(mapSize_ + cfg_.growBytes)) {
+        writeErrors_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+
+      unsigned char *dst = map_ + offset_;
+      journal::encode(slot.snapshot, dst + sizeof(JournalRecordHeader));
+
+      // Header al final: un lector concurrente / un crash ve bytes==0 hasta acá
+      JournalRecordHeader rh{};
+      rh.bytes = static_cast<uint32_t>(payload);
+      rh.captureNs = slot.captureNs;
+      std::memcpy(dst, &rh, sizeof(rh));
+
+      offset_ += total;
+      written_.fetch_add(1, std::memory_order_relaxed);
+      bytesWritten_.store(offset_, std::memory_order_relaxed);
+    }
+
+    void run() noexcept {
+      using namespace std::chrono_literals;
+
+      lanes_->firstTouch();
+      touched_.store(true, std::memory_order_release);
+
+      while (running_.load(std::memory_order_acquire) || lanes_->queuedApprox() > 0) {
+        bool didWork = false;
+        for (int lane = lanes_->pick(); lane >= 0; lane = lanes_->pick()) {
+          didWork = true;
+          writeOne(lanes_->front(lane));
+          lanes_->pop(lane);
+        }
+        if (!didWork)
+          std::this_thread::sleep_for(1ms);
+      }
+    }
+
+   private:
+    JournalConfig cfg_;
+    std::unique_ptr<Lanes> lanes_;
+
+    int fd_{-1};
+    unsigned char *map_{nullptr};
+    size_t mapSize_{0};
+    size_t offset_{0};
+
+    std::atomic<bool> running_{false};
+    std::atomic<bool> touched_{false};
+    std::thread thread_{};
+
+    std::atomic<uint64_t> accepted_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> writeErrors_{0};
+    std::atomic<uint64_t> bytesWritten_{0};
+  };
+
+  /**
+   * @brief Lectura secuencial de un journal (mmap read-only). Lanza si el archivo no existe
+   *        o el header no es válido; un record truncado al final solo termina la iteración.
+   */
+  class SnapshotJournalReader final {
+   public:
+    explicit SnapshotJournalReader(const std::string &path) {
+      const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0)
+        throw std::runtime_error("SnapshotJournalReader: cannot open " + path);
+
+      struct stat st {};
+      if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(JournalFileHeader)) {
+        ::close(fd);
+        throw std::runtime_error("SnapshotJournalReader: not a journal: " + path);
+      }
+      size_ = static_cast<size_t>(st.st_size);
+
+      void *p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      ::close(fd);
+      if (p == MAP_FAILED)
+        throw std::runtime_error("SnapshotJournalReader: cannot map " + path);
+      map_ = static_cast<const unsigned char *>(p);
+      (void)::madvise(const_cast<unsigned char *>(map_), size_, MADV_SEQUENTIAL);
+
+      std::memcpy(&header_, map_, sizeof(header_));
+      if (std::memcmp(header_.magic, JournalFileHeader::kMagic, sizeof(header_.magic)) != 0 ||
+          header_.version != JournalFileHeader::kVersion ||
+          header_.headerBytes < sizeof(JournalFileHeader) || header_.headerBytes > size_) {
+        ::munmap(const_cast<unsigned char *>(map_), size_);
+        throw std::runtime_error("SnapshotJournalReader: bad header: " + path);
+      }
+      rewind();
+    }
+
+    SnapshotJournalReader(const SnapshotJournalReader &) = delete;
+    SnapshotJournalReader &operator=(const SnapshotJournalReader &) = delete;
+
+    ~SnapshotJournalReader() {
+      if (map_)
+        ::munmap(const_cast<unsigned char *>(map_), size_);
+    }
+
+    void rewind() noexcept {
+      offset_ = header_.headerBytes;
+      truncated_ = false;
+    }
+
+    // Siguiente snapshot; false al final (o en un record truncado/corrupto: ver truncated()).
+    bool next(OrdersSnapshot &out, uint64_t &captureNs) noexcept {
+      if (offset_ + sizeof(JournalRecordHeader) > size_)
+        return false;
+
+      JournalRecordHeader rh{};
+      std::memcpy(&rh, map_ + offset_, sizeof(rh));
+      if (rh.bytes == 0)
+        return false;
+
+      const size_t total = journal::align8(sizeof(rh) + rh.bytes);
+      if (offset_ + sizeof(rh) + rh.bytes > size_ ||
+          !journal::decode(map_ + offset_ + sizeof(rh), rh.bytes, out)) {
+        truncated_ = true;
+        return false;
+      }
+
+      captureNs = rh.captureNs;
+      offset_ += total;
+      return true;
+    }
+
+    const JournalFileHeader &header() const noexcept { return header_; }
+    size_t fileBytes() const noexcept { return size_; }
+    bool truncated() const noexcept { return truncated_; }
+
+   private:
+    const unsigned char *map_{nullptr};
+    size_t size_{0};
+    size_t offset_{0};
+    bool truncated_{false};
+    JournalFileHeader header_{};
+  };
+
+} // namespace b3::md
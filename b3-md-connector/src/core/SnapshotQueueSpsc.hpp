@@ -1,30 +1,68 @@
 #pragma once
+#include "QueueMemory.hpp"
+
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
-#include <memory>
+#include <stdexcept>
+#include <type_traits>
 
 namespace b3::md {
 
 // FIFO SPSC ring buffer.
 // Producer: 1 thread (pipeline/callback)
 // Consumer: 1 thread (worker)
+//
+// Capacidad: CapacityPow2 por default, o runtime (config) vía el ctor explícito.
+// Storage: QueueMemory (mmap, hugepages opcionales). T trivially copyable: el ring es memoria
+// zero-filled y los slots se escriben por copia, nunca se construyen/destruyen.
 template <typename T, size_t CapacityPow2>
 class SnapshotQueueSpsc {
     static_assert((CapacityPow2 & (CapacityPow2 - 1)) == 0, "Capacity must be power of two");
+    static_assert(std::is_trivially_copyable_v<T>);
+    static_assert(std::is_trivially_destructible_v<T>);
 
 public:
     SnapshotQueueSpsc()
-        : buffer_(std::make_unique<T[]>(CapacityPow2))
+        : SnapshotQueueSpsc(CapacityPow2)
     {}
 
+    // deferFirstTouch: el consumer llama firstTouch() desde su thread antes de arrancar
+    // (fault de páginas en startup y en el nodo NUMA del consumer). Si no, se toca acá.
+    explicit SnapshotQueueSpsc(size_t capacityPow2, bool hugePages = false, bool deferFirstTouch = false)
+        : capacity_(checkedCapacity(capacityPow2)),
+          mask_(static_cast<uint32_t>(capacityPow2 - 1)),
+          memory_(capacityPow2 * sizeof(T), hugePages),
+          buffer_(static_cast<T*>(memory_.data()))
+    {
+        if (!deferFirstTouch) memory_.firstTouch();
+    }
+
+    SnapshotQueueSpsc(const SnapshotQueueSpsc&) = delete;
+    SnapshotQueueSpsc& operator=(const SnapshotQueueSpsc&) = delete;
+
+    void firstTouch() noexcept { memory_.firstTouch(); }
+
     bool try_push(const T& v) noexcept {
         const uint32_t t = tail_.load(std::memory_order_relaxed);
         const uint32_t h = head_.load(std::memory_order_acquire);
 
-        if ((t - h) >= CapacityPow2) return false; // full
+        if ((t - h) >= capacity_) return false; // full
+
+        buffer_[t & mask_] = v;
+        tail_.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Producer-only: escribe el elemento in-place (fill(T&)) para no copiar un temporal.
+    template <typename Fill>
+    bool try_push_with(Fill&& fill) noexcept {
+        const uint32_t t = tail_.load(std::memory_order_relaxed);
+        const uint32_t h = head_.load(std::memory_order_acquire);
+
+        if ((t - h) >= capacity_) return false; // full
 
-        buffer_[t & (CapacityPow2 - 1)] = v;
+        fill(buffer_[t & mask_]);
         tail_.store(t + 1, std::memory_order_release);
         return true;
     }
@@ -35,22 +73,59 @@ public:
 
         if (h == t) return false; // empty
 
-        out = buffer_[h & (CapacityPow2 - 1)];
+        out = buffer_[h & mask_];
         head_.store(h + 1, std::memory_order_release);
         return true;
     }
 
+    // Consumer-only: peek del head sin consumirlo (nullptr si vacía).
+    // El slot no se reusa hasta pop(), así que el puntero es estable hasta entonces.
+    const T* front() const noexcept {
+        const uint32_t h = head_.load(std::memory_order_relaxed);
+        const uint32_t t = tail_.load(std::memory_order_acquire);
+
+        if (h == t) return nullptr; // empty
+
+        return &buffer_[h & mask_];
+    }
+
+    // Consumer-only: descarta el head (precondición: front() != nullptr).
+    void pop() noexcept {
+        const uint32_t h = head_.load(std::memory_order_relaxed);
+        head_.store(h + 1, std::memory_order_release);
+    }
+
     uint32_t size_approx() const noexcept {
         const uint32_t h = head_.load(std::memory_order_acquire);
         const uint32_t t = tail_.load(std::memory_order_acquire);
         return t - h;
     }
 
+    // Posiciones monotónicas (con wrap de 32 bits): cuántos se pushearon / consumieron.
+    // Sirven de fence entre threads (handoff de instrumentos entre shards).
+    uint32_t pushedCount() const noexcept { return tail_.load(std::memory_order_acquire); }
+    uint32_t poppedCount() const noexcept { return head_.load(std::memory_order_acquire); }
+
+    uint32_t capacity() const noexcept { return capacity_; }
+    size_t memoryBytes() const noexcept { return memory_.mappedBytes(); }
+    QueueBacking backing() const noexcept { return memory_.backing(); }
+
+private:
+    static uint32_t checkedCapacity(size_t c) {
+        if (c < 2 || (c & (c - 1)) != 0 || c > (size_t{1} << 31)) {
+            throw std::invalid_argument("SnapshotQueueSpsc: capacity must be a power of two");
+        }
+        return static_cast<uint32_t>(c);
+    }
+
 private:
     alignas(64) std::atomic<uint32_t> head_{0};
     alignas(64) std::atomic<uint32_t> tail_{0};
 
-    std::unique_ptr<T[]> buffer_;
+    alignas(64) const uint32_t capacity_;
+    const uint32_t mask_;
+    QueueMemory memory_;
+    T* buffer_;
 };
 
 } // namespace b3::md
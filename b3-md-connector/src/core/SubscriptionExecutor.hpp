@@ -0,0 +1,220 @@
+#pragma once
+
+#include "IMarketDataHandler.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace b3::md {
+
+  /**
+   * @brief Ejecuta subscribe/unsubscribe del handler (OnixS) en un thread propio, fuera del
+   *        thread que recibe requests.
+   *
+   * El subscription server actualiza SubscriptionRegistry en el momento (el refcount decide qué
+   * transiciones 0<->1 hay que aplicar) y encola sólo esas transiciones. El thread drena todo lo
+   * pendiente de una vez y las coalesce por instrumento: para un mismo iid se alternan
+   * subscribe/unsubscribe, así que el neto es -1, 0 o +1 y un par sub+unsub que llega junto no
+   * toca el handler.
+   *
+   * Sin start() o después de stop() (tests, herramientas, shutdown) submit() aplica en el thread
+   * que llama.
+   *
+   * Si el handler tira, el iid no quedó aplicado: se cuenta en failures() y se avisa al callback
+   * (el server deshace el refcount y lo loguea). En modo inline submit() además devuelve esos
+   * iids, para que la respuesta no diga ok por algo que no se aplicó.
+   */
+  class SubscriptionExecutor final {
+   public:
+    // iid, true = subscribe / false = unsubscribe, mensaje de la excepción
+    using FailureFn = std::function<void(uint64_t, bool, const char *)>;
+
+    explicit SubscriptionExecutor(IMarketDataHandler &handler) : handler_(handler) {}
+
+    // Llamar antes del primer submit(). Corre en el thread que aplica (executor o el que llama
+    // submit).
+    void setFailureCallback(FailureFn fn) { onFailure_ = std::move(fn); }
+
+    ~SubscriptionExecutor() { stop(); }
+
+    SubscriptionExecutor(const SubscriptionExecutor &) = delete;
+    SubscriptionExecutor &operator=(const SubscriptionExecutor &) = delete;
+
+    void start() {
+      bool expected = false;
+      if (!running_.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+        return;
+      {
+        std::lock_guard<std::mutex> g(mu_);
+        stop_ = false;
+      }
+      thread_ = std::thread([this] { run(); });
+    }
+
+    // Aplica lo pendiente antes de salir.
+    void stop() {
+      {
+        std::lock_guard<std::mutex> g(mu_);
+        stop_ = true;
+      }
+      cv_.notify_all();
+      if (thread_.joinable())
+        thread_.join();
+      running_.store(false, std::memory_order_release);
+    }
+
+    bool running() const noexcept { return running_.load(std::memory_order_acquire); }
+
+    // Devuelve los iids que fallaron si se aplicó acá mismo; vacío si quedó encolado.
+    std::vector<uint64_t> submit(const std::vector<uint64_t> &subscribe,
+                                 const std::vector<uint64_t> &unsubscribe) {
+      if (subscribe.empty() && unsubscribe.empty())
+        return {};
+      bool queued = false;
+      {
+        std::lock_guard<std::mutex> g(mu_);
+        if (running() && !stop_) {
+          append(pending_, subscribe, unsubscribe);
+          queued = true;
+        }
+      }
+      if (queued) {
+        cv_.notify_one();
+        return {};
+      }
+      std::vector<Op> ops;
+      append(ops, subscribe, unsubscribe);
+      std::vector<uint64_t> failed;
+      apply(ops, &failed);
+      return failed;
+    }
+
+    // Bloquea hasta que no quede nada pendiente ni en curso (tests / shutdown ordenado).
+    void waitIdle() {
+      std::unique_lock<std::mutex> lk(mu_);
+      idleCv_.wait(lk, [this] { return (pending_.empty() && !busy_) || !running(); });
+    }
+
+    uint64_t subscribeCalls() const noexcept {
+      return subscribeCalls_.load(std::memory_order_relaxed);
+    }
+    uint64_t unsubscribeCalls() const noexcept {
+      return unsubscribeCalls_.load(std::memory_order_relaxed);
+    }
+    uint64_t coalesced() const noexcept { return coalesced_.load(std::memory_order_relaxed); }
+    uint64_t batches() const noexcept { return batches_.load(std::memory_order_relaxed); }
+    uint64_t failures() const noexcept { return failures_.load(std::memory_order_relaxed); }
+
+   private:
+    struct Op {
+      uint64_t iid;
+      int8_t delta; // +1 subscribe, -1 unsubscribe
+    };
+
+    static void append(std::vector<Op> &ops, const std::vector<uint64_t> &subscribe,
+                       const std::vector<uint64_t> &unsubscribe) {
+      ops.reserve(ops.size() + subscribe.size() + unsubscribe.size());
+      for (const auto iid : subscribe)
+        ops.push_back({iid, +1});
+      for (const auto iid : unsubscribe)
+        ops.push_back({iid, -1});
+    }
+
+    void apply(const std::vector<Op> &ops, std::vector<uint64_t> *failed = nullptr) {
+      // Neto por instrumento, en orden de primera aparición
+      std::unordered_map<uint64_t, int> net;
+      std::vector<uint64_t> order;
+      net.reserve(ops.size());
+      for (const auto &op : ops) {
+        auto [it, inserted] = net.try_emplace(op.iid, 0);
+        if (inserted)
+          order.push_back(op.iid);
+        it->second += op.delta;
+      }
+
+      size_t calls = 0;
+      for (const auto iid : order) {
+        const int n = net[iid];
+        if (n == 0)
+          continue;
+        ++calls;
+        try {
+          if (n > 0) {
+            handler_.subscribe(iid);
+            subscribeCalls_.fetch_add(1, std::memory_order_relaxed);
+          } else {
+            handler_.unsubscribe(iid);
+            unsubscribeCalls_.fetch_add(1, std::memory_order_relaxed);
+          }
+        } catch (const std::exception &e) {
+          fail(iid, n > 0, e.what(), failed);
+        } catch (...) {
+          fail(iid, n > 0, "unknown exception", failed);
+        }
+      }
+      coalesced_.fetch_add(ops.size() - calls, std::memory_order_relaxed);
+      batches_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // El handler rechazó el iid: se informa y se sigue con el resto del batch
+    void fail(uint64_t iid, bool subscribe, const char *what, std::vector<uint64_t> *failed) {
+      failures_.fetch_add(1, std::memory_order_relaxed);
+      if (failed)
+        failed->push_back(iid);
+      if (onFailure_) {
+        try {
+          onFailure_(iid, subscribe, what);
+        } catch (...) {
+        }
+      }
+    }
+
+    void run() {
+      std::vector<Op> batch;
+      for (;;) {
+        {
+          std::unique_lock<std::mutex> lk(mu_);
+          cv_.wait(lk, [this] { return !pending_.empty() || stop_; });
+          if (pending_.empty() && stop_)
+            break;
+          batch.swap(pending_);
+          busy_ = true;
+        }
+        apply(batch);
+        batch.clear();
+        {
+          std::lock_guard<std::mutex> g(mu_);
+          busy_ = false;
+        }
+        idleCv_.notify_all();
+      }
+      idleCv_.notify_all();
+    }
+
+    IMarketDataHandler &handler_;
+    FailureFn onFailure_{};
+
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::condition_variable idleCv_;
+    std::vector<Op> pending_;
+    bool busy_{false};
+    bool stop_{false};
+
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> subscribeCalls_{0};
+    std::atomic<uint64_t> unsubscribeCalls_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> failures_{0};
+    std::thread thread_{};
+  };
+
+} // namespace b3::md
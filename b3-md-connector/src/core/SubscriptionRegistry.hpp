@@ -35,6 +35,12 @@ namespace b3::md {
       return false;
     }
 
+    // Descarta todas las referencias (el subscribe del handler falló: el próximo add reintenta)
+    void reset(InstrumentId iid) {
+      std::unique_lock<std::shared_mutex> lock(mu_);
+      subscribersCount_.erase(iid);
+    }
+
     bool isActive(InstrumentId iid) const noexcept {
       std::shared_lock<std::shared_mutex> lock(mu_);
       auto it = subscribersCount_.find(iid);
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+namespace b3::md {
+
+  enum class TradeKind : uint8_t {
+    Trade = 0,        // Trade_53
+    ForwardTrade = 1, // ForwardTrade_54 (termo)
+    Bust = 2,         // TradeBust_57: anula el trade tradeId
+
+    // Precios estadísticos del exchange: viajan por la misma lane (FIFO con los trades) pero no
+    // se publican como trade, solo alimentan MdStatsEngine.
+    OpeningPrice = 3,    // OpeningPrice_15
+    HighPrice = 4,       // HighPrice_24
+    LowPrice = 5,        // LowPrice_25
+    ClosingPrice = 6,    // ClosingPrice_17
+    SettlementPrice = 7, // SettlementPrice_28
+  };
+
+  inline constexpr bool isTradeKind(TradeKind k) noexcept {
+    return k == TradeKind::Trade || k == TradeKind::ForwardTrade || k == TradeKind::Bust;
+  }
+
+  inline const char *toString(TradeKind k) noexcept {
+    switch (k) {
+    case TradeKind::Trade:
+      return "TRADE";
+    case TradeKind::ForwardTrade:
+      return "FORWARD";
+    case TradeKind::Bust:
+      return "BUST";
+    case TradeKind::OpeningPrice:
+      return "OPEN";
+    case TradeKind::HighPrice:
+      return "HIGH";
+    case TradeKind::LowPrice:
+      return "LOW";
+    case TradeKind::ClosingPrice:
+      return "CLOSE";
+    case TradeKind::SettlementPrice:
+      return "SETTLE";
+    }
+    return "?";
+  }
+
+  // Bits de TradeCondition (SBE B3) que usa el mapper
+  inline constexpr uint16_t kTradeCondOpeningPrice = 0x0001;
+  inline constexpr uint16_t kTradeCondCrossed = 0x0002;
+  inline constexpr uint16_t kTradeCondBlockTrade = 0x4000;
+
+  // Trade compacto (64 bytes) copiado en el callback de OnixS. Para los precios estadísticos
+  // solo valen instrumentId, priceMantissa, rptSeq, transactTimeNs (MDEntryTimestamp) y deleted.
+  struct TradeEvent {
+    uint64_t instrumentId{0};
+    int64_t priceMantissa{0}; // precio con 4 decimales (mantissa)
+    int64_t qty{0};
+    uint64_t transactTimeNs{0}; // TransactTime del exchange (0 = no vino)
+    uint64_t recvTsNs{0};       // callback OnixS (system clock), para latencia end-to-end
+
+    uint32_t tradeId{0};
+    uint32_t rptSeq{0};
+    uint32_t buyer{0};  // firm (0 = no informado)
+    uint32_t seller{0};
+
+    uint16_t condition{0}; // TradeCondition bits (SBE)
+    TradeKind kind{TradeKind::Trade};
+    bool deleted{false}; // precios estadísticos: UpdateAction DELETE (el valor deja de valer)
+    uint16_t session{0}; // época de sesión del canal (MarketDataEngine): cambia con ChannelReset_11
+    uint8_t reserved_[2]{};
+  };
+
+  static_assert(sizeof(TradeEvent) == 64);
+  static_assert(std::is_trivially_copyable_v<TradeEvent>);
+  static_assert(std::is_trivially_destructible_v<TradeEvent>);
+
+} // namespace b3::md
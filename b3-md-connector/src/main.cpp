@@ -2,16 +2,31 @@
 
 #include "core/MdPublishPipeline.hpp"
 #include "core/MdPublishWorker.hpp"
+#include "core/BookStaleTable.hpp"
+#include "core/ChannelSubscriptionRouter.hpp"
 #include "core/MarketDataEngine.hpp"
+#include "core/MarketStateTable.hpp"
+#include "core/MdInlinePublisher.hpp"
+#include "core/MdStateLane.hpp"
+#include "core/MdStatsEngine.hpp"
+#include "core/MdTradeLane.hpp"
+#include "core/SecurityListCache.hpp"
+#include "core/ShardRebalancer.hpp"
 #include "core/SubscriptionRegistry.hpp"
-#include "onixs/OnixsOrderBookListener.hpp"
-#include "onixs/OnixsHandlerWrapper.hpp"
-#include "onixs/B3InstrumentRegistryListener.hpp"
+#include "onixs/OnixsChannel.hpp"
+#include "onixs/OnixsFeedEngineHost.hpp"
+#include "onixs/OnixsFeedThreadLaneBinder.hpp"
+#include "onixs/OnixsLogReplay.hpp"
 #include "mapping/MdSnapshotMapper.hpp"
 #include "mapping/InstrumentTopicMapper.hpp"
+#include "publishing/ZmqDirectSink.hpp"
 #include "publishing/ZmqPublishConcentrator.hpp"
+#include "publishing/SerializerPool.hpp"
+#include "publishing/ShmRingWriter.hpp"
 #include "messaging/B3MdSubscriptionServer.hpp"
+#include "telemetry/LatencyHistogram.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <fstream>
@@ -97,6 +112,25 @@ namespace {
     }
   }
 
+  // "2,3" -> {2,3}. Entradas inválidas se ignoran.
+  std::vector<uint32_t> parseUintList(const std::string &s) {
+    std::vector<uint32_t> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+      item = trimCopy(item);
+      if (item.empty())
+        continue;
+      try {
+        const int v = std::stoi(item);
+        if (v >= 0)
+          out.push_back(static_cast<uint32_t>(v));
+      } catch (...) {
+      }
+    }
+    return out;
+  }
+
   std::string findConfigPath(std::string requested) {
     namespace fs = std::filesystem;
     fs::path p = requested;
@@ -122,14 +156,58 @@ namespace {
     return requested; // fallback (va a fallar y loguea)
   }
 
+  // b3-md-connector [config] [--replay <log|dir>] [--replay-speed X]
+  struct CommandLine {
+    std::string config{"b3-md-connector.conf"};
+    std::string replayPath; // vacío = modo live
+    double replaySpeed{0};  // 0 = máximo
+  };
+
+  bool parseCommandLine(int argc, char **argv, CommandLine &out) {
+    bool configSeen = false;
+    for (int i = 1; i < argc; ++i) {
+      const std::string a = argv[i];
+      if (a == "--replay" && i + 1 < argc) {
+        out.replayPath = argv[++i];
+      } else if (a == "--replay-speed" && i + 1 < argc) {
+        try {
+          out.replaySpeed = std::stod(argv[++i]);
+        } catch (...) {
+          return false;
+        }
+        if (out.replaySpeed < 0)
+          return false;
+      } else if (!a.empty() && a[0] != '-' && !configSeen) {
+        out.config = a;
+        configSeen = true;
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void printLatencyLine(const char *name, const b3::md::telemetry::LatencyHistogram &h) {
+    std::cerr << "[replay] " << name << " samples=" << h.count()
+              << " p50=" << h.percentile(0.50) / 1e3 << "us p90=" << h.percentile(0.90) / 1e3
+              << "us p99=" << h.percentile(0.99) / 1e3 << "us p99.9=" << h.percentile(0.999) / 1e3
+              << "us max=" << h.max() / 1e3 << "us\n";
+  }
+
 } // namespace
 
 int main(int argc, char **argv) {
   namespace fs = std::filesystem;
   std::cerr << "[startup] cwd=" << fs::current_path().string() << "\n";
 
-  std::string requestedConfig = (argc >= 2) ? argv[1] : "b3-md-connector.conf";
-  const std::string configPath = findConfigPath(requestedConfig);
+  CommandLine cmd;
+  if (!parseCommandLine(argc, argv, cmd)) {
+    std::cerr << "usage: " << argv[0] << " [config] [--replay <log file|log dir>] [--replay-speed X]\n";
+    return 2;
+  }
+  const bool replayMode = !cmd.replayPath.empty();
+
+  const std::string configPath = findConfigPath(cmd.config);
   const auto cfg = loadKeyValueFile(configPath);
 
   // -------------------------
@@ -143,34 +221,339 @@ int main(int argc, char **argv) {
   const std::string licenseDir = getOr(cfg, "onixs.license_dir", "./LICENSE_DIR_TODO");
   const std::string connectivityFile =
       getOr(cfg, "onixs.connectivity_file", "./CONNECTIVITY_TODO.xml");
-  const int channel = getOrInt(cfg, "onixs.channel", 80);
+  // Canales UMDF: onixs.channels=80,82 levanta un Handler (y feed engine) por canal sobre el
+  // mismo registry/pipeline/concentrator; sin la key, el canal único de onixs.channel.
+  std::vector<uint32_t> channels = parseUintList(getOr(cfg, "onixs.channels", ""));
+  if (channels.empty())
+    channels.push_back(static_cast<uint32_t>(std::max(0, getOrInt(cfg, "onixs.channel", 80))));
+  {
+    std::vector<uint32_t> unique;
+    for (uint32_t c : channels)
+      if (std::find(unique.begin(), unique.end(), c) == unique.end())
+        unique.push_back(c);
+    channels.swap(unique);
+  }
+  if (replayMode && channels.size() > 1) {
+    std::cerr << "[config] --replay uses a single channel: " << channels.front() << "\n";
+    channels.resize(1);
+  }
+  const bool multiChannel = channels.size() > 1;
 
   // Network interfaces for multicast (Linux only, optional)
   // OnixS will bind to these interfaces to receive B3 multicast feeds
   const std::string ifA = getOr(cfg, "onixs.if_a", "");
   const std::string ifB = getOr(cfg, "onixs.if_b", "");
 
+  // OnixS Feed Engine (threading model del lado feed)
+  // default = engine interno de OnixS; pool = SocketFeedEngine + FeedEngineThreadPool;
+  // single = SingleThreadedSocketFeedEngine polleado por un thread propio (busy-poll)
+  b3::md::onixs::FeedEngineConfig feedCfg;
+  const std::string feedMode = getOr(cfg, "onixs.feed_engine", "default");
+  if (!b3::md::onixs::parseFeedEngineMode(feedMode, feedCfg.mode)) {
+    std::cerr << "[config] unknown onixs.feed_engine=" << feedMode << ", using default\n";
+    feedCfg.mode = b3::md::onixs::FeedEngineMode::Default;
+  }
+  feedCfg.threadCount = static_cast<uint32_t>(std::max(1, getOrInt(cfg, "onixs.feed_engine.threads", 1)));
+  feedCfg.spinBeforeIdleMs =
+      static_cast<uint32_t>(std::max(0, getOrInt(cfg, "onixs.feed_engine.spin_before_idle_ms", 1)));
+  feedCfg.dataWaitMs =
+      static_cast<uint32_t>(std::max(0, getOrInt(cfg, "onixs.feed_engine.data_wait_ms", 10)));
+  feedCfg.socketBufferBytes = static_cast<uint32_t>(
+      std::max(0, getOrInt(cfg, "onixs.feed_engine.socket_buffer_bytes", 8 * 1024 * 1024)));
+  feedCfg.cpus = parseUintList(getOr(cfg, "onixs.feed_engine.cpus", ""));
+  feedCfg.busyPoll = getOrInt(cfg, "onixs.feed_engine.busy_poll", 1) != 0;
+
+  // Varios canales: cada feed thread necesita su lane de ingreso, y el thread interno de OnixS
+  // (default) no avisa cuándo arranca => default pasa a pool de 1 thread por canal.
+  if (multiChannel && feedCfg.mode == b3::md::onixs::FeedEngineMode::Default) {
+    std::cerr << "[config] onixs.feed_engine=default with " << channels.size()
+              << " channels: using pool (threads=1) per channel\n";
+    feedCfg.mode = b3::md::onixs::FeedEngineMode::ThreadPool;
+    feedCfg.threadCount = 1;
+  }
+
+  // Afinidad por canal: onixs.channel.<N>.cpus pisa onixs.feed_engine.cpus
+  std::vector<b3::md::onixs::FeedEngineConfig> channelFeedCfgs;
+  for (uint32_t ch : channels) {
+    b3::md::onixs::FeedEngineConfig c = feedCfg;
+    const std::string cpus = getOr(cfg, "onixs.channel." + std::to_string(ch) + ".cpus", "");
+    if (!cpus.empty())
+      c.cpus = parseUintList(cpus);
+    channelFeedCfgs.push_back(std::move(c));
+  }
+
   // Pipeline Configuration
   const int shards = getOrInt(cfg, "md.shards", 4);
 
+  // Hot-instrument rebalancing (override de shard + drain-and-handoff)
+  const bool rebalanceEnabled = getOrInt(cfg, "md.rebalance", 0) != 0;
+  b3::md::RebalanceConfig rebalanceCfg;
+  rebalanceCfg.intervalMs =
+      static_cast<uint32_t>(std::max(100, getOrInt(cfg, "md.rebalance.interval_ms", 1000)));
+  rebalanceCfg.minEventsPerSec =
+      static_cast<uint64_t>(std::max(0, getOrInt(cfg, "md.rebalance.min_rate", 2000)));
+  try {
+    rebalanceCfg.imbalanceRatio = std::stod(getOr(cfg, "md.rebalance.ratio", "1.5"));
+  } catch (...) {
+    rebalanceCfg.imbalanceRatio = 1.5;
+  }
+
+  // Queue sizing (elementos, redondeado a potencia de 2) + hugepages opt-in con fallback
+  const bool queueHugePages = getOrInt(cfg, "md.queue.hugepages", 0) != 0;
+  const b3::md::QueueConfig workerQueueCfg{
+      b3::md::roundUpPow2(static_cast<uint32_t>(std::max(
+          2, getOrInt(cfg, "md.queue.capacity",
+                      static_cast<int>(b3::md::MdPublishWorker::kQueueCapacity))))),
+      queueHugePages};
+  const b3::md::QueueConfig publishQueueCfg{
+      b3::md::roundUpPow2(static_cast<uint32_t>(std::max(
+          2, getOrInt(cfg, "pub.queue.capacity",
+                      static_cast<int>(
+                          b3::md::publishing::ZmqPublishConcentrator::kPerShardQueueCapacity))))),
+      queueHugePages};
+
+  // Serialización paralela (0 = inline en el worker). Con N > 0 cada shard reparte sus
+  // snapshots entre N serializers y el concentrator los reordena por seq antes del wire.
+  const uint32_t serializeThreads =
+      static_cast<uint32_t>(std::max(0, getOrInt(cfg, "md.serialize_threads", 0)));
+  const uint32_t serializeQueueCapacity = b3::md::roundUpPow2(static_cast<uint32_t>(std::max(
+      2, getOrInt(cfg, "md.serialize.queue_capacity",
+                  static_cast<int>(b3::md::publishing::SerializerPool::kJobQueueCapacity)))));
+
+  // Timestamps epoch-ns en transact_time_str / sending_time_str (latencia end-to-end en clientes)
+  const bool embedTimestamps = getOrInt(cfg, "md.publish.embed_timestamps", 0) != 0;
+  // RptSeq del libro en Book.sequence_number (detección de gaps en clientes)
+  const bool bookSequence = getOrInt(cfg, "md.publish.sequence_number", 0) != 0;
+
+  // Publicación inline (pocos instrumentos, un solo feed thread): el callback de OnixS agrega,
+  // serializa y manda los books por un socket propio en pub.inline.endpoint, sin shards ni
+  // concentrator. Trades/stats/estado siguen saliendo por el concentrator (pub.endpoint).
+  bool publishInline = getOrInt(cfg, "md.publish.inline", 0) != 0;
+  const std::string pubInlineEndpoint = getOr(cfg, "pub.inline.endpoint", "tcp://*:8083");
+
+  // Una lane de ingreso por feed thread que puede llamar callbacks en paralelo (pool > 1), sumando
+  // los feed threads de todos los canales.
+  uint32_t ingressLanes = 0;
+  for (const auto &c : channelFeedCfgs)
+    ingressLanes += b3::md::onixs::OnixsFeedEngineHost::producerThreads(c);
+
+  // El socket inline es de un único thread: con más de un feed thread se usa el pipeline. Se
+  // decide acá porque lo que cuelga del concentrator (batch, ring shm) depende del modo.
+  if (publishInline && ingressLanes != 1) {
+    std::cerr << "[config] md.publish.inline needs a single feed thread (got " << ingressLanes
+              << "): using the shard pipeline\n";
+    publishInline = false;
+  }
+
+  // Streams throttleados (GUIs, riesgo): por cada intervalo, topic "C<ms>.<SYMBOL>" con el
+  // último book del instrumento a lo sumo cada <ms>. El stream completo sigue igual.
+  std::vector<uint32_t> throttleIntervalsMs;
+  for (uint32_t ms : parseUintList(getOr(cfg, "md.throttle.intervals_ms", ""))) {
+    if (ms > 0 && std::find(throttleIntervalsMs.begin(), throttleIntervalsMs.end(), ms) ==
+                      throttleIntervalsMs.end())
+      throttleIntervalsMs.push_back(ms);
+  }
+  const uint32_t throttleCapacity = b3::md::roundUpPow2(
+      static_cast<uint32_t>(std::max(2, getOrInt(cfg, "md.throttle.capacity", 4096))));
+  if (!throttleIntervalsMs.empty() && serializeThreads > 0) {
+    std::cerr << "[config] md.throttle.intervals_ms needs md.serialize_threads=0: throttling off\n";
+    throttleIntervalsMs.clear();
+  }
+  // El throttle vive en los workers: con books inline no le llega ninguno
+  if (!throttleIntervalsMs.empty() && publishInline) {
+    std::cerr << "[config] md.throttle.intervals_ms needs the shard pipeline, "
+                 "md.publish.inline=1 bypasses it: throttling off\n";
+    throttleIntervalsMs.clear();
+  }
+
+  // Batch frames: además (o en lugar, con exclusive) del mensaje por instrumento, el
+  // concentrator empaqueta los books de cada vuelta en un frame bajo pub.batch.topic.
+  b3::md::publishing::BatchConfig batchCfg;
+  batchCfg.enabled = getOrInt(cfg, "pub.batch", 0) != 0;
+  batchCfg.topic = getOr(cfg, "pub.batch.topic", "BATCH");
+  batchCfg.flushUs = static_cast<uint32_t>(std::max(0, getOrInt(cfg, "pub.batch.flush_us", 200)));
+  batchCfg.exclusive = getOrInt(cfg, "pub.batch.exclusive", 0) != 0;
+
+  // Lane de trades (Trade_53/ForwardTrade_54/TradeBust_57 -> topic "T.<SYMBOL>")
+  const bool tradesEnabled = getOrInt(cfg, "md.trades", 0) != 0;
+  const b3::md::QueueConfig tradeQueueCfg{
+      b3::md::roundUpPow2(static_cast<uint32_t>(std::max(
+          2, getOrInt(cfg, "md.trades.queue_capacity",
+                      static_cast<int>(b3::md::MdTradeLane::kQueueCapacity))))),
+      queueHugePages};
+
+  // Stats de sesión (OHLC/VWAP/volumen) -> topic "S.<SYMBOL>" cada md.stats.interval_ms (solo dirty)
+  const bool statsEnabled = getOrInt(cfg, "md.stats", 0) != 0;
+  const int statsIntervalMs = std::max(10, getOrInt(cfg, "md.stats.interval_ms", 1000));
+  const uint32_t statsMaxInstruments = static_cast<uint32_t>(std::max(
+      1, getOrInt(cfg, "md.stats.max_instruments",
+                  static_cast<int>(b3::md::MdStatsEngine::kDefaultMaxInstruments))));
+
+  // Estado de mercado (status/fase de grupo/subasta/bandas) -> "M.<SYMBOL>" / "G.<GROUP>" al cambiar
+  const bool stateEnabled = getOrInt(cfg, "md.state", 0) != 0;
+  const b3::md::QueueConfig stateQueueCfg{
+      b3::md::roundUpPow2(static_cast<uint32_t>(std::max(
+          2, getOrInt(cfg, "md.state.queue_capacity",
+                      static_cast<int>(b3::md::MdStateLane::kQueueCapacity))))),
+      queueHugePages};
+  const uint32_t stateMaxInstruments = static_cast<uint32_t>(
+      std::max(1, getOrInt(cfg, "md.state.max_instruments", 8192)));
+
+  // Libros desactualizados: marcador "book invalid", updates suprimidos durante la recuperación
+  // y refresh completo al recuperarse (0 = legacy: onOrderBookOutOfDate solo se cuenta)
+  const bool staleBooksEnabled = getOrInt(cfg, "md.stale_books", 0) != 0;
+  const uint32_t staleBooksCapacity = b3::md::roundUpPow2(
+      static_cast<uint32_t>(std::max(2, getOrInt(cfg, "md.stale_books.capacity", 16384))));
+
+  // SecurityDefinitions después del loop inicial: deltas intradiarios (1) o freeze estricto (0)
+  const bool secdefLiveUpdates = getOrInt(cfg, "md.secdef.live_updates", 0) != 0;
+
+  // Cache de security list (vacío = off): restart intradiario sin esperar el loop de SecDefs
+  const std::string secdefCachePath = getOr(cfg, "md.secdef_cache.path", "");
+  const int secdefCacheDateCfg = getOrInt(cfg, "md.secdef_cache.trading_date", 0);
+  const uint32_t secdefCacheDate = secdefCacheDateCfg > 0
+                                       ? static_cast<uint32_t>(secdefCacheDateCfg)
+                                       : b3::md::seccache::tradingDateToday();
+
+  // Captura de OrdersSnapshot aceptados (vacío = off) para replay offline (b3-md-replay)
+  const std::string capturePath = getOr(cfg, "md.capture.path", "");
+  const uint32_t captureQueueCapacity = b3::md::roundUpPow2(
+      static_cast<uint32_t>(std::max(2, getOrInt(cfg, "md.capture.queue_capacity", 1024))));
+
   // Client Communication Endpoints
   // Subscription server: Clients send MarketDataSuscriptionRequest here
   const std::string subEndpoint = getOr(cfg, "sub.endpoint", "tcp://*:8080");
   const std::string subResponseEndpoint = "tcp://*:8082";  // SubscriberPublisher response port (hardcoded)
+  // SecurityListResponse servida como bytes pre-serializados (cache por versión del registry)
+  const bool securityListPreEncoded = getOrInt(cfg, "sub.security_list.pre_encoded", 0) != 0;
+  // Securities por SecurityListResponse (0 = todo en un mensaje; >0 = chunks + respuesta vacía final)
+  const int securityListPageSize = std::max(0, getOrInt(cfg, "sub.security_list.page_size", 0));
+  // subscribe/unsubscribe de OnixS en un thread propio (coalescidos), no en el de requests
+  const bool asyncSubscribe = getOrInt(cfg, "sub.async_subscribe", 0) != 0;
 
   // Market data publishing: Clients subscribe to symbols and receive MarketDataUpdate here
   const std::string pubEndpoint = getOr(cfg, "pub.endpoint", "tcp://*:8081");
+  // Consumidores del mismo host: ring de broadcast en /dev/shm (vacío = off), además del PUB
+  std::string pubShmName = getOr(cfg, "pub.shm.name", "");
+  const uint32_t pubShmSlots = static_cast<uint32_t>(std::max(
+      2, getOrInt(cfg, "pub.shm.slots",
+                  static_cast<int>(b3::md::publishing::ShmRingWriter::kDefaultSlots))));
+  const uint32_t pubShmSlotBytes = static_cast<uint32_t>(std::max(
+      0, getOrInt(cfg, "pub.shm.slot_bytes",
+                  static_cast<int>(b3::md::publishing::ShmRingWriter::kDefaultSlotBytes))));
+
+  // Inline: los books salen por su socket sin pasar por el concentrator, que es quien arma los
+  // batch frames y escribe el ring. Los dos son solo de books: quedarían vacíos, se apagan.
+  if (publishInline && batchCfg.enabled) {
+    std::cerr << "[config] pub.batch needs books through the concentrator, "
+                 "md.publish.inline=1 sends them directly: batching off\n";
+    batchCfg.enabled = false;
+  }
+  if (publishInline && !pubShmName.empty()) {
+    std::cerr << "[config] pub.shm.name needs books through the concentrator, "
+                 "md.publish.inline=1 sends them directly: shm ring off\n";
+    pubShmName.clear();
+  }
 
   std::cerr << "[startup] config=" << configPath << "\n";
+  if (replayMode)
+    std::cerr << "[startup] replay=" << cmd.replayPath << " speed="
+              << (cmd.replaySpeed > 0 ? std::to_string(cmd.replaySpeed) : std::string("max"))
+              << " (OnixS log replay: no network, no subscription server)\n";
   std::cerr << "[startup] onixs.license_dir=" << licenseDir << "\n";
   std::cerr << "[startup] onixs.connectivity_file=" << connectivityFile << "\n";
-  std::cerr << "[startup] onixs.channel=" << channel << "\n";
+  std::cerr << "[startup] onixs.channels=";
+  for (size_t i = 0; i < channels.size(); ++i)
+    std::cerr << (i ? "," : "") << channels[i];
+  std::cerr << "\n";
   std::cerr << "[startup] onixs.if_a=" << (ifA.empty() ? "<auto>" : ifA) << "\n";
   std::cerr << "[startup] onixs.if_b=" << (ifB.empty() ? "<auto>" : ifB) << "\n";
+  std::cerr << "[startup] onixs.feed_engine=" << b3::md::onixs::toString(feedCfg.mode) << "\n";
+  if (feedCfg.mode != b3::md::onixs::FeedEngineMode::Default) {
+    std::cerr << "[startup] onixs.feed_engine.threads=" << feedCfg.threadCount
+              << " spin_before_idle_ms=" << feedCfg.spinBeforeIdleMs
+              << " data_wait_ms=" << feedCfg.dataWaitMs
+              << " socket_buffer_bytes=" << feedCfg.socketBufferBytes
+              << " busy_poll=" << (feedCfg.busyPoll ? 1 : 0) << "\n";
+    for (size_t c = 0; c < channels.size(); ++c) {
+      const auto &cpus = channelFeedCfgs[c].cpus;
+      std::cerr << "[startup] channel " << channels[c] << " cpus=";
+      if (cpus.empty())
+        std::cerr << "<none>";
+      for (size_t i = 0; i < cpus.size(); ++i)
+        std::cerr << (i ? "," : "") << cpus[i];
+      std::cerr << "\n";
+    }
+  }
   std::cerr << "[startup] md.shards=" << shards << "\n";
+  std::cerr << "[startup] md.rebalance=" << (rebalanceEnabled ? 1 : 0);
+  if (rebalanceEnabled)
+    std::cerr << " interval_ms=" << rebalanceCfg.intervalMs << " ratio=" << rebalanceCfg.imbalanceRatio
+              << " min_rate=" << rebalanceCfg.minEventsPerSec;
+  std::cerr << "\n";
+  std::cerr << "[startup] md.queue.capacity=" << workerQueueCfg.capacity
+            << " pub.queue.capacity=" << publishQueueCfg.capacity
+            << " md.queue.hugepages=" << (queueHugePages ? 1 : 0) << "\n";
+  std::cerr << "[startup] md.capture.path=" << (capturePath.empty() ? "<off>" : capturePath);
+  if (!capturePath.empty())
+    std::cerr << " md.capture.queue_capacity=" << captureQueueCapacity;
+  std::cerr << "\n";
+  std::cerr << "[startup] md.secdef.live_updates=" << (secdefLiveUpdates ? 1 : 0) << "\n";
+  std::cerr << "[startup] md.secdef_cache.path="
+            << (secdefCachePath.empty() ? "<off>" : secdefCachePath);
+  if (!secdefCachePath.empty())
+    std::cerr << " trading_date=" << secdefCacheDate;
+  std::cerr << "\n";
+  std::cerr << "[startup] md.serialize_threads=" << serializeThreads;
+  if (serializeThreads > 0)
+    std::cerr << " md.serialize.queue_capacity=" << serializeQueueCapacity;
+  std::cerr << "\n";
+  std::cerr << "[startup] md.throttle.intervals_ms=";
+  if (throttleIntervalsMs.empty())
+    std::cerr << "<off>";
+  for (size_t i = 0; i < throttleIntervalsMs.size(); ++i)
+    std::cerr << (i ? "," : "") << throttleIntervalsMs[i];
+  if (!throttleIntervalsMs.empty())
+    std::cerr << " md.throttle.capacity=" << throttleCapacity;
+  std::cerr << "\n";
+  std::cerr << "[startup] md.trades=" << (tradesEnabled ? 1 : 0);
+  if (tradesEnabled)
+    std::cerr << " md.trades.queue_capacity=" << tradeQueueCfg.capacity;
+  std::cerr << "\n";
+  std::cerr << "[startup] md.stats=" << (statsEnabled ? 1 : 0);
+  if (statsEnabled)
+    std::cerr << " md.stats.interval_ms=" << statsIntervalMs
+              << " md.stats.max_instruments=" << statsMaxInstruments;
+  std::cerr << "\n";
+  std::cerr << "[startup] md.state=" << (stateEnabled ? 1 : 0);
+  if (stateEnabled)
+    std::cerr << " md.state.queue_capacity=" << stateQueueCfg.capacity
+              << " md.state.max_instruments=" << stateMaxInstruments;
+  std::cerr << "\n";
+  std::cerr << "[startup] md.stale_books=" << (staleBooksEnabled ? 1 : 0);
+  if (staleBooksEnabled)
+    std::cerr << " md.stale_books.capacity=" << staleBooksCapacity;
+  std::cerr << "\n";
+  std::cerr << "[startup] md.publish.embed_timestamps=" << (embedTimestamps ? 1 : 0)
+            << " md.publish.sequence_number=" << (bookSequence ? 1 : 0) << "\n";
+  std::cerr << "[startup] md.publish.inline=" << (publishInline ? 1 : 0);
+  if (publishInline)
+    std::cerr << " pub.inline.endpoint=" << pubInlineEndpoint;
+  std::cerr << "\n";
   std::cerr << "[startup] sub.endpoint=" << subEndpoint << " (requests)\n";
   std::cerr << "[startup] sub.response.endpoint=" << subResponseEndpoint << " (responses)\n";
+  std::cerr << "[startup] sub.security_list.pre_encoded=" << (securityListPreEncoded ? 1 : 0)
+            << "\n";
+  std::cerr << "[startup] sub.security_list.page_size=" << securityListPageSize << "\n";
+  std::cerr << "[startup] sub.async_subscribe=" << (asyncSubscribe ? 1 : 0) << "\n";
   std::cerr << "[startup] pub.endpoint=" << pubEndpoint << " (market data)\n";
+  if (pubShmName.empty())
+    std::cerr << "[startup] pub.shm.name=<off>\n";
+  std::cerr << "[startup] pub.batch=" << (batchCfg.enabled ? 1 : 0);
+  if (batchCfg.enabled)
+    std::cerr << " pub.batch.topic=" << batchCfg.topic << " pub.batch.flush_us=" << batchCfg.flushUs
+              << " pub.batch.exclusive=" << (batchCfg.exclusive ? 1 : 0);
+  std::cerr << "\n";
 
   // -------------------------
   // Pipeline publish
@@ -178,44 +561,242 @@ int main(int argc, char **argv) {
   b3::common::InstrumentRegistry registry;
   b3::md::mapping::InstrumentTopicMapper topicMapper(registry);
 
-  b3::md::publishing::ZmqPublishConcentrator concentrator(pubEndpoint,
-                                                          static_cast<uint32_t>(shards));
+  b3::md::publishing::ZmqPublishConcentrator concentrator(
+      pubEndpoint, static_cast<uint32_t>(shards), publishQueueCfg, serializeThreads);
+  // Replay: latencia callback OnixS -> socket medida en el concentrator
+  b3::md::telemetry::LatencyHistogram endToEndLatency;
+  if (replayMode)
+    concentrator.setLatencyProbe(&endToEndLatency);
+  concentrator.setBatching(batchCfg);
+  if (batchCfg.enabled && !concentrator.batching())
+    std::cerr << "[startup] WARNING: pub.batch.topic invalid (empty or > "
+              << b3::md::publishing::SerializedEnvelope::kMaxTopic << " chars), batching off\n";
+
+  std::unique_ptr<b3::md::publishing::ShmRingWriter> shmRing;
+  if (!pubShmName.empty()) {
+    try {
+      shmRing = std::make_unique<b3::md::publishing::ShmRingWriter>(pubShmName, pubShmSlots,
+                                                                     pubShmSlotBytes);
+      shmRing->start();
+      concentrator.setShmRing(shmRing.get());
+      std::cerr << "[startup] pub.shm.name=" << shmRing->name()
+                << " slots=" << shmRing->slotCount() << " slot_bytes=" << shmRing->slotBytes()
+                << " mapped=" << shmRing->mappedBytes() / (1024 * 1024) << "MiB\n";
+    } catch (const std::exception &e) {
+      std::cerr << "[startup] WARNING: shared-memory ring disabled: " << e.what() << "\n";
+      shmRing.reset();
+    }
+  }
   concentrator.start();
 
   b3::md::mapping::MdSnapshotMapper mapper;
+  mapper.setEmbedTimestamps(embedTimestamps);
+  mapper.setBookSequence(bookSequence);
+
+  std::unique_ptr<b3::md::publishing::SerializerPool> serializerPool;
+  if (serializeThreads > 0) {
+    serializerPool = std::make_unique<b3::md::publishing::SerializerPool>(
+        static_cast<uint32_t>(shards), serializeThreads, mapper, concentrator,
+        serializeQueueCapacity);
+    serializerPool->start();
+  }
+
+  std::cerr << "[startup] md.ingress_lanes=" << ingressLanes << " (per shard)\n";
 
   std::vector<std::unique_ptr<b3::md::MdPublishWorker>> workers;
   workers.reserve(static_cast<size_t>(shards));
   for (int i = 0; i < shards; ++i) {
-    workers.emplace_back(std::make_unique<b3::md::MdPublishWorker>(static_cast<uint32_t>(i), mapper,
-                                                                   concentrator, topicMapper));
+    workers.emplace_back(std::make_unique<b3::md::MdPublishWorker>(
+        static_cast<uint32_t>(i), mapper, concentrator, topicMapper, ingressLanes, workerQueueCfg));
+    workers.back()->attachSerializeStage(serializerPool.get());
+    for (uint32_t ms : throttleIntervalsMs)
+      workers.back()->addThrottle(static_cast<uint64_t>(ms) * 1'000'000ull,
+                                  "C" + std::to_string(ms) + ".", throttleCapacity);
   }
 
   b3::md::MdPublishPipeline pipeline(std::move(workers));
   pipeline.start();
 
-  b3::md::MarketDataEngine engine(pipeline);
+  // Colas ya prefaulteadas (first-touch en cada consumer): reporte de memoria residente
+  {
+    constexpr double kMiB = 1024.0 * 1024.0;
+    using b3::md::QueueBacking;
+    using b3::md::QueueMemory;
+    std::cerr << "[startup] queue.memory workers=" << pipeline.queueMemoryBytes() / kMiB
+              << "MiB (" << shards << "x" << ingressLanes << " lanes)"
+              << " publish=" << concentrator.queueMemoryBytes() / kMiB << "MiB ("
+              << b3::md::toString(concentrator.queueBacking()) << ")"
+              << " total=" << QueueMemory::liveBytesTotal() / kMiB << "MiB"
+              << " [hugetlb=" << QueueMemory::liveBytes(QueueBacking::HugeTlb) / kMiB
+              << " thp=" << QueueMemory::liveBytes(QueueBacking::TransparentHuge) / kMiB
+              << " regular=" << QueueMemory::liveBytes(QueueBacking::Regular) / kMiB << "]\n";
+  }
+
+  b3::md::ShardRebalancer rebalancer(pipeline, rebalanceCfg);
+  if (rebalanceEnabled)
+    rebalancer.start();
+
+  // Feed threads del pool toman su lane al arrancar (onFeedEngineThreadBegin); el poll thread
+  // del modo single, antes de crear su engine
+  b3::md::onixs::OnixsFeedThreadLaneBinder laneBinder(pipeline);
+
+  // Un canal = Handler + feed engine + MarketDataEngine + listeners propios (gating por canal)
+  std::vector<std::unique_ptr<b3::md::onixs::OnixsChannel>> feedChannels;
+  for (size_t c = 0; c < channels.size(); ++c) {
+    feedChannels.emplace_back(std::make_unique<b3::md::onixs::OnixsChannel>(
+        static_cast<int>(channels[c]), channelFeedCfgs[c], pipeline, registry));
+    auto &host = feedChannels.back()->feedHost();
+    host.setThreadPoolListener(&laneBinder);
+    host.setPollThreadStart([&laneBinder] { laneBinder.bindCurrentThread(); });
+  }
+
+  // Trades: colas y consumer propios, salen por la lane prioritaria del concentrator.
+  // Las stats corren en el mismo thread (md.stats sin md.trades: la lane existe pero no publica
+  // trades).
+  std::unique_ptr<b3::md::MdStatsEngine> statsEngine;
+  if (statsEnabled)
+    statsEngine = std::make_unique<b3::md::MdStatsEngine>(
+        mapper, concentrator, topicMapper, static_cast<uint64_t>(statsIntervalMs) * 1'000'000ull,
+        statsMaxInstruments);
+
+  std::unique_ptr<b3::md::MdTradeLane> tradeLane;
+  if (tradesEnabled || statsEnabled) {
+    tradeLane = std::make_unique<b3::md::MdTradeLane>(static_cast<uint32_t>(shards), mapper,
+                                                      concentrator, topicMapper, ingressLanes,
+                                                      tradeQueueCfg);
+    tradeLane->setStats(statsEngine.get());
+    tradeLane->setPublishTrades(tradesEnabled);
+    tradeLane->start();
+    for (auto &ch : feedChannels)
+      ch->engine().setTradeLane(tradeLane.get());
+  }
+
+  // Estado de mercado: lane propia de baja tasa; la tabla también responde SecurityStatusRequest
+  std::unique_ptr<b3::md::MarketStateTable> stateTable;
+  std::unique_ptr<b3::md::MdStateLane> stateLane;
+  if (stateEnabled) {
+    stateTable = std::make_unique<b3::md::MarketStateTable>(stateMaxInstruments, &registry);
+    stateLane = std::make_unique<b3::md::MdStateLane>(*stateTable, mapper, concentrator, topicMapper,
+                                                      ingressLanes, stateQueueCfg);
+    stateLane->start();
+    for (auto &ch : feedChannels)
+      ch->engine().setStateLane(stateLane.get());
+  }
+
+  // Journal: una lane por feed thread (mismo binding que el pipeline)
+  std::unique_ptr<b3::md::SnapshotJournalWriter> captureJournal;
+  if (!capturePath.empty()) {
+    b3::md::JournalConfig jc;
+    jc.path = capturePath;
+    jc.lanes = ingressLanes;
+    jc.queue = {captureQueueCapacity, queueHugePages};
+    captureJournal = std::make_unique<b3::md::SnapshotJournalWriter>(std::move(jc));
+    captureJournal->start();
+    for (auto &ch : feedChannels)
+      ch->engine().setCaptureJournal(captureJournal.get());
+  }
+
+  for (auto &ch : feedChannels)
+    ch->instrumentListener().setLiveUpdates(secdefLiveUpdates);
+
+  // Deltas del registry (altas/cambios intradiarios): los topics y las suscripciones resuelven
+  // por iid/símbolo contra el registry y se extienden solos; la tabla de estado recachea grupos.
+  if (stateTable)
+    registry.addDeltaListener(
+        [table = stateTable.get()](const b3::common::RegistryDelta &d) { table->onRegistryDelta(d); });
+
+  // Las tablas densas de stats/estado tienen tope fijo (sin alloc en hot path): si la security
+  // list las supera, lo que no entre se cuenta como overflow. Avisar una vez al cruzarlo.
+  if (statsEngine || stateTable) {
+    const uint32_t statsCap = statsEngine ? statsMaxInstruments : UINT32_MAX;
+    const uint32_t stateCap = stateTable ? stateMaxInstruments : UINT32_MAX;
+    auto warned = std::make_shared<std::atomic<bool>>(false);
+    registry.addDeltaListener([statsCap, stateCap, warned](const b3::common::RegistryDelta &d) {
+      const uint64_t total = static_cast<uint64_t>(d.firstNewDense) + d.added.size();
+      if ((total <= statsCap && total <= stateCap) || warned->exchange(true))
+        return;
+      std::cerr << "[runtime] WARNING: registry has " << total << " instruments, above";
+      if (total > statsCap)
+        std::cerr << " md.stats.max_instruments=" << statsCap;
+      if (total > stateCap)
+        std::cerr << " md.state.max_instruments=" << stateCap;
+      std::cerr << "; instruments beyond it get no stats/state (counted as overflow)\n";
+    });
+  }
+
+  // Replay usa la security list de los logs: el cache es solo para el feed en vivo.
+  // Un archivo por canal (key = fecha + canal); con varios canales, <path>.<canal> y solo los
+  // instrumentos que definió ese canal.
+  std::vector<std::unique_ptr<b3::md::SecurityListCacheSaver>> secdefCacheSavers;
+  if (!secdefCachePath.empty() && !replayMode) {
+    for (auto &ch : feedChannels) {
+      auto &listener = ch->instrumentListener();
+      const std::string path =
+          multiChannel ? secdefCachePath + "." + std::to_string(ch->channel()) : secdefCachePath;
+      const b3::md::SecurityListCacheKey key{secdefCacheDate, static_cast<uint32_t>(ch->channel())};
+
+      b3::md::SecurityListCacheReader cache(path, key);
+      if (cache.ok())
+        listener.preload(cache.loadAll());
+      std::cerr << "[startup] secdef cache channel=" << ch->channel() << " "
+                << b3::md::toString(cache.status()) << " instruments=" << listener.preloadedCount()
+                << " registry_ready=" << (listener.readyAtomic().load() ? 1 : 0) << "\n";
 
-  b3::md::onixs::B3InstrumentRegistryListener instrumentListener(registry);
-  engine.setRegistryReadyFlag(&instrumentListener.readyAtomic());
+      auto saver = std::make_unique<b3::md::SecurityListCacheSaver>(path, key, registry,
+                                                                    listener.loopCompleteAtomic());
+      if (multiChannel)
+        saver->setSource([&listener] { return listener.snapshotOwned(); });
+      saver->start();
+      secdefCacheSavers.push_back(std::move(saver));
+    }
+  }
+
+  std::unique_ptr<b3::md::BookStaleTable> staleBooks;
+  if (staleBooksEnabled) {
+    staleBooks = std::make_unique<b3::md::BookStaleTable>(staleBooksCapacity);
+    for (auto &ch : feedChannels)
+      ch->engine().setBookStaleTable(staleBooks.get());
+  }
+
+  // Modo inline: el socket se bindea acá (main) y desde el arranque del Handler lo usa solo el
+  // feed thread
+  std::unique_ptr<b3::md::publishing::ZmqDirectSink> inlineSink;
+  std::unique_ptr<b3::md::MdInlinePublisher> inlinePublisher;
+  if (publishInline) {
+    try {
+      inlineSink = std::make_unique<b3::md::publishing::ZmqDirectSink>(pubInlineEndpoint);
+      if (replayMode)
+        inlineSink->setLatencyProbe(&endToEndLatency);
+      inlineSink->start();
+      inlinePublisher =
+          std::make_unique<b3::md::MdInlinePublisher>(mapper, topicMapper, *inlineSink);
+      for (auto &ch : feedChannels)
+        ch->engine().setInlinePublisher(inlinePublisher.get());
+    } catch (const std::exception &ex) {
+      std::cerr << "[startup] inline publish disabled (" << pubInlineEndpoint << "): " << ex.what()
+                << "\n";
+      inlinePublisher.reset();
+      inlineSink.reset();
+    }
+  }
 
-  b3::md::onixs::OnixsOrderBookListener orderBookListener(engine);
+  for (auto &ch : feedChannels)
+    ch->wireListeners(staleBooks != nullptr, tradeLane != nullptr, statsEngine != nullptr,
+                      stateLane != nullptr);
 
   // -------------------------
   // Subscription Registry (tracks active subscriptions)
   // -------------------------
   b3::md::SubscriptionRegistry subscriptionRegistry;
 
-  // -------------------------
-  // OnixS Handler (lifetime fuera del try)
-  // -------------------------
-  std::unique_ptr<Handler> handler;
-
   // -------------------------
   // Subscription Server (lifetime fuera del try)
   // -------------------------
   std::unique_ptr<b3::md::messaging::B3MdSubscriptionServer> subscriptionServer;
 
+  // Backtest (--replay): se reporta al final, con todo el stack ya drenado
+  b3::md::onixs::OnixsLogReplay replay({cmd.replayPath, cmd.replaySpeed});
+
   try {
     // -------------------------
     // OnixS Handler Configuration
@@ -229,82 +810,116 @@ int main(int argc, char **argv) {
     // 2. Enable OrderBook building (required for our use case)
     settings.buildOrderBooks = true;
 
-    // 3. Load B3 multicast feed addresses from XML connectivity file
+    // 3. Network Interface Configuration (Linux only, optional)
+    // If specified, OnixS will bind to these NICs to receive multicast traffic
+    // Feed A and B are redundant feeds from B3 for reliability
+    // (replay de logs: los paquetes salen del log, no hacen falta feeds ni NICs)
+    if (!replayMode) {
+      if (!ifA.empty())
+        settings.networkInterfaceA = ifA.c_str();
+      if (!ifB.empty())
+        settings.networkInterfaceB = ifB.c_str();
+    }
+
+    // 4. Per channel: B3 multicast feed addresses from the XML connectivity file
     // This configures three feeds:
     // - instrumentFeeds: Receives SecurityDefinitions (security list)
     // - incrementalFeeds: Receives real-time OrderBook updates
     // - snapshotFeeds: Recovery feed for missed packets
-    settings.loadFeeds(channel, connectivityFile.c_str());
-
-    // 4. Network Interface Configuration (Linux only, optional)
-    // If specified, OnixS will bind to these NICs to receive multicast traffic
-    // Feed A and B are redundant feeds from B3 for reliability
-    if (!ifA.empty())
-      settings.networkInterfaceA = ifA.c_str();
-    if (!ifB.empty())
-      settings.networkInterfaceB = ifB.c_str();
+    // Con varios Handlers cada uno loguea con su propio prefijo (mismo directorio).
+    auto channelSettings = [&](const b3::md::onixs::OnixsChannel &ch) {
+      HandlerSettings cs = settings;
+      if (!replayMode)
+        cs.loadFeeds(ch.channel(), connectivityFile);
+      if (multiChannel)
+        cs.loggerSettings.logFileNamePrefix += "_" + std::to_string(ch.channel());
+      return cs;
+    };
 
-    // -------------------------
-    // OnixS Handler Initialization
-    // -------------------------
-    handler = std::make_unique<Handler>(settings);
+    if (replayMode) {
+      // -------------------------
+      // Backtest: mismo Handler + listeners, fuente = logs de OnixS
+      // -------------------------
+      auto &ch = *feedChannels.front();
+      auto &handler = ch.openForReplay(channelSettings(ch));
 
-    // Register Listeners
-    // 1. OrderBookListener: Receives real-time OrderBook updates → MarketDataEngine → Pipeline
-    handler->registerOrderBookListener(&orderBookListener);
+      std::cerr << "[replay] replaying...\n";
+      replay.run(handler);
+      ch.closeReplay();
+    } else {
+      // -------------------------
+      // OnixS Handler Initialization
+      // -------------------------
+      // Create/start y stop corren en el thread que indique el feed engine de cada canal:
+      // main para default/pool, el poll thread propio para single (requisito de OnixS).
+      //
+      // Start B3 Connection, per channel:
+      // 1. InstrumentFeed: SecurityDefinitions populate the (shared) InstrumentRegistry
+      // 2. After the channel's security list is ready, IncrementalFeed: OrderBook updates flow
+      //    through the pipeline
+      // 3. SnapshotFeed: Used for recovery if packets are lost
+      for (auto &ch : feedChannels) {
+        std::cerr << "[startup] starting OnixS handler channel=" << ch->channel() << "...\n";
+        ch->start(channelSettings(*ch));
+      }
 
-    // 2. MessageListener: Receives SecurityDefinitions → InstrumentRegistry
-    // SecurityDefinitions arrive automatically from the instrumentFeed when handler starts
-    // They are sent between two SequenceReset_1 messages (marks the security list batch)
-    handler->registerMessageListener(&instrumentListener);
+      // At this point:
+      // - OnixS is listening on multicast groups
+      // - SecurityDefinitions will start arriving and populate the registry
+      // - Once registry is ready, OrderBook updates will be processed
+      // - Clients can connect and subscribe to symbols
 
-    // -------------------------
-    // Start B3 Connection
-    // -------------------------
-    // This connects to B3 multicast feeds and starts receiving data:
-    // 1. InstrumentFeed: SecurityDefinitions populate the InstrumentRegistry
-    // 2. After registry is ready, IncrementalFeed: OrderBook updates flow through the pipeline
-    // 3. SnapshotFeed: Used for recovery if packets are lost
-    std::cerr << "[startup] starting OnixS handler...\n";
-    handler->start();
-
-    // At this point:
-    // - OnixS is listening on multicast groups
-    // - SecurityDefinitions will start arriving and populate the registry
-    // - Once registry is ready, OrderBook updates will be processed
-    // - Clients can connect and subscribe to symbols
+      // -------------------------
+      // Subscription Server (on-demand subscriptions)
+      // -------------------------
+      auto logCallback = [](const std::string& level, const std::string& msg) {
+        std::cerr << "[sub-server][" << level << "] " << msg << "\n";
+      };
 
-    // -------------------------
-    // Subscription Server (on-demand subscriptions)
-    // -------------------------
-    auto logCallback = [](const std::string& level, const std::string& msg) {
-      std::cerr << "[sub-server][" << level << "] " << msg << "\n";
-    };
+      // subscribe/unsubscribe van al Handler del canal que definió el instrumento
+      b3::md::ChannelSubscriptionRouter channelRouter;
+      for (auto &ch : feedChannels) {
+        const auto &listener = ch->instrumentListener();
+        channelRouter.add([&listener](uint64_t iid) { return listener.owns(iid); }, ch->handler());
+      }
+      b3::md::SubscriptionExecutor subscriptionExecutor(channelRouter);
+      if (asyncSubscribe) {
+        subscriptionExecutor.start();
+      }
 
-    // Wrap OnixS Handler to implement IMarketDataHandler interface
-    b3::md::onixs::OnixsHandlerWrapper handlerWrapper(*handler);
+      subscriptionServer = std::make_unique<b3::md::messaging::B3MdSubscriptionServer>(
+          subEndpoint,           // tcp://*:8080 - receives MarketDataSuscriptionRequest
+          subResponseEndpoint,   // tcp://*:8082 - sends MarketDataSuscriptionResponse
+          registry,
+          subscriptionRegistry,
+          channelRouter,
+          logCallback);
+      subscriptionServer->setMarketStateTable(stateTable.get());
+      subscriptionServer->setPreEncodedSecurityList(securityListPreEncoded);
+      subscriptionServer->setSecurityListPageSize(static_cast<uint32_t>(securityListPageSize));
+      subscriptionServer->setSubscriptionExecutor(&subscriptionExecutor);
 
-    subscriptionServer = std::make_unique<b3::md::messaging::B3MdSubscriptionServer>(
-        subEndpoint,           // tcp://*:8080 - receives MarketDataSuscriptionRequest
-        subResponseEndpoint,   // tcp://*:8082 - sends MarketDataSuscriptionResponse
-        registry,
-        subscriptionRegistry,
-        handlerWrapper,
-        logCallback);
+      std::cerr << "[startup] starting subscription server...\n";
+      subscriptionServer->Start();
 
-    std::cerr << "[startup] starting subscription server...\n";
-    subscriptionServer->Start();
+      std::cerr << "[runtime] running. Press ENTER to stop...\n";
+      std::cin.get();
 
-    std::cerr << "[runtime] running. Press ENTER to stop...\n";
-    std::cin.get();
+      std::cerr << "[shutdown] stopping subscription server...\n";
+      if (subscriptionServer) {
+        subscriptionServer->Stop();
+      }
+      subscriptionExecutor.stop();
+      std::cerr << "[shutdown] subscribe calls=" << subscriptionExecutor.subscribeCalls()
+                << " unsubscribe calls=" << subscriptionExecutor.unsubscribeCalls()
+                << " coalesced=" << subscriptionExecutor.coalesced()
+                << " failures=" << subscriptionExecutor.failures()
+                << " unrouted=" << channelRouter.unrouted() << "\n";
 
-    std::cerr << "[shutdown] stopping subscription server...\n";
-    if (subscriptionServer) {
-      subscriptionServer->Stop();
+      std::cerr << "[shutdown] stopping OnixS handlers...\n";
+      for (auto it = feedChannels.rbegin(); it != feedChannels.rend(); ++it)
+        (*it)->stop();
     }
-
-    std::cerr << "[shutdown] stopping OnixS handler...\n";
-    handler->stop(true);
   } catch (const std::exception &ex) {
     std::cerr << "[fatal] exception: " << ex.what() << "\n";
   } catch (...) {
@@ -319,12 +934,184 @@ int main(int argc, char **argv) {
     subscriptionServer->Stop();
   }
 
+  // No-op si ya se paró arriba
+  for (auto it = feedChannels.rbegin(); it != feedChannels.rend(); ++it)
+    (*it)->stop();
+
+  rebalancer.stop();
+
+  if (inlineSink) {
+    inlineSink->stop();
+    std::cerr << "[shutdown] inline books published=" << inlinePublisher->published()
+              << " dropped=" << inlinePublisher->dropped() << " sent=" << inlineSink->sent()
+              << " send_failures=" << inlineSink->dropped() << "\n";
+  }
+
+  // Contadores por canal; las lanes compartidas reportan una vez, con los totales de los canales
+  const auto sumChannels = [&feedChannels](auto metric) {
+    uint64_t n = 0;
+    for (const auto &ch : feedChannels) n += metric(*ch);
+    return n;
+  };
+  using Channel = b3::md::onixs::OnixsChannel;
+
+  std::cerr << "[shutdown] registry instruments=" << registry.size()
+            << " version=" << registry.version() << " lanes_bound=" << laneBinder.bound()
+            << " lanes_unbound=" << laneBinder.unbound() << "\n";
+  for (const auto &ch : feedChannels) {
+    const auto &listener = ch->instrumentListener();
+    std::cerr << "[shutdown] channel " << ch->channel()
+              << " registry_ready=" << (listener.readyAtomic().load() ? 1 : 0)
+              << " instruments=" << listener.ownedCount()
+              << " book_updates=" << ch->orderBookListener().updatedCount()
+              << " drops=" << ch->engine().drops() << " gated=" << ch->engine().gatedDrops()
+              << " delta_batches=" << listener.deltaBatches()
+              << " delta_added=" << listener.deltaAdded()
+              << " delta_changed=" << listener.deltaChanged();
+    if (ch->feedHost().pollFailed())
+      std::cerr << " poll_thread=FAILED";
+    std::cerr << "\n";
+  }
+
+  for (size_t i = 0; i < secdefCacheSavers.size(); ++i) {
+    auto &saver = *secdefCacheSavers[i];
+    const auto &listener = feedChannels[i]->instrumentListener();
+    saver.stop();
+    std::cerr << "[shutdown] secdef cache " << saver.path() << " saved=" << (saver.saved() ? 1 : 0)
+              << " saves=" << saver.saves() << " failures=" << saver.failures()
+              << " instruments=" << saver.savedCount()
+              << " preloaded=" << listener.preloadedCount()
+              << " added=" << listener.reconcileAdded()
+              << " changed=" << listener.reconcileChanged()
+              << " missing=" << listener.reconcileMissing() << "\n";
+  }
+
+  if (captureJournal) {
+    captureJournal->stop();
+    std::cerr << "[shutdown] capture journal " << captureJournal->path()
+              << " written=" << captureJournal->written() << " dropped=" << captureJournal->dropped()
+              << " write_errors=" << captureJournal->writeErrors()
+              << " bytes=" << captureJournal->bytesWritten() << "\n";
+  }
+
   std::cerr << "[shutdown] stopping pipeline...\n";
   pipeline.stop(true);
 
+  for (size_t t = 0; t < throttleIntervalsMs.size(); ++t) {
+    uint64_t offered = 0, emitted = 0, conflated = 0, untracked = 0;
+    for (uint32_t i = 0; i < pipeline.shardCount(); ++i) {
+      const auto &th = pipeline.worker(i).throttle(t);
+      offered += th.offered();
+      emitted += th.emitted();
+      conflated += th.conflated();
+      untracked += th.untracked();
+    }
+    std::cerr << "[shutdown] throttle " << pipeline.worker(0).throttlePrefix(t)
+              << " offered=" << offered << " emitted=" << emitted << " conflated=" << conflated
+              << " untracked=" << untracked << "\n";
+  }
+  if (!throttleIntervalsMs.empty()) {
+    uint64_t dropped = 0;
+    for (uint32_t i = 0; i < pipeline.shardCount(); ++i)
+      dropped += pipeline.worker(i).throttleDropped();
+    std::cerr << "[shutdown] throttle dropped=" << dropped << "\n";
+  }
+
+  if (staleBooks)
+    std::cerr << "[shutdown] stale books out_of_date="
+              << sumChannels([](const Channel &c) { return c.orderBookListener().outOfDateCount(); })
+              << " seq_gaps="
+              << sumChannels([](const Channel &c) { return c.bookRecoveryListener().gaps(); })
+              << " marked=" << sumChannels([](const Channel &c) { return c.engine().staleMarked(); })
+              << " suppressed="
+              << sumChannels([](const Channel &c) { return c.engine().staleSuppressed(); })
+              << " recovered="
+              << sumChannels([](const Channel &c) { return c.engine().staleRecovered(); })
+              << " still_stale=" << staleBooks->staleCount() << " marker_drops="
+              << sumChannels([](const Channel &c) { return c.engine().staleMarkerDrops(); })
+              << "\n";
+
+  const uint64_t tradesReceived =
+      sumChannels([](const Channel &c) { return c.tradeListener().trades(); });
+  const uint64_t tradeBusts = sumChannels([](const Channel &c) { return c.tradeListener().busts(); });
+  const uint64_t tradeEngineDrops =
+      sumChannels([](const Channel &c) { return c.engine().tradeDrops(); });
+  const uint64_t stateReceived =
+      sumChannels([](const Channel &c) { return c.marketStateListener().received(); });
+  const uint64_t stateEngineDrops =
+      sumChannels([](const Channel &c) { return c.engine().stateDrops(); });
+
+  if (tradeLane) {
+    tradeLane->stop(true);
+    std::cerr << "[shutdown] trades received=" << tradesReceived << " busts=" << tradeBusts
+              << " published=" << tradeLane->published() << " dropped=" << tradeLane->dropped()
+              << " engine_drops=" << tradeEngineDrops
+              << " priority_dropped=" << concentrator.priorityDropped() << "\n";
+    if (statsEngine)
+      std::cerr << "[shutdown] stats instruments=" << statsEngine->instruments() << " price_msgs="
+                << sumChannels([](const Channel &c) { return c.statisticsListener().received(); })
+                << " published=" << statsEngine->published()
+                << " dropped=" << statsEngine->dropped()
+                << " retried=" << statsEngine->retried()
+                << " overflow=" << statsEngine->overflow()
+                << " busts_ignored=" << statsEngine->bustsIgnored()
+                << " session_resets=" << statsEngine->sessionResets() << "\n";
+  }
+
+  if (stateLane) {
+    stateLane->stop(true);
+    std::cerr << "[shutdown] state msgs=" << stateReceived
+              << " instruments=" << stateTable->instruments() << " groups=" << stateTable->groups()
+              << " published=" << stateLane->published() << " dropped=" << stateLane->dropped()
+              << " engine_drops=" << stateEngineDrops << "\n";
+  }
+
+  if (serializerPool) {
+    std::cerr << "[shutdown] stopping serializer pool...\n";
+    serializerPool->stop(true);
+  }
+
   std::cerr << "[shutdown] stopping publisher concentrator...\n";
   concentrator.stop();
+  if (concentrator.batching())
+    std::cerr << "[shutdown] batch frames=" << concentrator.batchFrames()
+              << " updates=" << concentrator.batchedUpdates()
+              << " oversize=" << concentrator.batchOversize() << "\n";
+  if (shmRing) {
+    shmRing->stop();
+    std::cerr << "[shutdown] shm ring " << shmRing->name() << " written=" << shmRing->written()
+              << " oversize=" << shmRing->oversize() << "\n";
+  }
+
+  if (replayMode) {
+    const auto &ch = *feedChannels.front();
+    const double secs = std::chrono::duration<double>(replay.elapsed()).count();
+    const uint64_t updates = ch.orderBookListener().updatedCount();
+    const uint64_t published = concentrator.sentTotal() + concentrator.prioritySent() +
+                               (inlineSink ? inlineSink->sent() : 0);
+    if (!replay.error().empty())
+      std::cerr << "[replay] error: " << replay.error() << "\n";
+    std::cerr << "[replay] files=" << replay.files() << " wall=" << secs << "s"
+              << " registry_ready=" << (ch.instrumentListener().readyAtomic().load() ? 1 : 0)
+              << "\n";
+    std::cerr << "[replay] book_updates=" << updates << " (" << (secs > 0 ? updates / secs : 0)
+              << "/s) published=" << published << " (" << (secs > 0 ? published / secs : 0)
+              << "/s)\n";
+    std::cerr << "[replay] drops engine=" << ch.engine().drops()
+              << " gated=" << ch.engine().gatedDrops()
+              << " publish=" << concentrator.droppedTotal() << "\n";
+    if (tradeLane)
+      std::cerr << "[replay] trades=" << tradesReceived << " busts=" << tradeBusts
+                << " published=" << tradeLane->published()
+                << " dropped=" << tradeLane->dropped() + tradeEngineDrops << "\n";
+    if (stateLane)
+      std::cerr << "[replay] state msgs=" << stateReceived
+                << " published=" << stateLane->published()
+                << " dropped=" << stateLane->dropped() + stateEngineDrops << "\n";
+    printLatencyLine("end2end", endToEndLatency);
+    std::cerr << "[replay] end2end mean=" << endToEndLatency.mean() / 1e3 << "us\n";
+  }
 
   std::cerr << "[shutdown] done.\n";
-  return 0;
+  return replayMode && (!replay.finished() || !replay.error().empty()) ? 1 : 0;
 }
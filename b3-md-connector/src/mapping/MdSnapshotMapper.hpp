@@ -1,11 +1,19 @@
 #pragma once
 
 #include "../core/BookSnapshot.hpp"
+#include "../core/InstrumentStats.hpp"
+#include "../core/MarketStateTable.hpp"
+#include "../core/OrdersSnapshot.hpp"
+#include "../core/TradeEvent.hpp"
+#include "../publishing/CompactEnvelope.hpp"
 #include "../publishing/SerializedEnvelope.hpp"
 
+#include <charconv>
+#include <chrono>
 #include <cstdint>
 #include <cstring>
 #include <string>
+#include <string_view>
 
 // Protobuf (tu lib)
 #include <models/messages.pb.h>
@@ -13,10 +21,44 @@
 
 namespace b3::md::mapping {
 
+  // Lane de trades: topic "T.<SYMBOL>" (no colisiona por prefijo con el topic del libro) y
+  // message_type propio; el payload es un Book con solo instrument + last_trade.
+  inline constexpr char kTradeTopicPrefix[] = "T.";
+  inline constexpr std::string_view kMarketDataTradeType = "MarketDataTrade";
+
+  // Stats de sesión (MdStatsEngine): topic "S.<SYMBOL>", Book con los campos de estadística.
+  inline constexpr char kStatsTopicPrefix[] = "S.";
+  inline constexpr std::string_view kMarketDataStatsType = "MarketDataStats";
+
+  // Estado de mercado (MdStateLane): "M.<SYMBOL>" por instrumento, "G.<GROUP>" por grupo.
+  inline constexpr char kStateTopicPrefix[] = "M.";
+  inline constexpr char kGroupStateTopicPrefix[] = "G.";
+  inline constexpr std::string_view kMarketDataStateType = "MarketDataState";
+
+  // Libro desactualizado (onOrderBookOutOfDate / gap): mismo topic que el libro, sin niveles.
+  // El primer libro después de la recuperación sale como MarketDataUpdate con message_id
+  // kBookRefreshMessageId: reemplaza todo lo anterior.
+  inline constexpr std::string_view kMarketDataBookInvalidType = "MarketDataBookInvalid";
+  inline constexpr std::string_view kBookRefreshMessageId = "refresh";
+
   class MdSnapshotMapper {
    public:
     virtual ~MdSnapshotMapper() = default;
 
+    // Opcional (md.publish.embed_timestamps): epoch ns en texto en
+    //   transact_time_str = recepción del libro (callback OnixS), sending_time_str = serialización.
+    // sending_time_str NO es el envío al socket: el book todavía pasa por el concentrator.
+    // Lo usan test-client / benchmarks para latencia end-to-end; off por default para no
+    // cambiarle el formato de esos campos a consumidores existentes.
+    void setEmbedTimestamps(bool on) noexcept { embedTimestamps_ = on; }
+    bool embedTimestamps() const noexcept { return embedTimestamps_; }
+
+    // Opcional (md.publish.sequence_number): RptSeq del libro en Book.sequence_number de los
+    // books (test-client detecta gaps con eso). Off por default: el campo no se escribía y los
+    // consumidores existentes lo ven en 0.
+    void setBookSequence(bool on) noexcept { bookSequence_ = on; }
+    bool bookSequence() const noexcept { return bookSequence_; }
+
     virtual bool mapToSerializedEnvelope(const b3::md::BookSnapshot &s,
                                          b3::md::publishing::SerializedEnvelope &ev,
                                          const char* topic,
@@ -30,12 +72,18 @@ namespace b3::md::mapping {
 
       ev.size = 0;
 
+      const bool invalid = (s.flags & b3::md::OrdersSnapshot::kBookInvalid) != 0;
+
       WrapperMessage msg;
-      msg.set_message_type(std::string(MessageTypes::MarketDataUpdate));
+      msg.set_message_type(invalid ? std::string(kMarketDataBookInvalidType)
+                                   : std::string(MessageTypes::MarketDataUpdate));
 
       // C# usa ClientId como topic. Acá igual.
       msg.set_client_id(topic, topicLen);
-      msg.set_message_id(""); // opcional
+      if (s.flags & b3::md::OrdersSnapshot::kBookRefresh)
+        msg.set_message_id(std::string(kBookRefreshMessageId));
+      else
+        msg.set_message_id(""); // opcional
 
       auto *book = msg.mutable_market_data_update();
 
@@ -43,6 +91,10 @@ namespace b3::md::mapping {
       inst->set_symbol(topic, topicLen);
 
       book->set_is_aggregated(true);
+      if (bookSequence_)
+        book->set_sequence_number(static_cast<int64_t>(s.rptSeq));
+      if (embedTimestamps_)
+        setTimestamps(*book, s.exchangeTsNs);
       book->set_depth(static_cast<int32_t>((s.bidCount > s.askCount) ? s.bidCount : s.askCount));
 
       // Si bidCount/askCount ya vienen cappeados por DEPTH, no hace falta min().
@@ -73,6 +125,231 @@ namespace b3::md::mapping {
       std::memcpy(ev.topic, topic, topicLen);
       return true;
     }
+
+    // Trade -> CompactEnvelope (lane prioritaria). symbol = topic del libro, sin prefijo.
+    virtual bool mapTradeToEnvelope(const b3::md::TradeEvent &t,
+                                    b3::md::publishing::CompactEnvelope &ev, const char *symbol,
+                                    std::uint8_t symbolLen) const noexcept {
+      using ::markethub::messaging::WrapperMessage;
+      using ::markethub::messaging::trading::TradeType;
+
+      char topic[b3::md::publishing::CompactEnvelope::kMaxTopic];
+      const size_t topicLen = prefixedTopic(kTradeTopicPrefix, symbol, symbolLen, topic);
+      if (topicLen == 0)
+        return false;
+
+      ev.size = 0;
+
+      WrapperMessage msg;
+      msg.set_message_type(std::string(kMarketDataTradeType));
+      msg.set_client_id(topic, topicLen);
+
+      // TradeID identifica el trade (y el que anula un bust)
+      char id[16];
+      const auto idEnd = std::to_chars(id, id + sizeof(id), t.tradeId).ptr;
+      msg.set_message_id(id, static_cast<size_t>(idEnd - id));
+
+      auto *book = msg.mutable_market_data_update();
+      book->mutable_instrument()->set_symbol(symbol, symbolLen);
+      book->set_sequence_number(static_cast<int64_t>(t.rptSeq));
+      if (embedTimestamps_)
+        setTimestamps(*book, t.recvTsNs);
+
+      auto *trade = book->mutable_last_trade();
+      trade->set_price(t.priceMantissa / 10000.0);
+      trade->set_quantity(static_cast<double>(t.qty));
+      trade->set_entry_time(static_cast<int64_t>(t.transactTimeNs)); // epoch ns
+      trade->set_trade_type((t.condition & kTradeCondBlockTrade) ? TradeType::BLOCK_TRADE
+                                                                  : TradeType::REGULAR_TRADE);
+      trade->set_trade_condition(toString(t.kind));
+
+      return serializeCompact(msg, ev, topic, topicLen);
+    }
+
+    // Stats de sesión -> CompactEnvelope (timer de MdStatsEngine). Solo se setean los precios
+    // presentes (proto3: ausente = 0). message_id = cantidad de trades (el Book no tiene campo).
+    virtual bool mapStatsToEnvelope(const b3::md::InstrumentStats &st,
+                                    b3::md::publishing::CompactEnvelope &ev, const char *symbol,
+                                    std::uint8_t symbolLen) const noexcept {
+      using ::markethub::messaging::WrapperMessage;
+      using Flag = b3::md::InstrumentStats::Flag;
+
+      char topic[b3::md::publishing::CompactEnvelope::kMaxTopic];
+      const size_t topicLen = prefixedTopic(kStatsTopicPrefix, symbol, symbolLen, topic);
+      if (topicLen == 0)
+        return false;
+
+      ev.size = 0;
+
+      WrapperMessage msg;
+      msg.set_message_type(std::string(kMarketDataStatsType));
+      msg.set_client_id(topic, topicLen);
+
+      char count[24];
+      const auto countEnd = std::to_chars(count, count + sizeof(count), st.tradeCount).ptr;
+      msg.set_message_id(count, static_cast<size_t>(countEnd - count));
+
+      auto *book = msg.mutable_market_data_update();
+      book->mutable_instrument()->set_symbol(symbol, symbolLen);
+      book->set_sequence_number(static_cast<int64_t>(st.lastRptSeq));
+      if (embedTimestamps_)
+        setTimestamps(*book, st.lastTransactNs);
+
+      if (st.has(Flag::HasOpen))
+        book->set_opening_price(st.open / 10000.0);
+      if (st.has(Flag::HasHigh))
+        book->set_high_price(st.high / 10000.0);
+      if (st.has(Flag::HasLow))
+        book->set_low_price(st.low / 10000.0);
+      if (st.has(Flag::HasClose))
+        book->set_closing_price(st.close / 10000.0);
+      if (st.has(Flag::HasSettlement))
+        book->set_settlement_price(st.settlement / 10000.0);
+      if (st.has(Flag::HasLast)) {
+        auto *last = book->mutable_last_trade();
+        last->set_price(st.last / 10000.0);
+        last->set_quantity(static_cast<double>(st.lastQty));
+        last->set_entry_time(static_cast<int64_t>(st.lastTransactNs));
+      }
+      book->set_vwap_price(st.vwap());
+      book->set_trade_volume(static_cast<double>(st.volume));
+      book->set_turnover(st.notional);
+
+      return serializeCompact(msg, ev, topic, topicLen);
+    }
+
+    // Estado de un instrumento -> CompactEnvelope (MdStateLane, solo cuando cambia).
+    virtual bool mapStateToEnvelope(const b3::md::InstrumentMarketState &st,
+                                    b3::md::publishing::CompactEnvelope &ev, const char *symbol,
+                                    std::uint8_t symbolLen) const noexcept {
+      char topic[b3::md::publishing::CompactEnvelope::kMaxTopic];
+      const size_t topicLen = prefixedTopic(kStateTopicPrefix, symbol, symbolLen, topic);
+      if (topicLen == 0)
+        return false;
+
+      ev.size = 0;
+      ::markethub::messaging::WrapperMessage msg;
+      msg.set_client_id(topic, topicLen);
+      fillInstrumentState(msg, st, symbol, symbolLen);
+      return serializeCompact(msg, ev, topic, topicLen);
+    }
+
+    // Fase de un grupo -> CompactEnvelope. Instrument.symbol = código de grupo.
+    virtual bool mapGroupStateToEnvelope(const b3::md::GroupMarketState &gs,
+                                         b3::md::publishing::CompactEnvelope &ev) const noexcept {
+      const auto nameLen = static_cast<std::uint8_t>(::strnlen(gs.name, sizeof(gs.name)));
+      char topic[b3::md::publishing::CompactEnvelope::kMaxTopic];
+      const size_t topicLen = prefixedTopic(kGroupStateTopicPrefix, gs.name, nameLen, topic);
+      if (topicLen == 0)
+        return false;
+
+      ev.size = 0;
+      ::markethub::messaging::WrapperMessage msg;
+      msg.set_message_type(std::string(kMarketDataStateType));
+      msg.set_client_id(topic, topicLen);
+      auto *status = msg.mutable_security_status_response()->add_security_statuses();
+      status->mutable_instrument()->set_symbol(gs.name, nameLen);
+      status->set_security_trading_status(toProtoStatus(gs.phase));
+      return serializeCompact(msg, ev, topic, topicLen);
+    }
+
+    /**
+     * Mensaje de estado de un instrumento (publicado y respuesta a SecurityStatusRequest):
+     * - security_status_response.security_statuses[0]: symbol + status efectivo
+     * - market_data_update (Book), solo lo que el exchange informó:
+     *     auction_clearing_price / nominal_volume = precio / cantidad teórica de apertura
+     *     imbalance = cantidad desbalanceada (+ compradores, - vendedores)
+     *     low_price / high_price / fixing_price = banda de precio (límites y referencia)
+     *     trade_volume / open_interest = banda de cantidad (promedio diario / máximo por trade)
+     * El Book no tiene campos propios para subasta ni bandas: se reusan estos, documentados.
+     */
+    static void fillInstrumentState(::markethub::messaging::WrapperMessage &msg,
+                                    const b3::md::InstrumentMarketState &st, const char *symbol,
+                                    std::uint8_t symbolLen) {
+      const b3::md::PublishedMarketState &v = st.view;
+      msg.set_message_type(std::string(kMarketDataStateType));
+
+      auto *status = msg.mutable_security_status_response()->add_security_statuses();
+      status->mutable_instrument()->set_symbol(symbol, symbolLen);
+      status->set_security_trading_status(toProtoStatus(v.status));
+
+      auto *book = msg.mutable_market_data_update();
+      book->mutable_instrument()->set_symbol(symbol, symbolLen);
+      book->set_sequence_number(static_cast<int64_t>(st.lastRptSeq));
+      if (v.hasTop) {
+        book->set_auction_clearing_price(v.topPrice / 10000.0);
+        book->set_nominal_volume(static_cast<double>(v.topQty));
+      }
+      if (v.hasImbalance)
+        book->set_imbalance(static_cast<double>(v.imbalanceQty));
+      if (v.hasBand) {
+        book->set_low_price(v.bandLow / 10000.0);
+        book->set_high_price(v.bandHigh / 10000.0);
+        book->set_fixing_price(v.bandRef / 10000.0);
+      }
+      if (v.hasQtyBand) {
+        book->set_trade_volume(static_cast<double>(v.avgDailyQty));
+        book->set_open_interest(static_cast<double>(v.maxTradeVol));
+      }
+    }
+
+    // SecurityTradingStatus de B3 usa los números de FIX 326, igual que el enum del proto.
+    static ::markethub::messaging::trading::SecurityTradingStatus
+    toProtoStatus(uint8_t b3Status) noexcept {
+      using ::markethub::messaging::trading::SecurityTradingStatus;
+      if (b3Status == 0)
+        return ::markethub::messaging::trading::SECURITY_TRADING_STATUS_UNSPECIFIED;
+      if (!::markethub::messaging::trading::SecurityTradingStatus_IsValid(b3Status))
+        return ::markethub::messaging::trading::UNKNOWN_OR_INVALID;
+      return static_cast<SecurityTradingStatus>(b3Status);
+    }
+
+   private:
+    // prefix + symbol en out (kMaxTopic); 0 si no entra o symbol vacío.
+    static size_t prefixedTopic(std::string_view prefix, const char *symbol,
+                                std::uint8_t symbolLen, char *out) noexcept {
+      if (symbolLen == 0 ||
+          prefix.size() + symbolLen > b3::md::publishing::CompactEnvelope::kMaxTopic)
+        return 0;
+      std::memcpy(out, prefix.data(), prefix.size());
+      std::memcpy(out + prefix.size(), symbol, symbolLen);
+      return prefix.size() + symbolLen;
+    }
+
+    static bool serializeCompact(const ::markethub::messaging::WrapperMessage &msg,
+                                 b3::md::publishing::CompactEnvelope &ev, const char *topic,
+                                 size_t topicLen) noexcept {
+      const int size = msg.ByteSizeLong();
+      if (size <= 0 ||
+          static_cast<size_t>(size) > b3::md::publishing::CompactEnvelope::kMaxBytes)
+        return false;
+
+      if (!msg.SerializeToArray(ev.bytes, size))
+        return false;
+
+      ev.size = static_cast<uint16_t>(size);
+      ev.topicLen = static_cast<uint8_t>(topicLen);
+      std::memcpy(ev.topic, topic, topicLen);
+      return true;
+    }
+
+    // transact_time_str = ingreso (callback OnixS), sending_time_str = ahora (serialización, no
+    // el envío)
+    static void setTimestamps(::markethub::messaging::trading::Book &book,
+                              uint64_t sourceNs) noexcept {
+      const auto sendNs = static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::system_clock::now().time_since_epoch())
+              .count());
+      char buf[24];
+      auto r = std::to_chars(buf, buf + sizeof(buf), sourceNs);
+      book.set_transact_time_str(buf, static_cast<size_t>(r.ptr - buf));
+      r = std::to_chars(buf, buf + sizeof(buf), sendNs);
+      book.set_sending_time_str(buf, static_cast<size_t>(r.ptr - buf));
+    }
+
+    bool embedTimestamps_{false};
+    bool bookSequence_{false};
   };
 
 } // namespace b3::md::mapping
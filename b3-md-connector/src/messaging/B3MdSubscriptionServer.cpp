@@ -1,10 +1,16 @@
 #include "B3MdSubscriptionServer.hpp"
+#include "../mapping/MdSnapshotMapper.hpp"
 
+#include <algorithm>
+#include <exception>
+#include <string_view>
 #include <type_traits>
 #include <utility>
+#include <vector>
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/message.h>
 #include <google/protobuf/reflection.h>
+#include <google/protobuf/unknown_field_set.h>
 
 using markethub::messaging::WrapperMessage;
 using markethub::messaging::models::MessageTypes;
@@ -51,183 +57,87 @@ namespace {
       r->set_original_request_id(s);
   }
 
-  // Intenta setear un string field (si existe y es string)
-  inline void set_string_if_exists(::google::protobuf::Message *m, const char *fieldName,
-                                   std::string_view v) {
-    if (!m)
-      return;
-    const auto *d = m->GetDescriptor();
-    const auto *r = m->GetReflection();
-    if (!d || !r)
-      return;
-
-    const auto *f = d->FindFieldByName(fieldName);
-    if (!f)
-      return;
-    if (f->cpp_type() != ::google::protobuf::FieldDescriptor::CPPTYPE_STRING)
-      return;
-
-    r->SetString(m, f, std::string(v));
-  }
-
-  // Intenta setear un uint64 field (si existe y es uint64/int64/int32/uint32)
-  inline void set_u64_if_exists(::google::protobuf::Message *m, const char *fieldName,
-                                std::uint64_t v) {
-    if (!m)
-      return;
-    const auto *d = m->GetDescriptor();
-    const auto *r = m->GetReflection();
-    if (!d || !r)
-      return;
-
-    const auto *f = d->FindFieldByName(fieldName);
-    if (!f)
-      return;
-
-    using FD = ::google::protobuf::FieldDescriptor;
-    switch (f->cpp_type()) {
-      case FD::CPPTYPE_UINT64:
-        r->SetUInt64(m, f, v);
-        break;
-      case FD::CPPTYPE_INT64:
-        r->SetInt64(m, f, static_cast<std::int64_t>(v));
-        break;
-      case FD::CPPTYPE_UINT32:
-        r->SetUInt32(m, f, static_cast<std::uint32_t>(v));
-        break;
-      case FD::CPPTYPE_INT32:
-        r->SetInt32(m, f, static_cast<std::int32_t>(v));
-        break;
-      default:
-        break;
+  // SecurityType del proto -> códigos B3 (InstrumentData::securityType guarda el enum SBE como
+  // número: CASH=1 CORP=2 CS=3 DTERM=4 ETF=5 FOPT=6 FORWARD=7 FUT=8 INDEX=9 INDEXOPT=10 MLEG=11
+  // OPT=12 OPTEXER=13 PS=14 SECLOAN=15 SOPT=16 SPOT=17). false = tipo sin equivalente en B3.
+  static bool b3SecurityTypes(::markethub::messaging::trading::SecurityType t,
+                              std::vector<std::string> &out) {
+    using namespace ::markethub::messaging::trading;
+    switch (t) {
+    case COMMON_STOCK:
+      out = {"3", "14"};
+      return true;
+    case OPTION:
+      out = {"12", "16", "6", "10"};
+      return true;
+    case FUTURE_:
+      out = {"8"};
+      return true;
+    case INDEX_:
+      out = {"9"};
+      return true;
+    case CORPORATE_BOND:
+      out = {"2"};
+      return true;
+    case COMPLEX_OPTION:
+      out = {"11"};
+      return true;
+    case INVESTMENT_FUND:
+      out = {"5"};
+      return true;
+    default:
+      return false;
     }
   }
 
-  // Agrega un Instrument al map "securities" (key = symbol, value = Security message)
-  // Legacy version with minimal fields (symbol + iid only)
-  inline void add_instrument_best_effort(
-      ::markethub::messaging::trading::SecurityListResponse *resp, std::uint64_t iid,
-      const std::string &symbol) {
-    if (!resp)
-      return;
-
-    auto *securitiesMap = resp->mutable_securities();
-    if (!securitiesMap)
-      return;
-
-    auto &security = (*securitiesMap)[symbol];
-
-    // Set minimal fields using reflection
-    set_string_if_exists(&security, "symbol", symbol);
-    set_string_if_exists(&security, "ticker", symbol);
-    set_string_if_exists(&security, "code", symbol);
-
-    set_u64_if_exists(&security, "security_id", iid);
-    set_u64_if_exists(&security, "instrument_id", iid);
-    set_u64_if_exists(&security, "id", iid);
+  // Símbolo de suscripción que se expande a varios instrumentos ("PETR*", "@PETR4")
+  static bool isSubscriptionPattern(std::string_view symbol) {
+    return symbol.size() > 1 && (symbol.back() == '*' || symbol.front() == '@');
   }
 
-  // Full version with complete InstrumentData mapping
-  inline void add_instrument_full(::markethub::messaging::trading::SecurityListResponse *resp,
-                                   const b3::common::InstrumentData &data) {
-    if (!resp || data.symbol.empty())
-      return;
-
-    auto *securitiesMap = resp->mutable_securities();
-    if (!securitiesMap)
-      return;
-
-    auto &security = (*securitiesMap)[data.symbol];
-
-    // Core identification
-    set_string_if_exists(&security, "symbol", data.symbol);
-    set_string_if_exists(&security, "ticker", data.symbol);
-    set_u64_if_exists(&security, "security_id", data.securityId);
-    set_u64_if_exists(&security, "instrument_id", data.securityId);
-    set_string_if_exists(&security, "exchange", data.securityExchange);
-
-    // Classification
-    set_string_if_exists(&security, "security_type", data.securityType);
-    set_string_if_exists(&security, "security_group", data.securityGroup);
-    set_string_if_exists(&security, "asset", data.asset);
-    set_string_if_exists(&security, "cfi_code", data.cfiCode);
-    set_string_if_exists(&security, "market_segment_id", data.marketSegmentId);
-
-    // Trading parameters
-    if (data.governanceIndicator != 0) {
-      set_u64_if_exists(&security, "governance_indicator", data.governanceIndicator);
-    }
-    if (data.securityMatchType != 0) {
-      set_u64_if_exists(&security, "security_match_type", static_cast<uint64_t>(data.securityMatchType));
-    }
-
-    // Price specifications (convert mantissa to decimal if protobuf expects double)
-    if (data.minPriceIncrement != 0) {
-      // Assuming protobuf uses double for price - convert from mantissa
-      double tickSize = data.minPriceIncrement / 10000.0;
-      // set_double_if_exists(&security, "tick_size", tickSize);
-      // Or keep as mantissa if protobuf uses int64
-      set_u64_if_exists(&security, "min_price_increment", static_cast<uint64_t>(data.minPriceIncrement));
-    }
-
-    if (data.strikePrice != 0) {
-      double strike = data.strikePrice / 10000.0;
-      // set_double_if_exists(&security, "strike_price", strike);
-      set_u64_if_exists(&security, "strike_price_mantissa", static_cast<uint64_t>(data.strikePrice));
-    }
-
-    if (data.minPriceIncrementAmount != 0) {
-      set_u64_if_exists(&security, "min_price_increment_amount", static_cast<uint64_t>(data.minPriceIncrementAmount));
-    }
-
-    // Quantity specifications
-    if (data.minOrderQty != 0) {
-      set_u64_if_exists(&security, "min_order_qty", static_cast<uint64_t>(data.minOrderQty));
-    }
-    if (data.maxOrderQty != 0) {
-      set_u64_if_exists(&security, "max_order_qty", static_cast<uint64_t>(data.maxOrderQty));
-    }
-    if (data.lotSize != 0) {
-      set_u64_if_exists(&security, "lot_size", static_cast<uint64_t>(data.lotSize));
-    }
-    if (data.minTradeVol != 0) {
-      set_u64_if_exists(&security, "min_trade_vol", static_cast<uint64_t>(data.minTradeVol));
-    }
-
-    // Derivatives fields
-    if (data.underlyingSecurityId != 0) {
-      set_u64_if_exists(&security, "underlying_security_id", data.underlyingSecurityId);
-    }
-    set_string_if_exists(&security, "underlying_symbol", data.underlyingSymbol);
-
-    if (data.maturityDate != 0) {
-      set_u64_if_exists(&security, "maturity_date", static_cast<uint64_t>(data.maturityDate));
-    }
-
-    // Options fields
-    if (data.putOrCall != 0) {
-      set_u64_if_exists(&security, "put_or_call", static_cast<uint64_t>(data.putOrCall));
-    }
-    if (data.exerciseStyle != 0) {
-      set_u64_if_exists(&security, "exercise_style", static_cast<uint64_t>(data.exerciseStyle));
+  // "PETR4, VALE3,WIN*" -> f("PETR4"), f("VALE3"), f("WIN*"); items vacíos se ignoran
+  template <class F>
+  static void forEachListedSymbol(std::string_view list, F &&f) {
+    while (!list.empty()) {
+      const auto comma = list.find(',');
+      auto item = list.substr(0, comma);
+      while (!item.empty() && item.front() == ' ')
+        item.remove_prefix(1);
+      while (!item.empty() && item.back() == ' ')
+        item.remove_suffix(1);
+      if (!item.empty())
+        f(item);
+      if (comma == std::string_view::npos)
+        break;
+      list.remove_prefix(comma + 1);
     }
+  }
 
-    // Flags and settlement
-    if (data.hasCorporateAction) {
-      set_u64_if_exists(&security, "corporate_action_event_id", data.corporateActionEventId);
-    }
-    if (data.isMultileg) {
-      set_u64_if_exists(&security, "is_multileg", 1);
-    }
-    set_string_if_exists(&security, "settlement_type", data.settlementType);
-    if (data.productComplex != 0) {
-      set_u64_if_exists(&security, "product_complex", static_cast<uint64_t>(data.productComplex));
+  // SecurityListRequest -> consulta sobre el índice. symbol con '*' final = prefijo;
+  // security_list_request_type PRODUCT + symbol = derivativos de ese subyacente. false = ningún
+  // instrumento puede matchear (tipo o subyacente desconocido).
+  static bool toSecurityListQuery(const ::markethub::messaging::trading::SecurityListRequest &r,
+                                  const b3::md::SecurityListIndex &index,
+                                  b3::md::SecurityListQuery &q) {
+    using namespace ::markethub::messaging::trading;
+    std::string_view symbol = r.symbol();
+    if (r.security_list_request_type() == PRODUCT && !symbol.empty()) {
+      const uint32_t row = index.findSymbol(symbol);
+      if (row == index.size())
+        return false;
+      q.underlyingSecurityId = index.id(row);
+    } else if (!symbol.empty() && symbol.back() == '*') {
+      q.symbolPrefix = symbol.substr(0, symbol.size() - 1);
+    } else {
+      q.symbol = symbol;
     }
 
-    // Additional info
-    set_string_if_exists(&security, "currency", data.currency);
-    set_string_if_exists(&security, "isin", data.isin);
-    set_string_if_exists(&security, "description", data.securityDesc);
+    q.marketSegmentId = r.market_segment_id();
+    q.cfiCode = r.cfi_code();
+    q.securityExchange = r.security_exchange();
+    if (r.security_type() != SECURITY_TYPE_UNSPECIFIED && !b3SecurityTypes(r.security_type(), q.securityTypes))
+      return false;
+    return true;
   }
 
 } // namespace
@@ -240,49 +150,181 @@ namespace b3::md::messaging {
                                                  b3::md::SubscriptionRegistry &subs,
                                                  b3::md::IMarketDataHandler &handler,
                                                  LogCallback logCb)
-      : SubscriberPublisher(serverEndpoint, publishingEndpoint, std::move(logCb)),
+      : SubscriberPublisher(serverEndpoint, publishingEndpoint, logCb),
         registry_(registry),
         subs_(subs),
-        handler_(handler) {}
+        handler_(handler),
+        log_(std::move(logCb)),
+        listCache_(registry) {
+    const WrapperMessage proto;
+    const auto *d = proto.GetDescriptor();
+    const auto *f = d ? d->FindFieldByName("security_list_response") : nullptr;
+    securityListField_ = f ? f->number() : 0;
+  }
 
-  std::unique_ptr<WrapperMessage> B3MdSubscriptionServer::HandleMessage(
+  void B3MdSubscriptionServer::setSubscriptionExecutor(b3::md::SubscriptionExecutor *executor) {
+    executor_ = executor;
+    if (executor_) {
+      executor_->setFailureCallback([this](std::uint64_t iid, bool subscribe, const char *what) {
+        OnHandlerFailure(iid, subscribe, what);
+      });
+    }
+  }
+
+  // El handler no aplicó el iid. Subscribe: nadie recibe ese instrumento, así que se descartan
+  // sus referencias (si no, el próximo subscribe ve refcount > 0 y nunca reintenta). Unsubscribe:
+  // el feed sigue llegando sin suscriptores; solo se loguea.
+  void B3MdSubscriptionServer::OnHandlerFailure(std::uint64_t iid, bool subscribe,
+                                                const char *what) {
+    if (subscribe)
+      subs_.reset(iid);
+    if (log_)
+      log_("error", std::string(subscribe ? "subscribe" : "unsubscribe") +
+                        " failed iid=" + std::to_string(iid) + ": " + (what ? what : "") +
+                        (subscribe ? " (refcount reset)" : ""));
+  }
+
+  void B3MdSubscriptionServer::Start() {
+    listCache_.start();
+    SubscriberPublisher::Start();
+  }
+
+  void B3MdSubscriptionServer::Stop() {
+    SubscriberPublisher::Stop();
+    listCache_.stop();
+  }
+
+  // La lista sale del cache (armada una vez por versión del registry, fuera de este thread).
+  // Pre-encoded: el body va como bytes ya serializados en el campo security_list_response
+  // (unknown field con el mismo número); el request_id viaja en un segundo fragmento del mismo
+  // campo, que el parser protobuf mergea con el primero. Con filtros o paginado los bytes son la
+  // concatenación de las entries pre-serializadas de las filas que matchean.
+  std::vector<std::unique_ptr<WrapperMessage>> B3MdSubscriptionServer::BuildSecurityListResponses(
       const WrapperMessage &request) {
-    // -----------------------------
-    // 1) SECURITY LIST
-    // -----------------------------
-    if (request.message_type() == std::string(MessageTypes::SecurityListRequest)) {
-      if (!request.has_security_list_request()) {
-        return nullptr;
-      }
+    std::vector<std::unique_ptr<WrapperMessage>> out;
+    if (!request.has_security_list_request()) {
+      return out;
+    }
+
+    // if (!registryReady_ || !registryReady_->load(std::memory_order_acquire)) { ... }
 
-      // if (!registryReady_ || !registryReady_->load(std::memory_order_acquire)) { ... }
+    const auto &r = request.security_list_request();
+    const auto snap = listCache_.current();
 
+    const auto makeResponse = [&]() {
       auto resp = std::make_unique<WrapperMessage>();
       resp->set_message_id(request.message_id());
       resp->set_client_id(request.client_id());
       resp->set_message_type(std::string(MessageTypes::SecurityListResponse));
+      return resp;
+    };
+
+    // El modo lo fija el snapshot: trae bytes o mensaje, no los dos.
+    const bool preEncoded = snap->preEncoded;
+    const auto addEncoded = [&](WrapperMessage &resp, const std::string &bytes) {
+      auto *unknown = resp.GetReflection()->MutableUnknownFields(&resp);
+      unknown->AddLengthDelimited(securityListField_)->assign(bytes);
+
+      ::markethub::messaging::trading::SecurityListResponse tail;
+      set_request_id_if_exists(&tail, r.request_id());
+      tail.SerializeToString(unknown->AddLengthDelimited(securityListField_));
+    };
+
+    b3::md::SecurityListQuery query;
+    const bool satisfiable = toSecurityListQuery(r, snap->index, query);
+
+    // Lista entera en un mensaje: el camino de siempre, sin pasar por el índice
+    if (satisfiable && query.unfiltered() && securityListPageSize_ == 0) {
+      auto resp = makeResponse();
+      if (preEncoded) {
+        addEncoded(*resp, snap->bytes);
+      } else {
+        auto *body = resp->mutable_security_list_response();
+        *body = snap->message;
+        set_request_id_if_exists(body, r.request_id());
+        set_ok_if_exists(body, true);
+      }
+      out.push_back(std::move(resp));
+      return out;
+    }
 
-      auto *body = resp->mutable_security_list_response();
-
-      const auto &r = request.security_list_request();
-      set_request_id_if_exists(body, r.request_id());
-
-      // Tomamos snapshot completo con todos los campos
-      auto items = registry_.snapshotAllFull();
+    std::vector<uint32_t> rows;
+    if (satisfiable)
+      rows = snap->index.select(query).rows;
+
+    const size_t chunk = securityListPageSize_ == 0 ? rows.size() : securityListPageSize_;
+    size_t next = 0;
+    do {
+      const size_t end = std::min(rows.size(), next + chunk);
+      auto resp = makeResponse();
+      if (preEncoded) {
+        std::string bytes;
+        for (size_t i = next; i < end; ++i)
+          bytes += snap->entries[rows[i]];
+        addEncoded(*resp, bytes);
+      } else {
+        auto *body = resp->mutable_security_list_response();
+        auto *securities = body->mutable_securities();
+        const auto &all = snap->message.securities();
+        for (size_t i = next; i < end; ++i) {
+          const auto &symbol = snap->index.data(rows[i]).symbol;
+          auto it = all.find(symbol);
+          if (it != all.end())
+            (*securities)[symbol] = it->second;
+        }
+        set_request_id_if_exists(body, r.request_id());
+        set_ok_if_exists(body, true);
+      }
+      out.push_back(std::move(resp));
+      next = end;
+    } while (next < rows.size());
+
+    // Paginado: una respuesta vacía cierra el stream (si el resultado ya era vacío, es esa misma)
+    if (securityListPageSize_ != 0 && !rows.empty()) {
+      auto resp = makeResponse();
+      if (preEncoded) {
+        addEncoded(*resp, std::string{});
+      } else {
+        auto *body = resp->mutable_security_list_response();
+        set_request_id_if_exists(body, r.request_id());
+        set_ok_if_exists(body, true);
+      }
+      out.push_back(std::move(resp));
+    }
+    return out;
+  }
 
-      // OK si hay algo (o siempre ok; vos definís)
-      set_ok_if_exists(body, true);
+  // Todas menos la última se envían acá, en orden; la última vuelve por HandleMessage.
+  std::unique_ptr<WrapperMessage> B3MdSubscriptionServer::HandleSecurityList(
+      const WrapperMessage &request) {
+    auto responses = BuildSecurityListResponses(request);
+    if (responses.empty()) {
+      return nullptr;
+    }
+    for (size_t i = 0; i + 1 < responses.size(); ++i) {
+      SendMessage(*responses[i]);
+    }
+    return std::move(responses.back());
+  }
 
-      // Poblar lista con todos los campos disponibles
-      for (const auto &kv : items) {
-        add_instrument_full(body, kv.second);
-      }
+  std::unique_ptr<WrapperMessage> B3MdSubscriptionServer::HandleMessage(
+      const WrapperMessage &request) {
+    // -----------------------------
+    // 1) SECURITY LIST
+    // -----------------------------
+    if (request.message_type() == std::string(MessageTypes::SecurityListRequest)) {
+      return HandleSecurityList(request);
+    }
 
-      return resp;
+    // -----------------------------
+    // 2) SECURITY STATUS (estado de mercado vigente)
+    // -----------------------------
+    if (request.message_type() == std::string(MessageTypes::SecurityStatusRequest)) {
+      return HandleSecurityStatus(request);
     }
 
     // -----------------------------
-    // 2) MARKET DATA SUBSCRIPTION (tu lógica actual)
+    // 3) MARKET DATA SUBSCRIPTION (tu lógica actual)
     // -----------------------------
     if (request.message_type() != std::string(MessageTypes::MarketDataSuscriptionRequest)) {
       return nullptr;
@@ -311,8 +353,14 @@ namespace b3::md::messaging {
       return resp;
     }
 
-    const auto *iid = registry_.tryResolveId(symbol);
-    if (!iid) {
+    const auto t = r.subscription_request_type();
+    const bool enable = (t == ::markethub::messaging::trading::SNAPSHOT ||
+                         t == ::markethub::messaging::trading::SNAPSHOT_PLUS_UPDATES);
+    const bool disable =
+        (t == ::markethub::messaging::trading::DISABLE_PREVIOUS ||
+         t == ::markethub::messaging::trading::DISABLE_PREVIOUS_SNAPSHOT_PLUS_UPDATE_REQUEST);
+
+    if (!enable && !disable) {
       auto resp = std::make_unique<WrapperMessage>();
       resp->set_message_id(request.message_id());
       resp->set_client_id(request.client_id());
@@ -321,28 +369,55 @@ namespace b3::md::messaging {
       auto *body = resp->mutable_market_data_suscription_response();
       set_request_id_if_exists(body, r.request_id());
       set_ok_if_exists(body, false);
-      set_error_if_exists(body, "Symbol is not on security list: " + symbol);
+      set_error_if_exists(body, "Unsupported subscription_request_type");
       return resp;
     }
 
-    const auto t = r.subscription_request_type();
-    const bool enable = (t == ::markethub::messaging::trading::SNAPSHOT ||
-                         t == ::markethub::messaging::trading::SNAPSHOT_PLUS_UPDATES);
-    const bool disable =
-        (t == ::markethub::messaging::trading::DISABLE_PREVIOUS ||
-         t == ::markethub::messaging::trading::DISABLE_PREVIOUS_SNAPSHOT_PLUS_UPDATE_REQUEST);
+    // Batch: "PETR4,VALE3,WIN*" = un solo request/response. Cada item se resuelve por separado
+    // (símbolo, prefijo o subyacente); los que no resuelven se informan sin frenar al resto.
+    // Los patrones guardan lo que resolvieron por cliente: el unsubscribe suelta exactamente ese
+    // set, no lo que el patrón expandiría hoy (el índice pudo cambiar entre medio).
+    std::vector<std::uint64_t> targets;
+    std::vector<std::uint64_t> patternAdded;
+    std::vector<std::uint64_t> patternReleased;
+    std::vector<std::string_view> rejected;
+    size_t items = 0;
+    forEachListedSymbol(symbol, [&](std::string_view item) {
+      ++items;
+      if (!isSubscriptionPattern(item)) {
+        if (!ResolveSubscriptionTargets(item, r.instrument().security_type(), targets))
+          rejected.push_back(item);
+        return;
+      }
 
-    if (enable) {
-      const bool first = subs_.add(*iid);
-      if (first) {
-        handler_.subscribe(static_cast<std::uint64_t>(*iid));
+      const std::string key = patternKey(request.client_id(), r.instrument().security_type(), item);
+      if (disable) {
+        auto it = patternSubs_.find(key);
+        if (it == patternSubs_.end()) {
+          rejected.push_back(item);
+          return;
+        }
+        patternReleased.insert(patternReleased.end(), it->second.begin(), it->second.end());
+        patternSubs_.erase(it);
+        return;
       }
-    } else if (disable) {
-      const bool last = subs_.remove(*iid);
-      if (last) {
-        handler_.unsubscribe(static_cast<std::uint64_t>(*iid));
+
+      std::vector<std::uint64_t> resolved;
+      if (!ResolveSubscriptionTargets(item, r.instrument().security_type(), resolved)) {
+        rejected.push_back(item);
+        return;
       }
-    } else {
+      // Repetir el patrón solo suma las series nuevas: una referencia por (cliente, patrón)
+      auto &held = patternSubs_[key];
+      for (const auto iid : resolved) {
+        if (std::find(held.begin(), held.end(), iid) == held.end()) {
+          held.push_back(iid);
+          patternAdded.push_back(iid);
+        }
+      }
+    });
+
+    if (rejected.size() == items) {
       auto resp = std::make_unique<WrapperMessage>();
       resp->set_message_id(request.message_id());
       resp->set_client_id(request.client_id());
@@ -351,10 +426,61 @@ namespace b3::md::messaging {
       auto *body = resp->mutable_market_data_suscription_response();
       set_request_id_if_exists(body, r.request_id());
       set_ok_if_exists(body, false);
-      set_error_if_exists(body, "Unsupported subscription_request_type");
+      if (items == 1) {
+        const std::string item(rejected.front());
+        if (!isSubscriptionPattern(item))
+          set_error_if_exists(body, "Symbol is not on security list: " + item);
+        else if (disable)
+          set_error_if_exists(body, "Not subscribed: " + item);
+        else
+          set_error_if_exists(body, "No instruments match: " + item);
+      } else {
+        set_error_if_exists(body, "No symbol on security list: " + symbol);
+      }
       return resp;
     }
 
+    // Un símbolo repetido en el batch ("PETR4,PETR4") cuenta una sola vez. Los patrones tienen
+    // su propia referencia, aparte de la del símbolo suelto ("PETR*,PETR4" = dos).
+    std::sort(targets.begin(), targets.end());
+    targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+    targets.insert(targets.end(), enable ? patternAdded.begin() : patternReleased.begin(),
+                   enable ? patternAdded.end() : patternReleased.end());
+
+    // El refcount se actualiza acá; las llamadas al handler (transiciones 0<->1) van al executor
+    std::vector<std::uint64_t> toSubscribe;
+    std::vector<std::uint64_t> toUnsubscribe;
+    for (const auto iid : targets) {
+      if (enable ? subs_.add(iid) : subs_.remove(iid)) {
+        (enable ? toSubscribe : toUnsubscribe).push_back(iid);
+      }
+    }
+
+    // Inline (sin executor o sin arrancar) se sabe ya qué falló y la respuesta no dice ok por
+    // eso. Con el executor corriendo la respuesta sale antes: las fallas van a OnHandlerFailure.
+    std::vector<std::uint64_t> failed;
+    if (executor_) {
+      failed = executor_->submit(toSubscribe, toUnsubscribe);
+    } else {
+      auto apply = [&](std::uint64_t iid, bool subscribe) {
+        try {
+          subscribe ? handler_.subscribe(iid) : handler_.unsubscribe(iid);
+          return;
+        } catch (const std::exception &e) {
+          OnHandlerFailure(iid, subscribe, e.what());
+        } catch (...) {
+          OnHandlerFailure(iid, subscribe, "unknown exception");
+        }
+        failed.push_back(iid);
+      };
+      for (const auto iid : toSubscribe) {
+        apply(iid, true);
+      }
+      for (const auto iid : toUnsubscribe) {
+        apply(iid, false);
+      }
+    }
+
     auto resp = std::make_unique<WrapperMessage>();
     resp->set_message_id(request.message_id());
     resp->set_client_id(request.client_id());
@@ -362,7 +488,113 @@ namespace b3::md::messaging {
 
     auto *body = resp->mutable_market_data_suscription_response();
     set_request_id_if_exists(body, r.request_id());
-    set_ok_if_exists(body, true);
+    set_ok_if_exists(body, rejected.empty() && failed.empty());
+    std::string error;
+    if (!rejected.empty()) {
+      error = "Rejected " + std::to_string(rejected.size()) + " of " + std::to_string(items) + ":";
+      for (const auto item : rejected) {
+        error += ' ';
+        error += item;
+      }
+    }
+    if (!failed.empty()) {
+      if (!error.empty())
+        error += "; ";
+      error += "Handler failed for " + std::to_string(failed.size()) + " instrument(s)";
+    }
+    if (!error.empty())
+      set_error_if_exists(body, error);
+    return resp;
+  }
+
+  std::string B3MdSubscriptionServer::patternKey(
+      std::string_view clientId, ::markethub::messaging::trading::SecurityType type,
+      std::string_view pattern) {
+    std::string key(clientId);
+    key += '\n';
+    key += std::to_string(static_cast<int>(type));
+    key += '\n';
+    key += pattern;
+    return key;
+  }
+
+  // "PETR*" = prefijo, "@PETR4" = derivativos de PETR4; en ambos el security_type del instrument,
+  // si viene, acota (p.ej. "@PETR4" + OPTION = la cadena de opciones). Se expande sobre el índice
+  // de la versión vigente: series que aparezcan después necesitan otro request. Símbolo simple:
+  // lookup directo en el registry, como siempre. `out` acumula todo el batch: el resultado es
+  // si ESTE item agregó algo.
+  bool B3MdSubscriptionServer::ResolveSubscriptionTargets(
+      std::string_view symbol, ::markethub::messaging::trading::SecurityType type,
+      std::vector<std::uint64_t> &out) {
+    if (!isSubscriptionPattern(symbol)) {
+      const auto iid = registry_.tryResolveId(symbol);
+      if (!iid)
+        return false;
+      out.push_back(static_cast<std::uint64_t>(*iid));
+      return true;
+    }
+
+    const auto snap = listCache_.current();
+    const auto &index = snap->index;
+
+    b3::md::SecurityListQuery query;
+    if (symbol.front() == '@') {
+      const uint32_t row = index.findSymbol(symbol.substr(1));
+      if (row == index.size())
+        return false;
+      query.underlyingSecurityId = index.id(row);
+    } else {
+      query.symbolPrefix = symbol.substr(0, symbol.size() - 1);
+    }
+    if (type != ::markethub::messaging::trading::SECURITY_TYPE_UNSPECIFIED &&
+        !b3SecurityTypes(type, query.securityTypes))
+      return false;
+
+    const auto page = index.select(query);
+    out.reserve(out.size() + page.rows.size());
+    for (const uint32_t row : page.rows)
+      out.push_back(static_cast<std::uint64_t>(index.id(row)));
+    return !page.rows.empty();
+  }
+
+  // Con símbolo: status + subasta/bandas de ese instrumento (mismo formato que "M.<SYMBOL>").
+  // Sin símbolo: status de todos los instrumentos vistos. Sin tabla o sin datos: lista vacía.
+  std::unique_ptr<WrapperMessage> B3MdSubscriptionServer::HandleSecurityStatus(
+      const WrapperMessage &request) {
+    if (!request.has_security_status_request()) {
+      return nullptr;
+    }
+
+    const auto &r = request.security_status_request();
+    auto resp = std::make_unique<WrapperMessage>();
+
+    const std::string symbol =
+        r.has_instrument() ? extractSymbolFromInstrument(r.instrument()) : std::string{};
+
+    if (stateTable_ && !symbol.empty()) {
+      b3::md::InstrumentMarketState st;
+      const auto iid = registry_.tryResolveId(symbol);
+      if (iid && stateTable_->snapshot(static_cast<std::uint64_t>(*iid), st)) {
+        b3::md::mapping::MdSnapshotMapper::fillInstrumentState(
+            *resp, st, symbol.data(), static_cast<std::uint8_t>(symbol.size()));
+      }
+    } else if (stateTable_) {
+      auto *body = resp->mutable_security_status_response();
+      stateTable_->forEach([&](const b3::md::InstrumentMarketState &st) {
+        const auto *sym = registry_.tryResolveSymbol(st.instrumentId);
+        if (!sym)
+          return;
+        auto *status = body->add_security_statuses();
+        status->mutable_instrument()->set_symbol(*sym);
+        status->set_security_trading_status(
+            b3::md::mapping::MdSnapshotMapper::toProtoStatus(st.view.status));
+      });
+    }
+
+    resp->set_message_id(request.message_id());
+    resp->set_client_id(request.client_id());
+    resp->set_message_type(std::string(MessageTypes::SecurityStatusResponse));
+    resp->mutable_security_status_response()->set_original_request_id(r.request_id());
     return resp;
   }
 
@@ -1,11 +1,18 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include <b3/common/InstrumentRegistry.hpp>
 #include "../core/SubscriptionRegistry.hpp"
+#include "../core/SubscriptionExecutor.hpp"
 #include "../core/IMarketDataHandler.hpp"
+#include "../core/MarketStateTable.hpp"
+#include "SecurityListResponseCache.hpp"
 
 // Tu librería
 #include <servers/SubscriberPublisher.h>
@@ -21,12 +28,44 @@ namespace b3::md::messaging {
                            b3::md::SubscriptionRegistry &subs, b3::md::IMarketDataHandler &handler,
                            LogCallback logCb = nullptr);
 
+    // Arranca/para también el builder de SecurityListResponse (cache por versión del registry).
+    void Start() override;
+    void Stop() override;
+
+    // SecurityListRequest: true = se envía acá con el body pre-serializado del cache (sin copiar
+    // el mensaje) y HandleMessage devuelve nullptr; false = devuelve el WrapperMessage armado.
+    // El cache arma solo la forma que se usa (bytes o mensaje). Llamar antes de Start().
+    void setPreEncodedSecurityList(bool enabled) {
+      listCache_.setPreEncoded(enabled && securityListField_ > 0);
+    }
+
+    // Máximo de securities por SecurityListResponse. 0 = la respuesta entera en un solo mensaje.
+    // Con N > 0 la lista sale en chunks de hasta N y cierra con una respuesta vacía (mismo
+    // request_id), que marca el fin del stream.
+    void setSecurityListPageSize(uint32_t n) noexcept { securityListPageSize_ = n; }
+
+    const SecurityListResponseCache &securityListCache() const noexcept { return listCache_; }
+
+    // Opcional: subscribe/unsubscribe del handler fuera del thread de requests (coalesce por
+    // instrumento). Sin executor se llaman en el momento. Un subscribe que el handler rechaza
+    // descarta las referencias del iid (el próximo subscribe reintenta) y se loguea.
+    void setSubscriptionExecutor(b3::md::SubscriptionExecutor *executor);
+
+    // Opcional: habilita SecurityStatusRequest (estado vigente para late joiners).
+    void setMarketStateTable(const b3::md::MarketStateTable *table) noexcept { stateTable_ = table; }
+
     // Test accessor - exposes HandleMessage for unit testing
     std::unique_ptr<markethub::messaging::WrapperMessage> HandleMessageForTest(
         const markethub::messaging::WrapperMessage &request) {
       return HandleMessage(request);
     }
 
+    // Test accessor - todas las respuestas de un SecurityListRequest, sin enviar nada
+    std::vector<std::unique_ptr<markethub::messaging::WrapperMessage>> SecurityListResponsesForTest(
+        const markethub::messaging::WrapperMessage &request) {
+      return BuildSecurityListResponses(request);
+    }
+
    protected:
     std::unique_ptr<markethub::messaging::WrapperMessage> HandleMessage(
         const markethub::messaging::WrapperMessage &request) override;
@@ -35,6 +74,35 @@ namespace b3::md::messaging {
     b3::common::InstrumentRegistry &registry_;
     b3::md::SubscriptionRegistry &subs_;
     b3::md::IMarketDataHandler &handler_;
+    const b3::md::MarketStateTable *stateTable_{nullptr};
+    b3::md::SubscriptionExecutor *executor_{nullptr};
+    LogCallback log_; // copia del callback de la base, para fallas del handler
+
+    SecurityListResponseCache listCache_;
+    int securityListField_{0}; // número de campo de security_list_response en WrapperMessage
+    uint32_t securityListPageSize_{0};
+
+    // (cliente, security_type, patrón) -> iids que ese subscribe tomó. Solo el thread de requests.
+    std::unordered_map<std::string, std::vector<std::uint64_t>> patternSubs_;
+
+    void OnHandlerFailure(std::uint64_t iid, bool subscribe, const char *what);
+
+    static std::string patternKey(std::string_view clientId,
+                                  ::markethub::messaging::trading::SecurityType type,
+                                  std::string_view pattern);
+
+    std::unique_ptr<markethub::messaging::WrapperMessage> HandleSecurityList(
+        const markethub::messaging::WrapperMessage &request);
+
+    std::vector<std::unique_ptr<markethub::messaging::WrapperMessage>> BuildSecurityListResponses(
+        const markethub::messaging::WrapperMessage &request);
+
+    bool ResolveSubscriptionTargets(std::string_view symbol,
+                                    ::markethub::messaging::trading::SecurityType type,
+                                    std::vector<std::uint64_t> &out);
+
+    std::unique_ptr<markethub::messaging::WrapperMessage> HandleSecurityStatus(
+        const markethub::messaging::WrapperMessage &request);
   };
 
 } // namespace b3::md::messaging
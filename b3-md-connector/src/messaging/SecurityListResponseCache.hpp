@@ -0,0 +1,400 @@
+#pragma once
+
+#include <b3/common/InstrumentRegistry.hpp>
+#include "../core/SecurityListIndex.hpp"
+
+#include <models/messages.pb.h>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace b3::md::messaging {
+
+  /**
+   * @brief Escribe InstrumentData en un trading::Security por reflection, con los FieldDescriptor
+   *        resueltos una sola vez (no FindFieldByName por campo e instrumento).
+   *
+   * Mismo criterio que antes: un campo que no existe en el schema o con otro tipo se ignora, así
+   * el mapeo sobrevive a cambios del .proto.
+   */
+  class SecurityFieldWriter final {
+   public:
+    SecurityFieldWriter() {
+      const ::markethub::messaging::trading::Security proto;
+      const auto *d = proto.GetDescriptor();
+      for (int i = 0; i < kFieldCount; ++i)
+        fields_[i] = d ? d->FindFieldByName(kNames[i]) : nullptr;
+    }
+
+    void write(::markethub::messaging::trading::Security &security,
+               const b3::common::InstrumentData &data) const {
+      auto *m = static_cast<::google::protobuf::Message *>(&security);
+      const auto *r = security.GetReflection();
+      if (!r)
+        return;
+
+      // Core identification
+      setString(m, r, kSymbol, data.symbol);
+      setString(m, r, kTicker, data.symbol);
+      setU64(m, r, kSecurityId, data.securityId);
+      setU64(m, r, kInstrumentId, data.securityId);
+      setString(m, r, kExchange, data.securityExchange);
+
+      // Classification
+      setString(m, r, kSecurityType, data.securityType);
+      setString(m, r, kSecurityGroup, data.securityGroup);
+      setString(m, r, kAsset, data.asset);
+      setString(m, r, kCfiCode, data.cfiCode);
+      setString(m, r, kMarketSegmentId, data.marketSegmentId);
+
+      // Trading parameters
+      if (data.governanceIndicator != 0)
+        setU64(m, r, kGovernanceIndicator, data.governanceIndicator);
+      if (data.securityMatchType != 0)
+        setU64(m, r, kSecurityMatchType, data.securityMatchType);
+
+      // Price specifications (mantissa)
+      if (data.minPriceIncrement != 0)
+        setU64(m, r, kMinPriceIncrement, static_cast<uint64_t>(data.minPriceIncrement));
+      if (data.strikePrice != 0)
+        setU64(m, r, kStrikePriceMantissa, static_cast<uint64_t>(data.strikePrice));
+      if (data.minPriceIncrementAmount != 0)
+        setU64(m, r, kMinPriceIncrementAmount, static_cast<uint64_t>(data.minPriceIncrementAmount));
+
+      // Quantity specifications
+      if (data.minOrderQty != 0)
+        setU64(m, r, kMinOrderQty, static_cast<uint64_t>(data.minOrderQty));
+      if (data.maxOrderQty != 0)
+        setU64(m, r, kMaxOrderQty, static_cast<uint64_t>(data.maxOrderQty));
+      if (data.lotSize != 0)
+        setU64(m, r, kLotSize, static_cast<uint64_t>(data.lotSize));
+      if (data.minTradeVol != 0)
+        setU64(m, r, kMinTradeVol, static_cast<uint64_t>(data.minTradeVol));
+
+      // Derivatives / options
+      if (data.underlyingSecurityId != 0)
+        setU64(m, r, kUnderlyingSecurityId, data.underlyingSecurityId);
+      setString(m, r, kUnderlyingSymbol, data.underlyingSymbol);
+      if (data.maturityDate != 0)
+        setU64(m, r, kMaturityDate, data.maturityDate);
+      if (data.putOrCall != 0)
+        setU64(m, r, kPutOrCall, data.putOrCall);
+      if (data.exerciseStyle != 0)
+        setU64(m, r, kExerciseStyle, data.exerciseStyle);
+
+      // Flags and settlement
+      if (data.hasCorporateAction)
+        setU64(m, r, kCorporateActionEventId, data.corporateActionEventId);
+      if (data.isMultileg)
+        setU64(m, r, kIsMultileg, 1);
+      setString(m, r, kSettlementType, data.settlementType);
+      if (data.productComplex != 0)
+        setU64(m, r, kProductComplex, data.productComplex);
+
+      // Additional info
+      setString(m, r, kCurrency, data.currency);
+      setString(m, r, kIsin, data.isin);
+      setString(m, r, kDescription, data.securityDesc);
+    }
+
+   private:
+    enum Field : int {
+      kSymbol,
+      kTicker,
+      kSecurityId,
+      kInstrumentId,
+      kExchange,
+      kSecurityType,
+      kSecurityGroup,
+      kAsset,
+      kCfiCode,
+      kMarketSegmentId,
+      kGovernanceIndicator,
+      kSecurityMatchType,
+      kMinPriceIncrement,
+      kStrikePriceMantissa,
+      kMinPriceIncrementAmount,
+      kMinOrderQty,
+      kMaxOrderQty,
+      kLotSize,
+      kMinTradeVol,
+      kUnderlyingSecurityId,
+      kUnderlyingSymbol,
+      kMaturityDate,
+      kPutOrCall,
+      kExerciseStyle,
+      kCorporateActionEventId,
+      kIsMultileg,
+      kSettlementType,
+      kProductComplex,
+      kCurrency,
+      kIsin,
+      kDescription,
+      kFieldCount
+    };
+
+    // Mismo orden que Field
+    static constexpr const char *kNames[kFieldCount] = {
+        "symbol",
+        "ticker",
+        "security_id",
+        "instrument_id",
+        "exchange",
+        "security_type",
+        "security_group",
+        "asset",
+        "cfi_code",
+        "market_segment_id",
+        "governance_indicator",
+        "security_match_type",
+        "min_price_increment",
+        "strike_price_mantissa",
+        "min_price_increment_amount",
+        "min_order_qty",
+        "max_order_qty",
+        "lot_size",
+        "min_trade_vol",
+        "underlying_security_id",
+        "underlying_symbol",
+        "maturity_date",
+        "put_or_call",
+        "exercise_style",
+        "corporate_action_event_id",
+        "is_multileg",
+        "settlement_type",
+        "product_complex",
+        "currency",
+        "isin",
+        "description"};
+
+    void setString(::google::protobuf::Message *m, const ::google::protobuf::Reflection *r,
+                   Field id, std::string_view v) const {
+      const auto *f = fields_[id];
+      if (!f || f->cpp_type() != ::google::protobuf::FieldDescriptor::CPPTYPE_STRING)
+        return;
+      r->SetString(m, f, std::string(v));
+    }
+
+    void setU64(::google::protobuf::Message *m, const ::google::protobuf::Reflection *r, Field id,
+                uint64_t v) const {
+      const auto *f = fields_[id];
+      if (!f)
+        return;
+      using FD = ::google::protobuf::FieldDescriptor;
+      switch (f->cpp_type()) {
+      case FD::CPPTYPE_UINT64:
+        r->SetUInt64(m, f, v);
+        break;
+      case FD::CPPTYPE_INT64:
+        r->SetInt64(m, f, static_cast<int64_t>(v));
+        break;
+      case FD::CPPTYPE_UINT32:
+        r->SetUInt32(m, f, static_cast<uint32_t>(v));
+        break;
+      case FD::CPPTYPE_INT32:
+        r->SetInt32(m, f, static_cast<int32_t>(v));
+        break;
+      default:
+        break;
+      }
+    }
+
+    const ::google::protobuf::FieldDescriptor *fields_[kFieldCount]{};
+  };
+
+  // Respuesta completa para una versión del registry, más el índice para consultas filtradas.
+  // Según el modo se arma UNA de las dos formas, no ambas:
+  // - preEncoded: bytes (la lista entera serializada) y entries[row], una SecurityListResponse
+  //   de una sola security (la fila `row` del índice) ya serializada: concatenar entries da una
+  //   respuesta válida con esas filas. `message` queda vacío.
+  // - si no: message, para el camino que devuelve el WrapperMessage. bytes/entries vacíos.
+  struct SecurityListSnapshot {
+    uint64_t version{0};
+    uint32_t count{0};
+    bool preEncoded{false};
+    ::markethub::messaging::trading::SecurityListResponse message;
+    std::string bytes;
+    b3::md::SecurityListIndex index;
+    std::vector<std::string> entries;
+  };
+
+  /**
+   * @brief SecurityListResponse armada una vez por versión del registry, fuera del thread de
+   *        requests.
+   *
+   * Un thread propio espera deltas del registry (addDeltaListener) y reconstruye; los requests
+   * solo toman el shared_ptr vigente. Sin thread corriendo (tests, antes de Start) current()
+   * construye en el momento si la versión cambió. El request_id NO va en el cache: es por
+   * request.
+   */
+  class SecurityListResponseCache final {
+   public:
+    // El listener queda registrado en el registry (no hay unsubscribe): solo toca Signal, que
+    // puede sobrevivir al cache (weak_ptr).
+    explicit SecurityListResponseCache(b3::common::InstrumentRegistry &registry)
+        : registry_(registry), signal_(std::make_shared<Signal>()) {
+      std::weak_ptr<Signal> weak = signal_;
+      registry.addDeltaListener([weak](const b3::common::RegistryDelta &) {
+        if (auto s = weak.lock()) {
+          {
+            std::lock_guard<std::mutex> g(s->mu);
+            s->dirty = true;
+          }
+          s->cv.notify_one();
+        }
+      });
+    }
+
+    ~SecurityListResponseCache() { stop(); }
+
+    SecurityListResponseCache(const SecurityListResponseCache &) = delete;
+    SecurityListResponseCache &operator=(const SecurityListResponseCache &) = delete;
+
+    void start() {
+      bool expected = false;
+      if (!running_.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+        return;
+      {
+        std::lock_guard<std::mutex> g(signal_->mu);
+        signal_->stop = false;
+        signal_->dirty = true; // primera construcción en background
+      }
+      thread_ = std::thread([this] { run(); });
+    }
+
+    void stop() {
+      {
+        std::lock_guard<std::mutex> g(signal_->mu);
+        signal_->stop = true;
+      }
+      signal_->cv.notify_one();
+      if (thread_.joinable())
+        thread_.join();
+      running_.store(false, std::memory_order_release);
+    }
+
+    // Qué forma arma el builder (ver SecurityListSnapshot). Descarta el snapshot vigente: el
+    // próximo current() reconstruye en el modo nuevo.
+    void setPreEncoded(bool enabled) {
+      preEncoded_.store(enabled, std::memory_order_relaxed);
+      std::lock_guard<std::mutex> g(snapMu_);
+      if (snap_ && snap_->preEncoded != enabled)
+        snap_.reset();
+    }
+
+    std::shared_ptr<const SecurityListSnapshot> current() {
+      auto snap = load();
+      if (snap && (running_.load(std::memory_order_acquire) || snap->version == registry_.version()))
+        return snap; // con el builder corriendo, una versión vieja dura lo que tarda en rearmar
+      return rebuild();
+    }
+
+    // El último armado, sin reconstruir (nullptr si todavía no hubo build).
+    std::shared_ptr<const SecurityListSnapshot> built() const { return load(); }
+
+    uint64_t builds() const noexcept { return builds_.load(std::memory_order_relaxed); }
+    uint64_t builtVersion() const {
+      auto snap = load();
+      return snap ? snap->version : 0;
+    }
+
+   private:
+    struct Signal {
+      std::mutex mu;
+      std::condition_variable cv;
+      bool dirty{false};
+      bool stop{false};
+    };
+
+    std::shared_ptr<const SecurityListSnapshot> load() const {
+      std::lock_guard<std::mutex> g(snapMu_);
+      return snap_;
+    }
+
+    std::shared_ptr<const SecurityListSnapshot> rebuild() {
+      std::lock_guard<std::mutex> build(buildMu_);
+      // version antes del snapshot: un delta concurrente deja el cache "viejo" y fuerza otro build
+      const uint64_t version = registry_.version();
+      const bool preEncoded = preEncoded_.load(std::memory_order_relaxed);
+      {
+        auto snap = load();
+        if (snap && snap->version == version && snap->preEncoded == preEncoded)
+          return snap;
+      }
+
+      auto next = std::make_shared<SecurityListSnapshot>();
+      next->version = version;
+      next->preEncoded = preEncoded;
+      next->index = b3::md::SecurityListIndex(registry_.snapshotAllFull());
+      if (preEncoded) {
+        next->entries.resize(next->index.size());
+        for (uint32_t row = 0; row < next->index.size(); ++row) {
+          const auto &data = next->index.data(row);
+          ::markethub::messaging::trading::SecurityListResponse one;
+          writer_.write((*one.mutable_securities())[data.symbol], data);
+          one.SerializeToString(&next->entries[row]);
+          next->bytes += next->entries[row];
+        }
+        next->count = next->index.size();
+      } else {
+        auto *securities = next->message.mutable_securities();
+        for (uint32_t row = 0; row < next->index.size(); ++row) {
+          const auto &data = next->index.data(row);
+          writer_.write((*securities)[data.symbol], data);
+        }
+        next->count = static_cast<uint32_t>(securities->size());
+        if constexpr (requires { next->message.set_ok(true); })
+          next->message.set_ok(true);
+      }
+
+      std::shared_ptr<const SecurityListSnapshot> out = std::move(next);
+      {
+        std::lock_guard<std::mutex> g(snapMu_);
+        snap_ = out;
+      }
+      builds_.fetch_add(1, std::memory_order_relaxed);
+      return out;
+    }
+
+    void run() {
+      for (;;) {
+        {
+          std::unique_lock<std::mutex> lk(signal_->mu);
+          signal_->cv.wait(lk, [this] { return signal_->dirty || signal_->stop; });
+          if (signal_->stop)
+            return;
+          signal_->dirty = false;
+        }
+        try {
+          (void)rebuild();
+        } catch (...) {
+          // bad_alloc: se reintenta en el próximo delta; los requests siguen con la versión previa
+        }
+      }
+    }
+
+    const b3::common::InstrumentRegistry &registry_;
+    const SecurityFieldWriter writer_{};
+    std::shared_ptr<Signal> signal_;
+
+    mutable std::mutex snapMu_;
+    std::shared_ptr<const SecurityListSnapshot> snap_;
+    std::mutex buildMu_;
+
+    std::atomic<bool> running_{false};
+    std::atomic<bool> preEncoded_{false};
+    std::atomic<uint64_t> builds_{0};
+    std::thread thread_{};
+  };
+
+} // namespace b3::md::messaging
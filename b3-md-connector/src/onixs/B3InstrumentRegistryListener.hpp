@@ -5,9 +5,15 @@
 #include <OnixS/B3/MarketData/UMDF/messaging/Messages.h>
 
 #include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include <b3/common/InstrumentRegistry.hpp>
 
@@ -15,16 +21,95 @@ namespace b3::md::onixs {
 
   class B3InstrumentRegistryListener final : public ::OnixS::B3::MarketData::UMDF::MessageListener {
    public:
+    // Tope de un lote de deltas intradiarios y demora máxima antes de aplicarlo. La demora la
+    // garantiza flushDueDeltas() (timer del canal), no el próximo SecDef: puede no llegar otro.
+    static constexpr std::size_t kDeltaBatchMax = 256;
+    static constexpr uint64_t kDeltaMaxDelayNs = 100'000'000ull;
+
     explicit B3InstrumentRegistryListener(b3::common::InstrumentRegistry &registry) noexcept
         : registry_(registry) {}
 
+    // Después del loop: aplicar SecurityDefinitions nuevas/cambiadas (default) o freeze estricto.
+    void setLiveUpdates(bool enabled) noexcept { liveUpdates_ = enabled; }
+    bool liveUpdates() const noexcept { return liveUpdates_; }
+
     std::atomic<bool> &readyAtomic() noexcept { return ready_; }
     const std::atomic<bool> &readyAtomic() const noexcept { return ready_; }
 
+    // true cuando el loop en vivo cerró (commit o reconciliación): recién ahí se persiste el cache.
+    const std::atomic<bool> &loopCompleteAtomic() const noexcept { return loopComplete_; }
+
+    /**
+     * @brief Arranque rápido desde SecurityListCache (mismo día/canal): carga el registry y
+     *        marca ready antes de que llegue el loop. Llamar antes de arrancar el Handler.
+     *
+     * El loop SequenceReset→SequenceReset se sigue capturando; al cerrarlo se reconcilia contra
+     * lo precargado (altas y cambios se aplican, ver reconcile*()).
+     */
+    void preload(std::vector<std::pair<std::uint64_t, b3::common::InstrumentData>> items) {
+      if (items.empty())
+        return;
+      preloaded_.reserve(items.size());
+      for (const auto &kv : items) preloaded_.insert(kv.first);
+      own(items);
+      registry_.bulkUpsertFull(items.begin(), items.end());
+      ready_.store(true, std::memory_order_release);
+    }
+
+    std::size_t preloadedCount() const noexcept { return preloaded_.size(); }
+    uint32_t reconcileAdded() const noexcept { return added_.load(std::memory_order_relaxed); }
+    uint32_t reconcileChanged() const noexcept { return changed_.load(std::memory_order_relaxed); }
+    // Precargados que el loop en vivo no trajo: quedan en el registry (puede haber suscriptores).
+    uint32_t reconcileMissing() const noexcept { return missing_.load(std::memory_order_relaxed); }
+
+    // Timer (otro thread que el callback): aplica el lote pendiente si ya tiene
+    // kDeltaMaxDelayNs. Sin lote pendiente es un load atómico.
+    void flushDueDeltas() {
+      const uint64_t since = pendingSinceNs_.load(std::memory_order_acquire);
+      if (since == 0 || nowNs() - since < kDeltaMaxDelayNs)
+        return;
+      std::lock_guard<std::mutex> lk(deltaMu_);
+      flushDeltasLocked();
+    }
+
+    uint64_t deltaBatches() const noexcept { return deltaBatches_.load(std::memory_order_relaxed); }
+    uint64_t deltaAdded() const noexcept { return deltaAdded_.load(std::memory_order_relaxed); }
+    uint64_t deltaChanged() const noexcept { return deltaChanged_.load(std::memory_order_relaxed); }
+
+    // Instrumentos que definió ESTE canal (cache, loop y deltas). Con varios canales sobre un
+    // registry compartido decide a qué Handler va cada subscribe y qué entra en el cache del canal.
+    bool owns(std::uint64_t iid) const {
+      std::shared_lock<std::shared_mutex> lk(ownedMu_);
+      return owned_.find(iid) != owned_.end();
+    }
+
+    std::size_t ownedCount() const {
+      std::shared_lock<std::shared_mutex> lk(ownedMu_);
+      return owned_.size();
+    }
+
+    std::vector<std::pair<std::uint64_t, b3::common::InstrumentData>> snapshotOwned() const {
+      std::vector<std::uint64_t> ids;
+      {
+        std::shared_lock<std::shared_mutex> lk(ownedMu_);
+        ids.assign(owned_.begin(), owned_.end());
+      }
+      std::vector<std::pair<std::uint64_t, b3::common::InstrumentData>> out;
+      out.reserve(ids.size());
+      for (const auto iid : ids)
+        if (const auto *d = registry_.tryResolveData(iid))
+          out.emplace_back(iid, *d);
+      return out;
+    }
+
     void onSequenceReset_1(const ::OnixS::B3::MarketData::UMDF::Messaging::SequenceReset_1,
                            const ::OnixS::B3::MarketData::UMDF::DataSource &) override {
-      if (ready_.load(std::memory_order_acquire))
+      // Loop posterior: fin de vuelta, aplica lo pendiente
+      if (loopComplete_.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lk(deltaMu_);
+        flushDeltasLocked();
         return;
+      }
 
       // First reset: start capture
       if (!capturing_.exchange(true, std::memory_order_acq_rel)) {
@@ -33,7 +118,12 @@ namespace b3::md::onixs {
       }
 
       // Second reset: close loop → commit full instrument data
-      registry_.bulkUpsertFull(staging_.begin(), staging_.end());
+      own(staging_);
+      if (preloaded_.empty())
+        registry_.bulkUpsertFull(staging_.begin(), staging_.end());
+      else
+        reconcile();
+      loopComplete_.store(true, std::memory_order_release);
       ready_.store(true, std::memory_order_release);
     }
 
@@ -48,11 +138,24 @@ namespace b3::md::onixs {
       if (sym.empty())
         return;
 
-      // Después de ready=true: freeze estricto (lista fija, cargada al inicio del día)
-      if (ready_.load(std::memory_order_acquire)) {
-        return; // Freeze: ignora SecurityDefinitions posteriores
-        // registry_.upsertFull(iid, extractInstrumentData(msg)); // Descomentar para permitir
-        // updates
+      // Después del loop: altas intradiarias (series nuevas, estrategias) y cambios, en lotes.
+      // El loop de SecDefs se repite todo el día: lo idéntico a lo vigente se descarta acá.
+      if (loopComplete_.load(std::memory_order_acquire)) {
+        if (!liveUpdates_)
+          return;
+        b3::common::InstrumentData data = extractInstrumentData(msg);
+        data.securityId = iid;
+        const b3::common::InstrumentData *cur = registry_.tryResolveData(iid);
+        if (cur && *cur == data)
+          return;
+        std::lock_guard<std::mutex> lk(deltaMu_);
+        if (pendingDeltas_.empty())
+          pendingSinceNs_.store(nowNs(), std::memory_order_release);
+        pendingDeltas_.emplace_back(iid, std::move(data));
+        if (pendingDeltas_.size() >= kDeltaBatchMax ||
+            nowNs() - pendingSinceNs_.load(std::memory_order_relaxed) >= kDeltaMaxDelayNs)
+          flushDeltasLocked();
+        return;
       }
 
       if (!capturing_.load(std::memory_order_acquire))
@@ -62,6 +165,52 @@ namespace b3::md::onixs {
     }
 
    private:
+    // Loop en vivo vs cache: el registry descarta lo idéntico, solo cambia lo que difiere.
+    // Aplicar cambios acá es seguro porque el registry versiona (una definición reemplazada sigue
+    // viva en su storage: los const InstrumentData* que ya tomaron los readers no cuelgan).
+    void reconcile() {
+      const auto delta = registry_.bulkUpsertFull(staging_.begin(), staging_.end());
+
+      uint32_t missing = 0;
+      for (std::uint64_t iid : preloaded_)
+        if (staging_.find(iid) == staging_.end())
+          ++missing;
+
+      added_.store(static_cast<uint32_t>(delta.added.size()), std::memory_order_relaxed);
+      changed_.store(static_cast<uint32_t>(delta.changed.size()), std::memory_order_relaxed);
+      missing_.store(missing, std::memory_order_relaxed);
+      staging_.clear();
+    }
+
+    // Un lote = un lock exclusivo, una versión nueva y una notificación a los caches.
+    // Con deltaMu_ tomado (callback o timer).
+    void flushDeltasLocked() {
+      if (pendingDeltas_.empty())
+        return;
+      own(pendingDeltas_);
+      const auto delta = registry_.bulkUpsertFull(pendingDeltas_.begin(), pendingDeltas_.end());
+      pendingDeltas_.clear();
+      pendingSinceNs_.store(0, std::memory_order_release);
+      if (delta.empty())
+        return;
+      deltaBatches_.fetch_add(1, std::memory_order_relaxed);
+      deltaAdded_.fetch_add(delta.added.size(), std::memory_order_relaxed);
+      deltaChanged_.fetch_add(delta.changed.size(), std::memory_order_relaxed);
+    }
+
+    // Solo al cerrar el loop / aplicar un lote, nunca por mensaje.
+    template <typename Range>
+    void own(const Range &items) {
+      std::unique_lock<std::shared_mutex> lk(ownedMu_);
+      for (const auto &kv : items) owned_.insert(kv.first);
+    }
+
+    static uint64_t nowNs() noexcept {
+      return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       std::chrono::steady_clock::now().time_since_epoch())
+                                       .count());
+    }
+
     template <typename StrLike>
     static std::string trimRight(const StrLike &s) {
       const char *p = s.data();
@@ -150,7 +299,7 @@ namespace b3::md::onixs {
       auto underlyings = msg.underlyings();
       if (underlyings.size() > 0) {
         auto firstUnderlying = underlyings[0];
-        data.underlyingSecurityId = static_cast<uint32_t>(firstUnderlying.underlyingSecurityId());
+        data.underlyingSecurityId = static_cast<std::uint64_t>(firstUnderlying.underlyingSecurityId());
         data.underlyingSymbol = trimRight(firstUnderlying.underlyingSymbol());
       }
 
@@ -210,8 +359,26 @@ namespace b3::md::onixs {
 
     std::atomic<bool> ready_{false};
     std::atomic<bool> capturing_{false};
+    std::atomic<bool> loopComplete_{false};
 
     std::unordered_map<std::uint64_t, b3::common::InstrumentData> staging_;
+    std::unordered_set<std::uint64_t> preloaded_;
+
+    mutable std::shared_mutex ownedMu_;
+    std::unordered_set<std::uint64_t> owned_;
+
+    bool liveUpdates_{true};
+    std::mutex deltaMu_; // lote pendiente: callback de OnixS vs timer del canal
+    std::vector<std::pair<std::uint64_t, b3::common::InstrumentData>> pendingDeltas_;
+    std::atomic<uint64_t> pendingSinceNs_{0}; // 0 = sin lote pendiente
+
+    std::atomic<uint32_t> added_{0};
+    std::atomic<uint32_t> changed_{0};
+    std::atomic<uint32_t> missing_{0};
+
+    std::atomic<uint64_t> deltaBatches_{0};
+    std::atomic<uint64_t> deltaAdded_{0};
+    std::atomic<uint64_t> deltaChanged_{0};
   };
 
 } // namespace b3::md::onixs
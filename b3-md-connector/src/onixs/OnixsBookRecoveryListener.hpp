@@ -0,0 +1,50 @@
+#pragma once
+
+#include "../core/MarketDataEngine.hpp"
+
+#include <OnixS/B3/MarketData/UMDF/MessageListener.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace b3::md::onixs {
+
+  // Adapter: eventos de recuperación de OnixS -> MarketDataEngine (libros stale).
+  // - onSnapshotRecoveryStarted/Finished: ventana en la que los libros stale se suprimen.
+  // - onInstrumentSequenceGap: gap de RptSeq de un instrumento => su libro queda stale.
+  class OnixsBookRecoveryListener final : public ::OnixS::B3::MarketData::UMDF::MessageListener {
+   public:
+    explicit OnixsBookRecoveryListener(b3::md::MarketDataEngine &engine) noexcept
+        : engine_(engine) {}
+
+    OnixsBookRecoveryListener(const OnixsBookRecoveryListener &) = delete;
+    OnixsBookRecoveryListener &operator=(const OnixsBookRecoveryListener &) = delete;
+
+    void onSnapshotRecoveryStarted() override {
+      recoveries_.fetch_add(1, std::memory_order_relaxed);
+      engine_.setSnapshotRecovery(true);
+    }
+
+    void onSnapshotRecoveryFinished() override { engine_.setSnapshotRecovery(false); }
+
+    void onInstrumentSequenceGap(::OnixS::B3::MarketData::UMDF::Messaging::SecurityID id) override {
+      const auto now = std::chrono::system_clock::now().time_since_epoch();
+      const uint64_t nowNs =
+          static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+
+      gaps_.fetch_add(1, std::memory_order_relaxed);
+      engine_.onBookOutOfDate(static_cast<uint64_t>(id), 0, nowNs);
+    }
+
+    uint64_t recoveries() const noexcept { return recoveries_.load(std::memory_order_relaxed); }
+    uint64_t gaps() const noexcept { return gaps_.load(std::memory_order_relaxed); }
+
+   private:
+    b3::md::MarketDataEngine &engine_;
+
+    std::atomic<uint64_t> recoveries_{0};
+    std::atomic<uint64_t> gaps_{0};
+  };
+
+} // namespace b3::md::onixs
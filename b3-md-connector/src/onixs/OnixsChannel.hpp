@@ -0,0 +1,195 @@
+#pragma once
+
+#include "../core/MarketDataEngine.hpp"
+#include "../core/MdPublishPipeline.hpp"
+#include "B3InstrumentRegistryListener.hpp"
+#include "OnixsBookRecoveryListener.hpp"
+#include "OnixsFeedEngineHost.hpp"
+#include "OnixsHandlerWrapper.hpp"
+#include "OnixsMarketStateListener.hpp"
+#include "OnixsMessageListenerFanout.hpp"
+#include "OnixsOrderBookListener.hpp"
+#include "OnixsStatisticsListener.hpp"
+#include "OnixsTradeListener.hpp"
+
+#include <OnixS/B3/MarketData/UMDF/Handler.h>
+#include <OnixS/B3/MarketData/UMDF/HandlerSettings.h>
+
+#include <b3/common/InstrumentRegistry.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace b3::md::onixs {
+
+  /**
+   * @brief Un canal UMDF: Handler de OnixS + feed engine + engine + listeners propios.
+   *
+   * Varios canales comparten registry, pipeline, lanes (trades/estado/journal), tabla de libros
+   * stale y concentrator; lo que es del canal queda acá:
+   * - B3InstrumentRegistryListener: loop de SecDefs del canal. Su flag ready gatea SOLO el
+   *   engine de este canal (un canal lento no frena a los demás) y sabe qué iids son suyos.
+   * - MarketDataEngine: contadores de drops/gated/stale por canal y ventana de snapshot
+   *   recovery del canal.
+   * - OnixsFeedEngineHost: threads y afinidad del feed de este canal.
+   * - Timer de deltas: aplica el lote de SecDefs intradiarias pendiente a los
+   *   kDeltaMaxDelayNs aunque no llegue otra SecDef que lo dispare.
+   *
+   * Flags de las lanes compartidas: configurar engine() y llamar wireListeners() antes de start().
+   */
+  class OnixsChannel final {
+   public:
+    using Handler = ::OnixS::B3::MarketData::UMDF::Handler;
+    using HandlerSettings = ::OnixS::B3::MarketData::UMDF::HandlerSettings;
+
+    OnixsChannel(int channel, FeedEngineConfig feedCfg, b3::md::MdPublishPipeline &pipeline,
+                 b3::common::InstrumentRegistry &registry)
+        : channel_(channel), feedHost_(std::move(feedCfg)), engine_(pipeline),
+          instrumentListener_(registry), orderBookListener_(engine_),
+          bookRecoveryListener_(engine_), tradeListener_(engine_), statisticsListener_(engine_),
+          marketStateListener_(engine_) {
+      engine_.setRegistryReadyFlag(&instrumentListener_.readyAtomic());
+    }
+
+    ~OnixsChannel() { stop(); }
+
+    OnixsChannel(const OnixsChannel &) = delete;
+    OnixsChannel &operator=(const OnixsChannel &) = delete;
+
+    int channel() const noexcept { return channel_; }
+
+    OnixsFeedEngineHost &feedHost() noexcept { return feedHost_; }
+    b3::md::MarketDataEngine &engine() noexcept { return engine_; }
+    const b3::md::MarketDataEngine &engine() const noexcept { return engine_; }
+    B3InstrumentRegistryListener &instrumentListener() noexcept { return instrumentListener_; }
+    const B3InstrumentRegistryListener &instrumentListener() const noexcept {
+      return instrumentListener_;
+    }
+
+    const OnixsOrderBookListener &orderBookListener() const noexcept { return orderBookListener_; }
+    const OnixsBookRecoveryListener &bookRecoveryListener() const noexcept {
+      return bookRecoveryListener_;
+    }
+    const OnixsTradeListener &tradeListener() const noexcept { return tradeListener_; }
+    const OnixsStatisticsListener &statisticsListener() const noexcept { return statisticsListener_; }
+    const OnixsMarketStateListener &marketStateListener() const noexcept {
+      return marketStateListener_;
+    }
+
+    // OnixS acepta un solo MessageListener: registry + recuperación + trades + stats + estado
+    // comparten el fan-out. Una vez, antes de start().
+    void wireListeners(bool staleBooks, bool trades, bool stats, bool state) {
+      messageListeners_.add(&instrumentListener_);
+      if (staleBooks)
+        messageListeners_.add(&bookRecoveryListener_);
+      if (trades)
+        messageListeners_.add(&tradeListener_);
+      if (stats)
+        messageListeners_.add(&statisticsListener_);
+      if (state)
+        messageListeners_.add(&marketStateListener_);
+    }
+
+    // Crea y arranca el Handler en el thread que indique el feed engine (main para default/pool,
+    // el poll thread para single). `settings` ya trae los feeds del canal.
+    void start(HandlerSettings settings) {
+      settings_ = std::move(settings);
+      feedHost_.start(
+          [this](::OnixS::B3::MarketData::UMDF::FeedEngine *feedEngine) {
+            settings_.feedEngine = feedEngine;
+            createHandler();
+            handler_->start();
+          },
+          [this]() {
+            if (handler_) {
+              handler_->stop(true);
+              wrapper_.reset();
+              handler_.reset();
+            }
+          });
+      if (instrumentListener_.liveUpdates())
+        startDeltaTimer();
+    }
+
+    // Idempotente.
+    void stop() {
+      stopDeltaTimer();
+      feedHost_.stop();
+    }
+
+    // Backtest: Handler con los listeners registrados pero sin arrancar (lo maneja OnixsLogReplay).
+    Handler &openForReplay(HandlerSettings settings) {
+      settings_ = std::move(settings);
+      createHandler();
+      return *handler_;
+    }
+
+    void closeReplay() {
+      wrapper_.reset();
+      handler_.reset();
+    }
+
+    // subscribe/unsubscribe de este canal; válido mientras el canal está arrancado.
+    b3::md::IMarketDataHandler &handler() noexcept { return *wrapper_; }
+
+   private:
+    static constexpr auto kDeltaTimerPeriod = std::chrono::milliseconds(
+        B3InstrumentRegistryListener::kDeltaMaxDelayNs / 4'000'000ull);
+
+    void startDeltaTimer() {
+      if (deltaTimerRunning_.exchange(true, std::memory_order_acq_rel))
+        return;
+      deltaTimer_ = std::thread([this] {
+        while (deltaTimerRunning_.load(std::memory_order_acquire)) {
+          std::this_thread::sleep_for(kDeltaTimerPeriod);
+          try {
+            instrumentListener_.flushDueDeltas();
+          } catch (...) {
+            // bad_alloc en el registry: el lote queda pendiente para el próximo intento
+          }
+        }
+      });
+    }
+
+    void stopDeltaTimer() {
+      deltaTimerRunning_.store(false, std::memory_order_release);
+      if (deltaTimer_.joinable())
+        deltaTimer_.join();
+    }
+
+    void createHandler() {
+      handler_ = std::make_unique<Handler>(settings_);
+      handler_->registerOrderBookListener(&orderBookListener_);
+      handler_->registerMessageListener(&messageListeners_);
+      wrapper_ = std::make_unique<OnixsHandlerWrapper>(*handler_);
+    }
+
+    const int channel_;
+
+    // Dueño del feed engine (y del poll thread en modo single). El Handler no depende del orden
+    // de los miembros: stop() (también desde ~OnixsChannel) lo destruye vía stopFn, en el thread
+    // del engine, y recién después el host libera el engine. Acá handler_ ya está vacío.
+    OnixsFeedEngineHost feedHost_;
+    b3::md::MarketDataEngine engine_;
+
+    B3InstrumentRegistryListener instrumentListener_;
+    OnixsOrderBookListener orderBookListener_;
+    OnixsBookRecoveryListener bookRecoveryListener_;
+    OnixsTradeListener tradeListener_;
+    OnixsStatisticsListener statisticsListener_;
+    OnixsMarketStateListener marketStateListener_;
+    OnixsMessageListenerFanout messageListeners_;
+
+    HandlerSettings settings_{};
+    std::unique_ptr<Handler> handler_;
+    std::unique_ptr<OnixsHandlerWrapper> wrapper_;
+
+    std::atomic<bool> deltaTimerRunning_{false};
+    std::thread deltaTimer_{};
+  };
+
+} // namespace b3::md::onixs
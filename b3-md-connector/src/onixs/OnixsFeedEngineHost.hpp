@@ -0,0 +1,344 @@
+#pragma once
+
+#include "../telemetry/LogEvent.hpp"
+#include "../telemetry/SpdlogLogPublisher.hpp"
+
+#include <OnixS/B3/MarketData/UMDF/FeedEngine.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace b3::md::onixs {
+
+  /**
+   * @brief Qué feed engine de OnixS usa el Handler.
+   *
+   * - Default:        HandlerSettings::feedEngine = nullptr (OnixS crea su propio thread).
+   * - ThreadPool:     SocketFeedEngine + FeedEngineThreadPool con threads/spin/afinidad nuestros.
+   * - SingleThreaded: SingleThreadedSocketFeedEngine; el Handler se crea, arranca y para en
+   *                   NUESTRO thread de busy-poll, que llama process(). Callback OnixS,
+   *                   build del OrdersSnapshot y enqueue corren todos en ese core.
+   */
+  enum class FeedEngineMode : uint8_t { Default = 0, ThreadPool = 1, SingleThreaded = 2 };
+
+  inline bool parseFeedEngineMode(std::string_view s, FeedEngineMode &out) noexcept {
+    if (s.empty() || s == "default") {
+      out = FeedEngineMode::Default;
+      return true;
+    }
+    if (s == "pool") {
+      out = FeedEngineMode::ThreadPool;
+      return true;
+    }
+    if (s == "single") {
+      out = FeedEngineMode::SingleThreaded;
+      return true;
+    }
+    return false;
+  }
+
+  inline const char *toString(FeedEngineMode m) noexcept {
+    switch (m) {
+      case FeedEngineMode::Default:        return "default";
+      case FeedEngineMode::ThreadPool:     return "pool";
+      case FeedEngineMode::SingleThreaded: return "single";
+      default:                             return "unknown";
+    }
+  }
+
+  struct FeedEngineConfig {
+    FeedEngineMode mode{FeedEngineMode::Default};
+
+    // ThreadPool
+    uint32_t threadCount{1};
+    uint32_t spinBeforeIdleMs{1}; // FeedEngineThreadPoolSettings::spinBeforeIdleTime (ms)
+    uint32_t dataWaitMs{10};      // SocketFeedEngine dataWaitTime (ms)
+
+    // Ambos modos con engine propio
+    uint32_t socketBufferBytes{8 * 1024 * 1024};
+
+    // Afinidad: ThreadPool => set de CPUs del pool; SingleThreaded => cpus[0] para el poll thread.
+    // Vacío = sin pinning.
+    std::vector<uint32_t> cpus;
+
+    // SingleThreaded: true = spin puro; false = yield cuando process() no despachó nada.
+    bool busyPoll{true};
+  };
+
+  /**
+   * @brief Dueño del feed engine de OnixS y (en modo single) del thread que lo pollea.
+   *
+   * El Handler NO vive acá: main lo crea en `startFn(engine)` y lo destruye en `stopFn()`.
+   * En modo SingleThreaded ambos callbacks corren en el poll thread (OnixS exige que el
+   * Handler se cree y procese en el mismo thread que construyó el engine).
+   *
+   * Telemetría (solo single): cada 5s emite HealthTick(Adapter) con cantidad de process()
+   * que despacharon eventos y duración max/avg de esos process(), i.e. el costo feed-side
+   * (decode SBE + libro OnixS + build snapshot + enqueue).
+   */
+  class OnixsFeedEngineHost final {
+   public:
+    using FeedEngine = ::OnixS::B3::MarketData::UMDF::FeedEngine;
+    using StartFn = std::function<void(FeedEngine * /*nullptr en Default*/)>;
+    using StopFn = std::function<void()>;
+
+    static constexpr size_t kLogQueueCapacity = 1024;
+
+    explicit OnixsFeedEngineHost(FeedEngineConfig cfg) : cfg_(std::move(cfg)) {}
+
+    OnixsFeedEngineHost(const OnixsFeedEngineHost &) = delete;
+    OnixsFeedEngineHost &operator=(const OnixsFeedEngineHost &) = delete;
+
+    ~OnixsFeedEngineHost() { stop(); }
+
+    const FeedEngineConfig &config() const noexcept { return cfg_; }
+
+    // Producers que pueden llamar callbacks de libro en paralelo (= lanes de ingreso por shard).
+    static uint32_t producerThreads(const FeedEngineConfig &cfg) noexcept {
+      return cfg.mode == FeedEngineMode::ThreadPool && cfg.threadCount > 1 ? cfg.threadCount : 1;
+    }
+    uint32_t producerThreads() const noexcept { return producerThreads(cfg_); }
+
+    // Solo ThreadPool; llamar antes de start(). Lifetime del listener >= host.
+    void setThreadPoolListener(::OnixS::B3::MarketData::UMDF::FeedEngineThreadPoolListener *l) noexcept {
+      poolListener_ = l;
+    }
+
+    // Solo SingleThreaded: corre en el poll thread antes de crear el engine (p.ej. tomar una
+    // lane de ingreso cuando hay varios canales). Llamar antes de start().
+    void setPollThreadStart(std::function<void()> fn) { pollThreadStart_ = std::move(fn); }
+
+    // Crea el engine, corre startFn en el thread correcto y vuelve cuando el Handler arrancó.
+    // Si startFn lanza, la excepción se propaga acá (también desde el poll thread), después de
+    // correr stopFn con el engine todavía vivo (el Handler pudo quedar creado).
+    void start(StartFn startFn, StopFn stopFn) {
+      if (started_)
+        return;
+
+      stopFn_ = std::move(stopFn);
+
+      switch (cfg_.mode) {
+        case FeedEngineMode::Default:
+          startFn(nullptr);
+          break;
+
+        case FeedEngineMode::ThreadPool: {
+          using namespace ::OnixS::B3::MarketData::UMDF;
+
+          socketEngine_ = std::make_unique<SocketFeedEngine>(cfg_.dataWaitMs, cfg_.socketBufferBytes);
+
+          FeedEngineThreadPoolSettings ps;
+          ps.threadCount(cfg_.threadCount == 0 ? 1 : cfg_.threadCount);
+          ps.spinBeforeIdleTime(cfg_.spinBeforeIdleMs);
+          for (uint32_t cpu : cfg_.cpus) ps.threadAffinity().insert(cpu);
+
+          pool_ = std::make_unique<FeedEngineThreadPool>(ps, socketEngine_.get(), poolListener_);
+          try {
+            startFn(socketEngine_.get());
+          } catch (...) {
+            // Un Handler creado a medias apunta al engine: se libera antes que el engine
+            stopQuietly();
+            pool_.reset();
+            socketEngine_.reset();
+            throw;
+          }
+          break;
+        }
+
+        case FeedEngineMode::SingleThreaded: {
+          logger_.start();
+          running_.store(true, std::memory_order_release);
+
+          std::promise<void> started;
+          auto ready = started.get_future();
+          pollThread_ = std::thread(
+              [this, fn = std::move(startFn), p = std::move(started)]() mutable {
+                pollLoop(fn, p);
+              });
+
+          try {
+            ready.get();
+          } catch (...) {
+            running_.store(false, std::memory_order_release);
+            if (pollThread_.joinable())
+              pollThread_.join();
+            logger_.stop();
+            throw;
+          }
+          break;
+        }
+      }
+
+      started_ = true;
+    }
+
+    // Para el Handler (vía stopFn) y libera el engine. Idempotente.
+    void stop() {
+      if (!started_)
+        return;
+      started_ = false;
+
+      if (cfg_.mode == FeedEngineMode::SingleThreaded) {
+        running_.store(false, std::memory_order_release);
+        if (pollThread_.joinable())
+          pollThread_.join();
+        logger_.stop();
+        return;
+      }
+
+      if (stopFn_)
+        stopFn_();
+      pool_.reset();
+      socketEngine_.reset();
+    }
+
+    uint64_t dispatches() const noexcept { return dispatches_.load(std::memory_order_relaxed); }
+    uint64_t maxDispatchNs() const noexcept { return maxDispatchNs_.load(std::memory_order_relaxed); }
+    // El poll thread salió por una excepción después del start (Handler ya parado).
+    bool pollFailed() const noexcept { return loopFailed_.load(std::memory_order_relaxed); }
+
+   private:
+    static uint64_t nowNsSteady() noexcept {
+      const auto now = std::chrono::steady_clock::now().time_since_epoch();
+      return static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+    }
+
+    void emitHealth(uint64_t nowNs, uint64_t dDispatches, uint64_t maxNs, uint64_t avgNs) noexcept {
+      telemetry::LogEvent e{};
+      e.tsNs = nowNs;
+      e.level = telemetry::LogLevel::Health;
+      e.component = telemetry::Component::Adapter;
+      e.code = telemetry::Code::HealthTick;
+      e.arg0 = dDispatches;
+      e.arg1 = ((maxNs & 0xFFFFFFFFull) << 32) | (avgNs & 0xFFFFFFFFull);
+      (void)logger_.try_publish(e);
+    }
+
+    void emitPollFailure(uint64_t nowNs) noexcept {
+      telemetry::LogEvent e{};
+      e.tsNs = nowNs;
+      e.level = telemetry::LogLevel::Error;
+      e.component = telemetry::Component::Adapter;
+      e.code = telemetry::Code::WorkerException;
+      e.arg0 = dispatches_.load(std::memory_order_relaxed);
+      (void)logger_.try_publish(e);
+    }
+
+    void stopQuietly() noexcept {
+      if (!stopFn_)
+        return;
+      try {
+        stopFn_();
+      } catch (...) {
+      }
+    }
+
+    void pollLoop(StartFn &startFn, std::promise<void> &started) noexcept {
+      using namespace ::OnixS::B3::MarketData::UMDF;
+
+      bool signalled = false;
+      try {
+        if (!cfg_.cpus.empty())
+          System::ThisThread::affinity(static_cast<System::CpuIndex>(cfg_.cpus.front()));
+        if (pollThreadStart_)
+          pollThreadStart_();
+
+        // Construido en ESTE thread: process() assertea que el caller sea el mismo thread.
+        SingleThreadedSocketFeedEngine engine(cfg_.socketBufferBytes);
+
+        try {
+          startFn(&engine);
+        } catch (...) {
+          // startFn pudo lanzar con el Handler ya creado: apunta a `engine`, que sale de scope
+          // con el throw. Se libera acá, todavía con el engine vivo y en este thread.
+          stopQuietly();
+          throw;
+        }
+        started.set_value();
+        signalled = true;
+
+        uint64_t nextHealthNs = nowNsSteady() + kHealthEveryNs;
+        uint64_t intervalDispatches = 0;
+        uint64_t intervalTotalNs = 0;
+        uint64_t intervalMaxNs = 0;
+
+        // Falla post-start: el Handler igual se para acá, con el engine todavía vivo (si no,
+        // queda arrancado sin nadie que lo pollee).
+        try {
+          while (running_.load(std::memory_order_acquire)) {
+            const uint64_t t0 = nowNsSteady();
+            const NetFeedEngineProcessResult r = engine.process();
+            const uint64_t t1 = nowNsSteady();
+
+            if (r.eventsDispatched()) {
+              const uint64_t dt = t1 - t0;
+              ++intervalDispatches;
+              intervalTotalNs += dt;
+              if (dt > intervalMaxNs)
+                intervalMaxNs = dt;
+
+              dispatches_.fetch_add(1, std::memory_order_relaxed);
+              if (dt > maxDispatchNs_.load(std::memory_order_relaxed))
+                maxDispatchNs_.store(dt, std::memory_order_relaxed);
+            } else if (!cfg_.busyPoll) {
+              std::this_thread::yield();
+            }
+
+            if (t1 >= nextHealthNs) {
+              nextHealthNs = t1 + kHealthEveryNs;
+              const uint64_t avg = intervalDispatches ? intervalTotalNs / intervalDispatches : 0;
+              emitHealth(t1, intervalDispatches, intervalMaxNs, avg);
+              intervalDispatches = intervalTotalNs = intervalMaxNs = 0;
+            }
+          }
+        } catch (...) {
+          loopFailed_.store(true, std::memory_order_relaxed);
+          emitPollFailure(nowNsSteady());
+        }
+
+        stopQuietly();
+      } catch (...) {
+        if (!signalled) {
+          try {
+            started.set_exception(std::current_exception());
+          } catch (...) {
+          }
+        }
+        // noexcept: swallow (post-start)
+      }
+    }
+
+   private:
+    static constexpr uint64_t kHealthEveryNs = 5'000'000'000ull;
+
+    FeedEngineConfig cfg_;
+    StopFn stopFn_{};
+    bool started_{false};
+
+    // ThreadPool
+    std::unique_ptr<::OnixS::B3::MarketData::UMDF::SocketFeedEngine> socketEngine_;
+    std::unique_ptr<::OnixS::B3::MarketData::UMDF::FeedEngineThreadPool> pool_;
+    ::OnixS::B3::MarketData::UMDF::FeedEngineThreadPoolListener *poolListener_{nullptr};
+
+    // SingleThreaded
+    std::atomic<bool> running_{false};
+    std::function<void()> pollThreadStart_{};
+    std::thread pollThread_{};
+    telemetry::SpdlogLogPublisher<kLogQueueCapacity> logger_;
+
+    std::atomic<uint64_t> dispatches_{0};
+    std::atomic<uint64_t> maxDispatchNs_{0};
+    std::atomic<bool> loopFailed_{false};
+  };
+
+} // namespace b3::md::onixs
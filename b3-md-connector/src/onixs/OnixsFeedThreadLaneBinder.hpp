@@ -0,0 +1,52 @@
+#pragma once
+
+#include "../core/MdPublishPipeline.hpp"
+
+#include <OnixS/B3/MarketData/UMDF/FeedEngine.h>
+
+#include <atomic>
+#include <cstdint>
+
+namespace b3::md::onixs {
+
+  // Adapter: FeedEngineThreadPool -> MdPublishPipeline.
+  // Cada thread del pool se registra en onFeedEngineThreadBegin (corre EN ese thread) y toma
+  // una lane de ingreso propia, así los callbacks de libro de distintos feed threads nunca
+  // comparten una SPSC del worker.
+  class OnixsFeedThreadLaneBinder final
+      : public ::OnixS::B3::MarketData::UMDF::FeedEngineThreadPoolListener {
+   public:
+    explicit OnixsFeedThreadLaneBinder(b3::md::MdPublishPipeline &pipeline) noexcept
+        : pipeline_(pipeline) {}
+
+    OnixsFeedThreadLaneBinder(const OnixsFeedThreadLaneBinder &) = delete;
+    OnixsFeedThreadLaneBinder &operator=(const OnixsFeedThreadLaneBinder &) = delete;
+
+    void onFeedEngineThreadBegin(const ::OnixS::B3::MarketData::UMDF::FeedEngineThreadPool &) override {
+      bindCurrentThread();
+    }
+
+    // También para threads que no son del pool (poll thread de un canal en modo single).
+    void bindCurrentThread() noexcept {
+      if (pipeline_.bindCurrentThreadToLane())
+        bound_.fetch_add(1, std::memory_order_relaxed);
+      else
+        unbound_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void onFeedEngineThreadEnd(const ::OnixS::B3::MarketData::UMDF::FeedEngineThreadPool &) override {
+      ended_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t bound() const noexcept { return bound_.load(std::memory_order_relaxed); }
+    uint64_t unbound() const noexcept { return unbound_.load(std::memory_order_relaxed); }
+    uint64_t ended() const noexcept { return ended_.load(std::memory_order_relaxed); }
+
+   private:
+    b3::md::MdPublishPipeline &pipeline_;
+    std::atomic<uint64_t> bound_{0};
+    std::atomic<uint64_t> unbound_{0};
+    std::atomic<uint64_t> ended_{0};
+  };
+
+} // namespace b3::md::onixs
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <OnixS/B3/MarketData/UMDF/Handler.h>
+#include <OnixS/B3/MarketData/UMDF/Replay.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace b3::md::onixs {
+
+  struct LogReplayConfig {
+    std::string path; // archivo .log o directorio (se toman todos los *.log, viejo -> nuevo)
+    double speed{0};  // 0 = lo más rápido posible; >0 = ritmo grabado × speed
+  };
+
+  /**
+   * @brief Backtest: reproduce logs de OnixS (Handler::replayLogs) y espera a que terminen.
+   *
+   * Reemplaza a handler->start(): el Handler, los listeners y todo el stack
+   * (engine -> pipeline -> concentrator) son los de producción, solo cambia la fuente.
+   * No usa feed engine ni red (corre en cualquier Linux sin conectividad B3).
+   */
+  class OnixsLogReplay final : public ::OnixS::B3::MarketData::UMDF::ReplayListener {
+   public:
+    using Handler = ::OnixS::B3::MarketData::UMDF::Handler;
+
+    explicit OnixsLogReplay(LogReplayConfig cfg) : cfg_(std::move(cfg)) {}
+
+    // Lista de archivos resuelta; lanza si el path no existe o no hay logs.
+    ::OnixS::B3::MarketData::UMDF::ReplayOptions options() {
+      namespace fs = std::filesystem;
+      using namespace ::OnixS::B3::MarketData::UMDF;
+
+      ReplayOptions opt;
+      if (fs::is_directory(cfg_.path)) {
+        gatherLogs(&opt.files, cfg_.path);
+      } else if (fs::exists(cfg_.path)) {
+        opt.files.push_back(cfg_.path);
+      }
+      if (opt.files.empty())
+        throw std::runtime_error("replay: no log files at " + cfg_.path);
+
+      opt.listener = this;
+      opt.packetReplayDelay = 0;
+      if (cfg_.speed > 0) {
+        // FinalDelay = LogFileDelay * playSpeedMultiplier (+ packetReplayDelay)
+        opt.replayMode = ReplayMode::NaturalPacketReplayDelay;
+        opt.playSpeedMultiplier = static_cast<float>(1.0 / cfg_.speed);
+      } else {
+        opt.replayMode = ReplayMode::ConstantPacketReplayDelay;
+      }
+      return opt;
+    }
+
+    // Arranca el replay y bloquea hasta onReplayFinished/onReplayError. Devuelve la duración.
+    std::chrono::nanoseconds run(Handler &handler) {
+      finished_ = false;
+      const auto opt = options();
+      files_ = opt.files.size();
+
+      const auto t0 = std::chrono::steady_clock::now();
+      handler.replayLogs(opt);
+
+      std::unique_lock<std::mutex> lk(m_);
+      cv_.wait(lk, [this] { return done_; });
+      elapsed_ = std::chrono::steady_clock::now() - t0;
+      finished_ = true;
+      return elapsed_;
+    }
+
+    void onReplayError(const std::string &errorDescription) override {
+      std::lock_guard<std::mutex> g(m_);
+      error_ = errorDescription;
+      done_ = true;
+      cv_.notify_all();
+    }
+
+    void onReplayFinished() override {
+      std::lock_guard<std::mutex> g(m_);
+      done_ = true;
+      cv_.notify_all();
+    }
+
+    const std::string &error() const noexcept { return error_; }
+    bool finished() const noexcept { return finished_; }
+    std::chrono::nanoseconds elapsed() const noexcept { return elapsed_; }
+    size_t files() const noexcept { return files_; }
+    const LogReplayConfig &config() const noexcept { return cfg_; }
+
+   private:
+    LogReplayConfig cfg_;
+    size_t files_{0};
+    bool finished_{false};
+    std::chrono::nanoseconds elapsed_{0};
+
+    std::mutex m_;
+    std::condition_variable cv_;
+    bool done_{false};
+    std::string error_;
+  };
+
+} // namespace b3::md::onixs
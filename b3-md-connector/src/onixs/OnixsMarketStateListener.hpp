@@ -0,0 +1,195 @@
+#pragma once
+
+#include "../core/MarketDataEngine.hpp"
+#include "../core/MarketStateEvent.hpp"
+
+#include <OnixS/B3/MarketData/UMDF/MessageListener.h>
+#include <OnixS/B3/MarketData/UMDF/messaging/Messages.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+namespace b3::md::onixs {
+
+  // Adapter: estado de mercado de OnixS -> MarketStateEvent -> MarketDataEngine::onMarketState.
+  // SecurityStatus_3, SecurityGroupPhase_10, AuctionImbalance_19, TheoreticalOpeningPrice_16,
+  // PriceBand_22, QuantityBand_21. Copia POD en el callback, sin heap.
+  class OnixsMarketStateListener final : public ::OnixS::B3::MarketData::UMDF::MessageListener {
+   public:
+    explicit OnixsMarketStateListener(b3::md::MarketDataEngine &engine) noexcept
+        : engine_(engine) {}
+
+    OnixsMarketStateListener(const OnixsMarketStateListener &) = delete;
+    OnixsMarketStateListener &operator=(const OnixsMarketStateListener &) = delete;
+
+    void onSecurityStatus_3(const ::OnixS::B3::MarketData::UMDF::Messaging::SecurityStatus_3 msg,
+                            const ::OnixS::B3::MarketData::UMDF::DataSource &) override {
+      using namespace ::OnixS::B3::MarketData::UMDF::Messaging;
+
+      MarketStateEvent e{};
+      e.kind = MarketStateKind::SecurityStatus;
+      e.instrumentId = static_cast<uint64_t>(msg.securityId());
+      e.status = static_cast<uint8_t>(msg.securityTradingStatus());
+
+      SecurityTradingEvent::Enum ev;
+      if (msg.securityTradingEvent(ev))
+        e.tradingEvent = static_cast<uint8_t>(ev);
+
+      UTCTimestampNanos ts;
+      if (msg.transactTime(ts))
+        e.transactTimeNs = static_cast<uint64_t>(ts.time());
+
+      RptSeq seq;
+      if (msg.rptSeq(seq))
+        e.rptSeq = static_cast<uint32_t>(seq);
+
+      dispatch(e);
+    }
+
+    void onSecurityGroupPhase_10(
+        const ::OnixS::B3::MarketData::UMDF::Messaging::SecurityGroupPhase_10 msg,
+        const ::OnixS::B3::MarketData::UMDF::DataSource &) override {
+      using namespace ::OnixS::B3::MarketData::UMDF::Messaging;
+
+      MarketStateEvent e{};
+      e.kind = MarketStateKind::GroupPhase;
+      const auto group = msg.securityGroup();
+      std::memcpy(e.group, group.data(), std::min<size_t>(3, group.size()));
+      e.status = static_cast<uint8_t>(msg.tradingSessionSubId());
+
+      SecurityTradingEvent::Enum ev;
+      if (msg.securityTradingEvent(ev))
+        e.tradingEvent = static_cast<uint8_t>(ev);
+
+      UTCTimestampNanos ts;
+      if (msg.transactTime(ts))
+        e.transactTimeNs = static_cast<uint64_t>(ts.time());
+
+      dispatch(e);
+    }
+
+    void onAuctionImbalance_19(
+        const ::OnixS::B3::MarketData::UMDF::Messaging::AuctionImbalance_19 msg,
+        const ::OnixS::B3::MarketData::UMDF::DataSource &) override {
+      using namespace ::OnixS::B3::MarketData::UMDF::Messaging;
+
+      MarketStateEvent e{};
+      e.kind = MarketStateKind::AuctionImbalance;
+      fillEntry(msg, e);
+
+      QuantityOptional qty;
+      if (msg.mDEntrySize(qty)) {
+        const bool sellers = msg.imbalanceCondition().imbalanceMoreSellers();
+        e.qty = sellers ? -static_cast<int64_t>(qty) : static_cast<int64_t>(qty);
+        e.flags |= MarketStateEvent::kHasQty;
+      }
+
+      dispatch(e);
+    }
+
+    void onTheoreticalOpeningPrice_16(
+        const ::OnixS::B3::MarketData::UMDF::Messaging::TheoreticalOpeningPrice_16 msg,
+        const ::OnixS::B3::MarketData::UMDF::DataSource &) override {
+      using namespace ::OnixS::B3::MarketData::UMDF::Messaging;
+
+      MarketStateEvent e{};
+      e.kind = MarketStateKind::TheoreticalOpening;
+      fillEntry(msg, e);
+
+      PriceOptional px;
+      if (msg.mDEntryPx(px)) {
+        e.price = static_cast<int64_t>(px.mantissa());
+        e.flags |= MarketStateEvent::kHasPrice;
+      }
+      QuantityOptional qty;
+      if (msg.mDEntrySize(qty)) {
+        e.qty = static_cast<int64_t>(qty);
+        e.flags |= MarketStateEvent::kHasQty;
+      }
+
+      dispatch(e);
+    }
+
+    void onPriceBand_22(const ::OnixS::B3::MarketData::UMDF::Messaging::PriceBand_22 msg,
+                        const ::OnixS::B3::MarketData::UMDF::DataSource &) override {
+      using namespace ::OnixS::B3::MarketData::UMDF::Messaging;
+
+      MarketStateEvent e{};
+      e.kind = MarketStateKind::PriceBand;
+      fillEntry(msg, e);
+
+      PriceOptional px;
+      if (msg.lowLimitPrice(px)) {
+        e.price = static_cast<int64_t>(px.mantissa());
+        e.flags |= MarketStateEvent::kHasPrice;
+      }
+      if (msg.highLimitPrice(px)) {
+        e.price2 = static_cast<int64_t>(px.mantissa());
+        e.flags |= MarketStateEvent::kHasPrice2;
+      }
+      Fixed8 ref;
+      if (msg.tradingReferencePrice(ref)) {
+        // Fixed8 (8 decimales) -> mantissa de 4 decimales como el resto
+        e.price3 = static_cast<int64_t>(ref.mantissa()) / 10000;
+        e.flags |= MarketStateEvent::kHasPrice3;
+      }
+
+      dispatch(e);
+    }
+
+    void onQuantityBand_21(const ::OnixS::B3::MarketData::UMDF::Messaging::QuantityBand_21 msg,
+                           const ::OnixS::B3::MarketData::UMDF::DataSource &) override {
+      using namespace ::OnixS::B3::MarketData::UMDF::Messaging;
+
+      MarketStateEvent e{};
+      e.kind = MarketStateKind::QuantityBand;
+      fillEntry(msg, e);
+
+      QuantityVolumeOptional v;
+      if (msg.avgDailyTradedQty(v)) {
+        e.qty = static_cast<int64_t>(v);
+        e.flags |= MarketStateEvent::kHasQty;
+      }
+      if (msg.maxTradeVol(v)) {
+        e.qty2 = static_cast<int64_t>(v);
+        e.flags |= MarketStateEvent::kHasQty2;
+      }
+
+      dispatch(e);
+    }
+
+    uint64_t received() const noexcept { return received_.load(std::memory_order_relaxed); }
+
+   private:
+    // securityId / timestamp / rptSeq / DELETE: mismos nombres en 16, 19, 21 y 22
+    template <typename Msg>
+    static void fillEntry(const Msg &msg, MarketStateEvent &e) noexcept {
+      using namespace ::OnixS::B3::MarketData::UMDF::Messaging;
+
+      e.instrumentId = static_cast<uint64_t>(msg.securityId());
+
+      if constexpr (requires { msg.mDUpdateAction(); })
+        e.deleted = msg.mDUpdateAction() == UpdateAction::DELETE;
+
+      UTCTimestampNanos ts;
+      if (msg.mDEntryTimestamp(ts))
+        e.transactTimeNs = static_cast<uint64_t>(ts.time());
+
+      RptSeq seq;
+      if (msg.rptSeq(seq))
+        e.rptSeq = static_cast<uint32_t>(seq);
+    }
+
+    void dispatch(const MarketStateEvent &e) noexcept {
+      received_.fetch_add(1, std::memory_order_relaxed);
+      engine_.onMarketState(e);
+    }
+
+    b3::md::MarketDataEngine &engine_;
+
+    std::atomic<uint64_t> received_{0};
+  };
+
+} // namespace b3::md::onixs
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <OnixS/B3/MarketData/UMDF/MessageListener.h>
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+
+namespace b3::md::onixs {
+
+  // El Handler de OnixS acepta un solo MessageListener: este lo reparte a varios
+  // (registry de instrumentos, trades, ...), en orden de registro y en el mismo thread.
+  // add() antes de handler->start(); después la lista es inmutable (sin locks en el callback).
+  class OnixsMessageListenerFanout final : public ::OnixS::B3::MarketData::UMDF::MessageListener {
+   public:
+    static constexpr size_t kMaxListeners = 8;
+
+    using Listener = ::OnixS::B3::MarketData::UMDF::MessageListener;
+    using DataSource = ::OnixS::B3::MarketData::UMDF::DataSource;
+
+    void add(Listener *listener) {
+      if (!listener)
+        return;
+      if (count_ == kMaxListeners)
+        throw std::length_error("OnixsMessageListenerFanout: too many listeners");
+      listeners_[count_++] = listener;
+    }
+
+    size_t size() const noexcept { return count_; }
+
+    void onSequenceReset_1(const ::OnixS::B3::MarketData::UMDF::Messaging::SequenceReset_1 m,
+                           const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onSequenceReset_1(m, ds);
+    }
+
+    void onSequence_2(const ::OnixS::B3::MarketData::UMDF::Messaging::Sequence_2 m,
+                      const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onSequence_2(m, ds);
+    }
+
+    void onEmptyBook_9(const ::OnixS::B3::MarketData::UMDF::Messaging::EmptyBook_9 m,
+                       const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onEmptyBook_9(m, ds);
+    }
+
+    void onChannelReset_11(const ::OnixS::B3::MarketData::UMDF::Messaging::ChannelReset_11 m,
+                           const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onChannelReset_11(m, ds);
+    }
+
+    void onSecurityStatus_3(const ::OnixS::B3::MarketData::UMDF::Messaging::SecurityStatus_3 m,
+                            const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onSecurityStatus_3(m, ds);
+    }
+
+    void onSecurityGroupPhase_10(
+        const ::OnixS::B3::MarketData::UMDF::Messaging::SecurityGroupPhase_10 m,
+        const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onSecurityGroupPhase_10(m, ds);
+    }
+
+    void onSecurityDefinition_12(
+        const ::OnixS::B3::MarketData::UMDF::Messaging::SecurityDefinition_12 m,
+        const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onSecurityDefinition_12(m, ds);
+    }
+
+    void onSnapshotFullRefresh_Header_30(
+        const ::OnixS::B3::MarketData::UMDF::Messaging::SnapshotFullRefresh_Header_30 m,
+        const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onSnapshotFullRefresh_Header_30(m, ds);
+    }
+
+    void onSnapshotFullRefresh_Orders_MBO_71(
+        const ::OnixS::B3::MarketData::UMDF::Messaging::SnapshotFullRefresh_Orders_MBO_71 m,
+        const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onSnapshotFullRefresh_Orders_MBO_71(m, ds);
+    }
+
+    void onNews_5(const ::OnixS::B3::MarketData::UMDF::Messaging::News_5 m,
+                  const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onNews_5(m, ds);
+    }
+
+    void onClosingPrice_17(const ::OnixS::B3::MarketData::UMDF::Messaging::ClosingPrice_17 m,
+                           const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onClosingPrice_17(m, ds);
+    }
+
+    void onQuantityBand_21(const ::OnixS::B3::MarketData::UMDF::Messaging::QuantityBand_21 m,
+                           const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onQuantityBand_21(m, ds);
+    }
+
+    void onPriceBand_22(const ::OnixS::B3::MarketData::UMDF::Messaging::PriceBand_22 m,
+                        const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onPriceBand_22(m, ds);
+    }
+
+    void onOpeningPrice_15(const ::OnixS::B3::MarketData::UMDF::Messaging::OpeningPrice_15 m,
+                           const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onOpeningPrice_15(m, ds);
+    }
+
+    void onTheoreticalOpeningPrice_16(
+        const ::OnixS::B3::MarketData::UMDF::Messaging::TheoreticalOpeningPrice_16 m,
+        const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onTheoreticalOpeningPrice_16(m, ds);
+    }
+
+    void onAuctionImbalance_19(
+        const ::OnixS::B3::MarketData::UMDF::Messaging::AuctionImbalance_19 m,
+        const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onAuctionImbalance_19(m, ds);
+    }
+
+    void onHighPrice_24(const ::OnixS::B3::MarketData::UMDF::Messaging::HighPrice_24 m,
+                        const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onHighPrice_24(m, ds);
+    }
+
+    void onLowPrice_25(const ::OnixS::B3::MarketData::UMDF::Messaging::LowPrice_25 m,
+                       const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onLowPrice_25(m, ds);
+    }
+
+    void onLastTradePrice_27(const ::OnixS::B3::MarketData::UMDF::Messaging::LastTradePrice_27 m,
+                             const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onLastTradePrice_27(m, ds);
+    }
+
+    void onSettlementPrice_28(const ::OnixS::B3::MarketData::UMDF::Messaging::SettlementPrice_28 m,
+                              const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onSettlementPrice_28(m, ds);
+    }
+
+    void onOpenInterest_29(const ::OnixS::B3::MarketData::UMDF::Messaging::OpenInterest_29 m,
+                           const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onOpenInterest_29(m, ds);
+    }
+
+    void onOrder_MBO_50(const ::OnixS::B3::MarketData::UMDF::Messaging::Order_MBO_50 m,
+                        const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onOrder_MBO_50(m, ds);
+    }
+
+    void onDeleteOrder_MBO_51(const ::OnixS::B3::MarketData::UMDF::Messaging::DeleteOrder_MBO_51 m,
+                              const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onDeleteOrder_MBO_51(m, ds);
+    }
+
+    void onMassDeleteOrders_MBO_52(
+        const ::OnixS::B3::MarketData::UMDF::Messaging::MassDeleteOrders_MBO_52 m,
+        const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onMassDeleteOrders_MBO_52(m, ds);
+    }
+
+    void onTrade_53(const ::OnixS::B3::MarketData::UMDF::Messaging::Trade_53 m,
+                    const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onTrade_53(m, ds);
+    }
+
+    void onForwardTrade_54(const ::OnixS::B3::MarketData::UMDF::Messaging::ForwardTrade_54 m,
+                           const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onForwardTrade_54(m, ds);
+    }
+
+    void onExecutionSummary_55(
+        const ::OnixS::B3::MarketData::UMDF::Messaging::ExecutionSummary_55 m,
+        const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onExecutionSummary_55(m, ds);
+    }
+
+    void onExecutionStatistics_56(
+        const ::OnixS::B3::MarketData::UMDF::Messaging::ExecutionStatistics_56 m,
+        const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onExecutionStatistics_56(m, ds);
+    }
+
+    void onTradeBust_57(const ::OnixS::B3::MarketData::UMDF::Messaging::TradeBust_57 m,
+                        const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onTradeBust_57(m, ds);
+    }
+
+    void onUnknownMessage(const ::OnixS::B3::MarketData::UMDF::Messaging::SbeMessage m,
+                          const DataSource &ds) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onUnknownMessage(m, ds);
+    }
+
+    void onInstrumentChannelGap() override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onInstrumentChannelGap();
+    }
+
+    void onInstrumentChannelInactivity() override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onInstrumentChannelInactivity();
+    }
+
+    void onInstrumentRecoveryStarted() override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onInstrumentRecoveryStarted();
+    }
+
+    void onInstrumentRecoveryFinished() override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onInstrumentRecoveryFinished();
+    }
+
+    void onSnapshotChannelGap() override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onSnapshotChannelGap();
+    }
+
+    void onSnapshotChannelInactivity() override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onSnapshotChannelInactivity();
+    }
+
+    void onSnapshotRecoveryStarted() override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onSnapshotRecoveryStarted();
+    }
+
+    void onSnapshotRecoveryFinished() override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onSnapshotRecoveryFinished();
+    }
+
+    void onIncrementalChannelGap() override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onIncrementalChannelGap();
+    }
+
+    void onIncrementalChannelInactivity() override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onIncrementalChannelInactivity();
+    }
+
+    void onInstrumentSequenceGap(::OnixS::B3::MarketData::UMDF::Messaging::SecurityID id) override {
+      for (size_t i = 0; i < count_; ++i) listeners_[i]->onInstrumentSequenceGap(id);
+    }
+
+   private:
+    std::array<Listener *, kMaxListeners> listeners_{};
+    size_t count_{0};
+  };
+
+} // namespace b3::md::onixs
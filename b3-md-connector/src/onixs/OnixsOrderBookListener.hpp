@@ -48,9 +48,15 @@ public:
         engine_.injectTestSnapshot(snapshot);
     }
 
-    void onOrderBookOutOfDate(const ::OnixS::B3::MarketData::UMDF::OrderBook& /*book*/) override {
+    // El libro deja de ser confiable hasta el próximo onOrderBookUpdated: el engine lo marca stale
+    // y publica el marcador "book invalid" (si tiene BookStaleTable).
+    void onOrderBookOutOfDate(const ::OnixS::B3::MarketData::UMDF::OrderBook& book) override {
+        const auto now = std::chrono::system_clock::now().time_since_epoch();
+        const uint64_t nowNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+
         outOfDateCount_.fetch_add(1, std::memory_order_relaxed);
-        // TODO(B3): emitir health/counter para marcar "books outdated" (sin bloquear).
+        engine_.onBookOutOfDate(static_cast<uint64_t>(book.instrumentId()),
+                                static_cast<uint64_t>(book.lastRptSeq()), nowNs);
     }
 
     uint64_t changedCount() const noexcept { return changedCount_.load(std::memory_order_relaxed); }
@@ -18,10 +18,15 @@ namespace b3::md::onixs {
   // - NO agrupa por niveles (eso se hace en worker)
   // - saltea órdenes con precio null (market orders), porque no aportan a MBP por niveles de
   // precio.
+  //
+  // Book: en producción OnixS OrderBook. Template para poder medirlo/testearlo con un libro
+  // fake que exponga la misma superficie (instrumentId, lastRptSeq, lastMessageSeqNumApplied,
+  // bids()/asks() indexables de Order): el OrderBook de OnixS no se puede construir afuera.
   struct OnixsOrdersSnapshotBuilder final {
     using OrderBook = OnixS::B3::MarketData::UMDF::OrderBook;
 
-    static inline void buildFromBook(const OrderBook &book, uint64_t nowNs,
+    template <typename Book = OrderBook>
+    static inline void buildFromBook(const Book &book, uint64_t nowNs,
                                      b3::md::OrdersSnapshot &out) noexcept {
       // Reset POD
       out = b3::md::OrdersSnapshot{};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "../core/MarketDataEngine.hpp"
+#include "../core/TradeEvent.hpp"
+
+#include <OnixS/B3/MarketData/UMDF/MessageListener.h>
+#include <OnixS/B3/MarketData/UMDF/messaging/Messages.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace b3::md::onixs {
+
+  // Adapter: precios estadísticos del exchange (OpeningPrice_15, HighPrice_24, LowPrice_25,
+  // ClosingPrice_17, SettlementPrice_28) -> TradeEvent (kind = *Price) -> MarketDataEngine::onTrade.
+  // Viajan por la lane de trades para quedar en FIFO con los trades del mismo instrumento;
+  // los consume MdStatsEngine, no se publican sueltos.
+  class OnixsStatisticsListener final : public ::OnixS::B3::MarketData::UMDF::MessageListener {
+   public:
+    explicit OnixsStatisticsListener(b3::md::MarketDataEngine &engine) noexcept
+        : engine_(engine) {}
+
+    OnixsStatisticsListener(const OnixsStatisticsListener &) = delete;
+    OnixsStatisticsListener &operator=(const OnixsStatisticsListener &) = delete;
+
+    void onOpeningPrice_15(const ::OnixS::B3::MarketData::UMDF::Messaging::OpeningPrice_15 msg,
+                           const ::OnixS::B3::MarketData::UMDF::DataSource &) override {
+      dispatch(msg, TradeKind::OpeningPrice, msg.mDEntryPx().mantissa());
+    }
+
+    void onHighPrice_24(const ::OnixS::B3::MarketData::UMDF::Messaging::HighPrice_24 msg,
+                        const ::OnixS::B3::MarketData::UMDF::DataSource &) override {
+      dispatch(msg, TradeKind::HighPrice, msg.mDEntryPx().mantissa());
+    }
+
+    void onLowPrice_25(const ::OnixS::B3::MarketData::UMDF::Messaging::LowPrice_25 msg,
+                       const ::OnixS::B3::MarketData::UMDF::DataSource &) override {
+      dispatch(msg, TradeKind::LowPrice, msg.mDEntryPx().mantissa());
+    }
+
+    void onClosingPrice_17(const ::OnixS::B3::MarketData::UMDF::Messaging::ClosingPrice_17 msg,
+                           const ::OnixS::B3::MarketData::UMDF::DataSource &) override {
+      // Price8 (8 decimales) -> mantissa de 4 decimales como el resto
+      dispatch(msg, TradeKind::ClosingPrice, msg.mDEntryPx().mantissa() / 10000);
+    }
+
+    void onSettlementPrice_28(
+        const ::OnixS::B3::MarketData::UMDF::Messaging::SettlementPrice_28 msg,
+        const ::OnixS::B3::MarketData::UMDF::DataSource &) override {
+      dispatch(msg, TradeKind::SettlementPrice, msg.mDEntryPx().mantissa());
+    }
+
+    // Reset del canal = sesión nueva para las stats (volumen/#trades/precios arrancan de cero).
+    // SequenceReset_1 no sirve: abre también cada vuelta de los loops de SecDef/snapshot.
+    void onChannelReset_11(const ::OnixS::B3::MarketData::UMDF::Messaging::ChannelReset_11,
+                           const ::OnixS::B3::MarketData::UMDF::DataSource &) override {
+      engine_.onSessionReset();
+    }
+
+    uint64_t received() const noexcept { return received_.load(std::memory_order_relaxed); }
+
+   private:
+    template <typename Msg>
+    void dispatch(const Msg &msg, TradeKind kind, int64_t priceMantissa) noexcept {
+      using namespace ::OnixS::B3::MarketData::UMDF::Messaging;
+
+      TradeEvent t{};
+      t.instrumentId = static_cast<uint64_t>(msg.securityId());
+      t.priceMantissa = priceMantissa;
+      t.kind = kind;
+
+      if constexpr (requires { msg.mDUpdateAction(); })
+        t.deleted = msg.mDUpdateAction() == UpdateAction::DELETE;
+
+      UTCTimestampNanos ts;
+      if (msg.mDEntryTimestamp(ts))
+        t.transactTimeNs = static_cast<uint64_t>(ts.time());
+
+      RptSeq seq;
+      if (msg.rptSeq(seq))
+        t.rptSeq = static_cast<uint32_t>(seq);
+
+      const auto now = std::chrono::system_clock::now().time_since_epoch();
+      t.recvTsNs =
+          static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+
+      received_.fetch_add(1, std::memory_order_relaxed);
+      engine_.onTrade(t);
+    }
+
+    b3::md::MarketDataEngine &engine_;
+
+    std::atomic<uint64_t> received_{0};
+  };
+
+} // namespace b3::md::onixs
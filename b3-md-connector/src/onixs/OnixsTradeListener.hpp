@@ -0,0 +1,100 @@
+#pragma once
+
+#include "../core/MarketDataEngine.hpp"
+#include "../core/TradeEvent.hpp"
+
+#include <OnixS/B3/MarketData/UMDF/MessageListener.h>
+#include <OnixS/B3/MarketData/UMDF/messaging/Messages.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace b3::md::onixs {
+
+  // Adapter: mensajes de trade de OnixS (Trade_53 / ForwardTrade_54 / TradeBust_57) -> TradeEvent
+  // -> MarketDataEngine::onTrade. Copia POD en el callback, sin heap.
+  class OnixsTradeListener final : public ::OnixS::B3::MarketData::UMDF::MessageListener {
+   public:
+    explicit OnixsTradeListener(b3::md::MarketDataEngine &engine) noexcept : engine_(engine) {}
+
+    OnixsTradeListener(const OnixsTradeListener &) = delete;
+    OnixsTradeListener &operator=(const OnixsTradeListener &) = delete;
+
+    void onTrade_53(const ::OnixS::B3::MarketData::UMDF::Messaging::Trade_53 msg,
+                    const ::OnixS::B3::MarketData::UMDF::DataSource &) override {
+      TradeEvent t{};
+      fillCommon(msg, t);
+      t.kind = TradeKind::Trade;
+      t.condition = static_cast<uint16_t>(msg.tradeCondition().bits());
+      fillFirms(msg, t);
+      dispatch(t);
+    }
+
+    void onForwardTrade_54(const ::OnixS::B3::MarketData::UMDF::Messaging::ForwardTrade_54 msg,
+                           const ::OnixS::B3::MarketData::UMDF::DataSource &) override {
+      TradeEvent t{};
+      fillCommon(msg, t);
+      t.kind = TradeKind::ForwardTrade;
+      t.condition = static_cast<uint16_t>(msg.tradeCondition().bits());
+      fillFirms(msg, t);
+      dispatch(t);
+    }
+
+    void onTradeBust_57(const ::OnixS::B3::MarketData::UMDF::Messaging::TradeBust_57 msg,
+                        const ::OnixS::B3::MarketData::UMDF::DataSource &) override {
+      TradeEvent t{};
+      fillCommon(msg, t);
+      t.kind = TradeKind::Bust;
+      busts_.fetch_add(1, std::memory_order_relaxed);
+      dispatch(t);
+    }
+
+    uint64_t trades() const noexcept { return trades_.load(std::memory_order_relaxed); }
+    uint64_t busts() const noexcept { return busts_.load(std::memory_order_relaxed); }
+
+   private:
+    // Campos comunes a los tres mensajes (mismos nombres en el SBE)
+    template <typename Msg>
+    static void fillCommon(const Msg &msg, TradeEvent &t) noexcept {
+      using namespace ::OnixS::B3::MarketData::UMDF::Messaging;
+
+      t.instrumentId = static_cast<uint64_t>(msg.securityId());
+      t.priceMantissa = static_cast<int64_t>(msg.mDEntryPx().mantissa());
+      t.qty = static_cast<int64_t>(msg.mDEntrySize());
+      t.tradeId = static_cast<uint32_t>(msg.tradeId());
+
+      UTCTimestampNanos transact;
+      if (msg.transactTime(transact))
+        t.transactTimeNs = static_cast<uint64_t>(transact.time());
+
+      RptSeq seq;
+      if (msg.rptSeq(seq))
+        t.rptSeq = static_cast<uint32_t>(seq);
+
+      const auto now = std::chrono::system_clock::now().time_since_epoch();
+      t.recvTsNs =
+          static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+    }
+
+    template <typename Msg>
+    static void fillFirms(const Msg &msg, TradeEvent &t) noexcept {
+      ::OnixS::B3::MarketData::UMDF::Messaging::FirmOptional firm;
+      if (msg.mDEntryBuyer(firm))
+        t.buyer = static_cast<uint32_t>(firm);
+      if (msg.mDEntrySeller(firm))
+        t.seller = static_cast<uint32_t>(firm);
+    }
+
+    void dispatch(const TradeEvent &t) noexcept {
+      trades_.fetch_add(1, std::memory_order_relaxed);
+      engine_.onTrade(t);
+    }
+
+    b3::md::MarketDataEngine &engine_;
+
+    std::atomic<uint64_t> trades_{0};
+    std::atomic<uint64_t> busts_{0};
+  };
+
+} // namespace b3::md::onixs
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "SerializedEnvelope.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace b3::md::publishing {
+
+  /**
+   * @brief Frame de varios updates (topic + payload serializado cada uno) en un solo mensaje.
+   *
+   * Layout (little endian, sin padding):
+   *   header  : magic u32 ("B3MB") | version u16 | count u16
+   *   index   : count x { offset u16 | size u16 | topicLen u8 | reserved u8 }
+   *   data    : por entrada, topic y después payload; offset = desde el inicio del frame
+   *
+   * El índice va adelante: el consumidor salta a la entrada i sin recorrer las anteriores.
+   * Tope = SerializedEnvelope::kMaxBytes (lo mismo que acepta Publisher::SendSerialized).
+   */
+  namespace batch {
+    inline constexpr uint32_t kMagic = 0x424D3342u; // "B3MB"
+    inline constexpr uint16_t kVersion = 1;
+    inline constexpr size_t kHeaderBytes = 8;
+    inline constexpr size_t kEntryBytes = 6;
+    inline constexpr size_t kMaxBytes = SerializedEnvelope::kMaxBytes;
+    inline constexpr size_t kMaxEntries = (kMaxBytes - kHeaderBytes) / kEntryBytes;
+
+    inline void putU16(uint8_t *p, uint16_t v) noexcept { std::memcpy(p, &v, sizeof v); }
+    inline void putU32(uint8_t *p, uint32_t v) noexcept { std::memcpy(p, &v, sizeof v); }
+    inline uint16_t getU16(const uint8_t *p) noexcept {
+      uint16_t v;
+      std::memcpy(&v, p, sizeof v);
+      return v;
+    }
+    inline uint32_t getU32(const uint8_t *p) noexcept {
+      uint32_t v;
+      std::memcpy(&v, p, sizeof v);
+      return v;
+    }
+  } // namespace batch
+
+  // Arma un frame. Un solo thread (el del concentrator); sin allocations.
+  class BatchFrameBuilder final {
+   public:
+    bool empty() const noexcept { return count_ == 0; }
+    uint16_t count() const noexcept { return count_; }
+    size_t bytes() const noexcept { return frameBytes(count_, dataLen_); }
+
+    // steady ns del primer update del frame (timer de flush).
+    uint64_t firstNs() const noexcept { return firstNs_; }
+
+    // false = no entra en lo que queda (flushear y reintentar) o no entra ni en un frame vacío.
+    bool tryAdd(const char *topic, uint8_t topicLen, const uint8_t *payload, uint32_t size,
+                uint64_t nowNs) noexcept {
+      const size_t entry = static_cast<size_t>(topicLen) + size;
+      if (count_ == batch::kMaxEntries ||
+          frameBytes(count_ + 1u, dataLen_ + entry) > batch::kMaxBytes)
+        return false;
+
+      auto &e = index_[count_];
+      e.offset = static_cast<uint16_t>(dataLen_);
+      e.size = static_cast<uint16_t>(size);
+      e.topicLen = topicLen;
+      std::memcpy(data_ + dataLen_, topic, topicLen);
+      std::memcpy(data_ + dataLen_ + topicLen, payload, size);
+      dataLen_ += entry;
+
+      if (count_++ == 0)
+        firstNs_ = nowNs;
+      return true;
+    }
+
+    // Escribe el frame en `out` (>= bytes()) y vacía el builder. Devuelve los bytes escritos.
+    size_t finish(uint8_t *out) noexcept {
+      const size_t indexBytes = static_cast<size_t>(count_) * batch::kEntryBytes;
+      const size_t base = batch::kHeaderBytes + indexBytes;
+
+      batch::putU32(out, batch::kMagic);
+      batch::putU16(out + 4, batch::kVersion);
+      batch::putU16(out + 6, count_);
+      for (uint16_t i = 0; i < count_; ++i) {
+        uint8_t *p = out + batch::kHeaderBytes + static_cast<size_t>(i) * batch::kEntryBytes;
+        batch::putU16(p, static_cast<uint16_t>(base + index_[i].offset));
+        batch::putU16(p + 2, index_[i].size);
+        p[4] = index_[i].topicLen;
+        p[5] = 0;
+      }
+      std::memcpy(out + base, data_, dataLen_);
+
+      const size_t n = base + dataLen_;
+      count_ = 0;
+      dataLen_ = 0;
+      return n;
+    }
+
+   private:
+    struct Entry {
+      uint16_t offset; // dentro de data_ (finish() le suma header + índice)
+      uint16_t size;
+      uint8_t topicLen;
+    };
+
+    static constexpr size_t frameBytes(size_t count, size_t dataLen) noexcept {
+      return batch::kHeaderBytes + count * batch::kEntryBytes + dataLen;
+    }
+
+    Entry index_[batch::kMaxEntries]{};
+    uint8_t data_[batch::kMaxBytes]{};
+    size_t dataLen_{0};
+    uint16_t count_{0};
+    uint64_t firstNs_{0};
+  };
+
+  // Lectura de un frame (consumidores / tests). No copia: las vistas apuntan al buffer.
+  class BatchFrameView final {
+   public:
+    struct Update {
+      std::string_view topic;
+      const uint8_t *payload;
+      uint32_t size;
+    };
+
+    // false = no es un frame válido (magic/versión/índice fuera de rango).
+    bool parse(const void *frame, size_t len) noexcept {
+      p_ = static_cast<const uint8_t *>(frame);
+      len_ = len;
+      count_ = 0;
+      if (len < batch::kHeaderBytes || batch::getU32(p_) != batch::kMagic ||
+          batch::getU16(p_ + 4) != batch::kVersion)
+        return false;
+      const uint16_t count = batch::getU16(p_ + 6);
+      if (batch::kHeaderBytes + static_cast<size_t>(count) * batch::kEntryBytes > len)
+        return false;
+      for (uint16_t i = 0; i < count; ++i) {
+        const uint8_t *e = entryAt(i);
+        const size_t end = static_cast<size_t>(batch::getU16(e)) + e[4] + batch::getU16(e + 2);
+        if (end > len)
+          return false;
+      }
+      count_ = count;
+      return true;
+    }
+
+    uint16_t count() const noexcept { return count_; }
+
+    Update at(uint16_t i) const noexcept {
+      const uint8_t *e = entryAt(i);
+      const uint8_t *topic = p_ + batch::getU16(e);
+      const uint8_t topicLen = e[4];
+      return {std::string_view(reinterpret_cast<const char *>(topic), topicLen), topic + topicLen,
+              batch::getU16(e + 2)};
+    }
+
+   private:
+    const uint8_t *entryAt(uint16_t i) const noexcept {
+      return p_ + batch::kHeaderBytes + static_cast<size_t>(i) * batch::kEntryBytes;
+    }
+
+    const uint8_t *p_{nullptr};
+    size_t len_{0};
+    uint16_t count_{0};
+  };
+
+} // namespace b3::md::publishing
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+namespace b3::md::publishing {
+
+  // Envelope chico (512 bytes) para la lane prioritaria (trades, eventos de estado):
+  // SerializedEnvelope son 16KB por slot, demasiado para mensajes de ~100 bytes.
+  struct CompactEnvelope final {
+    static constexpr size_t kMaxTopic = 48;
+    static constexpr size_t kMaxBytes = 448;
+
+    uint16_t size{0};
+    uint8_t topicLen{0};
+    uint64_t sourceTsNs{0}; // ingreso del evento (callback OnixS); 0 = desconocido. No va al wire.
+    char topic[kMaxTopic]{};
+    uint8_t bytes[kMaxBytes]{};
+  };
+
+  static_assert(sizeof(CompactEnvelope) == 512);
+
+} // namespace b3::md::publishing
@@ -1,12 +1,33 @@
 #pragma once
 #include <cstdint>
+#include "CompactEnvelope.hpp"
 #include "SerializedEnvelope.hpp"
 
 namespace b3::md::publishing {
 
+  // Canales de la lane prioritaria (IPublishSink::tryPublishPriority), un productor por canal.
+  inline constexpr uint32_t kTradeChannel = 0; // MdTradeLane
+  inline constexpr uint32_t kStatsChannel = 1; // MdStatsEngine (thread de MdTradeLane)
+  inline constexpr uint32_t kStateChannel = 2; // MdStateLane (status / fases / subastas / bandas)
+  inline constexpr uint32_t kPriorityChannels = 3;
+
   struct IPublishSink {
     virtual ~IPublishSink() = default;
     virtual bool tryPublish(uint32_t shardId, const SerializedEnvelope &ev) noexcept = 0;
+
+    // Fence para handoff de instrumentos entre shards (sinks asíncronos con cola por shard).
+    // acceptedCount: eventos aceptados por tryPublish del shard; deliveredUpTo: si ya salieron
+    // al wire todos hasta `accepted`. Default = sink síncrono (publicar == entregado).
+    virtual uint64_t acceptedCount(uint32_t /*shardId*/) const noexcept { return 0; }
+    virtual bool deliveredUpTo(uint32_t /*shardId*/, uint64_t /*accepted*/) const noexcept {
+      return true;
+    }
+
+    // Lane prioritaria: una cola por canal, un único productor por canal (ej. canal 0 = trades).
+    // El publisher la drena antes que las colas de books. Default = sin soporte (drop).
+    virtual bool tryPublishPriority(uint32_t /*channel*/, const CompactEnvelope & /*ev*/) noexcept {
+      return false;
+    }
   };
 
 } // namespace b3::md::publishing
\ No newline at end of file
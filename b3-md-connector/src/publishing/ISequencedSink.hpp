@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+#include "SerializedEnvelope.hpp"
+
+namespace b3::md::publishing {
+
+  // Sink con reordenamiento: recibe envelopes serializados fuera de orden (varios serializers)
+  // y los entrega por shard en orden estricto de seq (0, 1, 2, ...).
+  struct ISequencedSink {
+    virtual ~ISequencedSink() = default;
+
+    // producer = índice del serializer; cada par (shard, producer) es SPSC.
+    // ev == nullptr: seq sin payload (falló la serialización) -> avanza la secuencia sin enviar.
+    // Nunca se debe perder una seq: el caller reintenta mientras devuelva false (cola llena).
+    virtual bool tryPublishSequenced(uint32_t shardId, uint32_t producer, uint64_t seq,
+                                     const SerializedEnvelope *ev) noexcept = 0;
+
+    // Próxima seq esperada del shard = cantidad entregada al wire.
+    virtual uint64_t deliveredSeq(uint32_t shardId) const noexcept = 0;
+  };
+
+} // namespace b3::md::publishing
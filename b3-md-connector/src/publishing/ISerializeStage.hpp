@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include "../core/BookSnapshot.hpp"
+
+namespace b3::md::publishing {
+
+  // Etapa de serialización desacoplada del worker (modo paralelo).
+  // El worker agrega MBO->MBP, resuelve el topic y entrega el BookSnapshot; la etapa asigna
+  // la secuencia del shard, serializa en otro thread y reordena antes del wire.
+  struct ISerializeStage {
+    virtual ~ISerializeStage() = default;
+
+    // Single producer por shard (el worker del shard). false = cola llena (drop del caller).
+    virtual bool trySubmit(uint32_t shardId, const b3::md::BookSnapshot &book, const char *topic,
+                           uint8_t topicLen) noexcept = 0;
+
+    // Fence (handoff entre shards): seqs aceptadas / si ya salieron todas hasta `accepted`.
+    virtual uint64_t acceptedCount(uint32_t shardId) const noexcept = 0;
+    virtual bool deliveredUpTo(uint32_t shardId, uint64_t accepted) const noexcept = 0;
+
+    // Envelopes del shard que llegaron al sink (no los aceptados por trySubmit).
+    virtual uint64_t publishedCount(uint32_t shardId) const noexcept = 0;
+  };
+
+} // namespace b3::md::publishing
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "../core/SnapshotQueueSpsc.hpp"
+#include "SerializedEnvelope.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace b3::md::publishing {
+
+  /**
+   * @brief Colas (shard x producer) + reordenamiento por seq, consumidas por UN thread.
+   *
+   * Cada serializer (producer) procesa los jobs de un shard en orden, así que dentro de cada
+   * cola (shard, producer) las seqs son crecientes. La seq esperada del shard está entonces en
+   * el head de alguna de sus P colas: basta mirar P heads, sin buffer de reordenamiento ni
+   * copias extra. Con colas separadas por shard no hay espera circular entre shards.
+   */
+  class SequencedReorder final {
+   public:
+    struct Slot {
+      uint64_t seq{0};
+      uint8_t skip{0}; // 1 = seq sin payload
+      SerializedEnvelope ev{};
+    };
+
+    using QueueT = b3::md::SnapshotQueueSpsc<Slot, 1024>;
+
+    SequencedReorder(uint32_t shardCount, uint32_t producers, b3::md::QueueConfig queue,
+                     bool deferFirstTouch)
+        : shardCount_(shardCount), producers_(producers),
+          next_(std::make_unique<std::atomic<uint64_t>[]>(shardCount)) {
+      if (shardCount == 0 || producers == 0)
+        throw std::invalid_argument("SequencedReorder: shardCount/producers == 0");
+      queues_.reserve(static_cast<size_t>(shardCount) * producers);
+      for (uint32_t i = 0; i < shardCount * producers; ++i)
+        queues_.emplace_back(
+            std::make_unique<QueueT>(queue.capacity, queue.hugePages, deferFirstTouch));
+      for (uint32_t s = 0; s < shardCount; ++s) next_[s].store(0, std::memory_order_relaxed);
+    }
+
+    SequencedReorder(const SequencedReorder &) = delete;
+    SequencedReorder &operator=(const SequencedReorder &) = delete;
+
+    // Producer (serializer `producer`): no throw, no alloc.
+    bool tryPush(uint32_t shardId, uint32_t producer, uint64_t seq,
+                 const SerializedEnvelope *ev) noexcept {
+      if (shardId >= shardCount_ || producer >= producers_)
+        return false;
+      return q(shardId, producer).try_push_with([&](Slot &slot) noexcept {
+        slot.seq = seq;
+        slot.skip = ev ? 0 : 1;
+        if (ev) {
+          // Copia acotada: header + topic + payload usado (no los 16KB completos)
+          slot.ev.size = ev->size;
+          slot.ev.topicLen = ev->topicLen;
+          slot.ev.flags = ev->flags;
+          slot.ev.sourceTsNs = ev->sourceTsNs;
+          std::memcpy(slot.ev.topic, ev->topic, ev->topicLen);
+          std::memcpy(slot.ev.bytes, ev->bytes, ev->size);
+        }
+      });
+    }
+
+    // Consumer: entrega hasta maxBatch seqs consecutivas del shard. send(const SerializedEnvelope&)
+    // se llama ANTES de avanzar la seq publicada (delivered() implica enviado).
+    template <typename Send>
+    uint32_t drainShard(uint32_t shardId, uint32_t maxBatch, Send &&send) {
+      uint64_t want = next_[shardId].load(std::memory_order_relaxed);
+      uint32_t n = 0;
+      while (n < maxBatch) {
+        bool found = false;
+        for (uint32_t p = 0; p < producers_; ++p) {
+          auto &queue = q(shardId, p);
+          const Slot *h = queue.front();
+          if (!h || h->seq != want)
+            continue;
+          if (!h->skip)
+            send(h->ev);
+          queue.pop();
+          next_[shardId].store(++want, std::memory_order_release);
+          ++n;
+          found = true;
+          break;
+        }
+        if (!found)
+          break;
+      }
+      return n;
+    }
+
+    uint64_t delivered(uint32_t shardId) const noexcept {
+      return shardId < shardCount_ ? next_[shardId].load(std::memory_order_acquire) : 0;
+    }
+
+    uint64_t pendingApprox() const noexcept {
+      uint64_t n = 0;
+      for (const auto &qq : queues_) n += qq->size_approx();
+      return n;
+    }
+
+    void firstTouch() noexcept {
+      for (auto &qq : queues_) qq->firstTouch();
+    }
+
+    size_t memoryBytes() const noexcept {
+      size_t n = 0;
+      for (const auto &qq : queues_) n += qq->memoryBytes();
+      return n;
+    }
+
+    uint32_t producers() const noexcept { return producers_; }
+    uint32_t queueCapacity() const noexcept { return queues_.front()->capacity(); }
+    b3::md::QueueBacking backing() const noexcept { return queues_.front()->backing(); }
+
+   private:
+    QueueT &q(uint32_t shardId, uint32_t producer) noexcept {
+      return *queues_[static_cast<size_t>(shardId) * producers_ + producer];
+    }
+
+   private:
+    uint32_t shardCount_;
+    uint32_t producers_;
+    std::vector<std::unique_ptr<QueueT>> queues_;
+    std::unique_ptr<std::atomic<uint64_t>[]> next_;
+  };
+
+} // namespace b3::md::publishing
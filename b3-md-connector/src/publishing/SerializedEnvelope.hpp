@@ -9,8 +9,13 @@ namespace b3::md::publishing {
     static constexpr size_t kMaxTopic = 128;
     static constexpr size_t kMaxBytes = 16384;
 
+    // flags: solo para el concentrator, no van al wire
+    static constexpr uint8_t kDirectOnly = 1u << 0; // mensaje suelto: sin batch frame ni ring shm
+
     uint32_t size{0};
     uint8_t topicLen{0};
+    uint8_t flags{0};
+    uint64_t sourceTsNs{0}; // ingreso del snapshot (callback OnixS); 0 = desconocido. No va al wire.
     char topic[kMaxTopic]{};
     uint8_t bytes[kMaxBytes]{};
   };
@@ -0,0 +1,246 @@
+#pragma once
+
+#include "ISequencedSink.hpp"
+#include "ISerializeStage.hpp"
+#include "SerializedEnvelope.hpp"
+
+#include "../core/BookSnapshot.hpp"
+#include "../core/SnapshotQueueSpsc.hpp"
+#include "../mapping/MdSnapshotMapper.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace b3::md::publishing {
+
+  /**
+   * @brief Pool de serializers (protobuf) entre los workers y el concentrator.
+   *
+   * - El worker del shard llama trySubmit(): asigna la seq del shard y reparte round-robin
+   *   por seq entre los T serializers (un instrumento caliente usa T cores para encodear).
+   * - Colas job: una SPSC por (shard, serializer) -> productor = worker, consumer = serializer.
+   * - Cada serializer publica en ISequencedSink con su índice; el sink reordena por seq y
+   *   entrega en orden estricto por shard => FIFO por instrumento intacto.
+   * - Una seq aceptada nunca se pierde: si la serialización falla se manda como skip, y si el
+   *   sink está lleno el serializer reintenta (backpressure hacia las colas job).
+   * - El reintento NO bloquea al serializer: si la cola (shard, k) del sink está llena, el
+   *   envelope queda estacionado para ese shard y el serializer sigue con los demás. Esperar
+   *   ahí retendría seqs que otro shard necesita para drenar => espera circular entre
+   *   serializers. Mientras haya uno estacionado no se saca otro job de ese shard (las seqs
+   *   de la cola (shard, k) tienen que seguir crecientes).
+   */
+  class SerializerPool final : public ISerializeStage {
+   public:
+    static constexpr uint32_t kJobQueueCapacity = 1024;
+    static constexpr uint32_t kBatchPerShard = 8;
+
+    SerializerPool(uint32_t shardCount, uint32_t threads, const mapping::MdSnapshotMapper &mapper,
+                   ISequencedSink &out, uint32_t jobQueueCapacity = kJobQueueCapacity)
+        : shardCount_(shardCount), threads_(threads), mapper_(mapper), out_(out),
+          nextSeq_(std::make_unique<std::atomic<uint64_t>[]>(shardCount)),
+          publishedByShard_(std::make_unique<std::atomic<uint64_t>[]>(shardCount)) {
+      if (shardCount == 0 || threads == 0)
+        throw std::invalid_argument("SerializerPool: shardCount/threads == 0");
+
+      jobs_.reserve(static_cast<size_t>(shardCount) * threads);
+      for (uint32_t i = 0; i < shardCount * threads; ++i)
+        jobs_.emplace_back(std::make_unique<JobQueue>(jobQueueCapacity));
+      for (uint32_t s = 0; s < shardCount; ++s) {
+        nextSeq_[s].store(0, std::memory_order_relaxed);
+        publishedByShard_[s].store(0, std::memory_order_relaxed);
+      }
+    }
+
+    SerializerPool(const SerializerPool &) = delete;
+    SerializerPool &operator=(const SerializerPool &) = delete;
+
+    ~SerializerPool() { stop(false); }
+
+    void start() {
+      bool expected = false;
+      if (!running_.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+        return;
+      drainOnStop_.store(true, std::memory_order_relaxed);
+      serializers_.reserve(threads_);
+      for (uint32_t k = 0; k < threads_; ++k) serializers_.emplace_back([this, k] { run(k); });
+    }
+
+    // Parar DESPUÉS de los workers del pipeline y ANTES del concentrator.
+    void stop(bool drain = true) {
+      drainOnStop_.store(drain, std::memory_order_relaxed);
+      running_.store(false, std::memory_order_release);
+      for (auto &t : serializers_) {
+        if (t.joinable())
+          t.join();
+      }
+      serializers_.clear();
+    }
+
+    // ISerializeStage (hot path del worker `shardId`)
+    bool trySubmit(uint32_t shardId, const b3::md::BookSnapshot &book, const char *topic,
+                   uint8_t topicLen) noexcept override {
+      if (shardId >= shardCount_ || topicLen == 0 || topicLen > SerializedEnvelope::kMaxTopic)
+        return false;
+
+      // Solo el worker del shard escribe nextSeq_[shardId]
+      const uint64_t seq = nextSeq_[shardId].load(std::memory_order_relaxed);
+      const uint32_t k = static_cast<uint32_t>(seq % threads_);
+
+      const bool ok = jobs(shardId, k).try_push_with([&](Job &j) noexcept {
+        j.seq = seq;
+        j.topicLen = topicLen;
+        std::memcpy(j.topic, topic, topicLen);
+        j.book = book;
+      });
+      if (!ok) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+
+      nextSeq_[shardId].store(seq + 1, std::memory_order_release);
+      return true;
+    }
+
+    uint64_t acceptedCount(uint32_t shardId) const noexcept override {
+      return shardId < shardCount_ ? nextSeq_[shardId].load(std::memory_order_acquire) : 0;
+    }
+
+    bool deliveredUpTo(uint32_t shardId, uint64_t accepted) const noexcept override {
+      return out_.deliveredSeq(shardId) >= accepted;
+    }
+
+    // Envelopes que el sink aceptó (las skips no cuentan).
+    uint64_t publishedCount(uint32_t shardId) const noexcept override {
+      return shardId < shardCount_ ? publishedByShard_[shardId].load(std::memory_order_relaxed) : 0;
+    }
+
+    uint64_t serialized() const noexcept { return serialized_.load(std::memory_order_relaxed); }
+    uint64_t serializeFailed() const noexcept { return failed_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+    uint32_t threadCount() const noexcept { return threads_; }
+
+   private:
+    struct Job {
+      uint64_t seq{0};
+      uint8_t topicLen{0};
+      char topic[SerializedEnvelope::kMaxTopic]{};
+      b3::md::BookSnapshot book{};
+    };
+
+    using JobQueue = b3::md::SnapshotQueueSpsc<Job, kJobQueueCapacity>;
+
+    JobQueue &jobs(uint32_t shardId, uint32_t k) noexcept {
+      return *jobs_[static_cast<size_t>(shardId) * threads_ + k];
+    }
+
+    // Un envelope por shard que el sink no aceptó todavía (cola (shard, k) llena).
+    struct Parked {
+      uint64_t seq{0};
+      bool active{false};
+      bool ok{false};
+      std::unique_ptr<SerializedEnvelope> ev;
+    };
+
+    bool pendingFor(uint32_t k, const std::vector<Parked> &parked) const noexcept {
+      for (uint32_t s = 0; s < shardCount_; ++s) {
+        if (parked[s].active || jobs_[static_cast<size_t>(s) * threads_ + k]->size_approx() > 0)
+          return true;
+      }
+      return false;
+    }
+
+    bool tryPublish(uint32_t shardId, uint32_t k, uint64_t seq,
+                    const SerializedEnvelope *ev) noexcept {
+      if (!out_.tryPublishSequenced(shardId, k, seq, ev))
+        return false;
+      if (ev)
+        publishedByShard_[shardId].fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+
+    void run(uint32_t k) noexcept {
+      using namespace std::chrono_literals;
+
+      // 16KB por envelope: fuera del stack del hot loop, una sola vez. Uno por shard para poder
+      // estacionar sin bloquear a los demás.
+      std::vector<Parked> parked(shardCount_);
+      for (auto &p : parked) p.ev = std::make_unique<SerializedEnvelope>();
+      Job job{};
+
+      while (running_.load(std::memory_order_acquire) ||
+             (drainOnStop_.load(std::memory_order_relaxed) && pendingFor(k, parked))) {
+        bool didWork = false;
+        bool blocked = false;
+
+        for (uint32_t s = 0; s < shardCount_; ++s) {
+          Parked &p = parked[s];
+          if (p.active) {
+            if (!tryPublish(s, k, p.seq, p.ok ? p.ev.get() : nullptr)) {
+              blocked = true;
+              continue; // el shard sigue trabado; los demás avanzan
+            }
+            p.active = false;
+            didWork = true;
+          }
+
+          auto &q = jobs(s, k);
+          for (uint32_t b = 0; b < kBatchPerShard && q.try_pop(job); ++b) {
+            didWork = true;
+            const bool ok =
+                mapper_.mapToSerializedEnvelope(job.book, *p.ev, job.topic, job.topicLen);
+            if (ok) {
+              p.ev->sourceTsNs = job.book.exchangeTsNs;
+              serialized_.fetch_add(1, std::memory_order_relaxed);
+            } else {
+              failed_.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (!tryPublish(s, k, job.seq, ok ? p.ev.get() : nullptr)) {
+              p.seq = job.seq;
+              p.ok = ok;
+              p.active = true;
+              blocked = true;
+              break;
+            }
+          }
+        }
+
+        // stop sin drain: lo estacionado se abandona
+        if (blocked && !running_.load(std::memory_order_acquire) &&
+            !drainOnStop_.load(std::memory_order_relaxed))
+          return;
+
+        if (!didWork) {
+          if (blocked)
+            std::this_thread::yield();
+          else
+            std::this_thread::sleep_for(100us);
+        }
+      }
+    }
+
+   private:
+    const uint32_t shardCount_;
+    const uint32_t threads_;
+    const mapping::MdSnapshotMapper &mapper_;
+    ISequencedSink &out_;
+
+    std::vector<std::unique_ptr<JobQueue>> jobs_;
+    std::unique_ptr<std::atomic<uint64_t>[]> nextSeq_;
+    std::unique_ptr<std::atomic<uint64_t>[]> publishedByShard_;
+
+    std::atomic<bool> running_{false};
+    std::atomic<bool> drainOnStop_{true};
+    std::vector<std::thread> serializers_;
+
+    std::atomic<uint64_t> serialized_{0};
+    std::atomic<uint64_t> failed_{0};
+    std::atomic<uint64_t> dropped_{0};
+  };
+
+} // namespace b3::md::publishing
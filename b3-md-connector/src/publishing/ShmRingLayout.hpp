@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace b3::md::publishing::shm {
+
+  /**
+   * @brief Layout del ring de broadcast en memoria compartida (pub.shm.name).
+   *
+   * Un writer (el thread del concentrator), N readers en otros procesos del mismo host. El
+   * writer nunca espera a nadie: cada reader lleva su propio cursor y, si se atrasa más que
+   * el ring, detecta el pisado y se resincroniza (lost()).
+   *
+   *   [RingHeader][slot 0][slot 1]...[slot slotCount-1]
+   *   slot = SlotHeader | topic | payload   (slotBytes fijo, múltiplo de 64)
+   *
+   * El mensaje n (0-based) va al slot n & (slotCount - 1). Seqlock por slot:
+   *   seq = 2n + 1 mientras el writer lo escribe, 2n + 2 cuando quedó completo.
+   * Un reader que espera n y ve seq > 2n + 2 (antes o después de copiar) fue pisado.
+   * Un mensaje que no entra en un slot igual consume su n: el slot queda con kSlotDropped y
+   * sin datos, y el reader lo cuenta como perdido (el stream no tiene huecos silenciosos).
+   *
+   * topic + payload = los dos frames del mensaje ZMQ (símbolo / WrapperMessage serializado).
+   */
+  inline constexpr uint64_t kMagic = 0x31444D523342ull; // "B3RMD1"
+  inline constexpr uint32_t kVersion = 1;
+  inline constexpr size_t kCacheLine = 64;
+
+  static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                "shm ring: atomics deben ser lock-free para compartirse entre procesos");
+
+  struct alignas(kCacheLine) RingHeader {
+    std::atomic<uint64_t> magic; // se publica último (release): el ring está listo
+    uint32_t version;
+    uint32_t slotCount; // potencia de 2
+    uint32_t slotBytes; // incluye SlotHeader
+    uint32_t reserved;
+    uint64_t writerPid;
+    uint64_t createdNs; // epoch ns del arranque del writer
+
+    alignas(kCacheLine) std::atomic<uint64_t> writeSeq; // próximo n (= mensajes publicados)
+    alignas(kCacheLine) std::atomic<uint32_t> closed;   // 1 = el writer paró (reabrir por nombre)
+  };
+
+  struct SlotHeader {
+    std::atomic<uint64_t> seq;
+    uint64_t sourceTsNs; // exchange ts del book (0 si no hay)
+    uint32_t size;       // payload
+    uint8_t topicLen;
+    uint8_t flags; // kSlotDropped
+    uint8_t pad[2];
+  };
+
+  inline constexpr uint8_t kSlotDropped = 1u << 0; // el writer descartó el mensaje n (oversize)
+
+  static_assert(sizeof(SlotHeader) == 24);
+  inline constexpr size_t kHeaderBytes = sizeof(RingHeader);
+
+  inline constexpr size_t ringBytes(uint32_t slotCount, uint32_t slotBytes) noexcept {
+    return kHeaderBytes + static_cast<size_t>(slotCount) * slotBytes;
+  }
+
+} // namespace b3::md::publishing::shm
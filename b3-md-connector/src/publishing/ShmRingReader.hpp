@@ -0,0 +1,273 @@
+#pragma once
+
+#include "ShmRingLayout.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace b3::md::publishing {
+
+  enum class ShmRingStatus : uint8_t {
+    Attached = 0,
+    Missing = 1,   // no existe el segmento (connector parado o sin pub.shm.name)
+    BadFormat = 2, // magic/versión/tamaños no coinciden
+    NotReady = 3,  // el writer todavía no terminó de inicializarlo
+  };
+
+  /**
+   * @brief Reader del ring de broadcast (ver ShmRingLayout.hpp). Librería para consumidores del
+   *        mismo host: sin ZMQ, sin syscalls por mensaje.
+   *
+   *   ShmRingReader r;
+   *   if (r.attach("/b3md") == ShmRingStatus::Attached)
+   *     while (running) {
+   *       if (r.poll([](const ShmRingReader::Message &m) { ... }) == 0) { pause / sleep }
+   *       if (r.writerClosed()) { reattach cuando vuelva el connector }
+   *     }
+   *
+   * Cada reader tiene su cursor (privado, no compartido): arranca en el mensaje más nuevo y
+   * avanza a su ritmo. El writer no lo espera; si el reader queda más de un ring atrás, pierde
+   * lo pisado (lost()) y salta a la mitad del ring más reciente. Cada mensaje se copia a un
+   * buffer propio antes de validarlo, así que Message es válido solo dentro del callback.
+   * Topic y payload son los mismos del mensaje ZMQ: el consumidor filtra por topic.
+   * writerClosed() también detecta un writer que murió sin stop() (pid que ya no existe, o el
+   * nombre desvinculado / recreado por otro writer); lo revisa cada kLivenessCheckNs.
+   * Un reader por thread.
+   */
+  class ShmRingReader final {
+   public:
+    struct Message {
+      uint64_t seq;        // posición en el stream del writer (0-based)
+      uint64_t sourceTsNs; // exchange ts del book (0 si no hay)
+      std::string_view topic;
+      const uint8_t *payload;
+      uint32_t size;
+    };
+
+    static constexpr int64_t kLivenessCheckNs = 100'000'000; // 100ms
+
+    ShmRingReader() = default;
+    ~ShmRingReader() { detach(); }
+
+    ShmRingReader(const ShmRingReader &) = delete;
+    ShmRingReader &operator=(const ShmRingReader &) = delete;
+
+    // Mapea el ring (read-only) y deja el cursor en el próximo mensaje a publicar.
+    ShmRingStatus attach(const std::string &name) noexcept {
+      detach();
+      const std::string n = (!name.empty() && name[0] == '/') ? name : "/" + name;
+      const int fd = ::shm_open(n.c_str(), O_RDONLY, 0);
+      if (fd < 0)
+        return ShmRingStatus::Missing;
+
+      struct stat st {};
+      if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < shm::kHeaderBytes) {
+        ::close(fd);
+        return ShmRingStatus::BadFormat;
+      }
+      bytes_ = static_cast<size_t>(st.st_size);
+      name_ = n;
+      dev_ = st.st_dev;
+      ino_ = st.st_ino;
+      void *p = ::mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, fd, 0);
+      ::close(fd);
+      if (p == MAP_FAILED) {
+        bytes_ = 0;
+        return ShmRingStatus::BadFormat;
+      }
+      map_ = static_cast<const unsigned char *>(p);
+
+      const ShmRingStatus s = validate();
+      if (s != ShmRingStatus::Attached) {
+        detach();
+        return s;
+      }
+      slotCount_ = header()->slotCount;
+      slotBytes_ = header()->slotBytes;
+      buffer_ = std::make_unique<unsigned char[]>(slotBytes_);
+      writerPid_ = header()->writerPid;
+      writerGone_ = false;
+      nextLivenessNs_ = 0;
+      cursor_ = header()->writeSeq.load(std::memory_order_acquire);
+      return ShmRingStatus::Attached;
+    }
+
+    void detach() noexcept {
+      if (map_)
+        ::munmap(const_cast<unsigned char *>(map_), bytes_);
+      map_ = nullptr;
+      bytes_ = 0;
+    }
+
+    bool attached() const noexcept { return map_ != nullptr; }
+
+    // Cursor al mensaje más viejo que sigue en el ring (replay de lo reciente).
+    void seekToOldest() noexcept {
+      if (!map_)
+        return;
+      const uint64_t w = header()->writeSeq.load(std::memory_order_acquire);
+      cursor_ = w > slotCount_ ? w - slotCount_ : 0;
+    }
+
+    // Hasta `max` mensajes: fn(const Message&). Devuelve los entregados (0 = nada nuevo).
+    template <typename Fn>
+    size_t poll(Fn &&fn, size_t max = SIZE_MAX) noexcept {
+      if (!map_)
+        return 0;
+      size_t delivered = 0;
+      while (delivered < max) {
+        const uint64_t n = cursor_;
+        const auto *slot = slotAt(n);
+        const uint64_t done = 2 * n + 2;
+
+        const uint64_t s1 = slot->seq.load(std::memory_order_acquire);
+        if (s1 < done)
+          break; // todavía no publicado (o a medio escribir)
+        if (s1 > done) {
+          resync();
+          continue;
+        }
+
+        const uint32_t size = slot->size;
+        const uint8_t topicLen = slot->topicLen;
+        const uint8_t flags = slot->flags;
+        const uint64_t tsNs = slot->sourceTsNs;
+        const size_t len = static_cast<size_t>(topicLen) + size;
+        if (len <= slotBytes_ - sizeof(shm::SlotHeader))
+          std::memcpy(buffer_.get(),
+                      reinterpret_cast<const unsigned char *>(slot) + sizeof(shm::SlotHeader), len);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->seq.load(std::memory_order_relaxed) != s1) {
+          resync(); // pisado mientras copiábamos
+          continue;
+        }
+
+        cursor_ = n + 1;
+        if (flags & shm::kSlotDropped) {
+          ++lost_; // el writer lo descartó (no entraba en un slot)
+          continue;
+        }
+        ++delivered;
+        fn(Message{n, tsNs,
+                   std::string_view(reinterpret_cast<const char *>(buffer_.get()), topicLen),
+                   reinterpret_cast<const uint8_t *>(buffer_.get()) + topicLen, size});
+      }
+      received_ += delivered;
+      return delivered;
+    }
+
+    // El writer paró (stop() o murió): este mapping ya no avanza. attach() de nuevo cuando
+    // vuelva.
+    bool writerClosed() const noexcept {
+      if (!map_)
+        return false;
+      if (header()->closed.load(std::memory_order_acquire) != 0)
+        return true;
+      return writerGone();
+    }
+
+    // Mensajes publicados que este reader todavía no leyó (aprox.).
+    uint64_t lag() const noexcept {
+      return map_ ? header()->writeSeq.load(std::memory_order_acquire) - cursor_ : 0;
+    }
+
+    uint64_t cursor() const noexcept { return cursor_; }
+    uint64_t received() const noexcept { return received_; }
+    uint64_t lost() const noexcept { return lost_; }
+    uint32_t slotCount() const noexcept { return slotCount_; }
+
+   private:
+    const shm::RingHeader *header() const noexcept {
+      return reinterpret_cast<const shm::RingHeader *>(map_);
+    }
+
+    const shm::SlotHeader *slotAt(uint64_t n) const noexcept {
+      return reinterpret_cast<const shm::SlotHeader *>(map_ + shm::kHeaderBytes +
+                                                       (n & (slotCount_ - 1)) * slotBytes_);
+    }
+
+    // Writer muerto sin stop(): su pid ya no existe (EPERM = vive, de otro usuario) o el nombre
+    // ya no es este segmento (desvinculado, o recreado por un writer nuevo). Las syscalls van
+    // como mucho cada kLivenessCheckNs; una vez muerto queda muerto.
+    bool writerGone() const noexcept {
+      if (writerGone_)
+        return true;
+      const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now().time_since_epoch())
+                              .count();
+      if (now < nextLivenessNs_)
+        return false;
+      nextLivenessNs_ = now + kLivenessCheckNs;
+
+      if (writerPid_ != 0 && ::kill(static_cast<pid_t>(writerPid_), 0) != 0 && errno == ESRCH) {
+        writerGone_ = true;
+        return true;
+      }
+      const int fd = ::shm_open(name_.c_str(), O_RDONLY, 0);
+      if (fd < 0) {
+        writerGone_ = errno == ENOENT;
+        return writerGone_;
+      }
+      struct stat st {};
+      if (::fstat(fd, &st) == 0 && (st.st_dev != dev_ || st.st_ino != ino_))
+        writerGone_ = true;
+      ::close(fd);
+      return writerGone_;
+    }
+
+    ShmRingStatus validate() const noexcept {
+      const auto *h = header();
+      if (h->magic.load(std::memory_order_acquire) != shm::kMagic)
+        return ShmRingStatus::NotReady;
+      if (h->version != shm::kVersion || h->slotCount < 2 ||
+          (h->slotCount & (h->slotCount - 1)) != 0 || h->slotBytes <= sizeof(shm::SlotHeader) ||
+          shm::ringBytes(h->slotCount, h->slotBytes) > bytes_)
+        return ShmRingStatus::BadFormat;
+      return ShmRingStatus::Attached;
+    }
+
+    // Nos pasaron por arriba: saltar a la mitad más reciente del ring (margen para no volver a
+    // ser pisados enseguida) y contar lo salteado.
+    void resync() noexcept {
+      const uint64_t w = header()->writeSeq.load(std::memory_order_acquire);
+      const uint64_t target = w > slotCount_ / 2 ? w - slotCount_ / 2 : 0;
+      if (target > cursor_) {
+        lost_ += target - cursor_;
+        cursor_ = target;
+      } else {
+        ++lost_;
+        ++cursor_;
+      }
+    }
+
+    const unsigned char *map_{nullptr};
+    size_t bytes_{0};
+    uint32_t slotCount_{0};
+    uint32_t slotBytes_{0};
+    std::unique_ptr<unsigned char[]> buffer_;
+
+    std::string name_;
+    dev_t dev_{0};
+    ino_t ino_{0};
+    uint64_t writerPid_{0};
+    mutable bool writerGone_{false};
+    mutable int64_t nextLivenessNs_{0};
+
+    uint64_t cursor_{0};
+    uint64_t received_{0};
+    uint64_t lost_{0};
+  };
+
+} // namespace b3::md::publishing
@@ -0,0 +1,224 @@
+#pragma once
+
+#include "SerializedEnvelope.hpp"
+#include "ShmRingLayout.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace b3::md::publishing {
+
+  /**
+   * @brief Writer del ring de broadcast en /dev/shm (ver ShmRingLayout.hpp).
+   *
+   * Single writer: publish() lo llama solo el thread del concentrator. Sin syscalls ni locks en
+   * publish(): dos stores del seqlock + memcpy al slot. start() crea el segmento con O_EXCL y lo
+   * prefaultea. Si el nombre ya existe mira el writerPid del header: con ese proceso vivo se
+   * rechaza (desvincularlo dejaría a sus readers en un ring huérfano); si murió sin stop(), el
+   * segmento viejo se desvincula y se crea de nuevo. stop() marca closed y lo desvincula.
+   */
+  class ShmRingWriter final {
+   public:
+    static constexpr uint32_t kDefaultSlots = 65536;
+    static constexpr uint32_t kDefaultSlotBytes = 1024;
+
+    // name: "/b3md" (con o sin '/'). slotCount se redondea a potencia de 2, slotBytes a 64.
+    ShmRingWriter(std::string name, uint32_t slotCount = kDefaultSlots,
+                  uint32_t slotBytes = kDefaultSlotBytes)
+        : name_(normalize(std::move(name))), slotCount_(pow2(slotCount)),
+          slotBytes_(roundSlot(slotBytes)), bytes_(shm::ringBytes(slotCount_, slotBytes_)) {}
+
+    ~ShmRingWriter() { stop(); }
+
+    ShmRingWriter(const ShmRingWriter &) = delete;
+    ShmRingWriter &operator=(const ShmRingWriter &) = delete;
+
+    // Lanza std::runtime_error si no puede crear/mapear el segmento o si otro writer vivo lo usa.
+    void start() {
+      if (map_)
+        return;
+
+      int fd = ::shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0660);
+      if (fd < 0 && errno == EEXIST) {
+        if (const uint64_t pid = liveWriterPid(name_))
+          throw std::runtime_error("ShmRingWriter: " + name_ + " is in use by writer pid " +
+                                   std::to_string(pid));
+        ::shm_unlink(name_.c_str()); // ring de una corrida que murió sin stop()
+        fd = ::shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0660);
+      }
+      if (fd < 0)
+        throw std::runtime_error("ShmRingWriter: shm_open failed for " + name_);
+      if (::ftruncate(fd, static_cast<off_t>(bytes_)) != 0) {
+        ::close(fd);
+        ::shm_unlink(name_.c_str());
+        throw std::runtime_error("ShmRingWriter: ftruncate failed for " + name_);
+      }
+      void *p = ::mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      ::close(fd);
+      if (p == MAP_FAILED) {
+        ::shm_unlink(name_.c_str());
+        throw std::runtime_error("ShmRingWriter: mmap failed for " + name_);
+      }
+      map_ = static_cast<unsigned char *>(p);
+
+      // El pid primero: otro start() que vea el segmento a medio inicializar ya lo encuentra
+      auto *h = header();
+      h->writerPid = static_cast<uint64_t>(::getpid());
+
+      // ftruncate deja todo en 0 (seq = 0 en cada slot); tocar cada página acá y no en el
+      // primer publish()
+      volatile unsigned char *touch = map_;
+      for (size_t off = 0; off < bytes_; off += 4096) touch[off] = 0;
+
+      h->version = shm::kVersion;
+      h->slotCount = slotCount_;
+      h->slotBytes = slotBytes_;
+      h->createdNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                               std::chrono::system_clock::now().time_since_epoch())
+                                               .count());
+      h->writeSeq.store(0, std::memory_order_relaxed);
+      h->closed.store(0, std::memory_order_relaxed);
+      h->magic.store(shm::kMagic, std::memory_order_release);
+      next_ = 0;
+    }
+
+    // Idempotente.
+    void stop() noexcept {
+      if (!map_)
+        return;
+      header()->closed.store(1, std::memory_order_release);
+      ::munmap(map_, bytes_);
+      ::shm_unlink(name_.c_str());
+      map_ = nullptr;
+    }
+
+    bool running() const noexcept { return map_ != nullptr; }
+
+    const std::string &name() const noexcept { return name_; }
+    uint32_t slotCount() const noexcept { return slotCount_; }
+    uint32_t slotBytes() const noexcept { return slotBytes_; }
+    size_t mappedBytes() const noexcept { return bytes_; }
+
+    // Lo que entra en un slot (topic + payload).
+    size_t slotCapacity() const noexcept { return slotBytes_ - sizeof(shm::SlotHeader); }
+
+    // Hot path (thread del concentrator). false = no arrancó o no entra en un slot. El que no
+    // entra igual consume un n (slot con kSlotDropped): los readers lo ven como perdido.
+    bool publish(const char *topic, uint8_t topicLen, const uint8_t *payload, uint32_t size,
+                 uint64_t sourceTsNs) noexcept {
+      if (!map_)
+        return false;
+      const bool fits = static_cast<size_t>(topicLen) + size <= slotCapacity();
+
+      const uint64_t n = next_;
+      auto *slot = reinterpret_cast<shm::SlotHeader *>(map_ + shm::kHeaderBytes +
+                                                       (n & (slotCount_ - 1)) * slotBytes_);
+      unsigned char *data = reinterpret_cast<unsigned char *>(slot) + sizeof(shm::SlotHeader);
+
+      slot->seq.store(2 * n + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      slot->sourceTsNs = sourceTsNs;
+      if (fits) {
+        slot->size = size;
+        slot->topicLen = topicLen;
+        slot->flags = 0;
+        std::memcpy(data, topic, topicLen);
+        std::memcpy(data + topicLen, payload, size);
+      } else {
+        slot->size = 0;
+        slot->topicLen = 0;
+        slot->flags = shm::kSlotDropped;
+      }
+      slot->seq.store(2 * n + 2, std::memory_order_release);
+
+      next_ = n + 1;
+      header()->writeSeq.store(n + 1, std::memory_order_release);
+      if (!fits) {
+        oversize_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      written_.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+
+    bool publish(const SerializedEnvelope &ev) noexcept {
+      return publish(ev.topic, ev.topicLen, ev.bytes, ev.size, ev.sourceTsNs);
+    }
+
+    uint64_t written() const noexcept { return written_.load(std::memory_order_relaxed); }
+    uint64_t oversize() const noexcept { return oversize_.load(std::memory_order_relaxed); }
+
+   private:
+    static std::string normalize(std::string name) {
+      if (name.empty() || name.find('/', 1) != std::string::npos)
+        throw std::invalid_argument("ShmRingWriter: invalid shm name '" + name + "'");
+      return name[0] == '/' ? name : "/" + name;
+    }
+
+    // pid del writer de un segmento existente si sigue vivo (y no marcó closed); 0 = huérfano o
+    // ilegible. EPERM de kill() = el proceso existe, de otro usuario.
+    static uint64_t liveWriterPid(const std::string &name) noexcept {
+      const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+      if (fd < 0)
+        return 0;
+      struct stat st {};
+      if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < shm::kHeaderBytes) {
+        ::close(fd);
+        return 0;
+      }
+      void *p = ::mmap(nullptr, shm::kHeaderBytes, PROT_READ, MAP_SHARED, fd, 0);
+      ::close(fd);
+      if (p == MAP_FAILED)
+        return 0;
+      const auto *h = static_cast<const shm::RingHeader *>(p);
+      const uint64_t pid = h->writerPid;
+      const bool closed = h->closed.load(std::memory_order_acquire) != 0;
+      ::munmap(p, shm::kHeaderBytes);
+
+      if (pid == 0 || closed)
+        return 0;
+      if (::kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM)
+        return pid;
+      return 0;
+    }
+
+    static uint32_t pow2(uint32_t v) noexcept {
+      uint32_t p = 2;
+      while (p < v && p < (1u << 30)) p <<= 1;
+      return p;
+    }
+
+    static uint32_t roundSlot(uint32_t v) noexcept {
+      const uint32_t min = static_cast<uint32_t>(sizeof(shm::SlotHeader)) + 64;
+      v = v < min ? min : v;
+      return (v + static_cast<uint32_t>(shm::kCacheLine) - 1) &
+             ~static_cast<uint32_t>(shm::kCacheLine - 1);
+    }
+
+    shm::RingHeader *header() const noexcept { return reinterpret_cast<shm::RingHeader *>(map_); }
+
+    const std::string name_;
+    const uint32_t slotCount_;
+    const uint32_t slotBytes_;
+    const size_t bytes_;
+
+    unsigned char *map_{nullptr};
+    uint64_t next_{0}; // solo el writer
+
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> oversize_{0};
+  };
+
+} // namespace b3::md::publishing
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "../telemetry/LatencyHistogram.hpp"
+
+#include "IPublishSink.hpp"
+#include "SerializedEnvelope.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <zmq.hpp>
+
+namespace b3::md::publishing {
+
+  /**
+   * @brief Sink síncrono: tryPublish() manda topic + payload al socket PUB en el thread que
+   *        llama. Sin cola, sin thread propio, sin la cola interna de sockets::Publisher.
+   *
+   * Para el modo inline (md.publish.inline): el socket lo usa un único thread, el feed thread de
+   * OnixS. start() lo crea y bindea en el thread de main antes de arrancar el Handler (el
+   * arranque del feed thread es la barrera que exige ZMQ para pasar el socket de thread);
+   * stop() lo cierra con el Handler ya parado.
+   *
+   * PUB no bloquea: con el HWM lleno ZMQ descarta el mensaje sin avisar (no se cuenta acá).
+   */
+  class ZmqDirectSink final : public IPublishSink {
+   public:
+    static constexpr int kDefaultSendHwm = 100'000;
+
+    explicit ZmqDirectSink(std::string endpoint, int sendHwm = kDefaultSendHwm)
+        : endpoint_(std::move(endpoint)), sendHwm_(sendHwm) {}
+
+    ~ZmqDirectSink() { stop(); }
+
+    ZmqDirectSink(const ZmqDirectSink &) = delete;
+    ZmqDirectSink &operator=(const ZmqDirectSink &) = delete;
+
+    // Lanza si el bind falla (endpoint ocupado / inválido).
+    void start() {
+      if (sock_)
+        return;
+      auto sock = std::make_unique<zmq::socket_t>(ctx_, zmq::socket_type::pub);
+      sock->set(zmq::sockopt::sndhwm, sendHwm_);
+      sock->set(zmq::sockopt::linger, 0);
+      sock->bind(endpoint_);
+      sock_ = std::move(sock);
+    }
+
+    void stop() noexcept {
+      if (!sock_)
+        return;
+      try {
+        sock_->close();
+      } catch (...) {
+      }
+      sock_.reset();
+    }
+
+    const std::string &endpoint() const noexcept { return endpoint_; }
+
+    // Probe opcional (antes de start()): now(system) - sourceTsNs por envío.
+    void setLatencyProbe(telemetry::LatencyHistogram *probe) noexcept { probe_ = probe; }
+
+    bool tryPublish(uint32_t /*shardId*/, const SerializedEnvelope &ev) noexcept override {
+      if (!sock_ || ev.topicLen == 0 || ev.topicLen > SerializedEnvelope::kMaxTopic ||
+          ev.size == 0 || ev.size > SerializedEnvelope::kMaxBytes) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      try {
+        const bool ok =
+            sock_->send(zmq::const_buffer(ev.topic, ev.topicLen),
+                        zmq::send_flags::sndmore | zmq::send_flags::dontwait)
+                .has_value() &&
+            sock_->send(zmq::const_buffer(ev.bytes, ev.size), zmq::send_flags::dontwait)
+                .has_value();
+        if (ok) {
+          sent_.fetch_add(1, std::memory_order_relaxed);
+          if (probe_ && ev.sourceTsNs != 0) {
+            const uint64_t now = nowNsSystem();
+            probe_->record(now > ev.sourceTsNs ? now - ev.sourceTsNs : 0);
+          }
+          return true;
+        }
+      } catch (...) {
+      }
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    uint64_t sent() const noexcept { return sent_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+
+   private:
+    static uint64_t nowNsSystem() noexcept {
+      const auto now = std::chrono::system_clock::now().time_since_epoch();
+      return static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+    }
+
+    const std::string endpoint_;
+    const int sendHwm_;
+
+    zmq::context_t ctx_{1};
+    std::unique_ptr<zmq::socket_t> sock_;
+    telemetry::LatencyHistogram *probe_{nullptr};
+
+    std::atomic<uint64_t> sent_{0};
+    std::atomic<uint64_t> dropped_{0};
+  };
+
+} // namespace b3::md::publishing
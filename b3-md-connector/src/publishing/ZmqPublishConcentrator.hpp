@@ -2,11 +2,17 @@
 
 #include "../core/SnapshotQueueSpsc.hpp"
 #include "../telemetry/SpdlogLogPublisher.hpp"
+#include "../telemetry/LatencyHistogram.hpp"
 #include "../telemetry/LogEvent.hpp"
 
+#include "BatchFrame.hpp"
 #include "IPublishSink.hpp"
+#include "ISequencedSink.hpp"
+#include "SequencedReorder.hpp"
 #include "SerializedEnvelope.hpp"
+#include "ShmRingWriter.hpp"
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
@@ -21,17 +27,49 @@
 
 namespace b3::md::publishing {
 
-  class ZmqPublishConcentrator final : public IPublishSink {
+  // Batch frames opcionales (pub.batch): los books que drena una vuelta del concentrator se
+  // empaquetan además en un frame BatchFrame bajo un topic propio, para consumidores masivos.
+  struct BatchConfig {
+    bool enabled{false};
+    std::string topic{"BATCH"};
+    uint32_t flushUs{200};  // tope de espera del primer update del frame
+    bool exclusive{false};  // true = los books salen SOLO en batches (sin mensaje por instrumento)
+  };
+
+  class ZmqPublishConcentrator final : public IPublishSink, public ISequencedSink {
    public:
     static constexpr size_t kPerShardQueueCapacity = 4096;
+    static constexpr size_t kPriorityQueueCapacity = 1024;
     static constexpr uint32_t kBatchPerShard = 8;
     static constexpr size_t kLogQueueCapacity = 1024;
 
-    explicit ZmqPublishConcentrator(std::string pubEndpoint, uint32_t shardCount)
+    // queue = capacidad por shard + hugepages; el thread publisher hace el first-touch.
+    // sequencedProducers > 0: modo serialización paralela (SerializerPool). Las colas pasan a ser
+    // (shard x serializer) con reordenamiento por seq; la capacidad se reparte entre serializers.
+    // priorityCapacity: cola por canal prioritario (kPriorityChannels, ver IPublishSink).
+    explicit ZmqPublishConcentrator(std::string pubEndpoint, uint32_t shardCount,
+                                    b3::md::QueueConfig queue = {kPerShardQueueCapacity, false},
+                                    uint32_t sequencedProducers = 0,
+                                    uint32_t priorityCapacity = kPriorityQueueCapacity)
         : pubEndpoint_(std::move(pubEndpoint)), shardCount_(shardCount) {
-      queues_.reserve(shardCount_);
-      for (uint32_t i = 0; i < shardCount_; ++i) {
-        queues_.emplace_back(std::make_unique<QueueT>());
+      priority_.reserve(kPriorityChannels);
+      for (uint32_t i = 0; i < kPriorityChannels; ++i) {
+        priority_.emplace_back(std::make_unique<PriorityQueueT>(
+            b3::md::roundUpPow2(priorityCapacity), queue.hugePages, /*deferFirstTouch=*/true));
+      }
+
+      if (sequencedProducers > 0) {
+        const uint32_t perProducer =
+            std::max<uint32_t>(64, b3::md::roundUpPow2(queue.capacity / sequencedProducers));
+        sequenced_ = std::make_unique<SequencedReorder>(
+            shardCount_, sequencedProducers, b3::md::QueueConfig{perProducer, queue.hugePages},
+            /*deferFirstTouch=*/true);
+      } else {
+        queues_.reserve(shardCount_);
+        for (uint32_t i = 0; i < shardCount_; ++i) {
+          queues_.emplace_back(std::make_unique<QueueT>(queue.capacity, queue.hugePages,
+                                                        /*deferFirstTouch=*/true));
+        }
       }
 
       droppedByShard_.reserve(shardCount_);
@@ -53,7 +91,11 @@ namespace b3::md::publishing {
         return;
 
       logger_.start();
+      touched_.store(false, std::memory_order_relaxed);
       thread_ = std::thread([this] { run(); });
+
+      // Los workers no publican antes de que el consumer haya tocado las páginas de las colas.
+      while (!touched_.load(std::memory_order_acquire)) std::this_thread::yield();
     }
 
     void stop() {
@@ -77,9 +119,14 @@ namespace b3::md::publishing {
         return false;
       }
 
+      if (queues_.empty()) { // modo secuenciado: solo tryPublishSequenced
+        droppedByShard_[shardId].v.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+
       auto &q = *queues_[shardId];
       if (q.try_push(ev)) {
-        enqByShard_[shardId].v.fetch_add(1, std::memory_order_relaxed);
+        enqByShard_[shardId].v.fetch_add(1, std::memory_order_release);
         return true;
       }
 
@@ -87,6 +134,109 @@ namespace b3::md::publishing {
       return false;
     }
 
+    // Lane prioritaria: trades/eventos chicos, drenada antes que los books en cada vuelta.
+    bool tryPublishPriority(uint32_t channel, const CompactEnvelope &ev) noexcept override {
+      if (channel >= priority_.size() || ev.topicLen == 0 ||
+          ev.topicLen > CompactEnvelope::kMaxTopic || ev.size == 0 ||
+          ev.size > CompactEnvelope::kMaxBytes) {
+        priorityDropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      if (priority_[channel]->try_push(ev))
+        return true;
+      priorityDropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    uint64_t priorityDropped() const noexcept {
+      return priorityDropped_.load(std::memory_order_relaxed);
+    }
+    uint64_t prioritySent() const noexcept { return prioritySent_.load(std::memory_order_relaxed); }
+
+    uint64_t acceptedCount(uint32_t shardId) const noexcept override {
+      return shardId < shardCount_ ? enqByShard_[shardId].v.load(std::memory_order_acquire) : 0;
+    }
+
+    // Un solo thread/socket envía: si sent >= accepted, lo que se encole después sale después.
+    bool deliveredUpTo(uint32_t shardId, uint64_t accepted) const noexcept override {
+      return shardId >= shardCount_ ||
+             sentByShard_[shardId].v.load(std::memory_order_acquire) >= accepted;
+    }
+
+    // Llamar antes de start(). Topic vacío o > kMaxTopic => batching off.
+    void setBatching(BatchConfig cfg) {
+      if (!cfg.enabled || cfg.topic.empty() || cfg.topic.size() > SerializedEnvelope::kMaxTopic) {
+        batch_.reset();
+        return;
+      }
+      batchCfg_ = std::move(cfg);
+      batchFlushNs_ = static_cast<uint64_t>(batchCfg_.flushUs) * 1000ull;
+      batch_ = std::make_unique<BatchFrameBuilder>();
+      batchFrame_ = std::make_unique<uint8_t[]>(batch::kMaxBytes);
+    }
+
+    // Ring en memoria compartida (pub.shm.name), antes de start(): cada book que sale por el
+    // socket se escribe antes en el ring. El writer ya arrancado; lo usa solo el thread publisher.
+    void setShmRing(ShmRingWriter *ring) noexcept { shm_ = ring; }
+
+    bool batching() const noexcept { return batch_ != nullptr; }
+    uint64_t batchFrames() const noexcept { return batchFrames_.load(std::memory_order_relaxed); }
+    uint64_t batchedUpdates() const noexcept {
+      return batchedUpdates_.load(std::memory_order_relaxed);
+    }
+    // Updates que no entraban ni en un frame vacío: salieron sueltos.
+    uint64_t batchOversize() const noexcept {
+      return batchOversize_.load(std::memory_order_relaxed);
+    }
+
+    // Probe opcional (llamar antes de start()): por cada envío registra
+    // now(system) - SerializedEnvelope::sourceTsNs, i.e. callback OnixS -> socket.
+    void setLatencyProbe(telemetry::LatencyHistogram *probe) noexcept { probe_ = probe; }
+
+    // ISequencedSink (producer = serializer k). Un envelope inválido se degrada a skip:
+    // la seq tiene que avanzar igual o el shard queda trabado esperándola.
+    bool tryPublishSequenced(uint32_t shardId, uint32_t producer, uint64_t seq,
+                             const SerializedEnvelope *ev) noexcept override {
+      if (!sequenced_ || shardId >= shardCount_)
+        return false;
+
+      if (ev && (ev->topicLen == 0 || ev->topicLen > SerializedEnvelope::kMaxTopic ||
+                 ev->size == 0 || ev->size > SerializedEnvelope::kMaxBytes)) {
+        ev = nullptr;
+      }
+
+      if (!sequenced_->tryPush(shardId, producer, seq, ev))
+        return false; // lleno: el serializer reintenta
+
+      if (ev)
+        enqByShard_[shardId].v.fetch_add(1, std::memory_order_relaxed);
+      else
+        droppedByShard_[shardId].v.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+
+    uint64_t deliveredSeq(uint32_t shardId) const noexcept override {
+      return sequenced_ ? sequenced_->delivered(shardId) : 0;
+    }
+
+    size_t queueMemoryBytes() const noexcept {
+      size_t n = sequenced_ ? sequenced_->memoryBytes() : 0;
+      for (const auto &q : queues_) n += q->memoryBytes();
+      for (const auto &q : priority_) n += q->memoryBytes();
+      return n;
+    }
+
+    // Modo secuenciado: capacidad de cada cola (shard, serializer).
+    uint32_t queueCapacity() const noexcept {
+      return sequenced_ ? sequenced_->queueCapacity() : queues_.front()->capacity();
+    }
+
+    b3::md::QueueBacking queueBacking() const noexcept {
+      return sequenced_ ? sequenced_->backing() : queues_.front()->backing();
+    }
+
+    uint32_t sequencedProducers() const noexcept { return sequenced_ ? sequenced_->producers() : 0; }
+
     uint64_t droppedTotal() const noexcept {
       uint64_t sum = 0;
       for (uint32_t i = 0; i < shardCount_; ++i) {
@@ -95,8 +245,17 @@ namespace b3::md::publishing {
       return sum;
     }
 
+    uint64_t sentTotal() const noexcept {
+      uint64_t sum = 0;
+      for (uint32_t i = 0; i < shardCount_; ++i) {
+        sum += sentByShard_[i].v.load(std::memory_order_relaxed);
+      }
+      return sum;
+    }
+
    private:
     using QueueT = b3::md::SnapshotQueueSpsc<SerializedEnvelope, kPerShardQueueCapacity>;
+    using PriorityQueueT = b3::md::SnapshotQueueSpsc<CompactEnvelope, kPriorityQueueCapacity>;
 
     struct CopyableAtomicU64 {
       std::atomic<uint64_t> v;
@@ -109,6 +268,12 @@ namespace b3::md::publishing {
       }
     };
 
+    static uint64_t nowNsSystem() noexcept {
+      const auto now = std::chrono::system_clock::now().time_since_epoch();
+      return static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+    }
+
     static uint64_t nowNsSteady() noexcept {
       const auto now = std::chrono::steady_clock::now().time_since_epoch();
       return static_cast<uint64_t>(
@@ -142,27 +307,108 @@ namespace b3::md::publishing {
       void start() { pub.Start(); }
       void stop() { pub.Stop(); }
 
-      void sendSerialized(const SerializedEnvelope &ev) {
+      telemetry::LatencyHistogram *probe{nullptr};
+
+      template <typename Envelope>
+      void sendSerialized(const Envelope &ev) {
         pub.SendSerialized(ev.topic, ev.topicLen, ev.bytes, ev.size);
+        if (probe && ev.sourceTsNs != 0) {
+          const uint64_t now = nowNsSystem();
+          probe->record(now > ev.sourceTsNs ? now - ev.sourceTsNs : 0);
+        }
       }
     };
 
+    // Book drenado de un shard: suelto y/o al frame en curso (flush si no entra).
+    // kDirectOnly (streams throttleados C<N>.*): siempre suelto; el batch y el ring son del
+    // stream completo y pub.batch.exclusive no debe tragárselos.
+    void sendBook(MessagingPublisher &out, const SerializedEnvelope &ev, uint64_t nowNs) {
+      if (ev.flags & SerializedEnvelope::kDirectOnly) {
+        out.sendSerialized(ev);
+        return;
+      }
+      if (shm_)
+        (void)shm_->publish(ev); // same-host primero: no espera a la cola del Publisher
+      if (!batch_) {
+        out.sendSerialized(ev);
+        return;
+      }
+      if (!batch_->tryAdd(ev.topic, ev.topicLen, ev.bytes, ev.size, nowNs)) {
+        flushBatch(out);
+        if (!batch_->tryAdd(ev.topic, ev.topicLen, ev.bytes, ev.size, nowNs)) {
+          batchOversize_.fetch_add(1, std::memory_order_relaxed);
+          out.sendSerialized(ev);
+          return;
+        }
+      }
+      if (!batchCfg_.exclusive)
+        out.sendSerialized(ev);
+    }
+
+    void flushBatch(MessagingPublisher &out) {
+      if (!batch_ || batch_->empty())
+        return;
+      const uint16_t n = batch_->count();
+      const size_t bytes = batch_->finish(batchFrame_.get());
+      out.pub.SendSerialized(batchCfg_.topic.data(), static_cast<uint8_t>(batchCfg_.topic.size()),
+                             batchFrame_.get(), static_cast<uint32_t>(bytes));
+      batchFrames_.fetch_add(1, std::memory_order_relaxed);
+      batchedUpdates_.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    // Todo lo pendiente en la lane prioritaria (baja tasa: sin batch limit).
+    bool drainPriority(MessagingPublisher &out, CompactEnvelope &ev) {
+      bool didWork = false;
+      for (auto &q : priority_) {
+        while (q->try_pop(ev)) {
+          didWork = true;
+          out.sendSerialized(ev);
+          prioritySent_.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+      return didWork;
+    }
+
     void run() noexcept {
       using namespace std::chrono_literals;
 
+      for (auto &q : queues_) q->firstTouch();
+      for (auto &q : priority_) q->firstTouch();
+      if (sequenced_)
+        sequenced_->firstTouch();
+      touched_.store(true, std::memory_order_release);
+
       try {
         MessagingPublisher out(pubEndpoint_);
+        out.probe = probe_;
         out.start();
 
         uint32_t rr = 0;
         uint64_t nextHealth = nowNsSteady() + 5'000'000'000ull;
 
         SerializedEnvelope ev{};
+        CompactEnvelope pev{};
         while (running_.load(std::memory_order_acquire)) {
           bool didWork = false;
+          const uint64_t passNs = batch_ ? nowNsSteady() : 0;
 
           for (uint32_t n = 0; n < shardCount_; ++n) {
             const uint32_t sid = (rr + n) % shardCount_;
+
+            // Antes de cada batch de books: un trade nunca espera más que un batch
+            didWork = drainPriority(out, pev) || didWork;
+
+            if (sequenced_) {
+              const uint32_t sent = sequenced_->drainShard(sid, kBatchPerShard,
+                                                           [&](const SerializedEnvelope &e) {
+                                                             sendBook(out, e, passNs);
+                                                             sentByShard_[sid].v.fetch_add(
+                                                                 1, std::memory_order_release);
+                                                           });
+              didWork = didWork || sent > 0;
+              continue;
+            }
+
             auto &q = *queues_[sid];
 
             for (uint32_t k = 0; k < kBatchPerShard; ++k) {
@@ -170,14 +416,18 @@ namespace b3::md::publishing {
                 break;
 
               didWork = true;
-              out.sendSerialized(ev);
-              sentByShard_[sid].v.fetch_add(1, std::memory_order_relaxed);
+              sendBook(out, ev, passNs);
+              sentByShard_[sid].v.fetch_add(1, std::memory_order_release);
             }
           }
 
           rr = (rr + 1) % shardCount_;
 
           const uint64_t now = nowNsSteady();
+          // Frame en curso: sale por tiempo o cuando no hubo nada más que drenar
+          if (batch_ && !batch_->empty() && (!didWork || now - batch_->firstNs() >= batchFlushNs_))
+            flushBatch(out);
+
           if (now >= nextHealth) {
             nextHealth = now + 5'000'000'000ull;
             emitHealth(now);
@@ -188,13 +438,21 @@ namespace b3::md::publishing {
         }
 
         // Drain final
-        for (uint32_t sid = 0; sid < shardCount_; ++sid) {
+        (void)drainPriority(out, pev);
+        for (uint32_t sid = 0; sequenced_ && sid < shardCount_; ++sid) {
+          (void)sequenced_->drainShard(sid, UINT32_MAX, [&](const SerializedEnvelope &e) {
+            sendBook(out, e, 0);
+            sentByShard_[sid].v.fetch_add(1, std::memory_order_relaxed);
+          });
+        }
+        for (uint32_t sid = 0; sid < queues_.size(); ++sid) {
           auto &q = *queues_[sid];
           while (q.try_pop(ev)) {
-            out.sendSerialized(ev);  // No std::move: SerializedEnvelope is trivially copyable (16KB POD)
+            sendBook(out, ev, 0);  // No std::move: SerializedEnvelope is trivially copyable (16KB POD)
             sentByShard_[sid].v.fetch_add(1, std::memory_order_relaxed);
           }
         }
+        flushBatch(out);
 
         out.stop();
       } catch (...) {
@@ -207,6 +465,21 @@ namespace b3::md::publishing {
     uint32_t shardCount_{0};
 
     std::vector<std::unique_ptr<QueueT>> queues_;
+    std::unique_ptr<SequencedReorder> sequenced_; // solo modo serialización paralela
+    std::vector<std::unique_ptr<PriorityQueueT>> priority_; // un canal por productor prioritario
+    std::atomic<uint64_t> prioritySent_{0};
+    std::atomic<uint64_t> priorityDropped_{0};
+    telemetry::LatencyHistogram *probe_{nullptr};
+    ShmRingWriter *shm_{nullptr};
+
+    // Batch frames (solo el thread publisher usa builder/buffer)
+    BatchConfig batchCfg_{};
+    uint64_t batchFlushNs_{0};
+    std::unique_ptr<BatchFrameBuilder> batch_;
+    std::unique_ptr<uint8_t[]> batchFrame_;
+    std::atomic<uint64_t> batchFrames_{0};
+    std::atomic<uint64_t> batchedUpdates_{0};
+    std::atomic<uint64_t> batchOversize_{0};
 
     std::vector<CopyableAtomicU64> droppedByShard_;
     std::vector<CopyableAtomicU64> enqByShard_;
@@ -215,6 +488,7 @@ namespace b3::md::publishing {
     telemetry::SpdlogLogPublisher<kLogQueueCapacity> logger_;
 
     std::atomic<bool> running_{false};
+    std::atomic<bool> touched_{false};
     std::thread thread_{};
   };
 
@@ -0,0 +1,310 @@
+// b3-md-connector/src/replay_main.cpp
+//
+// Pipeline replay benchmark
+//
+// Feeds an OrdersSnapshot capture journal (md.capture.path, see core/SnapshotJournal.hpp)
+// through MdPublishPipeline -> workers -> sink, either at the recorded pace or as fast as
+// possible, and reports throughput plus per-stage latency percentiles. The sink only counts
+// (no ZMQ), so the numbers are the in-process cost of the pipeline for a real traffic shape.
+//
+// Usage:
+//   b3-md-replay <journal> [--shards N] [--queue-capacity N] [--hugepages 0|1]
+//                          [--pace max|recorded] [--speed X]
+
+#include "core/MdPublishPipeline.hpp"
+#include "core/MdPublishWorker.hpp"
+#include "core/SnapshotJournal.hpp"
+#include "mapping/InstrumentTopicMapper.hpp"
+#include "mapping/MdSnapshotMapper.hpp"
+#include "publishing/IPublishSink.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+  struct ReplayOptions {
+    std::string journalPath;
+    uint32_t shards{4};
+    uint32_t queueCapacity{static_cast<uint32_t>(b3::md::MdPublishWorker::kQueueCapacity)};
+    bool hugePages{false};
+    bool recordedPace{false};
+    double speed{1.0};
+  };
+
+  uint64_t nowNsSteady() noexcept {
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+  }
+
+  // Muestras por record (índice global en el journal). Cada índice lo escribe un solo thread.
+  struct StageSamples {
+    std::vector<uint64_t> enqueueAtNs; // antes de tryEnqueue (producer)
+    std::vector<uint64_t> decodeNs;
+    std::vector<uint64_t> enqueueNs;   // tryEnqueue incl. reintentos por cola llena
+    std::vector<uint64_t> queueNs;     // encolado -> inicio de serialización (cola + agregado MBP)
+                                       // (durante el run guarda el instante absoluto; ver main)
+    std::vector<uint64_t> serializeNs;
+    std::vector<uint64_t> endToEndNs;  // antes de tryEnqueue -> aceptado por el sink
+
+    explicit StageSamples(size_t n)
+        : enqueueAtNs(n), decodeNs(n), enqueueNs(n), queueNs(n), serializeNs(n), endToEndNs(n) {}
+  };
+
+  // Los records de un instrumento salen en orden (FIFO por instrumento), así que el worker
+  // recupera el índice global con un contador propio por instrumento: sin tocar los datos.
+  struct InstrumentTrack {
+    std::vector<uint32_t> records;
+    uint32_t next{0}; // solo lo avanza el worker dueño del instrumento
+  };
+
+  using TrackMap = std::unordered_map<uint64_t, InstrumentTrack>;
+
+  inline thread_local uint32_t tlsCurrentRecord = 0;
+
+  class TimingMapper final : public b3::md::mapping::MdSnapshotMapper {
+   public:
+    TimingMapper(TrackMap &tracks, StageSamples &samples) : tracks_(tracks), samples_(samples) {}
+
+    bool mapToSerializedEnvelope(const b3::md::BookSnapshot &s,
+                                 b3::md::publishing::SerializedEnvelope &ev, const char *topic,
+                                 std::uint8_t topicLen) const noexcept override {
+      const uint64_t t0 = nowNsSteady();
+      auto it = tracks_.find(s.instrumentId);
+      const uint32_t rec = it->second.records[it->second.next++];
+      tlsCurrentRecord = rec;
+
+      const bool ok = MdSnapshotMapper::mapToSerializedEnvelope(s, ev, topic, topicLen);
+      const uint64_t t1 = nowNsSteady();
+      samples_.queueNs[rec] = t0; // enqueueNs[rec] puede no estar escrito todavía
+      samples_.serializeNs[rec] = t1 - t0;
+      return ok;
+    }
+
+   private:
+    TrackMap &tracks_;
+    StageSamples &samples_;
+  };
+
+  class TimingSink final : public b3::md::publishing::IPublishSink {
+   public:
+    explicit TimingSink(StageSamples &samples) : samples_(samples) {}
+
+    bool tryPublish(uint32_t, const b3::md::publishing::SerializedEnvelope &ev) noexcept override {
+      const uint32_t rec = tlsCurrentRecord;
+      samples_.endToEndNs[rec] = nowNsSteady() - samples_.enqueueAtNs[rec];
+      bytes_.fetch_add(ev.size, std::memory_order_relaxed);
+      published_.fetch_add(1, std::memory_order_relaxed);
+      lastPublishNs_.store(nowNsSteady(), std::memory_order_relaxed);
+      return true;
+    }
+
+    uint64_t published() const noexcept { return published_.load(std::memory_order_relaxed); }
+    uint64_t bytes() const noexcept { return bytes_.load(std::memory_order_relaxed); }
+    uint64_t lastPublishNs() const noexcept { return lastPublishNs_.load(std::memory_order_relaxed); }
+
+   private:
+    StageSamples &samples_;
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> lastPublishNs_{0};
+  };
+
+  void printStage(const char *name, std::vector<uint64_t> v) {
+    if (v.empty())
+      return;
+    std::sort(v.begin(), v.end());
+    auto pct = [&](double p) {
+      return v[std::min(v.size() - 1, static_cast<size_t>(p * static_cast<double>(v.size())))];
+    };
+    std::printf("  %-10s p50=%8.2fus p90=%8.2fus p99=%8.2fus p99.9=%8.2fus max=%9.2fus\n", name,
+                pct(0.50) / 1e3, pct(0.90) / 1e3, pct(0.99) / 1e3, pct(0.999) / 1e3,
+                v.back() / 1e3);
+  }
+
+  bool parseArgs(int argc, char **argv, ReplayOptions &o) {
+    for (int i = 1; i < argc; ++i) {
+      const std::string a = argv[i];
+      auto value = [&]() -> const char * { return i + 1 < argc ? argv[++i] : nullptr; };
+
+      if (a == "--shards") {
+        const char *v = value();
+        if (!v) return false;
+        o.shards = static_cast<uint32_t>(std::max(1, std::atoi(v)));
+      } else if (a == "--queue-capacity") {
+        const char *v = value();
+        if (!v) return false;
+        o.queueCapacity = b3::md::roundUpPow2(static_cast<uint32_t>(std::max(2, std::atoi(v))));
+      } else if (a == "--hugepages") {
+        const char *v = value();
+        if (!v) return false;
+        o.hugePages = std::atoi(v) != 0;
+      } else if (a == "--pace") {
+        const char *v = value();
+        if (!v) return false;
+        const std::string p = v;
+        if (p != "max" && p != "recorded") return false;
+        o.recordedPace = p == "recorded";
+      } else if (a == "--speed") {
+        const char *v = value();
+        if (!v) return false;
+        o.speed = std::atof(v);
+        if (o.speed <= 0) return false;
+      } else if (!a.empty() && a[0] != '-' && o.journalPath.empty()) {
+        o.journalPath = a;
+      } else {
+        return false;
+      }
+    }
+    return !o.journalPath.empty();
+  }
+
+} // namespace
+
+int main(int argc, char **argv) {
+  ReplayOptions opt;
+  if (!parseArgs(argc, argv, opt)) {
+    std::cerr << "usage: " << argv[0]
+              << " <journal> [--shards N] [--queue-capacity N] [--hugepages 0|1]"
+                 " [--pace max|recorded] [--speed X]\n";
+    return 2;
+  }
+
+  std::unique_ptr<b3::md::SnapshotJournalReader> reader;
+  try {
+    reader = std::make_unique<b3::md::SnapshotJournalReader>(opt.journalPath);
+  } catch (const std::exception &ex) {
+    std::cerr << "[replay] " << ex.what() << "\n";
+    return 1;
+  }
+
+  // -------------------------
+  // Pre-pass: índice por instrumento
+  // -------------------------
+  b3::md::OrdersSnapshot snap{};
+  uint64_t captureNs = 0;
+  uint64_t firstCaptureNs = 0;
+  uint64_t lastCaptureNs = 0;
+  uint32_t records = 0;
+  TrackMap tracks;
+  while (reader->next(snap, captureNs)) {
+    if (records == 0)
+      firstCaptureNs = captureNs;
+    lastCaptureNs = captureNs;
+    tracks[snap.instrumentId].records.push_back(records++);
+  }
+  if (reader->truncated())
+    std::cerr << "[replay] warning: journal ends with a truncated record (ignored)\n";
+  if (records == 0) {
+    std::cerr << "[replay] journal is empty\n";
+    return 1;
+  }
+
+  std::cerr << "[replay] journal=" << opt.journalPath << " records=" << records
+            << " instruments=" << tracks.size() << " bytes=" << reader->fileBytes()
+            << " span=" << (lastCaptureNs - firstCaptureNs) / 1e9 << "s\n";
+  std::cerr << "[replay] shards=" << opt.shards << " queue.capacity=" << opt.queueCapacity
+            << " hugepages=" << (opt.hugePages ? 1 : 0)
+            << " pace=" << (opt.recordedPace ? "recorded" : "max");
+  if (opt.recordedPace)
+    std::cerr << " speed=" << opt.speed;
+  std::cerr << "\n";
+
+  // -------------------------
+  // Pipeline (sin ZMQ: el sink solo mide)
+  // -------------------------
+  StageSamples samples(records);
+  TimingMapper mapper(tracks, samples);
+  TimingSink sink(samples);
+
+  // El journal no guarda símbolos: topic sintético por instrumento (sin él el worker dropea)
+  b3::common::InstrumentRegistry registry;
+  for (const auto &[iid, track] : tracks) registry.upsert(iid, "IID" + std::to_string(iid));
+  b3::md::mapping::InstrumentTopicMapper topicMapper(registry);
+
+  std::vector<std::unique_ptr<b3::md::MdPublishWorker>> workers;
+  for (uint32_t i = 0; i < opt.shards; ++i) {
+    workers.emplace_back(std::make_unique<b3::md::MdPublishWorker>(
+        i, mapper, sink, topicMapper, 1, b3::md::QueueConfig{opt.queueCapacity, opt.hugePages}));
+  }
+  b3::md::MdPublishPipeline pipeline(std::move(workers));
+  pipeline.start();
+
+  // -------------------------
+  // Replay
+  // -------------------------
+  reader->rewind();
+  uint64_t enqueueFull = 0;
+  const uint64_t startNs = nowNsSteady();
+
+  for (uint32_t rec = 0; rec < records; ++rec) {
+    const uint64_t d0 = nowNsSteady();
+    if (!reader->next(snap, captureNs))
+      break;
+    const uint64_t d1 = nowNsSteady();
+    samples.decodeNs[rec] = d1 - d0;
+
+    if (opt.recordedPace) {
+      const uint64_t due =
+          startNs + static_cast<uint64_t>(static_cast<double>(captureNs - firstCaptureNs) / opt.speed);
+      while (nowNsSteady() < due) std::this_thread::yield();
+    }
+
+    const uint64_t e0 = nowNsSteady();
+    samples.enqueueAtNs[rec] = e0;
+    while (!pipeline.tryEnqueue(snap)) {
+      ++enqueueFull;
+      std::this_thread::yield();
+    }
+    samples.enqueueNs[rec] = nowNsSteady() - e0;
+  }
+
+  const uint64_t producedNs = nowNsSteady();
+  pipeline.stop(true);
+
+  // -------------------------
+  // Reporte
+  // -------------------------
+  const uint64_t published = sink.published();
+  uint64_t workerDrops = 0;
+  for (uint32_t i = 0; i < pipeline.shardCount(); ++i) workerDrops += pipeline.worker(i).dropped();
+  const uint64_t endNs = std::max(sink.lastPublishNs(), producedNs);
+  const double wallS = static_cast<double>(endNs - startNs) / 1e9;
+
+  std::printf("[replay] records=%u published=%llu worker_drops=%llu enqueue_full_retries=%llu\n",
+              records, static_cast<unsigned long long>(published),
+              static_cast<unsigned long long>(workerDrops),
+              static_cast<unsigned long long>(enqueueFull));
+  std::printf("[replay] wall=%.3fs throughput=%.0f snapshots/s (%.1f MB/s serialized)\n", wallS,
+              static_cast<double>(published) / wallS,
+              static_cast<double>(sink.bytes()) / wallS / 1e6);
+
+  if (published != records) {
+    std::printf("[replay] latency omitted: not every record reached the sink\n");
+    return 1;
+  }
+
+  // El worker puede arrancar antes de que el producer tome el timestamp post-enqueue: clamp a 0
+  for (uint32_t rec = 0; rec < records; ++rec) {
+    const uint64_t enqueuedAt = samples.enqueueAtNs[rec] + samples.enqueueNs[rec];
+    samples.queueNs[rec] = samples.queueNs[rec] > enqueuedAt ? samples.queueNs[rec] - enqueuedAt : 0;
+  }
+
+  std::printf("[replay] per-stage latency:\n");
+  printStage("decode", std::move(samples.decodeNs));
+  printStage("enqueue", std::move(samples.enqueueNs));
+  printStage("queue+agg", std::move(samples.queueNs));
+  printStage("serialize", std::move(samples.serializeNs));
+  printStage("end2end", std::move(samples.endToEndNs));
+  return 0;
+}
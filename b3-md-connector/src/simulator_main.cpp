@@ -18,6 +18,7 @@
 #include "publishing/ZmqPublishConcentrator.hpp"
 #include "messaging/B3MdSubscriptionServer.hpp"
 #include "testsupport/FakeOnixsHandler.hpp"
+#include "testsupport/SyntheticLoadGenerator.hpp"
 
 #include <chrono>
 #include <csignal>
@@ -36,11 +37,84 @@ namespace {
     std::cerr << "\n[simulator] Caught signal " << signal << ", shutting down...\n";
     g_running.store(false, std::memory_order_release);
   }
+
+  struct SimulatorOptions {
+    int shards{4};
+    uint32_t queueCapacity{static_cast<uint32_t>(b3::md::MdPublishWorker::kQueueCapacity)};
+    std::string securitiesFile{"b3-md-connector/src/testsupport/securities.json"};
+
+    // Load test (--rate > 0). Sin --rate: loop legacy cada 100ms
+    b3::md::testsupport::LoadProfile load{};
+    bool loadTest{false};
+    std::string profileName{"steady"};
+    double durationSec{0}; // 0 = hasta Ctrl+C
+  };
+
+  void printUsage(const char *argv0) {
+    std::cerr
+        << "usage: " << argv0 << " [options]\n"
+        << "  --securities <file>        security-list dump (.json o CSV/TSV con header)\n"
+        << "  --shards N                 workers (default 4)\n"
+        << "  --queue-capacity N         cola por lane de cada worker\n"
+        << "  --rate N                   updates/s totales (activa el load generator)\n"
+        << "  --producers N              threads productores = lanes de ingreso (default 1)\n"
+        << "  --profile P                steady | opening | news | session\n"
+        << "  --zipf S                   exponente de actividad por instrumento (default 1.1)\n"
+        << "  --levels MIN:MAX           niveles por lado (default 3:40)\n"
+        << "  --orders-per-level MIN:MAX órdenes por nivel (default 1:12)\n"
+        << "  --duration SEC             parar solo después de SEC segundos\n"
+        << "  --seed N\n";
+  }
+
+  bool parseRange(const std::string &v, uint32_t &lo, uint32_t &hi) {
+    const auto c = v.find(':');
+    if (c == std::string::npos)
+      return false;
+    lo = static_cast<uint32_t>(std::stoul(v.substr(0, c)));
+    hi = static_cast<uint32_t>(std::stoul(v.substr(c + 1)));
+    return lo > 0 && hi >= lo;
+  }
+
+  bool parseOptions(int argc, char **argv, SimulatorOptions &o) {
+    try {
+      for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (a == "--help" || a == "-h" || !hasValue)
+          return false;
+        const std::string v = argv[++i];
+        if (a == "--securities") o.securitiesFile = v;
+        else if (a == "--shards") o.shards = std::max(1, std::stoi(v));
+        else if (a == "--queue-capacity")
+          o.queueCapacity = b3::md::roundUpPow2(static_cast<uint32_t>(std::max(2, std::stoi(v))));
+        else if (a == "--rate") { o.load.updatesPerSec = std::stod(v); o.loadTest = o.load.updatesPerSec > 0; }
+        else if (a == "--producers") o.load.producers = static_cast<uint32_t>(std::max(1, std::stoi(v)));
+        else if (a == "--profile") o.profileName = v;
+        else if (a == "--zipf") o.load.zipfExponent = std::stod(v);
+        else if (a == "--levels") { if (!parseRange(v, o.load.minLevels, o.load.maxLevels)) return false; }
+        else if (a == "--orders-per-level") {
+          if (!parseRange(v, o.load.minOrdersPerLevel, o.load.maxOrdersPerLevel)) return false;
+        }
+        else if (a == "--duration") o.durationSec = std::stod(v);
+        else if (a == "--seed") o.load.seed = std::stoull(v);
+        else return false;
+      }
+    } catch (const std::exception &) {
+      return false;
+    }
+    return o.load.applyPreset(o.profileName);
+  }
 } // namespace
 
 int main(int argc, char **argv) {
   namespace fs = std::filesystem;
 
+  SimulatorOptions opts;
+  if (!parseOptions(argc, argv, opts)) {
+    printUsage(argv[0]);
+    return 2;
+  }
+
   std::cerr << "╔════════════════════════════════════════════════════════════╗\n";
   std::cerr << "║  B3 Market Data Connector - End-to-End Simulator          ║\n";
   std::cerr << "╚════════════════════════════════════════════════════════════╝\n";
@@ -54,11 +128,13 @@ int main(int argc, char **argv) {
   // -------------------------
   // Configuration
   // -------------------------
-  const int shards = 4;
+  const int shards = opts.shards;
   const std::string subEndpoint = "tcp://*:8080";
   const std::string subResponseEndpoint = "tcp://*:8082";
   const std::string pubEndpoint = "tcp://*:8081";
-  const std::string securitiesFile = "b3-md-connector/src/testsupport/securities.json";
+  const std::string &securitiesFile = opts.securitiesFile;
+  // Un productor del load generator = una lane de ingreso (contrato SPSC por lane)
+  const uint32_t ingressLanes = opts.loadTest ? opts.load.producers : 1;
 
   std::cerr << "[simulator] Configuration:\n";
   std::cerr << "  - Shards: " << shards << "\n";
@@ -66,6 +142,14 @@ int main(int argc, char **argv) {
   std::cerr << "  - Subscription response: " << subResponseEndpoint << " (responses)\n";
   std::cerr << "  - Market data publishing: " << pubEndpoint << "\n";
   std::cerr << "  - Securities file: " << securitiesFile << "\n";
+  std::cerr << "  - Queue capacity: " << opts.queueCapacity << " x " << ingressLanes << " lanes\n";
+  if (opts.loadTest) {
+    std::cerr << "  - Load: rate=" << opts.load.updatesPerSec << "/s producers=" << opts.load.producers
+              << " profile=" << opts.profileName << " zipf=" << opts.load.zipfExponent
+              << " levels=" << opts.load.minLevels << ":" << opts.load.maxLevels
+              << " orders_per_level=" << opts.load.minOrdersPerLevel << ":"
+              << opts.load.maxOrdersPerLevel << "\n";
+  }
   std::cerr << "\n";
 
   // -------------------------
@@ -82,12 +166,15 @@ int main(int argc, char **argv) {
   std::cerr << "[simulator]   ✓ ZMQ Publisher started on " << pubEndpoint << "\n";
 
   b3::md::mapping::MdSnapshotMapper mapper;
+  mapper.setEmbedTimestamps(true); // test-client mide latencia end-to-end con estos campos
+  mapper.setBookSequence(true);    // y gaps por símbolo con el RptSeq
 
   std::vector<std::unique_ptr<b3::md::MdPublishWorker>> workers;
   workers.reserve(static_cast<size_t>(shards));
   for (int i = 0; i < shards; ++i) {
-    workers.emplace_back(std::make_unique<b3::md::MdPublishWorker>(static_cast<uint32_t>(i), mapper,
-                                                                   concentrator, topicMapper));
+    workers.emplace_back(std::make_unique<b3::md::MdPublishWorker>(
+        static_cast<uint32_t>(i), mapper, concentrator, topicMapper, ingressLanes,
+        b3::md::QueueConfig{opts.queueCapacity, false}));
   }
 
   b3::md::MdPublishPipeline pipeline(std::move(workers));
@@ -160,10 +247,25 @@ int main(int argc, char **argv) {
   // Start Market Data Generation
   // -------------------------
   std::cerr << "\n[simulator] Starting market data generation...\n";
-  std::cerr << "[simulator] Generating synthetic OrderBook updates every 100ms\n";
-  std::cerr << "\n";
 
-  fakeHandler.startUpdateLoop(std::chrono::milliseconds(100));
+  std::unique_ptr<b3::md::testsupport::SyntheticLoadGenerator> loadGen;
+  if (opts.loadTest) {
+    std::vector<uint64_t> ids;
+    ids.reserve(fakeHandler.securities().size());
+    for (const auto &sec : fakeHandler.securities()) ids.push_back(sec.securityId);
+
+    loadGen = std::make_unique<b3::md::testsupport::SyntheticLoadGenerator>(opts.load, std::move(ids));
+    std::cerr << "[simulator] Load generator: " << opts.load.updatesPerSec << " updates/s over "
+              << fakeHandler.securities().size() << " instruments (" << opts.load.producers
+              << " producers)\n";
+    loadGen->start(
+        [&](const b3::md::OrdersSnapshot &s) { orderBookListener.injectTestSnapshot(s); },
+        [&](uint32_t) { (void)pipeline.bindCurrentThreadToLane(); });
+  } else {
+    std::cerr << "[simulator] Generating synthetic OrderBook updates every 100ms\n";
+    fakeHandler.startUpdateLoop(std::chrono::milliseconds(100));
+  }
+  std::cerr << "\n";
 
   // -------------------------
   // Runtime
@@ -182,9 +284,32 @@ int main(int argc, char **argv) {
   std::cerr << "  Note: Worker stats are logged via spdlog every 5 seconds.\n";
   std::cerr << "\n";
 
-  // Wait for shutdown signal
+  // Wait for shutdown signal (load test: línea de stats por segundo)
+  uint64_t lastGenerated = 0;
+  uint64_t lastSent = 0;
+  auto workerDrops = [&] {
+    uint64_t n = 0;
+    for (uint32_t i = 0; i < pipeline.shardCount(); ++i) n += pipeline.worker(i).dropped();
+    return n;
+  };
   while (g_running.load(std::memory_order_acquire)) {
     std::this_thread::sleep_for(std::chrono::seconds(1));
+    if (!loadGen)
+      continue;
+
+    const double t = loadGen->elapsedSec();
+    const uint64_t generated = loadGen->generated();
+    const uint64_t sent = concentrator.sentTotal();
+    std::cerr << "[load] t=" << static_cast<int>(t) << "s x" << opts.load.multiplierAt(t)
+              << " gen/s=" << (generated - lastGenerated) << " pub/s=" << (sent - lastSent)
+              << " drops engine=" << engine.drops() << " worker=" << workerDrops()
+              << " publish=" << concentrator.droppedTotal() << " behind=" << loadGen->behindSlices()
+              << "\n";
+    lastGenerated = generated;
+    lastSent = sent;
+
+    if (opts.durationSec > 0 && t >= opts.durationSec)
+      g_running.store(false, std::memory_order_release);
   }
 
   // -------------------------
@@ -193,7 +318,10 @@ int main(int argc, char **argv) {
   std::cerr << "\n[simulator] Shutting down...\n";
 
   std::cerr << "[simulator] Stopping market data generation...\n";
-  fakeHandler.stopUpdateLoop();
+  if (loadGen)
+    loadGen->stop();
+  else
+    fakeHandler.stopUpdateLoop();
 
   std::cerr << "[simulator] Stopping subscription server...\n";
   subscriptionServer->Stop();
@@ -204,6 +332,15 @@ int main(int argc, char **argv) {
   std::cerr << "[simulator] Stopping concentrator...\n";
   concentrator.stop();
 
+  if (loadGen) {
+    const double secs = loadGen->elapsedSec();
+    std::cerr << "\n[simulator] Load summary: generated=" << loadGen->generated() << " ("
+              << loadGen->generated() / secs << "/s) published=" << concentrator.sentTotal()
+              << " drops engine=" << engine.drops() << " worker=" << workerDrops()
+              << " publish=" << concentrator.droppedTotal()
+              << " behind_slices=" << loadGen->behindSlices() << "\n";
+  }
+
   std::cerr << "\n[simulator] Shutdown complete.\n";
   return 0;
 }
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace b3::md::telemetry {
+
+  /**
+   * @brief Histograma log-lineal de latencias (ns), sin alocar y O(1) por muestra.
+   *
+   * Bucket = potencia de 2 del valor × 8 sub-buckets lineales (error relativo <= 12.5%).
+   * Single writer (el thread que mide); los lectores pueden consultar en caliente
+   * (atomics relaxed: percentiles aproximados mientras corre, exactos después del join).
+   */
+  class LatencyHistogram final {
+   public:
+    static constexpr uint32_t kSubBits = 3;
+    static constexpr uint32_t kSubBuckets = 1u << kSubBits;
+    static constexpr uint32_t kBuckets = 64 * kSubBuckets;
+
+    void record(uint64_t ns) noexcept {
+      buckets_[indexOf(ns)].fetch_add(1, std::memory_order_relaxed);
+      count_.fetch_add(1, std::memory_order_relaxed);
+      sum_.fetch_add(ns, std::memory_order_relaxed);
+      if (ns > max_.load(std::memory_order_relaxed))
+        max_.store(ns, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const noexcept { return count_.load(std::memory_order_relaxed); }
+    uint64_t max() const noexcept { return max_.load(std::memory_order_relaxed); }
+    uint64_t mean() const noexcept {
+      const uint64_t n = count();
+      return n ? sum_.load(std::memory_order_relaxed) / n : 0;
+    }
+
+    // Cota superior del bucket que contiene el percentil p (0..1). 0 si no hay muestras.
+    uint64_t percentile(double p) const noexcept {
+      const uint64_t n = count();
+      if (n == 0)
+        return 0;
+      const uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(n - 1)) + 1;
+      uint64_t seen = 0;
+      for (uint32_t i = 0; i < kBuckets; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+          const uint64_t hi = upperBound(i);
+          return hi < max() ? hi : max();
+        }
+      }
+      return max();
+    }
+
+    void reset() noexcept {
+      for (auto &b : buckets_) b.store(0, std::memory_order_relaxed);
+      count_.store(0, std::memory_order_relaxed);
+      sum_.store(0, std::memory_order_relaxed);
+      max_.store(0, std::memory_order_relaxed);
+    }
+
+   private:
+    static uint32_t indexOf(uint64_t v) noexcept {
+      if (v < kSubBuckets)
+        return static_cast<uint32_t>(v);
+      const uint32_t msb = 63u - static_cast<uint32_t>(__builtin_clzll(v));
+      const uint32_t sub = static_cast<uint32_t>(v >> (msb - kSubBits)) & (kSubBuckets - 1);
+      return (msb - kSubBits + 1) * kSubBuckets + sub;
+    }
+
+    static uint64_t upperBound(uint32_t idx) noexcept {
+      if (idx < kSubBuckets)
+        return idx;
+      const uint32_t msb = idx / kSubBuckets + kSubBits - 1;
+      const uint64_t sub = idx % kSubBuckets;
+      const uint64_t base = (uint64_t{1} << msb) | (sub << (msb - kSubBits));
+      return base + (uint64_t{1} << (msb - kSubBits)) - 1;
+    }
+
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+  };
+
+} // namespace b3::md::telemetry
@@ -12,7 +12,9 @@ namespace b3::md::telemetry {
     Worker = 2,
     Mapping = 3,
     Publishing = 4,
-    Adapter = 5
+    Adapter = 5,
+    Trades = 6,
+    MarketState = 7
   };
 
   enum class Code : uint16_t {
@@ -22,6 +24,7 @@ namespace b3::md::telemetry {
     HealthTick = 10,
     Drops = 11,
     QueueSaturated = 12,
+    ShardRebalanced = 13,
 
     WorkerException = 100,
     PublishFailed = 101,
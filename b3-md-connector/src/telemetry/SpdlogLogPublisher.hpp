@@ -85,6 +85,8 @@ private:
             case Component::Mapping:    return "mapping";
             case Component::Publishing: return "publishing";
             case Component::Adapter:    return "adapter";
+            case Component::Trades:     return "trades";
+            case Component::MarketState:return "state";
             default:                    return "unknown";
         }
     }
@@ -96,6 +98,7 @@ private:
             case Code::HealthTick:      return "health_tick";
             case Code::Drops:           return "drops";
             case Code::QueueSaturated:  return "queue_saturated";
+            case Code::ShardRebalanced: return "shard_rebalanced";
             case Code::WorkerException: return "worker_exception";
             case Code::PublishFailed:   return "publish_failed";
             case Code::SerializeFailed: return "serialize_failed";
@@ -136,6 +139,12 @@ private:
                                  comp, code, e.shard, e.arg0, high, low);
                 }
             }
+        } else if (e.component == Component::Adapter && e.code == Code::HealthTick) {
+            // Feed poll thread: arg0 = process() con eventos, arg1 = (maxNs << 32) | avgNs
+            const uint64_t maxNs = (e.arg1 >> 32) & 0xFFFFFFFFull;
+            const uint64_t avgNs = e.arg1 & 0xFFFFFFFFull;
+            spdlog::info("[{}] code={} dispatches={} max_ns={} avg_ns={}",
+                         comp, code, e.arg0, maxNs, avgNs);
         } else {
             // Standard format for other events
             if (e.level == LogLevel::Error) {
@@ -18,12 +18,17 @@
 #include <vector>
 #include <fstream>
 #include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
 
 namespace b3::md::testsupport {
 
   struct Security {
     uint64_t securityId;
     std::string symbol;
+    uint64_t rptSeq{0};
   };
 
   /**
@@ -44,7 +49,10 @@ namespace b3::md::testsupport {
     }
 
 
-    // Load securities from JSON file
+    // Load securities from a security-list dump:
+    // - .json: array de {"securityId": N, "symbol": "XXX"} (uno por línea; sin securityId => secuencial)
+    // - otro: texto delimitado (',' ';' o tab) con header; columnas securityId/SecurityID/SctyId/
+    //   instrumentId y symbol/Symbol/TckrSymb (p.ej. el cadastro de instrumentos de B3)
     bool loadSecurities(const std::string& filepath) {
       securities_.clear();
 
@@ -54,35 +62,22 @@ namespace b3::md::testsupport {
         return false;
       }
 
-      // Simple JSON parsing (expects array format)
-      std::string line;
-      uint64_t id = 0;
-      while (std::getline(file, line)) {
-        // Look for "symbol": "XXX" pattern
-        auto symPos = line.find("\"symbol\"");
-        if (symPos == std::string::npos) continue;
-
-        auto colonPos = line.find(':', symPos);
-        if (colonPos == std::string::npos) continue;
+      const bool json = filepath.size() >= 5 && filepath.compare(filepath.size() - 5, 5, ".json") == 0;
+      if (json)
+        loadJsonLines(file);
+      else
+        loadDelimited(file);
 
-        auto quote1 = line.find('"', colonPos);
-        if (quote1 == std::string::npos) continue;
-
-        auto quote2 = line.find('"', quote1 + 1);
-        if (quote2 == std::string::npos) continue;
-
-        std::string symbol = line.substr(quote1 + 1, quote2 - quote1 - 1);
-        if (!symbol.empty()) {
-          ++id;
-          securities_.push_back({id, symbol});
-          std::cerr << "[FakeHandler] Loaded security: " << id << " -> " << symbol << "\n";
-        }
+      if (securities_.size() <= kVerboseSecurities) {
+        for (const auto& sec : securities_)
+          std::cerr << "[FakeHandler] Loaded security: " << sec.securityId << " -> " << sec.symbol << "\n";
       }
-
       std::cerr << "[FakeHandler] Total securities loaded: " << securities_.size() << "\n";
       return !securities_.empty();
     }
 
+    const std::vector<Security>& securities() const noexcept { return securities_; }
+
     // Register listeners (mimics OnixS API)
     void registerMessageListener(::OnixS::B3::MarketData::UMDF::MessageListener* listener) {
       if (listener) messageListeners_.push_back(listener);
@@ -121,8 +116,9 @@ namespace b3::md::testsupport {
 
       for (const auto& sec : securities_) {
         pairs.emplace_back(sec.securityId, sec.symbol);
-        std::cerr << "[FakeHandler] Registering: " << sec.securityId
-                  << " -> " << sec.symbol << "\n";
+        if (securities_.size() <= kVerboseSecurities)
+          std::cerr << "[FakeHandler] Registering: " << sec.securityId
+                    << " -> " << sec.symbol << "\n";
       }
 
       // Bulk upsert
@@ -148,7 +144,7 @@ namespace b3::md::testsupport {
       b3::md::OrdersSnapshot snapshot{};
       snapshot.instrumentId = it->securityId;
       snapshot.exchangeTsNs = nowNs();
-      snapshot.rptSeq = 0;  // Not used in simulator
+      snapshot.rptSeq = ++it->rptSeq;  // secuencia por instrumento (test-client detecta gaps)
       snapshot.channelSeq = 0;  // Not used in simulator
 
       // Generate random bid/ask levels
@@ -214,6 +210,93 @@ namespace b3::md::testsupport {
     }
 
    private:
+    // Dumps reales tienen miles de instrumentos: el detalle por instrumento solo para listas chicas
+    static constexpr size_t kVerboseSecurities = 20;
+
+    static std::string trimField(std::string v) {
+      const auto b = v.find_first_not_of(" \t\r\"");
+      const auto e = v.find_last_not_of(" \t\r\"");
+      return b == std::string::npos ? std::string() : v.substr(b, e - b + 1);
+    }
+
+    static std::string lower(std::string v) {
+      for (auto& c : v) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+      return v;
+    }
+
+    static std::vector<std::string> splitFields(const std::string& line, char delim) {
+      std::vector<std::string> out;
+      std::string cur;
+      std::istringstream in(line);
+      while (std::getline(in, cur, delim)) out.push_back(trimField(cur));
+      return out;
+    }
+
+    void loadJsonLines(std::istream& file) {
+      // Parser mínimo: busca "symbol": "XXX" y "securityId": N en la misma línea
+      std::string line;
+      uint64_t seq = 0;
+      while (std::getline(file, line)) {
+        auto symPos = line.find("\"symbol\"");
+        if (symPos == std::string::npos) continue;
+
+        auto colonPos = line.find(':', symPos);
+        if (colonPos == std::string::npos) continue;
+
+        auto quote1 = line.find('"', colonPos);
+        if (quote1 == std::string::npos) continue;
+
+        auto quote2 = line.find('"', quote1 + 1);
+        if (quote2 == std::string::npos) continue;
+
+        std::string symbol = line.substr(quote1 + 1, quote2 - quote1 - 1);
+        if (symbol.empty()) continue;
+
+        ++seq;
+        uint64_t id = seq;
+        const auto idPos = line.find("\"securityId\"");
+        if (idPos != std::string::npos) {
+          const auto digits = line.find_first_of("0123456789", line.find(':', idPos));
+          if (digits != std::string::npos) id = std::strtoull(line.c_str() + digits, nullptr, 10);
+        }
+        securities_.push_back({id, symbol});
+      }
+    }
+
+    void loadDelimited(std::istream& file) {
+      std::string header;
+      while (std::getline(file, header) && trimField(header).empty()) {
+      }
+
+      const char delim = header.find(';') != std::string::npos    ? ';'
+                         : header.find('\t') != std::string::npos ? '\t'
+                                                                   : ',';
+      const auto cols = splitFields(header, delim);
+      int idCol = -1;
+      int symCol = -1;
+      for (size_t i = 0; i < cols.size(); ++i) {
+        const auto c = lower(cols[i]);
+        if (idCol < 0 && (c == "securityid" || c == "sctyid" || c == "instrumentid"))
+          idCol = static_cast<int>(i);
+        if (symCol < 0 && (c == "symbol" || c == "tckrsymb"))
+          symCol = static_cast<int>(i);
+      }
+      if (idCol < 0 || symCol < 0) {
+        std::cerr << "[FakeHandler] ERROR: header needs securityId and symbol columns: " << header << "\n";
+        return;
+      }
+
+      std::string line;
+      while (std::getline(file, line)) {
+        const auto f = splitFields(line, delim);
+        if (f.size() <= static_cast<size_t>(std::max(idCol, symCol))) continue;
+        const std::string& sym = f[static_cast<size_t>(symCol)];
+        const uint64_t id = std::strtoull(f[static_cast<size_t>(idCol)].c_str(), nullptr, 10);
+        if (sym.empty() || id == 0) continue;
+        securities_.push_back({id, sym});
+      }
+    }
+
     static uint64_t nowNs() {
       const auto now = std::chrono::system_clock::now().time_since_epoch();
       return static_cast<uint64_t>(
@@ -0,0 +1,313 @@
+#pragma once
+
+#include "../core/OrdersSnapshot.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace b3::md::testsupport {
+
+  // Ventana del perfil con la tasa multiplicada (p.ej. subasta de apertura).
+  struct BurstPhase {
+    double startSec{0};
+    double durationSec{0};
+    double multiplier{1};
+  };
+
+  struct LoadProfile {
+    double updatesPerSec{100'000}; // total (todos los productores), sin bursts
+    uint32_t producers{1};         // threads productores (= lanes de ingreso del pipeline)
+    double zipfExponent{1.1};      // actividad del instrumento de rank r ∝ 1 / r^s
+
+    // Forma del libro: los instrumentos más activos son los más profundos
+    uint32_t minLevels{3};
+    uint32_t maxLevels{40};
+    uint32_t minOrdersPerLevel{1};
+    uint32_t maxOrdersPerLevel{12};
+
+    std::vector<BurstPhase> phases;
+
+    // Spikes de noticias: cada newsEverySec, newsDurationSec a newsMultiplier con la mitad
+    // del tráfico concentrado en un instrumento. 0 = sin noticias.
+    double newsEverySec{0};
+    double newsDurationSec{0.5};
+    double newsMultiplier{8};
+
+    uint64_t seed{42};
+
+    // steady | opening | news | session (opening + news). false si el nombre no existe.
+    bool applyPreset(std::string_view name) {
+      phases.clear();
+      newsEverySec = 0;
+      if (name == "steady")
+        return true;
+      if (name == "opening" || name == "session") {
+        // Uncross de la subasta + primeros minutos de continuo comprimidos en segundos
+        phases.push_back({0.0, 2.0, 10.0});
+        phases.push_back({2.0, 8.0, 3.0});
+      }
+      if (name == "news" || name == "session")
+        newsEverySec = 15.0;
+      return name == "opening" || name == "news" || name == "session";
+    }
+
+    double multiplierAt(double elapsedSec) const noexcept {
+      double m = 1.0;
+      for (const auto &p : phases)
+        if (elapsedSec >= p.startSec && elapsedSec < p.startSec + p.durationSec)
+          m = std::max(m, p.multiplier);
+      if (inNews(elapsedSec))
+        m = std::max(m, newsMultiplier);
+      return m;
+    }
+
+    bool inNews(double elapsedSec) const noexcept {
+      if (newsEverySec <= 0 || elapsedSec < newsEverySec)
+        return false;
+      return std::fmod(elapsedSec, newsEverySec) < newsDurationSec;
+    }
+
+    uint64_t newsIndex(double elapsedSec) const noexcept {
+      return newsEverySec > 0 ? static_cast<uint64_t>(elapsedSec / newsEverySec) : 0;
+    }
+  };
+
+  /**
+   * SyntheticLoadGenerator - carga sintética de alta tasa para el simulador
+   *
+   * - N threads productores; cada uno es dueño de un subconjunto disjunto de instrumentos
+   *   (como los feed threads de OnixS por canal) y llama a onThreadStart() antes de emitir
+   *   (ahí se bindea la lane de ingreso del pipeline).
+   * - Instrumento elegido con Zipf sobre un rank barajado (la actividad no sigue el orden del dump).
+   * - Libro MBO con profundidad / órdenes por nivel según el rank, mid con random walk.
+   * - Pacing en slices de 1ms; si el productor no llega, cuenta behindSlices (el cuello de
+   *   botella es el generador, no el pipeline).
+   */
+  class SyntheticLoadGenerator final {
+   public:
+    using Emit = std::function<void(const OrdersSnapshot &)>;
+    using ThreadStart = std::function<void(uint32_t producer)>;
+
+    SyntheticLoadGenerator(LoadProfile profile, std::vector<uint64_t> instrumentIds)
+        : profile_(std::move(profile)) {
+      if (instrumentIds.empty())
+        throw std::invalid_argument("SyntheticLoadGenerator: no instruments");
+      if (profile_.producers == 0)
+        throw std::invalid_argument("SyntheticLoadGenerator: producers == 0");
+      profile_.maxLevels = std::max(profile_.maxLevels, profile_.minLevels);
+      profile_.maxOrdersPerLevel = std::max(profile_.maxOrdersPerLevel, profile_.minOrdersPerLevel);
+
+      // Rank de actividad barajado (determinístico por seed)
+      uint64_t rng = profile_.seed | 1;
+      for (size_t i = instrumentIds.size(); i > 1; --i)
+        std::swap(instrumentIds[i - 1], instrumentIds[next(rng) % i]);
+
+      producers_.resize(profile_.producers);
+      const double n = static_cast<double>(instrumentIds.size());
+      for (size_t rank = 0; rank < instrumentIds.size(); ++rank) {
+        auto &p = producers_[rank % profile_.producers];
+        const double hot = 1.0 - static_cast<double>(rank) / n; // 1 = más activo
+
+        Instrument inst;
+        inst.id = instrumentIds[rank];
+        inst.mid = 100'000 + static_cast<int64_t>(next(rng) % 900) * 1'000; // R$10..R$100
+        inst.levels = static_cast<uint16_t>(
+            profile_.minLevels +
+            std::lround(hot * (profile_.maxLevels - profile_.minLevels)));
+        inst.ordersPerLevel = static_cast<uint16_t>(
+            profile_.minOrdersPerLevel +
+            std::lround(hot * (profile_.maxOrdersPerLevel - profile_.minOrdersPerLevel)));
+
+        p.cumWeight.push_back((p.cumWeight.empty() ? 0.0 : p.cumWeight.back()) +
+                              1.0 / std::pow(static_cast<double>(rank + 1), profile_.zipfExponent));
+        p.instruments.push_back(inst);
+      }
+    }
+
+    ~SyntheticLoadGenerator() { stop(); }
+
+    SyntheticLoadGenerator(const SyntheticLoadGenerator &) = delete;
+    SyntheticLoadGenerator &operator=(const SyntheticLoadGenerator &) = delete;
+
+    void start(Emit emit, ThreadStart onThreadStart = {}) {
+      bool expected = false;
+      if (!running_.compare_exchange_strong(expected, true))
+        return;
+      emit_ = std::move(emit);
+      onThreadStart_ = std::move(onThreadStart);
+      t0_ = std::chrono::steady_clock::now();
+      threads_.reserve(producers_.size());
+      for (uint32_t i = 0; i < producers_.size(); ++i)
+        threads_.emplace_back([this, i] { run(i); });
+    }
+
+    void stop() {
+      running_.store(false, std::memory_order_release);
+      for (auto &t : threads_)
+        if (t.joinable())
+          t.join();
+      threads_.clear();
+    }
+
+    uint64_t generated() const noexcept {
+      uint64_t n = 0;
+      for (const auto &p : producers_) n += p.generated.load(std::memory_order_relaxed);
+      return n;
+    }
+
+    uint64_t behindSlices() const noexcept {
+      uint64_t n = 0;
+      for (const auto &p : producers_) n += p.behindSlices.load(std::memory_order_relaxed);
+      return n;
+    }
+
+    double elapsedSec() const noexcept {
+      return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0_).count();
+    }
+
+    const LoadProfile &profile() const noexcept { return profile_; }
+
+   private:
+    static constexpr int64_t kTick = 100; // R$0,01 en mantissa de 4 decimales
+
+    struct Instrument {
+      uint64_t id{0};
+      int64_t mid{0};
+      uint16_t levels{0};
+      uint16_t ordersPerLevel{0};
+      uint64_t rptSeq{0};
+    };
+
+    struct Producer {
+      std::vector<Instrument> instruments;
+      std::vector<double> cumWeight; // CDF Zipf (no normalizada) sobre instruments
+      std::atomic<uint64_t> generated{0};
+      std::atomic<uint64_t> behindSlices{0};
+
+      Producer() = default;
+      Producer(Producer &&o) noexcept
+          : instruments(std::move(o.instruments)), cumWeight(std::move(o.cumWeight)) {}
+    };
+
+    // xorshift64*: barato y suficiente para carga sintética
+    static uint64_t next(uint64_t &s) noexcept {
+      s ^= s >> 12;
+      s ^= s << 25;
+      s ^= s >> 27;
+      return s * 2685821657736338717ull;
+    }
+
+    size_t pick(const Producer &p, uint64_t &rng, double elapsedSec) const noexcept {
+      // Durante una noticia, la mitad del tráfico va al instrumento "de la noticia"
+      if (profile_.inNews(elapsedSec) && (next(rng) & 1))
+        return static_cast<size_t>(profile_.newsIndex(elapsedSec) * 7919 % p.instruments.size());
+      const double u = static_cast<double>(next(rng) >> 11) * 0x1.0p-53 * p.cumWeight.back();
+      const auto it = std::upper_bound(p.cumWeight.begin(), p.cumWeight.end(), u);
+      return std::min(static_cast<size_t>(it - p.cumWeight.begin()), p.instruments.size() - 1);
+    }
+
+    static void fill(Instrument &inst, uint64_t &rng, uint64_t nowNs, OrdersSnapshot &out) noexcept {
+      // Random walk del mid (±1 tick, 1 de cada 8 updates)
+      const uint64_t r = next(rng);
+      if ((r & 7) == 0)
+        inst.mid += (r & 8) ? kTick : -kTick;
+      if (inst.mid < 10 * kTick)
+        inst.mid = 10 * kTick;
+
+      out.instrumentId = inst.id;
+      out.exchangeTsNs = nowNs;
+      out.rptSeq = ++inst.rptSeq;
+      out.channelSeq = inst.rptSeq;
+
+      auto side = [&](OrdersSnapshot::OrderEntry *orders, uint16_t &copied, uint16_t &raw,
+                      uint8_t &truncated, int64_t dir) noexcept {
+        uint32_t n = 0;
+        uint32_t total = 0;
+        for (uint32_t l = 0; l < inst.levels; ++l) {
+          // ±50% de órdenes por nivel alrededor del típico del instrumento
+          const uint32_t opl = 1 + static_cast<uint32_t>(next(rng) % (inst.ordersPerLevel * 3 / 2 + 1));
+          total += opl;
+          const int64_t px = inst.mid + dir * static_cast<int64_t>(l + 1) * kTick;
+          for (uint32_t o = 0; o < opl && n < OrdersSnapshot::K; ++o, ++n) {
+            orders[n].priceMantissa = px;
+            orders[n].qty = static_cast<int64_t>(100 * (1 + next(rng) % 50)); // lotes de 100
+          }
+        }
+        copied = static_cast<uint16_t>(n);
+        raw = static_cast<uint16_t>(std::min<uint32_t>(total, 0xFFFFu));
+        truncated = total > n ? 1 : 0;
+      };
+      side(out.bids, out.bidsCopied, out.bidCountRaw, out.bidTruncated, -1);
+      side(out.asks, out.asksCopied, out.askCountRaw, out.askTruncated, +1);
+    }
+
+    void run(uint32_t idx) noexcept {
+      using clock = std::chrono::steady_clock;
+      constexpr auto kSlice = std::chrono::milliseconds(1);
+
+      if (onThreadStart_)
+        onThreadStart_(idx);
+
+      Producer &p = producers_[idx];
+      if (p.instruments.empty())
+        return; // más productores que instrumentos
+      uint64_t rng = (profile_.seed + 0x9E3779B97F4A7C15ull * (idx + 1)) | 1;
+      const double perSlice = profile_.updatesPerSec / profile_.producers / 1000.0;
+
+      // Reusado: solo se pisa el prefijo copiado (el resto queda del update anterior, el
+      // builder real tampoco lo limpia fuera de la ventana copiada)
+      auto snapshot = std::make_unique<OrdersSnapshot>();
+
+      double credit = 0;
+      auto deadline = t0_;
+      while (running_.load(std::memory_order_acquire)) {
+        deadline += kSlice;
+        const double elapsed = std::chrono::duration<double>(deadline - t0_).count();
+        credit += perSlice * profile_.multiplierAt(elapsed);
+
+        const auto n = static_cast<uint64_t>(credit);
+        credit -= static_cast<double>(n);
+
+        const uint64_t nowNs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch())
+                .count());
+        for (uint64_t i = 0; i < n; ++i) {
+          Instrument &inst = p.instruments[pick(p, rng, elapsed)];
+          fill(inst, rng, nowNs, *snapshot);
+          emit_(*snapshot);
+        }
+        p.generated.fetch_add(n, std::memory_order_relaxed);
+
+        const auto now = clock::now();
+        if (now < deadline) {
+          std::this_thread::sleep_until(deadline);
+        } else if (now - deadline > 10 * kSlice) {
+          // Atrasado: no acumular deuda infinita, se pierde la tasa objetivo y se cuenta
+          p.behindSlices.fetch_add(1, std::memory_order_relaxed);
+          deadline = now;
+        }
+      }
+    }
+
+    LoadProfile profile_;
+    std::vector<Producer> producers_;
+
+    Emit emit_;
+    ThreadStart onThreadStart_;
+    std::chrono::steady_clock::time_point t0_{};
+    std::atomic<bool> running_{false};
+    std::vector<std::thread> threads_;
+  };
+
+} // namespace b3::md::testsupport
@@ -1,27 +1,54 @@
 // b3-md-connector/src/testsupport/test_client_main.cpp
 //
-// Simple test client for B3 Market Data Connector Simulator
+// Test client / herramienta de medición para el B3 Market Data Connector (y el simulador)
 //
 // This client:
-// 1. Subscribes to market data for specified symbols
-// 2. Listens for MarketDataUpdate messages
-// 3. Prints received data
+// 1. Subscribes to market data for the given symbols (args y/o --symbols-file)
+// 2. Decodes every MarketDataUpdate
+// 3. Measures end-to-end latency from the embedded timestamps:
+//      serialize -> client : now - Book.sending_time_str  (serialización en el connector, no el send)
+//      source    -> client : now - Book.transact_time_str (recepción OnixS / generación en el simulador)
+//    (requiere md.publish.embed_timestamps=1 en el connector; el simulador siempre los embebe)
+// 4. Detects sequence gaps per symbol (Book.sequence_number = RptSeq del libro; requiere
+//    md.publish.sequence_number=1 en el connector, el simulador siempre lo manda)
+// 5. Reports throughput + latency percentiles every second, and a final summary
+//
+// Fan-out: --clients N lanza N procesos cliente (fork, antes de tocar ZMQ) y agrega sus
+// resultados; comparar N=1 vs N=8 da el costo del fan-out del PUB socket.
 //
 // Usage:
 //   ./test_client PETR4 VALE3 ITUB4
+//   ./test_client --symbols-file securities.csv --duration 30 --clients 4
+//   ./test_client --print PETR4            (imprime cada update, modo legacy)
+//   ./test_client --shm /b3md PETR4 VALE3  (books por el ring en /dev/shm, pub.shm.name)
 
 #include <clients/PublisherSubscriber.h>
 #include <sockets/Subscriber.h>
 #include <models/messages.pb.h>
 
+#include "../publishing/ShmRingReader.hpp"
+#include "../telemetry/LatencyHistogram.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
 #include <atomic>
+#include <charconv>
 #include <chrono>
 #include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace {
@@ -31,196 +58,560 @@ namespace {
     std::cerr << "\n[client] Caught signal " << signal << ", shutting down...\n";
     g_running.store(false, std::memory_order_release);
   }
-}
 
-int main(int argc, char** argv) {
-  if (argc < 2) {
-    std::cerr << "Usage: " << argv[0] << " SYMBOL1 [SYMBOL2 ...]\n";
-    std::cerr << "Example: " << argv[0] << " PETR4 VALE3 ITUB4\n";
-    return 1;
+  using b3::md::telemetry::LatencyHistogram;
+
+  struct ClientOptions {
+    std::vector<std::string> symbols;
+    std::string host{"localhost"};
+    uint32_t durationSec{0}; // 0 = hasta Ctrl+C
+    uint32_t clients{1};
+    std::string clientId{"test-client"};
+    bool print{false};
+    std::string shmName; // vacío = books por ZMQ (:8081)
+  };
+
+  void usage(const char *argv0) {
+    std::cerr << "Usage: " << argv0 << " [options] SYMBOL1 [SYMBOL2 ...]\n"
+              << "  --symbols-file F  un símbolo por línea, CSV/TSV con header 'symbol'/'TckrSymb',\n"
+              << "                    o JSON lines con \"symbol\"\n"
+              << "  --host H          host del connector/simulador (default localhost)\n"
+              << "  --duration S      segundos de medición (default: hasta Ctrl+C)\n"
+              << "  --clients N       N procesos cliente en paralelo (fan-out)\n"
+              << "  --client-id ID    client_id de las suscripciones (default test-client)\n"
+              << "  --print           imprime cada update recibido\n"
+              << "  --shm NAME        books por el ring en memoria compartida (mismo host)\n"
+              << "Example: " << argv0 << " PETR4 VALE3 ITUB4\n";
   }
 
-  std::vector<std::string> symbols;
-  for (int i = 1; i < argc; ++i) {
-    symbols.push_back(argv[i]);
+  std::string jsonString(const std::string &line, const std::string &key) {
+    const auto k = line.find("\"" + key + "\"");
+    if (k == std::string::npos)
+      return {};
+    const auto open = line.find('"', line.find(':', k) + 1);
+    const auto close = open == std::string::npos ? open : line.find('"', open + 1);
+    return close == std::string::npos ? std::string{} : line.substr(open + 1, close - open - 1);
   }
 
-  std::cerr << "╔════════════════════════════════════════════════════════════╗\n";
-  std::cerr << "║  B3 Market Data Test Client (C++)                         ║\n";
-  std::cerr << "╚════════════════════════════════════════════════════════════╝\n";
-  std::cerr << "\n";
-  std::cerr << "Subscribing to symbols: ";
-  for (size_t i = 0; i < symbols.size(); ++i) {
-    std::cerr << symbols[i];
-    if (i < symbols.size() - 1) std::cerr << ", ";
-  }
-  std::cerr << "\n\n";
+  // Mismo formato que acepta el simulador (--securities): así se reusa el archivo
+  bool loadSymbolsFile(const std::string &path, std::vector<std::string> &out) {
+    std::ifstream in(path);
+    if (!in)
+      return false;
+
+    std::string line;
+    int column = -1; // -1: lista simple / JSON
+    char delim = ',';
+    bool first = true;
+    while (std::getline(in, line)) {
+      if (!line.empty() && line.back() == '\r')
+        line.pop_back();
+      if (line.empty() || line[0] == '#')
+        continue;
+
+      if (line[0] == '{') {
+        const std::string s = jsonString(line, "symbol");
+        if (!s.empty())
+          out.push_back(s);
+        continue;
+      }
 
-  // Signal handling
-  std::signal(SIGINT, signalHandler);
-  std::signal(SIGTERM, signalHandler);
+      if (first) {
+        first = false;
+        delim = line.find(';') != std::string::npos    ? ';'
+                : line.find('\t') != std::string::npos ? '\t'
+                                                       : ',';
+        std::stringstream ss(line);
+        std::string cell;
+        for (int i = 0; std::getline(ss, cell, delim); ++i)
+          if (cell == "symbol" || cell == "TckrSymb")
+            column = i;
+        if (column >= 0)
+          continue; // era header
+      }
 
-  // -------------------------
-  // 1. Send subscription request
-  // -------------------------
-  std::cerr << "[client] Connecting to subscription server...\n";
-
-  using markethub::messaging::clients::PublisherSubscriber;
-  using markethub::messaging::WrapperMessage;
-
-  PublisherSubscriber subClient(
-      "test-client",
-      "tcp://localhost:8080",  // Subscription requests
-      "tcp://localhost:8082"   // Subscription responses
-  );
-
-  // Response callback
-  subClient.SetMessageReceivedCallback([](const WrapperMessage& msg) {
-    std::cerr << "[client] Received response: " << msg.message_type() << "\n";
-  });
-
-  subClient.Start();
-  std::this_thread::sleep_for(std::chrono::milliseconds(100));
-
-  // Send subscription request for each symbol
-  for (const auto& symbol : symbols) {
-    WrapperMessage request;
-    request.set_message_type("MarketDataSuscriptionRequest");
-    request.set_client_id("test-client");
-    request.set_message_id(symbol);  // Use symbol as message ID
-
-    auto* subReq = request.mutable_market_data_suscription_request();
-    subReq->mutable_instrument()->set_symbol(symbol);
-    subReq->set_subscription_request_type(
-        ::markethub::messaging::trading::SNAPSHOT_PLUS_UPDATES);
-
-    std::cerr << "[client] Subscribing to: " << symbol << "\n";
-    subClient.SendMessage(std::move(request));
+      if (column < 0) {
+        out.push_back(line);
+        continue;
+      }
+      std::stringstream ss(line);
+      std::string cell;
+      for (int i = 0; std::getline(ss, cell, delim); ++i)
+        if (i == column && !cell.empty())
+          out.push_back(cell);
+    }
+    return true;
   }
 
-  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  bool parseOptions(int argc, char **argv, ClientOptions &opt) {
+    for (int i = 1; i < argc; ++i) {
+      const std::string a = argv[i];
+      auto next = [&]() -> const char * { return i + 1 < argc ? argv[++i] : nullptr; };
 
-  // -------------------------
-  // 2. Listen for market data
-  // -------------------------
-  std::cerr << "\n[client] Connecting to market data stream...\n";
-
-  using markethub::messaging::sockets::Subscriber;
-
-  // isMultipleSubscriber = true (client uses Connect, not Bind)
-  Subscriber dataClient("tcp://localhost:8081", true);
+      if (a == "--symbols-file") {
+        const char *v = next();
+        if (!v || !loadSymbolsFile(v, opt.symbols)) {
+          std::cerr << "[client] cannot read symbols file\n";
+          return false;
+        }
+      } else if (a == "--host") {
+        const char *v = next();
+        if (!v)
+          return false;
+        opt.host = v;
+      } else if (a == "--duration") {
+        const char *v = next();
+        if (!v)
+          return false;
+        opt.durationSec = static_cast<uint32_t>(std::strtoul(v, nullptr, 10));
+      } else if (a == "--clients") {
+        const char *v = next();
+        if (!v)
+          return false;
+        opt.clients = std::max<uint32_t>(1, static_cast<uint32_t>(std::strtoul(v, nullptr, 10)));
+      } else if (a == "--client-id") {
+        const char *v = next();
+        if (!v)
+          return false;
+        opt.clientId = v;
+      } else if (a == "--print") {
+        opt.print = true;
+      } else if (a == "--shm") {
+        const char *v = next();
+        if (!v)
+          return false;
+        opt.shmName = v;
+      } else if (a == "-h" || a == "--help" || (!a.empty() && a[0] == '-')) {
+        return false;
+      } else {
+        opt.symbols.push_back(a);
+      }
+    }
+    return !opt.symbols.empty();
+  }
 
-  std::unordered_map<std::string, uint64_t> messageCount;
-  std::unordered_map<std::string, double> lastPrice;
+  uint64_t nowEpochNs() noexcept {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count());
+  }
 
-  dataClient.SetMessageReceivedCallback([&](const WrapperMessage& msg) {
-    if (msg.has_market_data_update()) {
-      const auto& update = msg.market_data_update();
+  // Epoch-ns en texto (lo que escribe MdSnapshotMapper). 0 si no viene o no parsea.
+  uint64_t parseEpochNs(const std::string &s) noexcept {
+    uint64_t v = 0;
+    const auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+    return (ec == std::errc{} && ptr == s.data() + s.size()) ? v : 0;
+  }
 
-      if (update.has_instrument()) {
-        const std::string symbol = update.instrument().symbol();
+  double us(uint64_t ns) { return static_cast<double>(ns) / 1000.0; }
+
+  // Estado de medición. Todo lo escribe el thread del callback del Subscriber;
+  // el main thread lee contadores/histogramas en caliente (aproximado) y el resto después del Stop.
+  struct Measurement {
+    std::atomic<uint64_t> received{0};
+    std::atomic<uint64_t> gaps{0};       // updates faltantes (suma de saltos de sequence_number)
+    std::atomic<uint64_t> outOfOrder{0}; // sequence_number <= último visto
+    std::atomic<uint64_t> noTimestamp{0};
+
+    LatencyHistogram serializeToClient; // total de la corrida
+    LatencyHistogram sourceToClient;
+    LatencyHistogram intervalSerialize; // reseteado en cada reporte por segundo
+    LatencyHistogram intervalSource;
+
+    struct SymbolStats {
+      uint64_t count{0};
+      uint64_t lastSeq{0};
+      uint64_t gaps{0};
+      double lastMid{0};
+    };
+    std::unordered_map<std::string, SymbolStats> perSymbol;
+
+    void onUpdate(const ::markethub::messaging::trading::Book &update, bool print) {
+      const uint64_t now = nowEpochNs();
+      received.fetch_add(1, std::memory_order_relaxed);
+
+      const uint64_t serialized = parseEpochNs(update.sending_time_str());
+      const uint64_t source = parseEpochNs(update.transact_time_str());
+      if (serialized == 0) {
+        noTimestamp.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        const uint64_t lat = now > serialized ? now - serialized : 0;
+        serializeToClient.record(lat);
+        intervalSerialize.record(lat);
+      }
+      if (source != 0) {
+        const uint64_t lat = now > source ? now - source : 0;
+        sourceToClient.record(lat);
+        intervalSource.record(lat);
+      }
 
-        messageCount[symbol]++;
+      const std::string &symbol = update.instrument().symbol();
+      auto &st = perSymbol[symbol];
+      ++st.count;
+
+      const auto seq = static_cast<uint64_t>(update.sequence_number());
+      if (seq != 0) {
+        if (st.lastSeq != 0) {
+          if (seq <= st.lastSeq) {
+            outOfOrder.fetch_add(1, std::memory_order_relaxed);
+          } else if (seq > st.lastSeq + 1) {
+            st.gaps += seq - st.lastSeq - 1;
+            gaps.fetch_add(seq - st.lastSeq - 1, std::memory_order_relaxed);
+          }
+        }
+        if (seq > st.lastSeq)
+          st.lastSeq = seq;
+      }
 
-        // Extract bid/ask info
-        const int bidCount = update.bid_lines_size();
-        const int askCount = update.offer_lines_size();
+      const int bidCount = update.bid_lines_size();
+      const int askCount = update.offer_lines_size();
+      const double bestBid = bidCount > 0 ? update.bid_lines(0).price() : 0.0;
+      const double bestAsk = askCount > 0 ? update.offer_lines(0).price() : 0.0;
+      st.lastMid = (bestBid + bestAsk) / 2.0;
 
-        double bestBid = 0.0;
-        double bestAsk = 0.0;
+      if (print) {
+        std::cerr << "[" << symbol << "] "
+                  << "Bid=" << std::fixed << std::setprecision(2) << bestBid << " (" << bidCount
+                  << " levels) | "
+                  << "Ask=" << std::fixed << std::setprecision(2) << bestAsk << " (" << askCount
+                  << " levels) | "
+                  << "Seq=" << seq << " Count=" << st.count << "\n";
+      }
+    }
+  };
+
+  // Una línea key=value: la imprime cada cliente y la parsea el padre en modo --clients
+  std::string summaryLine(const Measurement &m, double seconds) {
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(1) << "received=" << m.received.load()
+       << " rate=" << (seconds > 0 ? static_cast<double>(m.received.load()) / seconds : 0.0)
+       << " gaps=" << m.gaps.load() << " out_of_order=" << m.outOfOrder.load()
+       << " no_ts=" << m.noTimestamp.load() << " ser_p50_us=" << us(m.serializeToClient.percentile(0.50))
+       << " ser_p99_us=" << us(m.serializeToClient.percentile(0.99))
+       << " ser_p999_us=" << us(m.serializeToClient.percentile(0.999))
+       << " ser_max_us=" << us(m.serializeToClient.max())
+       << " src_p50_us=" << us(m.sourceToClient.percentile(0.50))
+       << " src_p99_us=" << us(m.sourceToClient.percentile(0.99))
+       << " src_max_us=" << us(m.sourceToClient.max());
+    return os.str();
+  }
 
-        if (bidCount > 0) {
-          bestBid = update.bid_lines(0).price();
-        }
-        if (askCount > 0) {
-          bestAsk = update.offer_lines(0).price();
+  int runClient(const ClientOptions &opt, int resultFd) {
+    const bool quiet = resultFd >= 0; // hijo de --clients: solo reporta al padre
+
+    if (!quiet) {
+      std::cerr << "╔════════════════════════════════════════════════════════════╗\n";
+      std::cerr << "║  B3 Market Data Test Client (C++)                         ║\n";
+      std::cerr << "╚════════════════════════════════════════════════════════════╝\n";
+      std::cerr << "\n";
+      std::cerr << "Subscribing to " << opt.symbols.size() << " symbols";
+      if (opt.symbols.size() <= 20) {
+        std::cerr << ": ";
+        for (size_t i = 0; i < opt.symbols.size(); ++i) {
+          std::cerr << opt.symbols[i];
+          if (i < opt.symbols.size() - 1)
+            std::cerr << ", ";
         }
+      }
+      std::cerr << "\n\n";
+    }
 
-        lastPrice[symbol] = (bestBid + bestAsk) / 2.0;
+    // -------------------------
+    // 1. Send subscription request
+    // -------------------------
+    using markethub::messaging::clients::PublisherSubscriber;
+    using markethub::messaging::WrapperMessage;
+
+    const std::string base = "tcp://" + opt.host;
+    PublisherSubscriber subClient(opt.clientId,
+                                  base + ":8080", // Subscription requests
+                                  base + ":8082"  // Subscription responses
+    );
+
+    std::atomic<uint64_t> responses{0};
+    subClient.SetMessageReceivedCallback([&](const WrapperMessage &msg) {
+      responses.fetch_add(1, std::memory_order_relaxed);
+      if (opt.print)
+        std::cerr << "[client] Received response: " << msg.message_type() << "\n";
+    });
+
+    subClient.Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    for (const auto &symbol : opt.symbols) {
+      WrapperMessage request;
+      request.set_message_type("MarketDataSuscriptionRequest");
+      request.set_client_id(opt.clientId);
+      request.set_message_id(symbol); // Use symbol as message ID
+
+      auto *subReq = request.mutable_market_data_suscription_request();
+      subReq->mutable_instrument()->set_symbol(symbol);
+      subReq->set_subscription_request_type(::markethub::messaging::trading::SNAPSHOT_PLUS_UPDATES);
+
+      subClient.SendMessage(std::move(request));
+    }
 
-        // Print update with fixed decimal format
-        std::cerr << "[" << symbol << "] "
-                  << "Bid=" << std::fixed << std::setprecision(2) << bestBid
-                  << " (" << bidCount << " levels) | "
-                  << "Ask=" << std::fixed << std::setprecision(2) << bestAsk
-                  << " (" << askCount << " levels) | "
-                  << "Count=" << messageCount[symbol] << "\n";
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    // -------------------------
+    // 2. Listen for market data
+    // -------------------------
+    using markethub::messaging::sockets::Subscriber;
+
+    Measurement m;
+    m.perSymbol.reserve(opt.symbols.size() * 2);
+
+    auto onMessage = [&](const WrapperMessage &msg) {
+      if (msg.has_market_data_update() && msg.market_data_update().has_instrument())
+        m.onUpdate(msg.market_data_update(), opt.print);
+    };
+
+    std::unique_ptr<Subscriber> dataClient;
+    b3::md::publishing::ShmRingReader shmReader;
+    std::atomic<bool> shmRunning{false};
+    std::thread shmThread;
+    std::string source = base + ":8081";
+
+    if (opt.shmName.empty()) {
+      // isMultipleSubscriber = true (client uses Connect, not Bind)
+      dataClient = std::make_unique<Subscriber>(base + ":8081", true);
+      dataClient->SetMessageReceivedCallback(onMessage);
+      for (const auto &symbol : opt.symbols) dataClient->Subscribe(symbol);
+      dataClient->Start();
+    } else {
+      // Mismo topic/payload que el PUB: filtramos por símbolo y decodificamos igual
+      if (shmReader.attach(opt.shmName) != b3::md::publishing::ShmRingStatus::Attached) {
+        std::cerr << "[client] cannot attach shm ring " << opt.shmName
+                  << " (pub.shm.name on the connector?)\n";
+        subClient.Stop();
+        return 1;
       }
+      source = "shm:" + opt.shmName;
+      shmRunning.store(true, std::memory_order_release);
+      shmThread = std::thread([&] {
+        const std::unordered_set<std::string_view> wanted(opt.symbols.begin(), opt.symbols.end());
+        WrapperMessage msg;
+        while (shmRunning.load(std::memory_order_acquire)) {
+          const size_t n = shmReader.poll([&](const b3::md::publishing::ShmRingReader::Message &r) {
+            if (wanted.count(r.topic) && msg.ParseFromArray(r.payload, static_cast<int>(r.size)))
+              onMessage(msg);
+          });
+          if (n == 0) {
+            if (shmReader.writerClosed())
+              break;
+            std::this_thread::yield();
+          }
+        }
+      });
     }
-  });
-
-  // Subscribe to all symbols
-  for (const auto& symbol : symbols) {
-    dataClient.Subscribe(symbol);
-    std::cerr << "[client] Subscribed to market data topic: " << symbol << "\n";
-  }
 
-  dataClient.Start();
+    if (!quiet) {
+      std::cerr << "[client] Listening on " << source
+                << (opt.durationSec ? " for " + std::to_string(opt.durationSec) + "s" : "")
+                << " (Ctrl+C to stop)\n\n";
+    }
 
-  std::cerr << "\n";
-  std::cerr << "╔════════════════════════════════════════════════════════════╗\n";
-  std::cerr << "║  LISTENING FOR MARKET DATA                                 ║\n";
-  std::cerr << "╚════════════════════════════════════════════════════════════╝\n";
-  std::cerr << "\n";
-  std::cerr << "Press Ctrl+C to stop...\n";
-  std::cerr << "\n";
+    // -------------------------
+    // Runtime: reporte por segundo
+    // -------------------------
+    const auto startTime = std::chrono::steady_clock::now();
+    uint64_t lastReceived = 0;
+    uint32_t second = 0;
+
+    while (g_running.load(std::memory_order_acquire)) {
+      std::this_thread::sleep_for(std::chrono::seconds(1));
+      ++second;
+
+      const uint64_t received = m.received.load(std::memory_order_relaxed);
+      if (!quiet) {
+        std::cerr << std::fixed << std::setprecision(1) << "[client] t=" << second
+                  << "s msgs/s=" << (received - lastReceived) << " total=" << received
+                  << " gaps=" << m.gaps.load(std::memory_order_relaxed)
+                  << " ser->client p50/p99/max us=" << us(m.intervalSerialize.percentile(0.50)) << "/"
+                  << us(m.intervalSerialize.percentile(0.99)) << "/" << us(m.intervalSerialize.max())
+                  << " src->client p99 us=" << us(m.intervalSource.percentile(0.99)) << "\n";
+      }
+      // Reset desde otro thread: los percentiles por segundo son aproximados
+      m.intervalSerialize.reset();
+      m.intervalSource.reset();
+      lastReceived = received;
 
-  // -------------------------
-  // Runtime
-  // -------------------------
-  const auto startTime = std::chrono::steady_clock::now();
+      if (opt.durationSec && second >= opt.durationSec)
+        break;
+    }
 
-  while (g_running.load(std::memory_order_acquire)) {
-    std::this_thread::sleep_for(std::chrono::seconds(5));
+    // -------------------------
+    // Shutdown
+    // -------------------------
+    if (dataClient)
+      dataClient->Stop();
+    shmRunning.store(false, std::memory_order_release);
+    if (shmThread.joinable())
+      shmThread.join();
+    subClient.Stop();
+
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    if (quiet) {
+      const std::string line = summaryLine(m, seconds) + "\n";
+      const ssize_t w = ::write(resultFd, line.data(), line.size());
+      (void)w;
+      return 0;
+    }
 
-    if (!g_running.load(std::memory_order_acquire)) break;
+    std::cerr << "\n╔════════════════════════════════════════════════════════════╗\n";
+    std::cerr << "║  FINAL STATISTICS                                          ║\n";
+    std::cerr << "╚════════════════════════════════════════════════════════════╝\n";
+    std::cerr << "\n";
 
-    // Print periodic stats
-    uint64_t total = 0;
-    for (const auto& [symbol, count] : messageCount) {
-      total += count;
+    // Ordenado por volumen; con muchos símbolos solo el top
+    std::vector<std::pair<std::string, Measurement::SymbolStats>> rows(m.perSymbol.begin(),
+                                                                       m.perSymbol.end());
+    std::sort(rows.begin(), rows.end(),
+              [](const auto &a, const auto &b) { return a.second.count > b.second.count; });
+    const size_t shown = std::min<size_t>(rows.size(), 20);
+    for (size_t i = 0; i < shown; ++i) {
+      const auto &[symbol, st] = rows[i];
+      std::cerr << "  " << symbol << ": " << st.count << " messages, last seq=" << st.lastSeq
+                << ", gaps=" << st.gaps << " (last mid=" << st.lastMid << ")\n";
     }
+    if (rows.size() > shown)
+      std::cerr << "  ... " << (rows.size() - shown) << " more symbols\n";
 
-    const auto elapsed = std::chrono::steady_clock::now() - startTime;
-    const auto seconds = std::chrono::duration<double>(elapsed).count();
-    const double rate = total / seconds;
+    const uint64_t total = m.received.load();
+    std::cerr << "\n";
+    std::cerr << std::fixed << std::setprecision(1);
+    std::cerr << "  Symbols:  " << m.perSymbol.size() << "/" << opt.symbols.size()
+              << " with data (responses=" << responses.load() << ")\n";
+    std::cerr << "  Total:    " << total << " messages\n";
+    std::cerr << "  Duration: " << seconds << " seconds\n";
+    std::cerr << "  Rate:     " << (seconds > 0 ? static_cast<double>(total) / seconds : 0.0)
+              << " msg/s\n";
+    std::cerr << "  Gaps:     " << m.gaps.load() << " missing seq, " << m.outOfOrder.load()
+              << " out of order\n";
+    if (shmReader.attached())
+      std::cerr << "  Shm:      " << shmReader.received() << " ring messages, "
+                << shmReader.lost() << " lost (overwritten before read)\n";
+    if (m.noTimestamp.load())
+      std::cerr << "  No ts:    " << m.noTimestamp.load()
+                << " updates sin timestamp (md.publish.embed_timestamps=0?)\n";
+    for (const auto &[name, h] : {std::pair<const char *, const LatencyHistogram *>{
+                                      "serialize->client", &m.serializeToClient},
+                                  {"source->client ", &m.sourceToClient}}) {
+      std::cerr << "  " << name << " us: p50=" << us(h->percentile(0.50))
+                << " p90=" << us(h->percentile(0.90)) << " p99=" << us(h->percentile(0.99))
+                << " p99.9=" << us(h->percentile(0.999)) << " max=" << us(h->max())
+                << " mean=" << us(h->mean()) << " (n=" << h->count() << ")\n";
+    }
+    std::cerr << "\n";
+    std::cout << summaryLine(m, seconds) << "\n";
 
-    std::cerr << "\n[client] Stats: total=" << total
-              << " messages, rate=" << rate << " msg/s\n\n";
+    return 0;
   }
 
-  // -------------------------
-  // Shutdown
-  // -------------------------
-  std::cerr << "\n[client] Shutting down...\n";
+  std::map<std::string, double> parseSummary(const std::string &line) {
+    std::map<std::string, double> kv;
+    std::istringstream is(line);
+    std::string tok;
+    while (is >> tok) {
+      const auto eq = tok.find('=');
+      if (eq != std::string::npos)
+        kv[tok.substr(0, eq)] = std::strtod(tok.c_str() + eq + 1, nullptr);
+    }
+    return kv;
+  }
 
-  dataClient.Stop();
-  subClient.Stop();
+  // --clients N: fork de N clientes (cada uno con su contexto ZMQ) y agregado de resultados
+  int runFanOut(const ClientOptions &opt) {
+    if (opt.durationSec == 0)
+      std::cerr << "[fanout] sin --duration: Ctrl+C termina a todos los clientes\n";
+
+    struct Child {
+      pid_t pid;
+      int fd;
+    };
+    std::vector<Child> children;
+
+    for (uint32_t c = 0; c < opt.clients; ++c) {
+      int fds[2];
+      if (::pipe(fds) != 0) {
+        std::perror("pipe");
+        break;
+      }
+      const pid_t pid = ::fork();
+      if (pid < 0) {
+        std::perror("fork");
+        ::close(fds[0]);
+        ::close(fds[1]);
+        break;
+      }
+      if (pid == 0) {
+        ::close(fds[0]);
+        ClientOptions childOpt = opt;
+        childOpt.clientId = opt.clientId + "-" + std::to_string(c);
+        const int rc = runClient(childOpt, fds[1]);
+        ::close(fds[1]);
+        std::_Exit(rc);
+      }
+      ::close(fds[1]);
+      children.push_back({pid, fds[0]});
+    }
 
-  std::cerr << "\n╔════════════════════════════════════════════════════════════╗\n";
-  std::cerr << "║  FINAL STATISTICS                                          ║\n";
-  std::cerr << "╚════════════════════════════════════════════════════════════╝\n";
-  std::cerr << "\n";
+    std::cerr << "[fanout] " << children.size() << " clients x " << opt.symbols.size()
+              << " symbols\n";
+
+    std::vector<std::map<std::string, double>> results;
+    for (size_t i = 0; i < children.size(); ++i) {
+      std::string out;
+      char buf[512];
+      ssize_t n;
+      while ((n = ::read(children[i].fd, buf, sizeof(buf))) > 0) out.append(buf, static_cast<size_t>(n));
+      ::close(children[i].fd);
+      int status = 0;
+      ::waitpid(children[i].pid, &status, 0);
+
+      while (!out.empty() && out.back() == '\n') out.pop_back();
+      std::cerr << "[fanout] client " << i << ": " << (out.empty() ? "<no result>" : out) << "\n";
+      if (!out.empty())
+        results.push_back(parseSummary(out));
+    }
 
-  uint64_t total = 0;
-  for (const auto& [symbol, count] : messageCount) {
-    std::cerr << "  " << symbol << ": " << count << " messages";
-    if (lastPrice.find(symbol) != lastPrice.end()) {
-      std::cerr << " (last mid=" << lastPrice[symbol] << ")";
+    if (results.empty())
+      return 1;
+
+    // Throughput y gaps suman; latencias: peor cliente (el fan-out castiga al último en recibir)
+    std::map<std::string, double> agg;
+    for (const auto &r : results) {
+      for (const auto &[k, v] : r) {
+        if (k.find("_us") != std::string::npos)
+          agg[k] = std::max(agg[k], v);
+        else
+          agg[k] += v;
+      }
     }
-    std::cerr << "\n";
-    total += count;
+    std::cout << std::fixed << std::setprecision(1) << "[fanout] clients=" << results.size()
+              << " total_rate=" << agg["rate"] << " per_client_rate="
+              << agg["rate"] / static_cast<double>(results.size()) << " gaps=" << agg["gaps"]
+              << " worst ser_p50_us=" << agg["ser_p50_us"] << " ser_p99_us=" << agg["ser_p99_us"]
+              << " ser_p999_us=" << agg["ser_p999_us"] << " ser_max_us=" << agg["ser_max_us"]
+              << "\n";
+    return results.size() == children.size() ? 0 : 1;
   }
+} // namespace
 
-  const auto elapsed = std::chrono::steady_clock::now() - startTime;
-  const auto seconds = std::chrono::duration<double>(elapsed).count();
-  const double rate = total / seconds;
+int main(int argc, char **argv) {
+  ClientOptions opt;
+  if (!parseOptions(argc, argv, opt)) {
+    usage(argv[0]);
+    return 1;
+  }
 
-  std::cerr << "\n";
-  std::cerr << "  Total:    " << total << " messages\n";
-  std::cerr << "  Duration: " << seconds << " seconds\n";
-  std::cerr << "  Rate:     " << rate << " msg/s\n";
-  std::cerr << "\n";
+  // Signal handling (los hijos de --clients lo heredan: Ctrl+C corta a todos)
+  std::signal(SIGINT, signalHandler);
+  std::signal(SIGTERM, signalHandler);
 
-  return 0;
+  if (opt.clients > 1)
+    return runFanOut(opt);
+  return runClient(opt, -1);
 }
@@ -0,0 +1,71 @@
+#pragma once
+#include <OnixS/B3/MarketData/UMDF/OrderBook.h>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace b3::md::test {
+
+  // Libro MBO fake con la superficie que usa OnixsOrdersSnapshotBuilder (el OrderBook de OnixS
+  // no se puede construir fuera del Handler). Mismo orden que el SDK: bids ascendentes (mejor al
+  // final), asks ascendentes (mejor al principio).
+  class FakeMboOrderBook final {
+   public:
+    using Order = OnixS::B3::MarketData::UMDF::Order;
+    using Price = OnixS::B3::MarketData::UMDF::Price;
+
+    void setInstrumentId(uint64_t v) { instrumentId_ = v; }
+    void setLastRptSeq(uint32_t v) { rptSeq_ = v; }
+    void setLastMessageSeqNumApplied(uint32_t v) { seqNum_ = v; }
+
+    // Precio null = market order
+    static Price marketPrice() noexcept {
+      return OnixS::B3::MarketData::UMDF::Messaging::NullPriceOptional();
+    }
+
+    void clear() {
+      bids_.clear();
+      asks_.clear();
+      nextOrderId_ = 1;
+    }
+
+    // levels niveles × ordersPerLevel órdenes por lado, alrededor de midMantissa (tick = 1).
+    // marketOrders: órdenes sin precio agregadas en el extremo de cada lado (el builder las saltea).
+    void fill(uint32_t levels, uint32_t ordersPerLevel, int64_t midMantissa = 100'000,
+              uint32_t marketOrders = 0) {
+      clear();
+      bids_.reserve(levels * ordersPerLevel + marketOrders);
+      asks_.reserve(levels * ordersPerLevel + marketOrders);
+
+      for (uint32_t l = levels; l > 0; --l)
+        for (uint32_t o = 0; o < ordersPerLevel; ++o) addBid(midMantissa - l, 100 + o);
+      for (uint32_t m = 0; m < marketOrders; ++m) addBid(marketPrice(), 100);
+
+      for (uint32_t m = 0; m < marketOrders; ++m) addAsk(marketPrice(), 100);
+      for (uint32_t l = 1; l <= levels; ++l)
+        for (uint32_t o = 0; o < ordersPerLevel; ++o) addAsk(midMantissa + l, 100 + o);
+    }
+
+    void addBid(int64_t mantissa, int64_t qty) { addBid(Price(mantissa), qty); }
+    void addAsk(int64_t mantissa, int64_t qty) { addAsk(Price(mantissa), qty); }
+    void addBid(Price px, int64_t qty) { bids_.emplace_back(nextOrderId_++, px, qty); }
+    void addAsk(Price px, int64_t qty) { asks_.emplace_back(nextOrderId_++, px, qty); }
+
+    uint64_t instrumentId() const noexcept { return instrumentId_; }
+    uint32_t lastRptSeq() const noexcept { return rptSeq_; }
+    uint32_t lastMessageSeqNumApplied() const noexcept { return seqNum_; }
+
+    std::span<const Order> bids() const noexcept { return bids_; }
+    std::span<const Order> asks() const noexcept { return asks_; }
+
+   private:
+    uint64_t instrumentId_{0};
+    uint32_t rptSeq_{0};
+    uint32_t seqNum_{0};
+    uint64_t nextOrderId_{1};
+    std::vector<Order> bids_;
+    std::vector<Order> asks_;
+  };
+
+} // namespace b3::md::test
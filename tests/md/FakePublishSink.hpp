@@ -2,6 +2,7 @@
 
 #include "../../b3-md-connector/src/publishing/IPublishSink.hpp"
 #include "../../b3-md-connector/src/publishing/SerializedEnvelope.hpp"
+#include "../../b3-md-connector/src/publishing/CompactEnvelope.hpp"
 
 #include <mutex>
 #include <string>
@@ -14,6 +15,8 @@ namespace b3::md::testsupport {
     uint32_t shardId{0};
     std::string topic;
     std::string bytes;
+    bool priority{false}; // vino por tryPublishPriority (shardId = channel)
+    uint8_t flags{0};      // SerializedEnvelope::flags
   };
 
   class FakePublishSink final : public b3::md::publishing::IPublishSink {
@@ -26,6 +29,19 @@ namespace b3::md::testsupport {
       c.shardId = shardId;
       c.topic.assign(ev.topic, ev.topic + ev.topicLen);
       c.bytes.assign(reinterpret_cast<const char *>(ev.bytes), ev.size);
+      c.flags = ev.flags;
+      msgs_.push_back(std::move(c));
+      return true;
+    }
+
+    bool tryPublishPriority(uint32_t channel,
+                            const b3::md::publishing::CompactEnvelope &ev) noexcept override {
+      std::lock_guard<std::mutex> g(m_);
+      CapturedPublish c;
+      c.shardId = channel;
+      c.topic.assign(ev.topic, ev.topic + ev.topicLen);
+      c.bytes.assign(reinterpret_cast<const char *>(ev.bytes), ev.size);
+      c.priority = true;
       msgs_.push_back(std::move(c));
       return true;
     }
@@ -35,6 +51,11 @@ namespace b3::md::testsupport {
       return msgs_.size();
     }
 
+    void clear() {
+      std::lock_guard<std::mutex> g(m_);
+      msgs_.clear();
+    }
+
     CapturedPublish at(size_t i) const {
       std::lock_guard<std::mutex> g(m_);
       return msgs_.at(i);
@@ -0,0 +1,279 @@
+// b3_md_bench: micro-benchmarks del hot path de MD (Google Benchmark).
+//
+// Comparar antes/después de un cambio:
+//   ./b3_md_bench --benchmark_out=before.json --benchmark_out_format=json
+//   ./b3_md_bench --benchmark_out=after.json  --benchmark_out_format=json
+//   compare.py benchmarks before.json after.json   (tools/ de google/benchmark)
+//
+// Filtrar: --benchmark_filter=Builder  |  repeticiones: --benchmark_repetitions=10
+
+#include <benchmark/benchmark.h>
+
+#include "../../b3-md-connector/src/core/BookSnapshot.hpp"
+#include "../../b3-md-connector/src/core/MboToMbpAggregator.hpp"
+#include "../../b3-md-connector/src/core/MdPublishPipeline.hpp"
+#include "../../b3-md-connector/src/core/MdPublishWorker.hpp"
+#include "../../b3-md-connector/src/core/OrdersSnapshot.hpp"
+#include "../../b3-md-connector/src/core/SnapshotQueueSpsc.hpp"
+#include "../../b3-md-connector/src/mapping/InstrumentTopicMapper.hpp"
+#include "../../b3-md-connector/src/mapping/MdSnapshotMapper.hpp"
+#include "../../b3-md-connector/src/onixs/OnixsOrdersSnapshotBuilder.hpp"
+#include "../../b3-md-connector/src/publishing/SerializedEnvelope.hpp"
+#include "FakeMboOrderBook.hpp"
+#include "FakePublishSink.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace b3::md;
+
+namespace {
+
+  // Profundidad (niveles por lado) × órdenes por nivel: de un libro fino a uno que satura K=256
+  void BookShapes(benchmark::internal::Benchmark *b) {
+    b->ArgNames({"levels", "orders_per_level"});
+    for (int levels : {5, 20, 64})
+      for (int opl : {1, 4, 16}) b->Args({levels, opl});
+  }
+
+  OrdersSnapshot BuildSnapshot(uint32_t levels, uint32_t ordersPerLevel, uint64_t iid = 1) {
+    test::FakeMboOrderBook book;
+    book.setInstrumentId(iid);
+    book.fill(levels, ordersPerLevel);
+    OrdersSnapshot s{};
+    onixs::OnixsOrdersSnapshotBuilder::buildFromBook(book, 1, s);
+    return s;
+  }
+
+  // Registry compartido por todos los benchmarks de topics/pipeline: "SYM<iid>" para 1..N
+  constexpr uint64_t kInstruments = 1024;
+
+  b3::common::InstrumentRegistry &SharedRegistry() {
+    static b3::common::InstrumentRegistry registry;
+    static const bool loaded = [] {
+      for (uint64_t iid = 1; iid <= kInstruments; ++iid) registry.upsert(iid, "SYM" + std::to_string(iid));
+      return true;
+    }();
+    (void)loaded;
+    return registry;
+  }
+
+} // namespace
+
+// ============================================================================
+// SnapshotQueueSpsc
+// ============================================================================
+
+// Costo de push+pop sin contención (mismo thread), en ráfagas de `burst`
+static void BM_SpscPushPopSameThread(benchmark::State &state) {
+  const auto burst = static_cast<uint32_t>(state.range(0));
+  SnapshotQueueSpsc<OrdersSnapshot, 4096> q;
+  OrdersSnapshot in{};
+  OrdersSnapshot out{};
+
+  for (auto _ : state) {
+    for (uint32_t i = 0; i < burst; ++i) {
+      in.exchangeTsNs = i;
+      q.try_push(in);
+    }
+    for (uint32_t i = 0; i < burst; ++i) q.try_pop(out);
+    benchmark::DoNotOptimize(out.exchangeTsNs);
+  }
+  state.SetItemsProcessed(state.iterations() * burst);
+  state.SetBytesProcessed(state.iterations() * burst * sizeof(OrdersSnapshot));
+}
+BENCHMARK(BM_SpscPushPopSameThread)->ArgName("burst")->Arg(1)->Arg(64)->Arg(1024);
+
+// Producer (thread del benchmark) -> consumer dedicado: throughput con las cache lines viajando
+static void BM_SpscProducerConsumer(benchmark::State &state) {
+  const auto capacity = static_cast<size_t>(state.range(0));
+  SnapshotQueueSpsc<OrdersSnapshot, 4096> q(capacity);
+
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> popped{0};
+  std::thread consumer([&] {
+    OrdersSnapshot out{};
+    uint64_t n = 0;
+    while (!stop.load(std::memory_order_acquire)) {
+      while (q.try_pop(out)) ++n;
+    }
+    while (q.try_pop(out)) ++n;
+    popped.store(n, std::memory_order_release);
+  });
+
+  OrdersSnapshot in{};
+  uint64_t fullSpins = 0;
+  for (auto _ : state) {
+    ++in.exchangeTsNs;
+    while (!q.try_push(in)) ++fullSpins;
+  }
+
+  stop.store(true, std::memory_order_release);
+  consumer.join();
+
+  state.SetItemsProcessed(state.iterations());
+  state.counters["full_spins"] = benchmark::Counter(static_cast<double>(fullSpins));
+  state.counters["popped"] = benchmark::Counter(static_cast<double>(popped.load()));
+}
+BENCHMARK(BM_SpscProducerConsumer)->ArgName("capacity")->Arg(256)->Arg(4096)->UseRealTime();
+
+// ============================================================================
+// OnixsOrdersSnapshotBuilder (libro MBO fake con Order de OnixS)
+// ============================================================================
+
+static void BM_SnapshotBuilder(benchmark::State &state) {
+  test::FakeMboOrderBook book;
+  book.setInstrumentId(1);
+  book.fill(static_cast<uint32_t>(state.range(0)), static_cast<uint32_t>(state.range(1)),
+            100'000, /*marketOrders=*/2);
+
+  OrdersSnapshot out{};
+  uint64_t now = 0;
+  for (auto _ : state) {
+    onixs::OnixsOrdersSnapshotBuilder::buildFromBook(book, ++now, out);
+    benchmark::DoNotOptimize(out.bidsCopied);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["orders_copied"] = benchmark::Counter(out.bidsCopied + out.asksCopied);
+}
+BENCHMARK(BM_SnapshotBuilder)->Apply(BookShapes);
+
+// ============================================================================
+// aggregateMboWindowToMbpTopN
+// ============================================================================
+
+static void BM_AggregateMboToMbp(benchmark::State &state) {
+  const OrdersSnapshot in = BuildSnapshot(static_cast<uint32_t>(state.range(0)),
+                                          static_cast<uint32_t>(state.range(1)));
+  BookSnapshot out{};
+  for (auto _ : state) {
+    aggregateMboWindowToMbpTopN(in, out);
+    benchmark::DoNotOptimize(out.bidCount);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AggregateMboToMbp)->Apply(BookShapes);
+
+// ============================================================================
+// MdSnapshotMapper::mapToSerializedEnvelope
+// ============================================================================
+
+static void BM_MapToSerializedEnvelope(benchmark::State &state) {
+  const int depth = static_cast<int>(state.range(0));
+  BookSnapshot book{};
+  book.instrumentId = 1;
+  book.exchangeTsNs = 1;
+  book.bidCount = static_cast<uint8_t>(depth);
+  book.askCount = static_cast<uint8_t>(depth);
+  for (int i = 0; i < depth; ++i) {
+    book.bids[i] = {1'000'000 - i * 100, 100 + i};
+    book.asks[i] = {1'000'100 + i * 100, 200 + i};
+  }
+
+  mapping::MdSnapshotMapper mapper;
+  auto ev = std::make_unique<publishing::SerializedEnvelope>();
+  static constexpr char kTopic[] = "PETR4";
+
+  uint64_t failures = 0;
+  for (auto _ : state) {
+    if (!mapper.mapToSerializedEnvelope(book, *ev, kTopic, sizeof(kTopic) - 1))
+      ++failures;
+    benchmark::DoNotOptimize(ev->size);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * ev->size);
+  state.counters["failures"] = benchmark::Counter(static_cast<double>(failures));
+}
+BENCHMARK(BM_MapToSerializedEnvelope)->ArgName("depth")->DenseRange(1, BookSnapshot::DEPTH, 2);
+
+// ============================================================================
+// InstrumentTopicMapper::getTopic con lectores concurrentes (shared_mutex del registry)
+// ============================================================================
+
+static void BM_GetTopicConcurrentReaders(benchmark::State &state) {
+  static mapping::InstrumentTopicMapper topics(SharedRegistry());
+
+  uint64_t iid = 1 + static_cast<uint64_t>(state.thread_index()) * 97;
+  uint64_t misses = 0;
+  for (auto _ : state) {
+    const auto [ptr, len] = topics.getTopic(iid);
+    benchmark::DoNotOptimize(ptr);
+    misses += (len == 0);
+    iid = iid % kInstruments + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["misses"] = benchmark::Counter(static_cast<double>(misses));
+}
+BENCHMARK(BM_GetTopicConcurrentReaders)->ThreadRange(1, 8)->UseRealTime();
+
+// ============================================================================
+// Pipeline end-to-end: tryEnqueue -> worker (agregado + mapper) -> FakePublishSink
+// ============================================================================
+
+static void BM_PipelineToFakeSink(benchmark::State &state) {
+  const auto shards = static_cast<uint32_t>(state.range(0));
+  const auto batch = static_cast<uint64_t>(state.range(1));
+
+  mapping::InstrumentTopicMapper topics(SharedRegistry());
+  mapping::MdSnapshotMapper mapper;
+  testsupport::FakePublishSink sink;
+
+  std::vector<std::unique_ptr<MdPublishWorker>> workers;
+  for (uint32_t s = 0; s < shards; ++s)
+    workers.emplace_back(std::make_unique<MdPublishWorker>(s, mapper, sink, topics));
+  MdPublishPipeline pipeline(std::move(workers));
+  pipeline.start();
+
+  // Un snapshot por instrumento (libro de 20 niveles × 4 órdenes), rotando instrumentos
+  std::vector<OrdersSnapshot> books;
+  books.reserve(kInstruments);
+  for (uint64_t iid = 1; iid <= kInstruments; ++iid) books.push_back(BuildSnapshot(20, 4, iid));
+
+  uint64_t fullSpins = 0;
+  size_t next = 0;
+  for (auto _ : state) {
+    for (uint64_t i = 0; i < batch; ++i) {
+      const OrdersSnapshot &s = books[next];
+      next = (next + 1) % books.size();
+      while (!pipeline.tryEnqueue(s)) {
+        ++fullSpins;
+        std::this_thread::yield();
+      }
+    }
+    // Batch completo publicado (incluye el idle sleep del worker: es latencia real del pipeline)
+    while (sink.count() < batch) std::this_thread::yield();
+
+    state.PauseTiming();
+    sink.clear();
+    state.ResumeTiming();
+  }
+
+  pipeline.stop(true);
+
+  state.SetItemsProcessed(state.iterations() * batch);
+  state.counters["full_spins"] = benchmark::Counter(static_cast<double>(fullSpins));
+}
+BENCHMARK(BM_PipelineToFakeSink)
+    ->ArgNames({"shards", "batch"})
+    ->ArgsProduct({{1, 2, 4, 8}, {256, 2048}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char **argv) {
+  // Los health/startup de los workers ensucian la tabla de resultados
+  spdlog::set_level(spdlog::level::warn);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
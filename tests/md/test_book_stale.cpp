@@ -0,0 +1,186 @@
+#include "../../b3-md-connector/src/core/BookStaleTable.hpp"
+#include "../../b3-md-connector/src/core/MarketDataEngine.hpp"
+#include "../../b3-md-connector/src/core/MdPublishPipeline.hpp"
+#include "../../b3-md-connector/src/core/MdPublishWorker.hpp"
+#include "../../b3-md-connector/src/mapping/MdSnapshotMapper.hpp"
+#include "../../b3-md-connector/src/testsupport/FakeInstrumentTopicMapper.hpp"
+#include "FakePublishSink.hpp"
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace b3::md;
+using b3::md::publishing::SerializedEnvelope;
+
+namespace {
+
+  // Formato texto para verificar lo publicado: "flags=1;bids=0"
+  class TextBookMapper final : public b3::md::mapping::MdSnapshotMapper {
+   public:
+    bool mapToSerializedEnvelope(const BookSnapshot &s, SerializedEnvelope &ev, const char *topic,
+                                 std::uint8_t topicLen) const noexcept override {
+      const int n = std::snprintf(reinterpret_cast<char *>(ev.bytes), SerializedEnvelope::kMaxBytes,
+                                  "flags=%u;bids=%u", (unsigned)s.flags, (unsigned)s.bidCount);
+      ev.size = static_cast<uint32_t>(n);
+      std::memcpy(ev.topic, topic, topicLen);
+      ev.topicLen = topicLen;
+      return true;
+    }
+  };
+
+  OrdersSnapshot book(uint64_t iid, int64_t bidPx) {
+    OrdersSnapshot s{};
+    s.instrumentId = iid;
+    s.bids[0] = {bidPx, 100};
+    s.bidsCopied = 1;
+    s.bidCountRaw = 1;
+    return s;
+  }
+
+  void waitFor(const testsupport::FakePublishSink &sink, size_t n) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(2000);
+    while (sink.count() < n && std::chrono::steady_clock::now() < deadline)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+} // namespace
+
+TEST(BookStaleTableTests, MarksOnceAndClears) {
+  BookStaleTable stale(8);
+  EXPECT_FALSE(stale.isStale(42));
+
+  EXPECT_TRUE(stale.markStale(42));
+  EXPECT_FALSE(stale.markStale(42)); // ya stale: el marcador sale una sola vez
+  EXPECT_TRUE(stale.isStale(42));
+  EXPECT_FALSE(stale.isStale(43));
+  EXPECT_EQ(stale.staleCount(), 1u);
+
+  EXPECT_TRUE(stale.clear(42));
+  EXPECT_FALSE(stale.clear(42));
+  EXPECT_FALSE(stale.isStale(42));
+  EXPECT_EQ(stale.staleCount(), 0u);
+
+  EXPECT_FALSE(stale.markStale(0));
+  EXPECT_EQ(stale.overflow(), 1u);
+
+  // Marcador pendiente: se toma una vez y el clear lo descarta
+  EXPECT_TRUE(stale.markStale(42));
+  stale.setMarkerPending(42);
+  EXPECT_TRUE(stale.takeMarkerPending(42));
+  EXPECT_FALSE(stale.takeMarkerPending(42));
+  stale.setMarkerPending(42);
+  EXPECT_TRUE(stale.clear(42));
+  EXPECT_FALSE(stale.takeMarkerPending(42));
+}
+
+TEST(MarketDataEngineStaleTests, InvalidMarkerSuppressionAndRefresh) {
+  TextBookMapper mapper;
+  testsupport::FakePublishSink sink;
+  testsupport::FakeInstrumentTopicMapper topics{{42, "PETR4"}};
+
+  std::vector<std::unique_ptr<MdPublishWorker>> workers;
+  workers.push_back(std::make_unique<MdPublishWorker>(0, mapper, sink, topics.get()));
+  MdPublishPipeline pipeline(std::move(workers));
+  pipeline.start();
+
+  BookStaleTable stale(64);
+  MarketDataEngine engine(pipeline);
+  engine.setBookStaleTable(&stale);
+
+  engine.injectTestSnapshot(book(42, 100000));
+  engine.onBookOutOfDate(42, 7, 1);
+  engine.onBookOutOfDate(42, 7, 2); // repetido: sin segundo marcador
+
+  // Recuperación en curso: el libro parcial no sale
+  engine.setSnapshotRecovery(true);
+  engine.injectTestSnapshot(book(42, 101000));
+  engine.setSnapshotRecovery(false);
+
+  engine.injectTestSnapshot(book(42, 102000)); // refresh completo
+  engine.injectTestSnapshot(book(42, 103000)); // normal
+
+  waitFor(sink, 4);
+  pipeline.stop(true);
+
+  ASSERT_EQ(sink.count(), 4u);
+  EXPECT_EQ(sink.at(0).bytes, "flags=0;bids=1");
+  EXPECT_EQ(sink.at(1).bytes, "flags=1;bids=0"); // book invalid, sin niveles
+  EXPECT_EQ(sink.at(1).topic, "PETR4");          // mismo topic (y shard) que el libro
+  EXPECT_EQ(sink.at(2).bytes, "flags=2;bids=1");
+  EXPECT_EQ(sink.at(3).bytes, "flags=0;bids=1");
+
+  EXPECT_EQ(engine.staleMarked(), 1u);
+  EXPECT_EQ(engine.staleSuppressed(), 1u);
+  EXPECT_EQ(engine.staleRecovered(), 1u);
+  EXPECT_EQ(stale.staleCount(), 0u);
+}
+
+TEST(MarketDataEngineStaleTests, DroppedMarkerIsRetriedByNextBookEvent) {
+  TextBookMapper mapper;
+  testsupport::FakePublishSink sink;
+  testsupport::FakeInstrumentTopicMapper topics{{42, "PETR4"}};
+
+  // Cola de 2 sin arrancar el worker: el marcador no entra
+  std::vector<std::unique_ptr<MdPublishWorker>> workers;
+  workers.push_back(
+      std::make_unique<MdPublishWorker>(0, mapper, sink, topics.get(), 1, QueueConfig{2, false}));
+  MdPublishPipeline pipeline(std::move(workers));
+
+  BookStaleTable stale(64);
+  MarketDataEngine engine(pipeline);
+  engine.setBookStaleTable(&stale);
+
+  engine.injectTestSnapshot(book(42, 100000));
+  engine.injectTestSnapshot(book(42, 100500));
+  engine.onBookOutOfDate(42, 7, 1);
+  EXPECT_EQ(engine.staleMarkerDrops(), 1u);
+  EXPECT_TRUE(stale.isStale(42)); // sigue stale: los updates se siguen suprimiendo
+
+  pipeline.start();
+  waitFor(sink, 2);
+
+  // Próximo evento del libro (suprimido por la recuperación) reintenta el marcador
+  engine.setSnapshotRecovery(true);
+  engine.injectTestSnapshot(book(42, 101000));
+  engine.injectTestSnapshot(book(42, 101500)); // sin segundo marcador
+  engine.setSnapshotRecovery(false);
+  engine.injectTestSnapshot(book(42, 102000)); // refresh
+
+  waitFor(sink, 4);
+  pipeline.stop(true);
+
+  ASSERT_EQ(sink.count(), 4u);
+  EXPECT_EQ(sink.at(1).bytes, "flags=0;bids=1");
+  EXPECT_EQ(sink.at(2).bytes, "flags=1;bids=0");
+  EXPECT_EQ(sink.at(3).bytes, "flags=2;bids=1");
+  EXPECT_EQ(engine.staleMarked(), 1u);
+  EXPECT_EQ(engine.staleMarkerDrops(), 1u);
+  EXPECT_EQ(engine.staleSuppressed(), 2u);
+}
+
+TEST(MarketDataEngineStaleTests, WithoutTableOutOfDateIsIgnored) {
+  TextBookMapper mapper;
+  testsupport::FakePublishSink sink;
+  testsupport::FakeInstrumentTopicMapper topics{{42, "PETR4"}};
+
+  std::vector<std::unique_ptr<MdPublishWorker>> workers;
+  workers.push_back(std::make_unique<MdPublishWorker>(0, mapper, sink, topics.get()));
+  MdPublishPipeline pipeline(std::move(workers));
+  pipeline.start();
+
+  MarketDataEngine engine(pipeline);
+  engine.onBookOutOfDate(42, 7, 1);
+  engine.injectTestSnapshot(book(42, 100000));
+
+  waitFor(sink, 1);
+  pipeline.stop(true);
+
+  ASSERT_EQ(sink.count(), 1u);
+  EXPECT_EQ(sink.at(0).bytes, "flags=0;bids=1");
+  EXPECT_EQ(engine.staleMarked(), 0u);
+}
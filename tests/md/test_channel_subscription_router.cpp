@@ -0,0 +1,67 @@
+#include "../../b3-md-connector/src/core/ChannelSubscriptionRouter.hpp"
+#include <gtest/gtest.h>
+
+#include <unordered_set>
+#include <vector>
+
+using namespace b3::md;
+
+namespace {
+
+  class RecordingHandler final : public IMarketDataHandler {
+   public:
+    void subscribe(uint64_t iid) override { subscribed.push_back(iid); }
+    void unsubscribe(uint64_t iid) override { unsubscribed.push_back(iid); }
+
+    std::vector<uint64_t> subscribed;
+    std::vector<uint64_t> unsubscribed;
+  };
+
+} // namespace
+
+TEST(ChannelSubscriptionRouterTests, RoutesToOwningChannel) {
+  RecordingHandler equities;
+  RecordingHandler derivatives;
+  const std::unordered_set<uint64_t> ch80{1, 2};
+  const std::unordered_set<uint64_t> ch84{10};
+
+  ChannelSubscriptionRouter router;
+  router.add([&](uint64_t iid) { return ch80.count(iid) != 0; }, equities);
+  router.add([&](uint64_t iid) { return ch84.count(iid) != 0; }, derivatives);
+
+  router.subscribe(1);
+  router.subscribe(10);
+  router.unsubscribe(2);
+
+  EXPECT_EQ(equities.subscribed, (std::vector<uint64_t>{1}));
+  EXPECT_EQ(equities.unsubscribed, (std::vector<uint64_t>{2}));
+  EXPECT_EQ(derivatives.subscribed, (std::vector<uint64_t>{10}));
+  EXPECT_TRUE(derivatives.unsubscribed.empty());
+  EXPECT_EQ(router.unrouted(), 0u);
+
+  // Ningún canal lo reclama: va a todos
+  router.subscribe(99);
+  EXPECT_EQ(equities.subscribed.back(), 99u);
+  EXPECT_EQ(derivatives.subscribed.back(), 99u);
+  EXPECT_EQ(router.unrouted(), 1u);
+}
+
+TEST(ChannelSubscriptionRouterTests, SingleChannelSkipsOwnershipLookup) {
+  RecordingHandler handler;
+  int lookups = 0;
+
+  ChannelSubscriptionRouter router;
+  router.add(
+      [&](uint64_t) {
+        ++lookups;
+        return false;
+      },
+      handler);
+
+  router.subscribe(7);
+  router.unsubscribe(7);
+  EXPECT_EQ(handler.subscribed, (std::vector<uint64_t>{7}));
+  EXPECT_EQ(handler.unsubscribed, (std::vector<uint64_t>{7}));
+  EXPECT_EQ(lookups, 0);
+  EXPECT_EQ(router.unrouted(), 0u);
+}
@@ -0,0 +1,80 @@
+#include <b3/common/InstrumentRegistry.hpp>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+using b3::common::InstrumentData;
+using b3::common::InstrumentRegistry;
+using b3::common::RegistryDelta;
+
+namespace {
+
+  InstrumentData instrument(const char *symbol, const char *group = "A1") {
+    InstrumentData d;
+    d.symbol = symbol;
+    d.securityGroup = group;
+    return d;
+  }
+
+} // namespace
+
+TEST(InstrumentRegistryDeltaTests, VersionDenseIndexAndNotification) {
+  InstrumentRegistry reg;
+  std::vector<RegistryDelta> seen;
+  reg.addDeltaListener([&](const RegistryDelta &d) { seen.push_back(d); });
+
+  std::vector<std::pair<uint64_t, InstrumentData>> loop{{42, instrument("PETR4")},
+                                                       {43, instrument("VALE3")}};
+  auto d = reg.bulkUpsertFull(loop.begin(), loop.end());
+  EXPECT_EQ(d.version, 1u);
+  EXPECT_EQ(d.added.size(), 2u);
+  EXPECT_EQ(reg.denseIndexOf(42), 0u);
+  EXPECT_EQ(reg.denseIndexOf(43), 1u);
+
+  // El loop se repite idéntico: sin versión nueva ni notificación
+  d = reg.bulkUpsertFull(loop.begin(), loop.end());
+  EXPECT_TRUE(d.empty());
+  EXPECT_EQ(reg.version(), 1u);
+
+  // Delta intradiario: una serie nueva y un cambio de grupo
+  std::vector<std::pair<uint64_t, InstrumentData>> delta{{44, instrument("PETRK300")},
+                                                        {43, instrument("VALE3", "A2")}};
+  d = reg.bulkUpsertFull(delta.begin(), delta.end());
+  EXPECT_EQ(d.version, 2u);
+  EXPECT_EQ(d.firstNewDense, 2u);
+  ASSERT_EQ(d.added.size(), 1u);
+  EXPECT_EQ(d.added[0], 44u);
+  ASSERT_EQ(d.changed.size(), 1u);
+  EXPECT_EQ(d.changed[0], 43u);
+
+  // Los existentes conservan su índice denso
+  EXPECT_EQ(reg.denseIndexOf(42), 0u);
+  EXPECT_EQ(reg.denseIndexOf(43), 1u);
+  EXPECT_EQ(reg.denseIndexOf(44), 2u);
+  EXPECT_EQ(reg.instrumentAtDense(2), 44u);
+  EXPECT_EQ(reg.denseIndexOf(99), InstrumentRegistry::kNoDenseIndex);
+
+  ASSERT_EQ(seen.size(), 2u);
+  EXPECT_EQ(seen[1].version, 2u);
+}
+
+TEST(InstrumentRegistryDeltaTests, ReplacedDataStaysValidForReaders) {
+  InstrumentRegistry reg;
+  reg.upsertFull(42, instrument("PETR4"));
+
+  const std::string *sym = reg.tryResolveSymbol(42);
+  const InstrumentData *data = reg.tryResolveData(42);
+  ASSERT_NE(sym, nullptr);
+
+  reg.upsertFull(42, instrument("PETR4", "B1"));
+
+  // El lector que ya tenía el puntero sigue viendo la versión anterior, no memoria liberada
+  EXPECT_EQ(*sym, "PETR4");
+  EXPECT_EQ(data->securityGroup, "A1");
+  EXPECT_EQ(reg.tryResolveData(42)->securityGroup, "B1");
+  EXPECT_EQ(reg.retiredVersions(), 1u);
+  EXPECT_EQ(*reg.tryResolveId("PETR4"), 42u);
+  EXPECT_EQ(reg.size(), 1u);
+}
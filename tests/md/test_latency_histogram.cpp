@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+
+#include "../../b3-md-connector/src/telemetry/LatencyHistogram.hpp"
+
+using b3::md::telemetry::LatencyHistogram;
+
+TEST(LatencyHistogramTests, EmptyReportsZero) {
+  LatencyHistogram h;
+  EXPECT_EQ(h.count(), 0u);
+  EXPECT_EQ(h.mean(), 0u);
+  EXPECT_EQ(h.percentile(0.99), 0u);
+}
+
+TEST(LatencyHistogramTests, PercentilesWithinBucketError) {
+  LatencyHistogram h;
+  for (uint64_t v = 1; v <= 10'000; ++v) h.record(v * 100); // 100ns .. 1ms uniforme
+
+  EXPECT_EQ(h.count(), 10'000u);
+  EXPECT_EQ(h.max(), 1'000'000u);
+  EXPECT_EQ(h.mean(), 500'050u);
+
+  // Cota superior del bucket: nunca por debajo del valor real, a lo sumo +12.5%
+  for (double p : {0.5, 0.9, 0.99, 0.999}) {
+    const double exact = p * 999'900.0 + 100.0;
+    const double got = static_cast<double>(h.percentile(p));
+    EXPECT_GE(got, exact * 0.999) << "p=" << p;
+    EXPECT_LE(got, exact * 1.125) << "p=" << p;
+  }
+  EXPECT_EQ(h.percentile(1.0), 1'000'000u);
+
+  h.reset();
+  EXPECT_EQ(h.count(), 0u);
+  EXPECT_EQ(h.max(), 0u);
+}
+
+TEST(LatencyHistogramTests, SmallAndHugeValuesStayInRange) {
+  LatencyHistogram h;
+  for (uint64_t v = 0; v < 8; ++v) h.record(v);
+  EXPECT_EQ(h.percentile(0.0), 0u);
+  EXPECT_EQ(h.percentile(1.0), 7u);
+
+  h.record(~uint64_t{0});
+  EXPECT_EQ(h.percentile(1.0), ~uint64_t{0});
+}
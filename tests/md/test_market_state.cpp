@@ -0,0 +1,315 @@
+#include "../../b3-md-connector/src/core/MarketStateTable.hpp"
+#include "../../b3-md-connector/src/core/MdStateLane.hpp"
+#include "../../b3-md-connector/src/mapping/MdSnapshotMapper.hpp"
+#include "../../b3-md-connector/src/testsupport/FakeInstrumentTopicMapper.hpp"
+#include "FakePublishSink.hpp"
+#include <gtest/gtest.h>
+
+#include <b3/common/InstrumentRegistry.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+using namespace b3::md;
+using b3::md::publishing::CompactEnvelope;
+
+namespace {
+
+  // Formato texto para verificar lo publicado: "st=17;top=100000;imb=-300"
+  class TextStateMapper final : public b3::md::mapping::MdSnapshotMapper {
+   public:
+    bool mapStateToEnvelope(const InstrumentMarketState &st, CompactEnvelope &ev,
+                            const char *symbol, std::uint8_t symbolLen) const noexcept override {
+      const int n = std::snprintf(reinterpret_cast<char *>(ev.bytes), CompactEnvelope::kMaxBytes,
+                                  "st=%u;top=%lld;imb=%lld", (unsigned)st.view.status,
+                                  (long long)st.view.topPrice, (long long)st.view.imbalanceQty);
+      ev.size = static_cast<uint16_t>(n);
+      setTopic(ev, 'M', symbol, symbolLen);
+      return true;
+    }
+
+    bool mapGroupStateToEnvelope(const GroupMarketState &gs,
+                                 CompactEnvelope &ev) const noexcept override {
+      const int n = std::snprintf(reinterpret_cast<char *>(ev.bytes), CompactEnvelope::kMaxBytes,
+                                  "phase=%u", (unsigned)gs.phase);
+      ev.size = static_cast<uint16_t>(n);
+      setTopic(ev, 'G', gs.name, static_cast<std::uint8_t>(std::strlen(gs.name)));
+      return true;
+    }
+
+   private:
+    static void setTopic(CompactEnvelope &ev, char prefix, const char *s, std::uint8_t len) {
+      ev.topic[0] = prefix;
+      ev.topic[1] = '.';
+      std::memcpy(ev.topic + 2, s, len);
+      ev.topicLen = static_cast<uint8_t>(len + 2);
+    }
+  };
+
+  MarketStateEvent status(uint64_t iid, uint8_t st, uint8_t tradingEvent = 0) {
+    MarketStateEvent e{};
+    e.kind = MarketStateKind::SecurityStatus;
+    e.instrumentId = iid;
+    e.status = st;
+    e.tradingEvent = tradingEvent;
+    return e;
+  }
+
+  MarketStateEvent groupPhase(const char *group, uint8_t phase) {
+    MarketStateEvent e{};
+    e.kind = MarketStateKind::GroupPhase;
+    std::memcpy(e.group, group, std::min<size_t>(3, std::strlen(group)));
+    e.status = phase;
+    return e;
+  }
+
+  // Sink que rechaza la lane de estado hasta open() (cola prioritaria llena).
+  class GatedPrioritySink final : public b3::md::publishing::IPublishSink {
+   public:
+    bool tryPublish(uint32_t shardId,
+                    const b3::md::publishing::SerializedEnvelope &ev) noexcept override {
+      return out.tryPublish(shardId, ev);
+    }
+
+    bool tryPublishPriority(uint32_t channel, const CompactEnvelope &ev) noexcept override {
+      if (!open_.load(std::memory_order_acquire)) {
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      return out.tryPublishPriority(channel, ev);
+    }
+
+    void open() noexcept { open_.store(true, std::memory_order_release); }
+
+    testsupport::FakePublishSink out;
+    std::atomic<uint64_t> rejected{0};
+
+   private:
+    std::atomic<bool> open_{false};
+  };
+
+  void addInstrument(b3::common::InstrumentRegistry &reg, uint64_t iid, const char *symbol,
+                     const char *group) {
+    b3::common::InstrumentData d;
+    d.symbol = symbol;
+    d.securityGroup = group;
+    reg.upsertFull(iid, std::move(d));
+  }
+
+} // namespace
+
+TEST(MarketStateTableTests, PublishesOnlyOnChange) {
+  MarketStateTable table;
+  std::vector<uint32_t> changed;
+
+  table.apply(status(7, kB3StatusOpen), changed);
+  ASSERT_EQ(changed.size(), 1u);
+
+  changed.clear();
+  table.apply(status(7, kB3StatusOpen), changed); // repetido (ej. recovery): no sale nada
+  EXPECT_TRUE(changed.empty());
+
+  table.apply(status(7, kB3StatusPause), changed);
+  ASSERT_EQ(changed.size(), 1u);
+
+  InstrumentMarketState st;
+  ASSERT_TRUE(table.snapshot(7, st));
+  EXPECT_EQ(st.view.status, kB3StatusPause);
+  EXPECT_FALSE(table.snapshot(8, st));
+}
+
+TEST(MarketStateTableTests, InstrumentFollowsGroupUntilOwnStatusAndRejoin) {
+  b3::common::InstrumentRegistry reg;
+  addInstrument(reg, 7, "PETR4", "A1");
+  addInstrument(reg, 8, "VALE3", "A1");
+  addInstrument(reg, 9, "WINZ6", "F1");
+
+  MarketStateTable table(16, &reg);
+  std::vector<uint32_t> changed;
+
+  MarketStateEvent band{};
+  band.kind = MarketStateKind::PriceBand;
+  for (uint64_t iid : {7, 8, 9}) {
+    band.instrumentId = iid;
+    table.apply(band, changed);
+  }
+
+  changed.clear();
+  auto r = table.apply(groupPhase("A1", kB3StatusOpen), changed);
+  EXPECT_TRUE(r.groupChanged);
+  EXPECT_EQ(changed.size(), 2u); // PETR4 y VALE3, no WINZ6
+
+  // Halt propio de PETR4: deja de seguir al grupo
+  changed.clear();
+  table.apply(status(7, kB3StatusPause), changed);
+  ASSERT_EQ(changed.size(), 1u);
+
+  changed.clear();
+  table.apply(groupPhase("A1", kB3StatusFinalClosingCall), changed);
+  ASSERT_EQ(changed.size(), 1u); // solo VALE3
+
+  InstrumentMarketState st;
+  ASSERT_TRUE(table.snapshot(7, st));
+  EXPECT_EQ(st.view.status, kB3StatusPause);
+  ASSERT_TRUE(table.snapshot(8, st));
+  EXPECT_EQ(st.view.status, kB3StatusFinalClosingCall);
+
+  // "Rejoins security group": vuelve a la fase del grupo
+  changed.clear();
+  table.apply(status(7, kB3StatusOpen, kB3EventRejoinsGroup), changed);
+  ASSERT_TRUE(table.snapshot(7, st));
+  EXPECT_EQ(st.view.status, kB3StatusFinalClosingCall);
+  EXPECT_EQ(table.groups(), 2u);
+}
+
+TEST(MarketStateTableTests, InstrumentWithoutEventsTakesRegistryGroupPhase) {
+  b3::common::InstrumentRegistry reg;
+  addInstrument(reg, 7, "PETR4", "A1");
+  addInstrument(reg, 8, "VALE3", "A1");
+  addInstrument(reg, 9, "WINZ6", "F1");
+
+  MarketStateTable table(16, &reg);
+  std::vector<uint32_t> changed;
+  table.apply(status(7, kB3StatusPause), changed);
+
+  InstrumentMarketState st;
+  EXPECT_FALSE(table.snapshot(8, st)); // grupo todavía sin fase
+
+  table.apply(groupPhase("A1", kB3StatusOpen), changed);
+
+  // VALE3 nunca tuvo un evento propio: responde con la fase de su grupo
+  ASSERT_TRUE(table.snapshot(8, st));
+  EXPECT_EQ(st.instrumentId, 8u);
+  EXPECT_EQ(st.view.status, kB3StatusOpen);
+  EXPECT_TRUE(st.followsGroup);
+  ASSERT_TRUE(table.snapshot(7, st));
+  EXPECT_EQ(st.view.status, kB3StatusPause); // status propio manda
+  EXPECT_FALSE(table.snapshot(9, st));       // F1 sin fase
+  EXPECT_EQ(table.instruments(), 1u);        // el fallback no crea filas
+}
+
+TEST(MarketStateTableTests, AuctionAndBandsKeepLastValueAndDeleteClears) {
+  MarketStateTable table;
+  std::vector<uint32_t> changed;
+
+  MarketStateEvent top{};
+  top.kind = MarketStateKind::TheoreticalOpening;
+  top.instrumentId = 7;
+  top.price = 101000;
+  top.qty = 500;
+  top.flags = MarketStateEvent::kHasPrice | MarketStateEvent::kHasQty;
+  table.apply(top, changed);
+
+  MarketStateEvent imb{};
+  imb.kind = MarketStateKind::AuctionImbalance;
+  imb.instrumentId = 7;
+  imb.qty = -300;
+  imb.flags = MarketStateEvent::kHasQty;
+  table.apply(imb, changed);
+
+  MarketStateEvent band{};
+  band.kind = MarketStateKind::PriceBand;
+  band.instrumentId = 7;
+  band.price = 90000;
+  band.price2 = 110000;
+  band.flags = MarketStateEvent::kHasPrice | MarketStateEvent::kHasPrice2;
+  table.apply(band, changed);
+  band.price3 = 100000;
+  band.flags = MarketStateEvent::kHasPrice3; // solo referencia: los límites quedan
+  table.apply(band, changed);
+
+  InstrumentMarketState st;
+  ASSERT_TRUE(table.snapshot(7, st));
+  EXPECT_TRUE(st.view.hasTop);
+  EXPECT_EQ(st.view.topPrice, 101000);
+  EXPECT_EQ(st.view.topQty, 500);
+  EXPECT_EQ(st.view.imbalanceQty, -300);
+  EXPECT_EQ(st.view.bandLow, 90000);
+  EXPECT_EQ(st.view.bandHigh, 110000);
+  EXPECT_EQ(st.view.bandRef, 100000);
+
+  changed.clear();
+  top.deleted = true;
+  table.apply(top, changed);
+  EXPECT_EQ(changed.size(), 1u);
+  ASSERT_TRUE(table.snapshot(7, st));
+  EXPECT_FALSE(st.view.hasTop);
+  EXPECT_EQ(st.view.topPrice, 0);
+}
+
+TEST(MdStateLaneTests, PublishesChangesOnStateChannel) {
+  b3::common::InstrumentRegistry reg;
+  addInstrument(reg, 7, "PETR4", "A1");
+
+  TextStateMapper mapper;
+  testsupport::FakePublishSink sink;
+  testsupport::FakeInstrumentTopicMapper topics{{7, "PETR4"}};
+  MarketStateTable table(16, &reg);
+
+  MdStateLane lane(table, mapper, sink, topics.get());
+  lane.start();
+
+  ASSERT_TRUE(lane.tryEnqueue(status(7, kB3StatusPause), 0));
+  ASSERT_TRUE(lane.tryEnqueue(status(7, kB3StatusPause), 0)); // sin cambio
+  ASSERT_TRUE(lane.tryEnqueue(groupPhase("A1", kB3StatusOpen), 0));
+
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(2000);
+  while (sink.count() < 2 && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  lane.stop(true);
+
+  // PETR4 tiene status propio: el cambio de fase del grupo no lo republica
+  ASSERT_EQ(sink.count(), 2u);
+  EXPECT_EQ(sink.at(0).topic, "M.PETR4");
+  EXPECT_EQ(sink.at(0).bytes, "st=2;top=0;imb=0");
+  EXPECT_EQ(sink.at(1).topic, "G.A1");
+  EXPECT_EQ(sink.at(1).bytes, "phase=17");
+  for (size_t i = 0; i < sink.count(); ++i) {
+    EXPECT_TRUE(sink.at(i).priority);
+    EXPECT_EQ(sink.at(i).shardId, publishing::kStateChannel);
+  }
+  EXPECT_EQ(lane.published(), 2u);
+  EXPECT_EQ(lane.unchanged(), 1u);
+  EXPECT_EQ(lane.dropped(), 0u);
+}
+
+TEST(MdStateLaneTests, RejectedInstrumentIsRetriedOnceWithLatestState) {
+  b3::common::InstrumentRegistry reg;
+  addInstrument(reg, 7, "PETR4", "A1");
+
+  TextStateMapper mapper;
+  GatedPrioritySink sink;
+  testsupport::FakeInstrumentTopicMapper topics{{7, "PETR4"}};
+  MarketStateTable table(16, &reg);
+
+  MdStateLane lane(table, mapper, sink, topics.get());
+  lane.start();
+
+  // Sink lleno: cada cambio de PETR4 cae en pending, pero una sola vez
+  for (int i = 0; i < 50; ++i)
+    ASSERT_TRUE(lane.tryEnqueue(status(7, i % 2 ? kB3StatusOpen : kB3StatusPause), 0));
+  ASSERT_TRUE(lane.tryEnqueue(status(7, kB3StatusFinalClosingCall), 0));
+
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(2000);
+  InstrumentMarketState st;
+  while ((!table.snapshot(7, st) || st.view.status != kB3StatusFinalClosingCall) &&
+         std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  ASSERT_EQ(st.view.status, kB3StatusFinalClosingCall);
+  EXPECT_GT(sink.rejected.load(), 0u);
+
+  sink.open();
+  while (sink.out.count() < 1 && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20)); // duplicados saldrían acá
+  lane.stop(true);
+
+  ASSERT_EQ(sink.out.count(), 1u);
+  EXPECT_EQ(sink.out.at(0).topic, "M.PETR4");
+  EXPECT_EQ(sink.out.at(0).bytes, "st=101;top=0;imb=0");
+  EXPECT_EQ(lane.published(), 1u);
+}
@@ -3,6 +3,8 @@
 #include "../../b3-md-connector/src/core/OrdersSnapshot.hpp"
 #include "../../b3-md-connector/src/core/BookSnapshot.hpp"
 #include "../../b3-md-connector/src/core/MboToMbpAggregator.hpp"
+#include "../../b3-md-connector/src/onixs/OnixsOrdersSnapshotBuilder.hpp"
+#include "FakeMboOrderBook.hpp"
 
 using namespace b3::md;
 
@@ -90,3 +92,50 @@ TEST(MboToMbpAggregatorTests, IgnoresZeroQtyOrders) {
     EXPECT_EQ(out.bids[0].qty,   10);
     EXPECT_EQ(out.askCount, 0u);
 }
+
+TEST(MboToMbpAggregatorTests, BuilderSkipsMarketOrdersAndFeedsBestLevelsFirst) {
+    test::FakeMboOrderBook book;
+    book.setInstrumentId(42);
+    book.setLastRptSeq(7);
+    book.setLastMessageSeqNumApplied(9);
+    book.fill(/*levels=*/8, /*ordersPerLevel=*/3, /*mid=*/1000, /*marketOrders=*/2);
+
+    OrdersSnapshot snap{};
+    onixs::OnixsOrdersSnapshotBuilder::buildFromBook(book, 123, snap);
+
+    EXPECT_EQ(snap.instrumentId, 42u);
+    EXPECT_EQ(snap.rptSeq, 7u);
+    EXPECT_EQ(snap.channelSeq, 9u);
+    EXPECT_EQ(snap.exchangeTsNs, 123u);
+    EXPECT_EQ(snap.bidCountRaw, 26u);
+    EXPECT_EQ(snap.bidsCopied, 24u); // market orders fuera
+    EXPECT_EQ(snap.asksCopied, 24u);
+    EXPECT_EQ(snap.bidTruncated, 0u);
+
+    BookSnapshot out{};
+    aggregateMboWindowToMbpTopN(snap, out);
+
+    ASSERT_EQ(out.bidCount, BookSnapshot::DEPTH);
+    ASSERT_EQ(out.askCount, BookSnapshot::DEPTH);
+    for (int i = 0; i < BookSnapshot::DEPTH; ++i) {
+        EXPECT_EQ(out.bids[i].price, 999 - i);
+        EXPECT_EQ(out.bids[i].qty, 100 + 101 + 102);
+        EXPECT_EQ(out.asks[i].price, 1001 + i);
+        EXPECT_EQ(out.asks[i].qty, 100 + 101 + 102);
+    }
+}
+
+TEST(MboToMbpAggregatorTests, BuilderTruncatesAtWindowSize) {
+    test::FakeMboOrderBook book;
+    book.fill(/*levels=*/100, /*ordersPerLevel=*/3);
+
+    OrdersSnapshot snap{};
+    onixs::OnixsOrdersSnapshotBuilder::buildFromBook(book, 1, snap);
+
+    EXPECT_EQ(snap.bidsCopied, OrdersSnapshot::K);
+    EXPECT_EQ(snap.asksCopied, OrdersSnapshot::K);
+    EXPECT_EQ(snap.bidTruncated, 1u);
+    EXPECT_EQ(snap.askTruncated, 1u);
+    EXPECT_EQ(snap.bids[0].priceMantissa, 100'000 - 1);
+    EXPECT_EQ(snap.asks[0].priceMantissa, 100'000 + 1);
+}
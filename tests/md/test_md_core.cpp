@@ -166,6 +166,47 @@ TEST(SnapshotQueueSpscTests, WrapAroundBehavior) {
     }
 }
 
+TEST(SnapshotQueueSpscTests, RuntimeCapacityOverridesTemplateDefault) {
+    SnapshotQueueSpsc<int, 4> queue(8);
+    EXPECT_EQ(queue.capacity(), 8u);
+
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_TRUE(queue.try_push(i));
+    }
+    EXPECT_FALSE(queue.try_push(8));
+
+    for (int i = 0; i < 8; ++i) {
+        int value;
+        EXPECT_TRUE(queue.try_pop(value));
+        EXPECT_EQ(value, i);
+    }
+
+    EXPECT_THROW((SnapshotQueueSpsc<int, 4>(6)), std::invalid_argument);
+}
+
+TEST(SnapshotQueueSpscTests, HugePagesFallBackTransparently) {
+    const uint64_t before = b3::md::QueueMemory::liveBytesTotal();
+    {
+        // Sin hugepages reservadas cae a THP/regular; en cualquier caso la cola funciona igual
+        SnapshotQueueSpsc<BookSnapshot, 1024> q(1024, /*hugePages=*/true, /*deferFirstTouch=*/true);
+        q.firstTouch();
+
+        EXPECT_GE(q.memoryBytes(), 1024 * sizeof(BookSnapshot));
+        if (q.backing() == b3::md::QueueBacking::HugeTlb) {
+            EXPECT_EQ(q.memoryBytes() % b3::md::QueueMemory::kHugePageSize, 0u);
+        }
+        EXPECT_EQ(b3::md::QueueMemory::liveBytesTotal(), before + q.memoryBytes());
+
+        BookSnapshot in{};
+        in.instrumentId = 42;
+        EXPECT_TRUE(q.try_push(in));
+        BookSnapshot out{};
+        EXPECT_TRUE(q.try_pop(out));
+        EXPECT_EQ(out.instrumentId, 42u);
+    }
+    EXPECT_EQ(b3::md::QueueMemory::liveBytesTotal(), before);
+}
+
 // ============================================================================
 // SnapshotQueueSpsc Tests - Multi-threaded SPSC
 // ============================================================================
@@ -1,12 +1,15 @@
 #include <gtest/gtest.h>
 
+#include "../../b3-md-connector/src/core/BookStaleTable.hpp"
 #include "../../b3-md-connector/src/core/MarketDataEngine.hpp"
+#include "../../b3-md-connector/src/core/MdInlinePublisher.hpp"
 #include "../../b3-md-connector/src/core/MdPublishPipeline.hpp"
 #include "../../b3-md-connector/src/core/MdPublishWorker.hpp"
 #include "../../b3-md-connector/src/mapping/MdSnapshotMapper.hpp"
 #include "../../b3-md-connector/src/testsupport/OrdersSnapshotFromMbpView.hpp"
 #include "../../b3-md-connector/src/testsupport/FakeInstrumentTopicMapper.hpp"
 #include "FakeOrderBook.hpp"
+#include "FakePublishSink.hpp"
 
 #include <atomic>
 #include <chrono>
@@ -91,3 +94,51 @@ TEST(MarketDataEngineTests, EnqueueNeverBlocks) {
   pipeline.stop(false);
   SUCCEED();
 }
+
+TEST(MarketDataEngineTests, InlinePublishSkipsPipeline) {
+  MdSnapshotMapper mapper;
+  CountingSink pipelineSink;
+  testsupport::FakePublishSink inlineSink;
+  testsupport::FakeInstrumentTopicMapper fakeTopics{{42, "AAA"}};
+
+  // Pipeline sin arrancar: si algo se encolara ahí no saldría nunca
+  std::vector<std::unique_ptr<MdPublishWorker>> workers;
+  workers.emplace_back(std::make_unique<MdPublishWorker>(0, mapper, pipelineSink, fakeTopics.get()));
+  MdPublishPipeline pipeline(std::move(workers));
+
+  MdInlinePublisher inlinePublisher(mapper, fakeTopics.get(), inlineSink);
+  BookStaleTable stale(64);
+  MarketDataEngine engine(pipeline);
+  engine.setInlinePublisher(&inlinePublisher);
+  engine.setBookStaleTable(&stale);
+
+  FakeOrderBook book;
+  book.setInstrumentId(42);
+  book.setExchangeTsNs(123);
+  book.setBidCount(1);
+  book.setAskCount(1);
+  book.setBidLevel(0, b3::md::Level{10, 5});
+  book.setAskLevel(0, b3::md::Level{11, 7});
+  const auto snapshot = b3::md::testsupport::makeOrdersSnapshotFromMbpView(book);
+
+  // Publicado en el thread que llama, antes de volver
+  engine.injectTestSnapshot(snapshot);
+  ASSERT_EQ(inlineSink.count(), 1u);
+  EXPECT_EQ(inlineSink.at(0).topic, "AAA");
+
+  // Marcador stale y refresh también van inline
+  engine.onBookOutOfDate(42, 7, 124);
+  engine.injectTestSnapshot(snapshot);
+  EXPECT_EQ(inlineSink.count(), 3u);
+  EXPECT_EQ(engine.staleRecovered(), 1u);
+
+  // Sin topic: drop contado, nada enviado
+  auto unknown = snapshot;
+  unknown.instrumentId = 99;
+  engine.injectTestSnapshot(unknown);
+  EXPECT_EQ(inlineSink.count(), 3u);
+  EXPECT_EQ(inlinePublisher.published(), 3u);
+  EXPECT_EQ(inlinePublisher.dropped(), 1u);
+  EXPECT_EQ(engine.drops(), 1u);
+  EXPECT_EQ(pipeline.worker(0).enqueued(), 0u);
+}
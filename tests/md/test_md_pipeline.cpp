@@ -11,6 +11,7 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <mutex>
 
 using namespace b3::md;
 using b3::md::mapping::MdSnapshotMapper;
@@ -79,7 +80,7 @@ namespace {
   }
 
   MdPublishPipeline BuildPipeline(uint32_t shards, TestMdSnapshotMapper &mapper,
-                                  testsupport::FakePublishSink &sink) {
+                                  testsupport::FakePublishSink &sink, uint32_t lanes = 1) {
     std::vector<std::unique_ptr<MdPublishWorker>> workers;
     workers.reserve(shards);
 
@@ -91,7 +92,7 @@ namespace {
     };
 
     for (uint32_t i = 0; i < shards; ++i) {
-      workers.emplace_back(std::make_unique<MdPublishWorker>(i, mapper, sink, fakeTopics.get()));
+      workers.emplace_back(std::make_unique<MdPublishWorker>(i, mapper, sink, fakeTopics.get(), lanes));
     }
 
     return MdPublishPipeline(std::move(workers));
@@ -190,4 +191,68 @@ TEST(MdPublishPipelineTests, ProgressUnderMultipleInstruments) {
   pipeline.stop(true);
 
   ASSERT_EQ(sink.count(), expected);
-}
\ No newline at end of file
+}
+TEST(MdPublishPipelineTests, MultiProducerLanesPreserveFifoPerInstrument) {
+  testsupport::FakePublishSink sink;
+  TestMdSnapshotMapper mapper;
+
+  constexpr uint32_t kProducers = 3;
+  auto pipeline = BuildPipeline(2, mapper, sink, kProducers);
+  ASSERT_EQ(pipeline.laneCount(), kProducers);
+  pipeline.start();
+
+  // Emula el Handler de OnixS: los callbacks de un mismo libro están serializados, pero
+  // pueden llegar desde cualquier feed thread del pool.
+  std::mutex handlerLock;
+  std::unordered_map<uint64_t, uint64_t> nextTs{{1, 0}, {2, 0}, {3, 0}, {4, 0}};
+
+  constexpr int kPerProducer = 20'000;
+  std::vector<std::thread> producers;
+  for (uint32_t p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&, p] {
+      ASSERT_TRUE(pipeline.bindCurrentThreadToLane());
+      for (int i = 0; i < kPerProducer; ++i) {
+        const uint64_t iid = 1 + static_cast<uint64_t>((i + p) % 4);
+        std::lock_guard<std::mutex> g(handlerLock);
+        OrdersSnapshot s{};
+        s.instrumentId = iid;
+        s.exchangeTsNs = nextTs[iid]++;
+        while (!pipeline.tryEnqueue(s)) std::this_thread::yield();
+      }
+    });
+  }
+  for (auto &t : producers) t.join();
+
+  // Un productor extra ya no tiene lane: se rechaza en vez de compartir una SPSC
+  std::thread extra([&] {
+    EXPECT_FALSE(pipeline.bindCurrentThreadToLane());
+    OrdersSnapshot s{};
+    s.instrumentId = 1;
+    EXPECT_FALSE(pipeline.tryEnqueue(s));
+  });
+  extra.join();
+  EXPECT_EQ(pipeline.laneRejected(), 1u);
+
+  const size_t expected = static_cast<size_t>(kProducers) * kPerProducer;
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (sink.count() < expected && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  pipeline.stop(true);
+
+  ASSERT_EQ(sink.count(), expected);
+
+  std::unordered_map<uint64_t, std::vector<uint64_t>> seen;
+  for (size_t i = 0; i < expected; ++i) {
+    const auto msg = sink.at(i);
+    seen[ParseIid(msg.bytes)].push_back(ParseTs(msg.bytes));
+  }
+
+  ASSERT_EQ(seen.size(), 4u);
+  for (const auto &[iid, tss] : seen) {
+    for (size_t i = 1; i < tss.size(); ++i) {
+      ASSERT_EQ(tss[i], tss[i - 1] + 1) << "iid=" << iid;
+    }
+  }
+}
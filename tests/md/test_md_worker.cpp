@@ -7,6 +7,7 @@
 
 #include <chrono>
 #include <thread>
+#include <vector>
 
 using namespace b3::md;
 using b3::md::mapping::MdSnapshotMapper;
@@ -241,3 +242,45 @@ TEST(MdPublishWorkerTests, AggregationAffectsCountsInSerializedOutput) {
   EXPECT_EQ(bc, 2u);
   EXPECT_EQ(ac, 2u);
 }
+
+TEST(MdPublishWorkerTests, ThrottledStreamCarriesLatestBookUnderPrefix) {
+  testsupport::FakePublishSink sink;
+  TestMdSnapshotMapper mapper;
+  testsupport::FakeInstrumentTopicMapper fakeTopics{{77, "AAA"}};
+
+  MdPublishWorker worker(0, mapper, sink, fakeTopics.get());
+  worker.addThrottle(60'000'000'000ull, "C60000."); // intervalo > duración del test
+  worker.start();
+
+  for (int i = 1; i <= 50; ++i) {
+    OrdersSnapshot s{};
+    s.instrumentId = 77;
+    s.exchangeTsNs = static_cast<uint64_t>(i);
+    s.bidsCopied = 1;
+    s.bids[0] = {.priceMantissa = 1000, .qty = 1};
+    while (!worker.tryEnqueue(s)) std::this_thread::yield();
+  }
+  worker.stop(true);
+
+  std::vector<uint64_t> full, throttled;
+  for (size_t i = 0; i < sink.count(); ++i) {
+    const auto m = sink.at(i);
+    // El stream throttleado sale suelto: ni batch frames ni ring shm en el concentrator
+    const bool directOnly = m.flags & publishing::SerializedEnvelope::kDirectOnly;
+    if (m.topic == "AAA") {
+      EXPECT_FALSE(directOnly);
+      full.push_back(parse_ts(m.bytes));
+    } else if (m.topic == "C60000.AAA") {
+      EXPECT_TRUE(directOnly);
+      throttled.push_back(parse_ts(m.bytes));
+    } else
+      ADD_FAILURE() << "unexpected topic " << m.topic;
+  }
+
+  EXPECT_EQ(full.size(), 50u); // el stream completo no cambia
+  // Primer book al toque, el último en el flush del stop
+  ASSERT_EQ(throttled.size(), 2u);
+  EXPECT_EQ(throttled.front(), 1u);
+  EXPECT_EQ(throttled.back(), 50u);
+  EXPECT_EQ(worker.throttle(0).conflated(), 48u);
+}
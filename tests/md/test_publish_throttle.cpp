@@ -0,0 +1,93 @@
+#include "../../b3-md-connector/src/core/PublishThrottle.hpp"
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace b3::md;
+
+namespace {
+
+  constexpr uint64_t kMs = 1'000'000;
+
+  BookSnapshot book(uint64_t iid, uint64_t rptSeq, uint8_t flags = 0) {
+    BookSnapshot b{};
+    b.instrumentId = iid;
+    b.rptSeq = rptSeq;
+    b.flags = flags;
+    return b;
+  }
+
+  struct Recorder {
+    std::vector<BookSnapshot> out;
+    auto fn() {
+      return [this](const BookSnapshot &b) { out.push_back(b); };
+    }
+  };
+
+} // namespace
+
+TEST(PublishThrottleTests, LeadingEdgeThenLatestAtInterval) {
+  PublishThrottle th(100 * kMs, 64);
+  Recorder r;
+  const uint64_t t0 = 1'000 * kMs;
+
+  th.offer(book(7, 1), t0, r.fn());
+  ASSERT_EQ(r.out.size(), 1u); // sin emisión previa: sale ya
+  EXPECT_EQ(r.out.back().rptSeq, 1u);
+
+  th.offer(book(7, 2), t0 + 10 * kMs, r.fn());
+  th.offer(book(7, 3), t0 + 20 * kMs, r.fn());
+  th.offer(book(7, 4), t0 + 30 * kMs, r.fn());
+  EXPECT_EQ(r.out.size(), 1u);
+  EXPECT_EQ(th.conflated(), 2u);
+
+  th.advance(t0 + 99 * kMs, r.fn());
+  EXPECT_EQ(r.out.size(), 1u); // todavía dentro del intervalo
+
+  th.advance(t0 + 100 * kMs, r.fn());
+  ASSERT_EQ(r.out.size(), 2u);
+  EXPECT_EQ(r.out.back().rptSeq, 4u); // el último, no el primero retenido
+  EXPECT_EQ(th.pendingCount(), 0u);
+
+  // Otro instrumento no comparte el intervalo
+  th.offer(book(8, 1), t0 + 101 * kMs, r.fn());
+  EXPECT_EQ(r.out.size(), 3u);
+}
+
+TEST(PublishThrottleTests, StaleMarkersAndRefreshBypassAndDropPending) {
+  PublishThrottle th(100 * kMs, 64);
+  Recorder r;
+  const uint64_t t0 = 1'000 * kMs;
+
+  th.offer(book(7, 1), t0, r.fn());
+  th.offer(book(7, 2), t0 + 5 * kMs, r.fn()); // pendiente
+  th.offer(book(7, 0, OrdersSnapshot::kBookInvalid), t0 + 6 * kMs, r.fn());
+  ASSERT_EQ(r.out.size(), 2u);
+  EXPECT_TRUE(r.out.back().flags & OrdersSnapshot::kBookInvalid);
+  EXPECT_EQ(th.pendingCount(), 0u); // el book viejo no sale después del marcador
+
+  th.offer(book(7, 50, OrdersSnapshot::kBookRefresh), t0 + 7 * kMs, r.fn());
+  ASSERT_EQ(r.out.size(), 3u);
+  EXPECT_TRUE(r.out.back().flags & OrdersSnapshot::kBookRefresh);
+
+  th.advance(t0 + 500 * kMs, r.fn());
+  EXPECT_EQ(r.out.size(), 3u);
+}
+
+TEST(PublishThrottleTests, FlushAllEmitsFinalState) {
+  PublishThrottle th(100 * kMs, 64);
+  Recorder r;
+  const uint64_t t0 = 1'000 * kMs;
+
+  for (uint64_t iid = 1; iid <= 3; ++iid) {
+    th.offer(book(iid, 1), t0, r.fn());
+    th.offer(book(iid, 2), t0 + kMs, r.fn());
+  }
+  EXPECT_EQ(r.out.size(), 3u);
+  EXPECT_EQ(th.pendingCount(), 3u);
+
+  th.flushAll(r.fn());
+  ASSERT_EQ(r.out.size(), 6u);
+  for (size_t i = 3; i < 6; ++i) EXPECT_EQ(r.out[i].rptSeq, 2u);
+  EXPECT_EQ(th.pendingCount(), 0u);
+}
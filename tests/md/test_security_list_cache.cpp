@@ -0,0 +1,130 @@
+#include "../../b3-md-connector/src/core/SecurityListCache.hpp"
+#include <gtest/gtest.h>
+
+#include <b3/common/InstrumentRegistry.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using namespace b3::md;
+using b3::common::InstrumentData;
+
+namespace {
+
+  std::string tempPath(const char *name) {
+    return "/tmp/b3_md_test_" + std::to_string(::getpid()) + "_" + name + ".cache";
+  }
+
+  InstrumentData instrument(uint64_t iid, const char *symbol) {
+    InstrumentData d;
+    d.securityId = iid;
+    d.symbol = symbol;
+    d.securityExchange = "BVMF";
+    d.securityGroup = "A1";
+    d.currency = "BRL";
+    d.isin = "BRPETRACNPR6";
+    d.securityDesc = "PETROBRAS PN";
+    d.minPriceIncrement = 100;
+    d.lotSize = 100;
+    d.maturityDate = 20261231;
+    d.underlyingSecurityId = (1ull << 32) + 7; // SecurityID de 64 bits
+    d.putOrCall = 1;
+    d.isMultileg = true;
+    return d;
+  }
+
+} // namespace
+
+TEST(SecurityListCacheTests, RoundTripKeepsAllFields) {
+  const std::string path = tempPath("roundtrip");
+  const SecurityListCacheKey key{20261019, 80};
+
+  std::vector<std::pair<b3::common::InstrumentId, InstrumentData>> items;
+  items.emplace_back(42, instrument(42, "PETR4"));
+  items.emplace_back(43, instrument(43, "VALE3"));
+  items.back().second.securityDesc.clear();
+  ASSERT_TRUE(writeSecurityListCache(path, key, items));
+
+  SecurityListCacheReader reader(path, key);
+  ASSERT_TRUE(reader.ok()) << toString(reader.status());
+  ASSERT_EQ(reader.count(), 2u);
+
+  const auto loaded = reader.loadAll();
+  ASSERT_EQ(loaded.size(), 2u);
+  EXPECT_EQ(loaded[0].first, 42u);
+  EXPECT_TRUE(loaded[0].second == items[0].second);
+  EXPECT_TRUE(loaded[1].second == items[1].second);
+  EXPECT_EQ(loaded[0].second.underlyingSecurityId, (1ull << 32) + 7);
+  EXPECT_EQ(loaded[1].second.securityDesc, "");
+
+  std::remove(path.c_str());
+}
+
+TEST(SecurityListCacheTests, RejectsOtherDayChannelAndCorruption) {
+  const std::string path = tempPath("reject");
+  std::vector<std::pair<b3::common::InstrumentId, InstrumentData>> items;
+  items.emplace_back(42, instrument(42, "PETR4"));
+  ASSERT_TRUE(writeSecurityListCache(path, {20261019, 80}, items));
+
+  EXPECT_EQ(SecurityListCacheReader(path, {20261020, 80}).status(),
+            SecurityListCacheStatus::WrongDate);
+  EXPECT_EQ(SecurityListCacheReader(path, {20261019, 81}).status(),
+            SecurityListCacheStatus::WrongChannel);
+  EXPECT_EQ(SecurityListCacheReader(tempPath("nope"), {20261019, 80}).status(),
+            SecurityListCacheStatus::Missing);
+
+  // Un byte del blob de strings alterado: checksum
+  {
+    std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+    f.seekp(-1, std::ios::end);
+    f.put('#');
+  }
+  SecurityListCacheReader corrupt(path, {20261019, 80});
+  EXPECT_EQ(corrupt.status(), SecurityListCacheStatus::Corrupt);
+  EXPECT_EQ(corrupt.count(), 0u);
+
+  std::remove(path.c_str());
+}
+
+TEST(SecurityListCacheTests, SaverWritesOnceLoopCompletes) {
+  const std::string path = tempPath("saver");
+  const SecurityListCacheKey key{20261019, 80};
+
+  b3::common::InstrumentRegistry registry;
+  registry.upsertFull(42, instrument(42, "PETR4"));
+  std::atomic<bool> loopComplete{false};
+
+  SecurityListCacheSaver saver(path, key, registry, loopComplete);
+  // Un item sin símbolo no se escribe: savedCount cuenta solo lo que quedó en el archivo
+  saver.setSource([&registry] {
+    auto items = registry.snapshotAllFull();
+    items.emplace_back(43, InstrumentData{});
+    return items;
+  });
+  saver.start();
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+  EXPECT_FALSE(saver.saved()); // sin loop cerrado no se pisa el cache anterior
+
+  loopComplete.store(true);
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(2000);
+  while (!saver.saved() && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  saver.stop();
+
+  ASSERT_TRUE(saver.saved());
+  EXPECT_EQ(saver.savedCount(), 1u);
+
+  SecurityListCacheReader reader(path, key);
+  ASSERT_TRUE(reader.ok());
+  EXPECT_EQ(reader.count(), 1u);
+  InstrumentData d;
+  ASSERT_TRUE(reader.decode(0, d));
+  EXPECT_EQ(d.symbol, "PETR4");
+  EXPECT_EQ(d.isin, "BRPETRACNPR6");
+
+  std::remove(path.c_str());
+}
@@ -0,0 +1,113 @@
+#include "../../b3-md-connector/src/core/SecurityListIndex.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace b3::md;
+using b3::common::InstrumentData;
+
+namespace {
+
+  SecurityListIndex::Item instrument(uint64_t iid, const char *symbol, const char *segment,
+                                     const char *type, uint64_t underlying = 0,
+                                     uint32_t maturity = 0) {
+    InstrumentData d;
+    d.securityId = iid;
+    d.symbol = symbol;
+    d.marketSegmentId = segment;
+    d.securityType = type;
+    d.underlyingSecurityId = underlying;
+    d.maturityDate = maturity;
+    return {iid, d};
+  }
+
+  std::vector<std::string> symbols(const SecurityListIndex &index, const SecurityListPage &page) {
+    std::vector<std::string> out;
+    for (uint32_t row : page.rows)
+      out.push_back(index.data(row).symbol);
+    return out;
+  }
+
+  SecurityListIndex sample() {
+    std::vector<SecurityListIndex::Item> items;
+    items.push_back(instrument(2, "VALE3", "1", "3"));
+    items.push_back(instrument(1, "PETR4", "1", "3"));
+    items.push_back(instrument(10, "PETRL300", "2", "12", 1, 20261216));
+    items.push_back(instrument(11, "PETRK300", "2", "12", 1, 20261118));
+    items.push_back(instrument(12, "VALEK600", "2", "12", 2, 20261118));
+    items.push_back(instrument(20, "WINZ26", "3", "8", 0, 20261216));
+    items.push_back(instrument(99, "", "1", "3")); // sin símbolo: no se indexa
+    return SecurityListIndex(std::move(items));
+  }
+
+} // namespace
+
+TEST(SecurityListIndexTests, FiltersCombineOverSecondaryIndexes) {
+  const auto index = sample();
+  ASSERT_EQ(index.size(), 6u);
+  EXPECT_EQ(index.data(0).symbol, "PETR4"); // orden por símbolo
+
+  SecurityListQuery q;
+  q.symbolPrefix = "PETR";
+  EXPECT_EQ(symbols(index, index.select(q)),
+            (std::vector<std::string>{"PETR4", "PETRK300", "PETRL300"}));
+
+  q = {};
+  q.underlyingSecurityId = 1;
+  EXPECT_EQ(symbols(index, index.select(q)), (std::vector<std::string>{"PETRK300", "PETRL300"}));
+
+  q = {};
+  q.underlyingSecurityId = 1; // el SecurityID es de 64 bits: no truncar
+  std::vector<SecurityListIndex::Item> wide;
+  wide.push_back(instrument(1, "PETR4", "1", "3"));
+  wide.push_back(instrument(30, "BIGK100", "2", "12", (1ull << 32) + 1, 20261118));
+  const SecurityListIndex wideIndex(std::move(wide));
+  EXPECT_TRUE(wideIndex.select(q).rows.empty());
+  q.underlyingSecurityId = (1ull << 32) + 1;
+  EXPECT_EQ(symbols(wideIndex, wideIndex.select(q)), (std::vector<std::string>{"BIGK100"}));
+
+  q = {};
+  q.marketSegmentId = "2";
+  q.maturityFrom = 20261101;
+  q.maturityTo = 20261130;
+  EXPECT_EQ(symbols(index, index.select(q)), (std::vector<std::string>{"PETRK300", "VALEK600"}));
+
+  q = {};
+  q.securityTypes = {"3", "8"};
+  EXPECT_EQ(symbols(index, index.select(q)),
+            (std::vector<std::string>{"PETR4", "VALE3", "WINZ26"}));
+
+  q = {};
+  q.symbol = "VALE3";
+  q.marketSegmentId = "2";
+  EXPECT_TRUE(index.select(q).rows.empty());
+
+  q = {};
+  q.symbol = "NOPE";
+  EXPECT_EQ(index.select(q).total, 0u);
+  EXPECT_EQ(index.findSymbol("NOPE"), index.size());
+}
+
+TEST(SecurityListIndexTests, PaginatesInSymbolOrder) {
+  const auto index = sample();
+
+  SecurityListQuery q;
+  q.limit = 4;
+  auto page = index.select(q);
+  EXPECT_EQ(page.total, 6u);
+  EXPECT_FALSE(page.last);
+  EXPECT_EQ(symbols(index, page),
+            (std::vector<std::string>{"PETR4", "PETRK300", "PETRL300", "VALE3"}));
+
+  q.offset = 4;
+  page = index.select(q);
+  EXPECT_TRUE(page.last);
+  EXPECT_EQ(symbols(index, page), (std::vector<std::string>{"VALEK600", "WINZ26"}));
+
+  q.offset = 10;
+  page = index.select(q);
+  EXPECT_TRUE(page.rows.empty());
+  EXPECT_TRUE(page.last);
+}
@@ -0,0 +1,308 @@
+#include <gtest/gtest.h>
+
+#include "../../b3-md-connector/src/core/MdPublishPipeline.hpp"
+#include "../../b3-md-connector/src/core/MdPublishWorker.hpp"
+#include "../../b3-md-connector/src/mapping/MdSnapshotMapper.hpp"
+#include "../../b3-md-connector/src/publishing/SequencedReorder.hpp"
+#include "../../b3-md-connector/src/publishing/SerializerPool.hpp"
+#include "../../b3-md-connector/src/testsupport/FakeInstrumentTopicMapper.hpp"
+#include "FakePublishSink.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace b3::md;
+
+namespace {
+
+  // Payload de texto iid=..;ts=..; con costo variable por evento (serializers desparejos
+  // => terminan fuera de orden y el reorder tiene trabajo). failEvery>0: falla ts%failEvery==0.
+  class JitterMdSnapshotMapper final : public b3::md::mapping::MdSnapshotMapper {
+   public:
+    explicit JitterMdSnapshotMapper(uint64_t failEvery = 0) : failEvery_(failEvery) {}
+
+    bool mapToSerializedEnvelope(const b3::md::BookSnapshot &s,
+                                 b3::md::publishing::SerializedEnvelope &ev, const char *topic,
+                                 std::uint8_t topicLen) const noexcept override {
+      if (failEvery_ && s.exchangeTsNs % failEvery_ == 0)
+        return false;
+
+      if ((s.exchangeTsNs * 2654435761u) % 7 == 0)
+        std::this_thread::sleep_for(std::chrono::microseconds(20));
+
+      char buf[128];
+      int n = std::snprintf(buf, sizeof(buf), "iid=%llu;ts=%llu;",
+                            static_cast<unsigned long long>(s.instrumentId),
+                            static_cast<unsigned long long>(s.exchangeTsNs));
+      if (n <= 0 || static_cast<size_t>(n) >= sizeof(buf))
+        return false;
+      ev.size = static_cast<uint32_t>(n);
+      std::memcpy(ev.bytes, buf, n);
+      ev.topicLen = topicLen;
+      std::memcpy(ev.topic, topic, topicLen);
+      return true;
+    }
+
+   private:
+    uint64_t failEvery_;
+  };
+
+  // Serializer trabado a pedido: el book (gateIid, ts=0) espera en el mapper hasta open().
+  class GatedMdSnapshotMapper final : public b3::md::mapping::MdSnapshotMapper {
+   public:
+    explicit GatedMdSnapshotMapper(uint64_t gateIid) : gateIid_(gateIid) {}
+
+    bool mapToSerializedEnvelope(const b3::md::BookSnapshot &s,
+                                 b3::md::publishing::SerializedEnvelope &ev, const char *topic,
+                                 std::uint8_t topicLen) const noexcept override {
+      if (s.instrumentId == gateIid_ && s.exchangeTsNs == 0) {
+        entered.store(true, std::memory_order_release);
+        while (!open_.load(std::memory_order_acquire))
+          std::this_thread::sleep_for(std::chrono::microseconds(50));
+      }
+      const int n = std::snprintf(reinterpret_cast<char *>(ev.bytes), 64, "iid=%llu;ts=%llu;",
+                                  static_cast<unsigned long long>(s.instrumentId),
+                                  static_cast<unsigned long long>(s.exchangeTsNs));
+      ev.size = static_cast<uint32_t>(n);
+      ev.topicLen = topicLen;
+      std::memcpy(ev.topic, topic, topicLen);
+      return true;
+    }
+
+    void open() noexcept { open_.store(true, std::memory_order_release); }
+
+    mutable std::atomic<bool> entered{false};
+
+   private:
+    uint64_t gateIid_;
+    std::atomic<bool> open_{false};
+  };
+
+  // ISequencedSink de test: mismo SequencedReorder que el concentrator, drenado por un thread
+  // que vuelca en un FakePublishSink (en orden de wire).
+  class FakeSequencedSink final : public b3::md::publishing::ISequencedSink,
+                                  public b3::md::publishing::IPublishSink {
+   public:
+    FakeSequencedSink(uint32_t shards, uint32_t producers, uint32_t perQueueCapacity = 64)
+        : shards_(shards), reorder_(shards, producers, QueueConfig{perQueueCapacity, false},
+                                    /*deferFirstTouch=*/false) {
+      drain_ = std::thread([this] {
+        while (running_.load(std::memory_order_acquire) || reorder_.pendingApprox() > 0) {
+          uint32_t sent = 0;
+          for (uint32_t s = 0; s < shards_; ++s) {
+            sent += reorder_.drainShard(s, 8, [&](const publishing::SerializedEnvelope &ev) {
+              (void)out.tryPublish(s, ev);
+            });
+          }
+          if (sent == 0)
+            std::this_thread::yield();
+        }
+      });
+    }
+
+    ~FakeSequencedSink() {
+      running_.store(false, std::memory_order_release);
+      drain_.join();
+    }
+
+    bool tryPublishSequenced(uint32_t shardId, uint32_t producer, uint64_t seq,
+                             const publishing::SerializedEnvelope *ev) noexcept override {
+      return reorder_.tryPush(shardId, producer, seq, ev);
+    }
+
+    uint64_t deliveredSeq(uint32_t shardId) const noexcept override {
+      return reorder_.delivered(shardId);
+    }
+
+    // El worker exige un IPublishSink aunque en modo etapa no lo use
+    bool tryPublish(uint32_t, const publishing::SerializedEnvelope &) noexcept override {
+      return false;
+    }
+
+    testsupport::FakePublishSink out;
+
+   private:
+    uint32_t shards_;
+    publishing::SequencedReorder reorder_;
+    std::atomic<bool> running_{true};
+    std::thread drain_;
+  };
+
+  uint64_t ParseTs(const std::string &bytes) {
+    const auto pos = bytes.find(";ts=") + 4;
+    return std::stoull(bytes.substr(pos, bytes.find(';', pos) - pos));
+  }
+
+  bool WaitForCount(const testsupport::FakePublishSink &sink, size_t n) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (sink.count() < n && std::chrono::steady_clock::now() < deadline)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return sink.count() >= n;
+  }
+
+  // delivered() avanza DESPUÉS del send: puede quedar un instante detrás del count()
+  bool WaitDelivered(const publishing::SerializerPool &pool, uint32_t shard) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!pool.deliveredUpTo(shard, pool.acceptedCount(shard)) &&
+           std::chrono::steady_clock::now() < deadline)
+      std::this_thread::yield();
+    return pool.deliveredUpTo(shard, pool.acceptedCount(shard));
+  }
+
+  void Submit(publishing::SerializerPool &pool, uint32_t shard, uint64_t iid, uint64_t ts) {
+    BookSnapshot b{};
+    b.instrumentId = iid;
+    b.exchangeTsNs = ts;
+    while (!pool.trySubmit(shard, b, "HOT", 3)) std::this_thread::yield();
+  }
+
+} // namespace
+
+TEST(SerializerPoolTests, HotInstrumentKeepsOrderAcrossSerializers) {
+  JitterMdSnapshotMapper mapper;
+  FakeSequencedSink sink(1, 3);
+  publishing::SerializerPool pool(1, 3, mapper, sink, 64);
+  pool.start();
+
+  constexpr uint64_t N = 20'000;
+  for (uint64_t ts = 0; ts < N; ++ts) Submit(pool, 0, 7, ts);
+
+  ASSERT_TRUE(WaitForCount(sink.out, N));
+  pool.stop(true);
+
+  EXPECT_EQ(pool.serialized(), N);
+  ASSERT_TRUE(WaitDelivered(pool, 0));
+  EXPECT_EQ(sink.deliveredSeq(0), N);
+  for (size_t i = 0; i < N; ++i) ASSERT_EQ(ParseTs(sink.out.at(i).bytes), i) << "reorden roto";
+}
+
+TEST(SerializerPoolTests, SerializationFailureSkipsSeqWithoutStallingShard) {
+  JitterMdSnapshotMapper mapper(/*failEvery=*/5);
+  FakeSequencedSink sink(2, 2);
+  publishing::SerializerPool pool(2, 2, mapper, sink, 64);
+  pool.start();
+
+  constexpr uint64_t N = 1'000;
+  for (uint64_t ts = 1; ts <= N; ++ts) {
+    Submit(pool, 0, 7, ts);
+    Submit(pool, 1, 9, ts);
+  }
+  pool.stop(true);
+
+  const size_t expected = 2 * (N - N / 5);
+  ASSERT_TRUE(WaitForCount(sink.out, expected));
+  EXPECT_EQ(pool.serializeFailed(), 2 * (N / 5));
+  ASSERT_TRUE(WaitDelivered(pool, 0));
+  ASSERT_TRUE(WaitDelivered(pool, 1));
+  EXPECT_EQ(sink.deliveredSeq(0), N); // las skips también avanzan la seq
+  EXPECT_EQ(sink.deliveredSeq(1), N);
+
+  uint64_t last[2] = {0, 0};
+  for (size_t i = 0; i < expected; ++i) {
+    const auto msg = sink.out.at(i);
+    const uint64_t ts = ParseTs(msg.bytes);
+    EXPECT_NE(ts % 5, 0u);
+    ASSERT_GT(ts, last[msg.shardId]) << "FIFO roto en shard " << msg.shardId;
+    last[msg.shardId] = ts;
+  }
+}
+
+TEST(SerializerPoolTests, WorkerHandsBooksToStageInShardOrder) {
+  JitterMdSnapshotMapper mapper;
+  FakeSequencedSink sink(2, 3);
+  testsupport::FakeInstrumentTopicMapper topics{{7, "AAA"}, {8, "BBB"}};
+  publishing::SerializerPool pool(2, 3, mapper, sink);
+  pool.start();
+
+  std::vector<std::unique_ptr<MdPublishWorker>> workers;
+  for (uint32_t i = 0; i < 2; ++i) {
+    workers.emplace_back(std::make_unique<MdPublishWorker>(i, mapper, sink, topics.get()));
+    workers.back()->attachSerializeStage(&pool);
+  }
+  MdPublishPipeline pipeline(std::move(workers));
+  pipeline.start();
+
+  constexpr uint64_t N = 5'000;
+  for (uint64_t ts = 0; ts < N; ++ts) {
+    for (uint64_t iid : {7ull, 8ull}) {
+      OrdersSnapshot s{};
+      s.instrumentId = iid;
+      s.exchangeTsNs = ts;
+      while (!pipeline.tryEnqueue(s)) std::this_thread::yield();
+    }
+  }
+
+  // Drain ordenado: workers -> serializers -> reorder
+  pipeline.stop(true);
+  pool.stop(true);
+
+  // Cola job llena => drop en el worker (contrato de overflow), nunca un hueco en la seq
+  const uint64_t accepted = pool.acceptedCount(0) + pool.acceptedCount(1);
+  EXPECT_EQ(accepted + pool.dropped(), 2 * N);
+  ASSERT_TRUE(WaitForCount(sink.out, accepted));
+  ASSERT_TRUE(WaitDelivered(pool, 0));
+  ASSERT_TRUE(WaitDelivered(pool, 1));
+  EXPECT_EQ(sink.deliveredSeq(0), pool.acceptedCount(0));
+  EXPECT_EQ(sink.deliveredSeq(1), pool.acceptedCount(1));
+
+  int64_t last[2] = {-1, -1};
+  for (size_t i = 0; i < accepted; ++i) {
+    const auto msg = sink.out.at(i);
+    const size_t k = msg.topic == "AAA" ? 0 : 1;
+    const auto ts = static_cast<int64_t>(ParseTs(msg.bytes));
+    ASSERT_GT(ts, last[k]) << "FIFO roto para " << msg.topic;
+    last[k] = ts;
+  }
+}
+
+TEST(SerializerPoolTests, SlowSerializerDoesNotDeadlockAcrossShards) {
+  // T=2: seq par -> serializer 0, impar -> serializer 1. Colas del reorder de 4.
+  GatedMdSnapshotMapper mapper(/*gateIid=*/8);
+  FakeSequencedSink sink(2, 2, /*perQueueCapacity=*/4);
+  publishing::SerializerPool pool(2, 2, mapper, sink, 64);
+  pool.start();
+
+  BookSnapshot b{};
+  auto submit = [&](uint32_t shard, uint64_t from, uint64_t to) {
+    for (uint64_t ts = from; ts < to; ++ts) {
+      b.instrumentId = 7 + shard;
+      b.exchangeTsNs = ts;
+      ASSERT_TRUE(pool.trySubmit(shard, b, "HOT", 3));
+    }
+  };
+
+  // 1) serializer 0 queda lento en el shard 1 (seq 0)
+  submit(1, 0, 2);
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (!mapper.entered.load(std::memory_order_acquire) &&
+         std::chrono::steady_clock::now() < deadline)
+    std::this_thread::yield();
+  ASSERT_TRUE(mapper.entered.load());
+
+  // 2) serializer 1 llena su cola del shard 0 (falta la seq 0, en la cola job del lento)
+  submit(0, 0, 20);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  // 3) el shard 1 necesita las impares del serializer 1; el lento se libera y llena la suya.
+  //    Antes: cada uno girando en un shard con lo que el otro necesita en su cola job.
+  submit(1, 2, 20);
+  mapper.open();
+
+  constexpr uint64_t N = 20;
+  ASSERT_TRUE(WaitForCount(sink.out, 2 * N)) << "serializers trabados";
+  pool.stop(true);
+  ASSERT_TRUE(WaitDelivered(pool, 0));
+  ASSERT_TRUE(WaitDelivered(pool, 1));
+  EXPECT_EQ(pool.publishedCount(0), N);
+  EXPECT_EQ(pool.publishedCount(1), N);
+
+  uint64_t next[2] = {0, 0};
+  for (size_t i = 0; i < 2 * N; ++i) {
+    const auto msg = sink.out.at(i);
+    ASSERT_EQ(ParseTs(msg.bytes), next[msg.shardId]++) << "FIFO roto en shard " << msg.shardId;
+  }
+}
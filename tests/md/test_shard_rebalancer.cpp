@@ -0,0 +1,226 @@
+#include <gtest/gtest.h>
+
+#include "../../b3-md-connector/src/core/MdPublishPipeline.hpp"
+#include "../../b3-md-connector/src/core/MdPublishWorker.hpp"
+#include "../../b3-md-connector/src/core/ShardRebalancer.hpp"
+#include "../../b3-md-connector/src/mapping/MdSnapshotMapper.hpp"
+#include "../../b3-md-connector/src/testsupport/FakeInstrumentTopicMapper.hpp"
+#include "FakePublishSink.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace b3::md;
+
+namespace {
+
+  // Payload de texto: iid=123;ts=456
+  class TestMdSnapshotMapper final : public b3::md::mapping::MdSnapshotMapper {
+   public:
+    bool mapToSerializedEnvelope(const b3::md::BookSnapshot &s,
+                                 b3::md::publishing::SerializedEnvelope &ev, const char *topic,
+                                 std::uint8_t topicLen) const noexcept override {
+      char buf[128];
+      int n = std::snprintf(buf, sizeof(buf), "iid=%llu;ts=%llu;",
+                            static_cast<unsigned long long>(s.instrumentId),
+                            static_cast<unsigned long long>(s.exchangeTsNs));
+      if (n <= 0 || static_cast<size_t>(n) >= sizeof(buf))
+        return false;
+      ev.size = static_cast<uint32_t>(n);
+      std::memcpy(ev.bytes, buf, n);
+      ev.topicLen = topicLen;
+      std::memcpy(ev.topic, topic, topicLen);
+      return true;
+    }
+  };
+
+  uint64_t ParseTs(const std::string &bytes) {
+    const auto pos = bytes.find(";ts=") + 4;
+    return std::stoull(bytes.substr(pos, bytes.find(';', pos) - pos));
+  }
+
+  uint32_t HashShard(uint64_t iid, uint32_t shards) {
+    return static_cast<uint32_t>((iid * 11400714819323198485ull) % shards);
+  }
+
+  // Primeros `n` instrumentos (>0) que el hash manda a `shard`
+  std::vector<uint64_t> InstrumentsOnShard(uint32_t shard, uint32_t shards, size_t n) {
+    std::vector<uint64_t> out;
+    for (uint64_t iid = 1; out.size() < n; ++iid) {
+      if (HashShard(iid, shards) == shard)
+        out.push_back(iid);
+    }
+    return out;
+  }
+
+  MdPublishPipeline BuildPipeline(uint32_t shards, TestMdSnapshotMapper &mapper,
+                                  testsupport::FakePublishSink &sink,
+                                  testsupport::FakeInstrumentTopicMapper &topics) {
+    std::vector<std::unique_ptr<MdPublishWorker>> workers;
+    for (uint32_t i = 0; i < shards; ++i)
+      workers.emplace_back(std::make_unique<MdPublishWorker>(i, mapper, sink, topics.get()));
+    return MdPublishPipeline(std::move(workers));
+  }
+
+  void Enqueue(MdPublishPipeline &pipeline, uint64_t iid, uint64_t ts) {
+    OrdersSnapshot s{};
+    s.instrumentId = iid;
+    s.exchangeTsNs = ts;
+    while (!pipeline.tryEnqueue(s)) std::this_thread::yield();
+  }
+
+  bool WaitNoHandoff(const MdPublishPipeline &pipeline) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (pipeline.handoffPending() && std::chrono::steady_clock::now() < deadline)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return !pipeline.handoffPending();
+  }
+
+  bool WaitForCount(const testsupport::FakePublishSink &sink, size_t n) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (sink.count() < n && std::chrono::steady_clock::now() < deadline)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return sink.count() >= n;
+  }
+
+} // namespace
+
+TEST(ShardRebalancerTests, PlanMovePicksInstrumentThatNarrowsGap) {
+  ShardRebalancer::Move mv{};
+  std::vector<std::vector<std::pair<uint64_t, uint64_t>>> rates(2);
+  rates[0] = {{1, 850}, {2, 400}, {3, 150}};
+
+  ASSERT_TRUE(ShardRebalancer::planMove({1400, 500}, rates, 1.5, 0, mv));
+  EXPECT_EQ(mv.instrumentId, 2u); // 900 de gap: 400 deja 1000/900
+  EXPECT_EQ(mv.from, 0u);
+  EXPECT_EQ(mv.to, 1u);
+
+  // Balanceado por debajo del ratio
+  EXPECT_FALSE(ShardRebalancer::planMove({1000, 900}, rates, 1.5, 0, mv));
+
+  // Por debajo de la carga mínima
+  EXPECT_FALSE(ShardRebalancer::planMove({1400, 500}, rates, 1.5, 5000, mv));
+
+  // Un único instrumento que es todo el shard: moverlo solo traslada el problema
+  rates[0] = {{1, 1000}};
+  EXPECT_FALSE(ShardRebalancer::planMove({1000, 0}, rates, 1.5, 0, mv));
+}
+
+TEST(ShardRebalancerTests, StepMovesHotInstrumentOffOverloadedShard) {
+  testsupport::FakePublishSink sink;
+  TestMdSnapshotMapper mapper;
+  const auto ids = InstrumentsOnShard(0, 2, 3);
+  testsupport::FakeInstrumentTopicMapper topics{{ids[0], "AAA"}, {ids[1], "BBB"}, {ids[2], "CCC"}};
+
+  auto pipeline = BuildPipeline(2, mapper, sink, topics);
+  pipeline.start();
+
+  uint64_t ts = 0;
+  for (int i = 0; i < 600; ++i) Enqueue(pipeline, ids[0], ts++);
+  for (int i = 0; i < 300; ++i) Enqueue(pipeline, ids[1], ts++);
+  for (int i = 0; i < 100; ++i) Enqueue(pipeline, ids[2], ts++);
+  ASSERT_TRUE(WaitForCount(sink, 1000));
+
+  RebalanceConfig cfg;
+  cfg.minEventsPerSec = 0;
+  ShardRebalancer rebalancer(pipeline, cfg);
+
+  ASSERT_TRUE(rebalancer.step());
+  EXPECT_EQ(rebalancer.moves(), 1u);
+  EXPECT_EQ(pipeline.currentShard(ids[0]), 1u);
+  EXPECT_TRUE(pipeline.handoffPending());
+
+  // Mientras el handoff no se completa no hay otro movimiento
+  EXPECT_FALSE(rebalancer.step());
+
+  // Primer evento en el shard nuevo completa el handoff
+  Enqueue(pipeline, ids[0], ts++);
+  ASSERT_TRUE(WaitForCount(sink, 1001));
+  pipeline.stop(true);
+
+  EXPECT_FALSE(pipeline.handoffPending());
+  EXPECT_EQ(pipeline.worker(1).handoffs(), 1u);
+  EXPECT_EQ(sink.at(1000).shardId, 1u);
+}
+
+TEST(ShardRebalancerTests, QuietInstrumentCompletesHandoffWithoutEvents) {
+  testsupport::FakePublishSink sink;
+  TestMdSnapshotMapper mapper;
+  const auto ids = InstrumentsOnShard(0, 2, 2);
+  testsupport::FakeInstrumentTopicMapper topics{{ids[0], "AAA"}, {ids[1], "BBB"}};
+
+  auto pipeline = BuildPipeline(2, mapper, sink, topics);
+  pipeline.start();
+
+  Enqueue(pipeline, ids[0], 1);
+  ASSERT_TRUE(WaitForCount(sink, 1));
+
+  // El instrumento movido no vuelve a tener eventos: el handoff igual se cierra
+  ASSERT_TRUE(pipeline.moveInstrument(ids[0], 1));
+  ASSERT_TRUE(WaitNoHandoff(pipeline));
+  EXPECT_EQ(pipeline.worker(1).handoffs(), 1u);
+
+  // ...y el rebalanceo no queda trabado
+  ASSERT_TRUE(pipeline.moveInstrument(ids[1], 1));
+  EXPECT_TRUE(WaitNoHandoff(pipeline));
+  pipeline.stop(true);
+
+  EXPECT_EQ(pipeline.worker(1).handoffs(), 2u);
+  EXPECT_EQ(pipeline.worker(1).handoffTimeouts(), 0u);
+  EXPECT_EQ(sink.count(), 1u);
+}
+
+TEST(ShardRebalancerTests, HandoffPreservesFifoWhileMovingUnderLoad) {
+  testsupport::FakePublishSink sink;
+  TestMdSnapshotMapper mapper;
+  testsupport::FakeInstrumentTopicMapper topics{{7, "HOT"}};
+
+  auto pipeline = BuildPipeline(2, mapper, sink, topics);
+  pipeline.start();
+
+  constexpr uint64_t N = 100'000;
+  std::atomic<bool> done{false};
+  std::thread producer([&] {
+    for (uint64_t ts = 0; ts < N; ++ts) Enqueue(pipeline, 7, ts);
+    done.store(true);
+  });
+
+  // Ida y vuelta entre shards mientras hay backlog en ambos lados
+  int moves = 0;
+  while (!done.load()) {
+    if (!pipeline.handoffPending() && pipeline.moveInstrument(7, 1 - pipeline.currentShard(7)))
+      ++moves;
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  producer.join();
+
+  pipeline.stop(true);
+
+  EXPECT_GT(moves, 1);
+  EXPECT_EQ(pipeline.worker(0).handoffTimeouts() + pipeline.worker(1).handoffTimeouts(), 0u);
+
+  // El destino no espera: estaciona el último book mientras el origen drena (los intermedios
+  // reemplazados se cuentan). Lo publicado sigue en orden y el último book siempre sale.
+  const uint64_t conflated =
+      pipeline.worker(0).handoffConflated() + pipeline.worker(1).handoffConflated();
+  ASSERT_EQ(sink.count() + conflated, N);
+
+  std::set<uint32_t> shardsSeen;
+  uint64_t last = 0;
+  for (size_t i = 0; i < sink.count(); ++i) {
+    const auto msg = sink.at(i);
+    shardsSeen.insert(msg.shardId);
+    const uint64_t ts = ParseTs(msg.bytes);
+    if (i > 0) {
+      ASSERT_GT(ts, last) << "FIFO roto en el handoff";
+    }
+    last = ts;
+  }
+  EXPECT_EQ(last, N - 1);
+  EXPECT_EQ(shardsSeen.size(), 2u);
+}
@@ -0,0 +1,143 @@
+#include "../../b3-md-connector/src/publishing/ShmRingReader.hpp"
+#include "../../b3-md-connector/src/publishing/ShmRingWriter.hpp"
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace b3::md::publishing;
+
+namespace {
+
+  std::string ringName(const char *tag) {
+    return "/b3md_test_" + std::string(tag) + "_" + std::to_string(::getpid());
+  }
+
+  bool publishText(ShmRingWriter &w, const std::string &topic, const std::string &payload,
+                   uint64_t ts = 0) {
+    return w.publish(topic.data(), static_cast<uint8_t>(topic.size()),
+                     reinterpret_cast<const uint8_t *>(payload.data()),
+                     static_cast<uint32_t>(payload.size()), ts);
+  }
+
+  struct Received {
+    uint64_t seq;
+    std::string topic;
+    std::string payload;
+  };
+
+  size_t drain(ShmRingReader &r, std::vector<Received> &out) {
+    return r.poll([&](const ShmRingReader::Message &m) {
+      out.push_back({m.seq, std::string(m.topic),
+                     std::string(reinterpret_cast<const char *>(m.payload), m.size)});
+    });
+  }
+
+} // namespace
+
+TEST(ShmRingTests, ReadersGetEveryMessageWithOwnCursors) {
+  ShmRingWriter w(ringName("rt"), 8, 256);
+  w.start();
+
+  ShmRingReader early;
+  ASSERT_EQ(early.attach(w.name()), ShmRingStatus::Attached);
+
+  ASSERT_TRUE(publishText(w, "PETR4", "book-1", 11));
+  ASSERT_TRUE(publishText(w, "VALE3", "book-2"));
+
+  // Se engancha después: arranca en lo próximo, salvo seekToOldest()
+  ShmRingReader late;
+  ASSERT_EQ(late.attach(w.name()), ShmRingStatus::Attached);
+  std::vector<Received> lateOut;
+  EXPECT_EQ(drain(late, lateOut), 0u);
+  late.seekToOldest();
+  EXPECT_EQ(drain(late, lateOut), 2u);
+
+  std::vector<Received> out;
+  ASSERT_EQ(drain(early, out), 2u);
+  EXPECT_EQ(out[0].seq, 0u);
+  EXPECT_EQ(out[0].topic, "PETR4");
+  EXPECT_EQ(out[0].payload, "book-1");
+  EXPECT_EQ(out[1].topic, "VALE3");
+  EXPECT_EQ(out[1].payload, "book-2");
+  EXPECT_EQ(drain(early, out), 0u);
+  EXPECT_EQ(early.lost(), 0u);
+
+  // Más grande que un slot: no se escribe, pero consume su seq y el reader lo ve como perdido
+  EXPECT_FALSE(publishText(w, "PETR4", std::string(300, 'x')));
+  EXPECT_EQ(w.oversize(), 1u);
+  ASSERT_TRUE(publishText(w, "VALE3", "book-4"));
+  out.clear();
+  ASSERT_EQ(drain(early, out), 1u);
+  EXPECT_EQ(out[0].seq, 3u);
+  EXPECT_EQ(out[0].payload, "book-4");
+  EXPECT_EQ(early.lost(), 1u);
+
+  w.stop();
+  EXPECT_TRUE(early.writerClosed());
+  ShmRingReader after;
+  EXPECT_EQ(after.attach(w.name()), ShmRingStatus::Missing);
+}
+
+TEST(ShmRingTests, SlowReaderDetectsOverwriteAndResyncs) {
+  ShmRingWriter w(ringName("lap"), 8, 128);
+  w.start();
+
+  ShmRingReader r;
+  ASSERT_EQ(r.attach(w.name()), ShmRingStatus::Attached);
+
+  for (int i = 0; i < 20; ++i) ASSERT_TRUE(publishText(w, "WINZ25", std::to_string(i)));
+
+  std::vector<Received> out;
+  drain(r, out);
+  ASSERT_FALSE(out.empty());
+  EXPECT_GT(r.lost(), 0u);
+  EXPECT_EQ(r.lost() + out.size(), 20u); // nada duplicado ni inventado
+  for (size_t i = 1; i < out.size(); ++i) EXPECT_EQ(out[i].seq, out[i - 1].seq + 1);
+  EXPECT_EQ(out.back().payload, "19");
+}
+
+TEST(ShmRingTests, StartRefusesLiveRingAndReplacesOrphan) {
+  const std::string name = ringName("owner");
+  ShmRingWriter first(name, 8, 128);
+  first.start();
+  ShmRingReader r;
+  ASSERT_EQ(r.attach(first.name()), ShmRingStatus::Attached);
+
+  // Otro writer con el mismo nombre no desvincula el ring vivo
+  ShmRingWriter second(name, 8, 128);
+  EXPECT_THROW(second.start(), std::runtime_error);
+  EXPECT_FALSE(second.running());
+  ASSERT_TRUE(publishText(first, "PETR4", "still-here"));
+  std::vector<Received> out;
+  EXPECT_EQ(drain(r, out), 1u);
+  EXPECT_FALSE(r.writerClosed());
+  first.stop();
+
+  // Writer que murió sin stop(): el segmento queda con un pid muerto y se reemplaza
+  const pid_t child = ::fork();
+  ASSERT_GE(child, 0);
+  if (child == 0) {
+    ShmRingWriter orphan(name, 8, 128);
+    orphan.start();
+    ::_exit(0); // sin destructores: no hay stop()
+  }
+  int status = 0;
+  ASSERT_EQ(::waitpid(child, &status, 0), child);
+  ASSERT_EQ(r.attach(name), ShmRingStatus::Attached); // el segmento del hijo sigue ahí
+  EXPECT_TRUE(r.writerClosed()); // closed nunca se marcó, pero el pid ya no existe
+
+  second.start();
+  EXPECT_TRUE(second.running());
+  ShmRingReader fresh;
+  ASSERT_EQ(fresh.attach(name), ShmRingStatus::Attached);
+  EXPECT_FALSE(fresh.writerClosed());
+  ASSERT_TRUE(publishText(second, "VALE3", "new-writer"));
+  out.clear();
+  EXPECT_EQ(drain(fresh, out), 1u);
+  second.stop();
+}
@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+
+#include "../../b3-md-connector/src/core/MarketDataEngine.hpp"
+#include "../../b3-md-connector/src/core/MdPublishPipeline.hpp"
+#include "../../b3-md-connector/src/core/MdPublishWorker.hpp"
+#include "../../b3-md-connector/src/core/SnapshotJournal.hpp"
+#include "../../b3-md-connector/src/mapping/MdSnapshotMapper.hpp"
+#include "../../b3-md-connector/src/testsupport/FakeInstrumentTopicMapper.hpp"
+#include "FakePublishSink.hpp"
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace b3::md;
+
+namespace {
+
+  std::string TempJournalPath(const char *name) {
+    return (std::filesystem::temp_directory_path() /
+            (std::string("b3md_") + name + "_" + std::to_string(::getpid()) + ".jnl"))
+        .string();
+  }
+
+  OrdersSnapshot MakeSnapshot(uint64_t iid, uint64_t ts, uint16_t bids, uint16_t asks) {
+    OrdersSnapshot s{};
+    s.instrumentId = iid;
+    s.exchangeTsNs = ts;
+    s.rptSeq = ts * 2;
+    s.channelSeq = ts * 3;
+    s.bidCountRaw = static_cast<uint16_t>(bids + 1);
+    s.askCountRaw = asks;
+    s.bidsCopied = bids;
+    s.asksCopied = asks;
+    s.bidTruncated = 1;
+    for (uint16_t i = 0; i < bids; ++i) s.bids[i] = {static_cast<int64_t>(1000 - i), i + 1};
+    for (uint16_t i = 0; i < asks; ++i) s.asks[i] = {static_cast<int64_t>(1001 + i), 2 * i + 1};
+    return s;
+  }
+
+  void ExpectSameSnapshot(const OrdersSnapshot &a, const OrdersSnapshot &b) {
+    EXPECT_EQ(a.instrumentId, b.instrumentId);
+    EXPECT_EQ(a.exchangeTsNs, b.exchangeTsNs);
+    EXPECT_EQ(a.rptSeq, b.rptSeq);
+    EXPECT_EQ(a.channelSeq, b.channelSeq);
+    EXPECT_EQ(a.bidCountRaw, b.bidCountRaw);
+    EXPECT_EQ(a.askCountRaw, b.askCountRaw);
+    EXPECT_EQ(a.bidTruncated, b.bidTruncated);
+    EXPECT_EQ(a.askTruncated, b.askTruncated);
+    ASSERT_EQ(a.bidsCopied, b.bidsCopied);
+    ASSERT_EQ(a.asksCopied, b.asksCopied);
+    // Comparación completa: las entradas fuera del prefijo también tienen que quedar en cero
+    EXPECT_EQ(std::memcmp(a.bids, b.bids, sizeof(a.bids)), 0);
+    EXPECT_EQ(std::memcmp(a.asks, b.asks, sizeof(a.asks)), 0);
+  }
+
+} // namespace
+
+TEST(SnapshotJournalTests, EncodesOnlyCopiedPrefixAndRoundTrips) {
+  const OrdersSnapshot deep = MakeSnapshot(7, 100, 40, 3);
+  const OrdersSnapshot shallow = MakeSnapshot(7, 101, 2, 0);
+
+  std::vector<unsigned char> buf(journal::encodedSize(deep));
+  EXPECT_EQ(buf.size(), sizeof(JournalSnapshotHead) + 43 * sizeof(OrdersSnapshot::OrderEntry));
+  ASSERT_EQ(journal::encode(deep, buf.data()), buf.size());
+
+  OrdersSnapshot out{};
+  ASSERT_TRUE(journal::decode(buf.data(), buf.size(), out));
+  ExpectSameSnapshot(out, deep);
+
+  // Reusar `out` con un libro más chico no deja órdenes viejas colgadas
+  buf.assign(journal::encodedSize(shallow), 0);
+  journal::encode(shallow, buf.data());
+  ASSERT_TRUE(journal::decode(buf.data(), buf.size(), out));
+  ExpectSameSnapshot(out, shallow);
+
+  // Payload truncado => rechazado
+  EXPECT_FALSE(journal::decode(buf.data(), buf.size() - 1, out));
+}
+
+TEST(SnapshotJournalTests, WriterGrowsFileAndReaderReplaysInOrder) {
+  const std::string path = TempJournalPath("grow");
+
+  constexpr uint64_t N = 2'000;
+  {
+    JournalConfig cfg;
+    cfg.path = path;
+    cfg.queue = {256, false};
+    cfg.growBytes = 1; // se clampa al mínimo (1MB): N libros de ~3KB fuerzan varios remaps
+    SnapshotJournalWriter writer(cfg);
+    writer.start();
+
+    for (uint64_t i = 0; i < N; ++i) {
+      const auto s = MakeSnapshot(1 + i % 3, i, static_cast<uint16_t>(i % 200), 5);
+      while (!writer.tryAppend(s, 1'000 + i)) std::this_thread::yield();
+    }
+    writer.stop();
+
+    EXPECT_EQ(writer.written(), N);
+    EXPECT_EQ(writer.writeErrors(), 0u);
+    EXPECT_EQ(std::filesystem::file_size(path), writer.bytesWritten());
+  }
+
+  SnapshotJournalReader reader(path);
+  OrdersSnapshot s{};
+  uint64_t captureNs = 0;
+  for (uint64_t i = 0; i < N; ++i) {
+    ASSERT_TRUE(reader.next(s, captureNs)) << "record " << i;
+    EXPECT_EQ(captureNs, 1'000 + i);
+    ExpectSameSnapshot(s, MakeSnapshot(1 + i % 3, i, static_cast<uint16_t>(i % 200), 5));
+  }
+  EXPECT_FALSE(reader.next(s, captureNs));
+  EXPECT_FALSE(reader.truncated());
+
+  reader.rewind();
+  ASSERT_TRUE(reader.next(s, captureNs));
+  EXPECT_EQ(s.exchangeTsNs, 0u);
+
+  std::filesystem::remove(path);
+}
+
+TEST(SnapshotJournalTests, MultiLaneWriterKeepsInstrumentOrderAcrossFeedThreads) {
+  const std::string path = TempJournalPath("lanes");
+
+  // Un instrumento que pasa de un feed thread a otro (turnos): cada append happen-before del
+  // siguiente, en otra lane. El archivo tiene que quedar en el orden de los turnos.
+  constexpr uint32_t kLanes = 3;
+  constexpr uint64_t N = 3'000;
+  {
+    JournalConfig cfg;
+    cfg.path = path;
+    cfg.lanes = kLanes;
+    cfg.queue = {64, false};
+    SnapshotJournalWriter writer(cfg);
+    writer.start();
+
+    std::atomic<uint64_t> turn{0};
+    std::vector<std::thread> feeds;
+    for (uint32_t lane = 0; lane < kLanes; ++lane) {
+      feeds.emplace_back([&, lane] {
+        tlsIngressLane = lane;
+        for (;;) {
+          const uint64_t t = turn.load(std::memory_order_acquire);
+          if (t >= N)
+            return;
+          if (t % kLanes != lane) {
+            std::this_thread::yield();
+            continue;
+          }
+          const auto s = MakeSnapshot(7, t, 1, 1);
+          while (!writer.tryAppend(s, t)) std::this_thread::yield();
+          turn.store(t + 1, std::memory_order_release);
+        }
+      });
+    }
+    for (auto &t : feeds) t.join();
+    writer.stop();
+    EXPECT_EQ(writer.written(), N);
+  }
+
+  SnapshotJournalReader reader(path);
+  OrdersSnapshot s{};
+  uint64_t captureNs = 0;
+  for (uint64_t i = 0; i < N; ++i) {
+    ASSERT_TRUE(reader.next(s, captureNs)) << "record " << i;
+    ASSERT_EQ(s.exchangeTsNs, i) << "orden roto entre lanes";
+  }
+  EXPECT_FALSE(reader.next(s, captureNs));
+
+  std::filesystem::remove(path);
+}
+
+TEST(SnapshotJournalTests, EngineCapturesOnlyAcceptedSnapshots) {
+  const std::string path = TempJournalPath("engine");
+
+  mapping::MdSnapshotMapper mapper;
+  testsupport::FakePublishSink sink;
+  testsupport::FakeInstrumentTopicMapper topics{{42, "AAA"}};
+
+  std::vector<std::unique_ptr<MdPublishWorker>> workers;
+  workers.emplace_back(std::make_unique<MdPublishWorker>(0, mapper, sink, topics.get()));
+  MdPublishPipeline pipeline(std::move(workers));
+  pipeline.start();
+
+  JournalConfig cfg;
+  cfg.path = path;
+  SnapshotJournalWriter writer(cfg);
+  writer.start();
+
+  std::atomic<bool> ready{false};
+  MarketDataEngine engine(pipeline);
+  engine.setRegistryReadyFlag(&ready);
+  engine.setCaptureJournal(&writer);
+
+  engine.injectTestSnapshot(MakeSnapshot(42, 1, 1, 1)); // gated: ni pipeline ni journal
+  ready.store(true);
+  engine.injectTestSnapshot(MakeSnapshot(42, 2, 1, 1));
+  engine.injectTestSnapshot(MakeSnapshot(42, 3, 1, 1));
+
+  pipeline.stop(true);
+  writer.stop();
+
+  EXPECT_EQ(engine.gatedDrops(), 1u);
+  EXPECT_EQ(writer.written(), 2u);
+
+  SnapshotJournalReader reader(path);
+  OrdersSnapshot s{};
+  uint64_t captureNs = 0;
+  ASSERT_TRUE(reader.next(s, captureNs));
+  EXPECT_EQ(s.exchangeTsNs, 2u);
+  EXPECT_GT(captureNs, 0u);
+  ASSERT_TRUE(reader.next(s, captureNs));
+  EXPECT_EQ(s.exchangeTsNs, 3u);
+  EXPECT_FALSE(reader.next(s, captureNs));
+
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,247 @@
+#include "../../b3-md-connector/src/core/DenseInstrumentIndex.hpp"
+#include "../../b3-md-connector/src/core/MdStatsEngine.hpp"
+#include "../../b3-md-connector/src/core/MdTradeLane.hpp"
+#include "../../b3-md-connector/src/mapping/MdSnapshotMapper.hpp"
+#include "../../b3-md-connector/src/testsupport/FakeInstrumentTopicMapper.hpp"
+#include "FakePublishSink.hpp"
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+using namespace b3::md;
+using b3::md::publishing::CompactEnvelope;
+
+namespace {
+
+  // Formato texto para verificar lo publicado: "n=2;o=100000;h=...;v=300"
+  class TextStatsMapper final : public b3::md::mapping::MdSnapshotMapper {
+   public:
+    bool mapStatsToEnvelope(const InstrumentStats &st, CompactEnvelope &ev, const char *symbol,
+                            std::uint8_t symbolLen) const noexcept override {
+      const int n = std::snprintf(
+          reinterpret_cast<char *>(ev.bytes), CompactEnvelope::kMaxBytes,
+          "n=%llu;o=%lld;h=%lld;l=%lld;c=%lld;v=%lld", (unsigned long long)st.tradeCount,
+          (long long)st.open, (long long)st.high, (long long)st.low, (long long)st.close,
+          (long long)st.volume);
+      ev.size = static_cast<uint16_t>(n);
+      ev.topic[0] = 'S';
+      ev.topic[1] = '.';
+      std::memcpy(ev.topic + 2, symbol, symbolLen);
+      ev.topicLen = static_cast<uint8_t>(symbolLen + 2);
+      return true;
+    }
+  };
+
+  TradeEvent ev(uint64_t iid, TradeKind kind, int64_t px, int64_t qty = 0, uint32_t id = 0) {
+    TradeEvent t{};
+    t.instrumentId = iid;
+    t.kind = kind;
+    t.priceMantissa = px;
+    t.qty = qty;
+    t.tradeId = id;
+    return t;
+  }
+
+} // namespace
+
+TEST(DenseInstrumentIndexTests, AssignsDenseIndicesInArrivalOrder) {
+  DenseInstrumentIndex idx(4);
+  EXPECT_EQ(idx.findOrInsert(900), 0u);
+  EXPECT_EQ(idx.findOrInsert(17), 1u);
+  EXPECT_EQ(idx.findOrInsert(900), 0u);
+  EXPECT_EQ(idx.find(17), 1u);
+  EXPECT_EQ(idx.find(5), DenseInstrumentIndex::kNone);
+  EXPECT_EQ(idx.findOrInsert(0), DenseInstrumentIndex::kNone);
+
+  EXPECT_EQ(idx.findOrInsert(3), 2u);
+  EXPECT_EQ(idx.findOrInsert(4), 3u);
+  EXPECT_EQ(idx.findOrInsert(5), DenseInstrumentIndex::kNone); // lleno
+  EXPECT_EQ(idx.size(), 4u);
+  EXPECT_EQ(idx.instrumentAt(1), 17u);
+}
+
+TEST(MdStatsEngineTests, TradesBuildOhlcVwapAndVolume) {
+  TextStatsMapper mapper;
+  testsupport::FakePublishSink sink;
+  testsupport::FakeInstrumentTopicMapper topics{{7, "PETR4"}};
+  MdStatsEngine stats(mapper, sink, topics.get());
+
+  stats.apply(ev(7, TradeKind::Trade, 100000, 100, 1)); // 10.00 x 100
+  stats.apply(ev(7, TradeKind::Trade, 120000, 100, 2)); // 12.00 x 100
+  stats.apply(ev(7, TradeKind::Trade, 90000, 200, 3));  //  9.00 x 200
+  stats.apply(ev(7, TradeKind::ForwardTrade, 500000, 1000, 4)); // termo: no cuenta
+
+  const InstrumentStats *st = stats.find(7);
+  ASSERT_NE(st, nullptr);
+  EXPECT_EQ(st->tradeCount, 3u);
+  EXPECT_EQ(st->open, 100000);
+  EXPECT_EQ(st->high, 120000);
+  EXPECT_EQ(st->low, 90000);
+  EXPECT_EQ(st->last, 90000);
+  EXPECT_EQ(st->lastQty, 200);
+  EXPECT_EQ(st->volume, 400);
+  EXPECT_DOUBLE_EQ(st->vwap(), (10.0 * 100 + 12.0 * 100 + 9.0 * 200) / 400);
+}
+
+TEST(MdStatsEngineTests, BustSubtractsVolumeAndExchangePricesOverride) {
+  TextStatsMapper mapper;
+  testsupport::FakePublishSink sink;
+  testsupport::FakeInstrumentTopicMapper topics{{7, "PETR4"}};
+  MdStatsEngine stats(mapper, sink, topics.get());
+
+  stats.apply(ev(7, TradeKind::Trade, 100000, 100, 1));
+  stats.apply(ev(7, TradeKind::Trade, 150000, 50, 2));
+  stats.apply(ev(7, TradeKind::Bust, 150000, 50, 2));
+
+  const InstrumentStats *st = stats.find(7);
+  ASSERT_NE(st, nullptr);
+  EXPECT_EQ(st->tradeCount, 1u);
+  EXPECT_EQ(st->volume, 100);
+  EXPECT_DOUBLE_EQ(st->vwap(), 10.0);
+  EXPECT_EQ(st->high, 150000); // sin historial: lo corrige el exchange
+
+  stats.apply(ev(7, TradeKind::HighPrice, 100000));
+  stats.apply(ev(7, TradeKind::OpeningPrice, 99000));
+  stats.apply(ev(7, TradeKind::ClosingPrice, 101000));
+  EXPECT_EQ(st->high, 100000);
+  EXPECT_EQ(st->open, 99000);
+  EXPECT_TRUE(st->has(InstrumentStats::OpenFromExchange));
+  EXPECT_EQ(st->close, 101000);
+
+  // Un trade posterior no pisa la apertura del exchange
+  stats.apply(ev(7, TradeKind::Trade, 102000, 10, 3));
+  EXPECT_EQ(st->open, 99000);
+
+  TradeEvent del = ev(7, TradeKind::ClosingPrice, 0);
+  del.deleted = true;
+  stats.apply(del);
+  EXPECT_FALSE(st->has(InstrumentStats::HasClose));
+}
+
+TEST(MdStatsEngineTests, BustOfUncountedTradeIsIgnored) {
+  TextStatsMapper mapper;
+  testsupport::FakePublishSink sink;
+  testsupport::FakeInstrumentTopicMapper topics{{7, "PETR4"}};
+  MdStatsEngine stats(mapper, sink, topics.get());
+
+  stats.apply(ev(7, TradeKind::Trade, 100000, 100, 10));
+  stats.apply(ev(7, TradeKind::ForwardTrade, 500000, 1000, 11));
+  stats.apply(ev(7, TradeKind::Trade, 110000, 100, 12));
+
+  stats.apply(ev(7, TradeKind::Bust, 500000, 1000, 11)); // termo: nunca se sumó
+  stats.apply(ev(7, TradeKind::Bust, 90000, 50, 3));     // anterior a la conexión
+  const InstrumentStats *st = stats.find(7);
+  ASSERT_NE(st, nullptr);
+  EXPECT_EQ(st->tradeCount, 2u);
+  EXPECT_EQ(st->volume, 200);
+  EXPECT_EQ(stats.bustsIgnored(), 2u);
+
+  stats.apply(ev(7, TradeKind::Bust, 110000, 100, 12));
+  EXPECT_EQ(st->tradeCount, 1u);
+  EXPECT_EQ(st->volume, 100);
+}
+
+TEST(MdStatsEngineTests, NewSessionEpochResetsInstrument) {
+  TextStatsMapper mapper;
+  testsupport::FakePublishSink sink;
+  testsupport::FakeInstrumentTopicMapper topics{{7, "PETR4"}};
+  MdStatsEngine stats(mapper, sink, topics.get());
+
+  stats.apply(ev(7, TradeKind::Trade, 100000, 100, 1));
+  stats.apply(ev(7, TradeKind::SettlementPrice, 105000));
+
+  // ChannelReset_11: el primer evento de la sesión nueva arranca de cero
+  TradeEvent t = ev(7, TradeKind::Trade, 120000, 10, 1);
+  t.session = 1;
+  stats.apply(t);
+
+  const InstrumentStats *st = stats.find(7);
+  ASSERT_NE(st, nullptr);
+  EXPECT_EQ(st->tradeCount, 1u);
+  EXPECT_EQ(st->volume, 10);
+  EXPECT_EQ(st->open, 120000);
+  EXPECT_EQ(st->low, 120000);
+  EXPECT_FALSE(st->has(InstrumentStats::HasSettlement));
+  EXPECT_EQ(stats.sessionResets(), 1u);
+  EXPECT_EQ(stats.dirtyCount(), 1u); // el reset no duplica la entrada dirty
+}
+
+TEST(MdStatsEngineTests, PublishesOnlyDirtyInstrumentsOnTimer) {
+  TextStatsMapper mapper;
+  testsupport::FakePublishSink sink;
+  testsupport::FakeInstrumentTopicMapper topics{{7, "PETR4"}, {8, "VALE3"}};
+  MdStatsEngine stats(mapper, sink, topics.get(), /*intervalNs=*/1000);
+
+  stats.apply(ev(7, TradeKind::Trade, 100000, 100, 1));
+  stats.apply(ev(8, TradeKind::Trade, 200000, 10, 2));
+  stats.apply(ev(7, TradeKind::Trade, 110000, 100, 3));
+  EXPECT_EQ(stats.dirtyCount(), 2u);
+
+  EXPECT_EQ(stats.maybePublish(5000), 2u);
+  EXPECT_EQ(sink.count(), 2u);
+  EXPECT_EQ(sink.at(0).topic, "S.PETR4");
+  EXPECT_EQ(sink.at(0).shardId, publishing::kStatsChannel);
+  EXPECT_TRUE(sink.at(0).priority);
+  EXPECT_EQ(sink.at(0).bytes, "n=2;o=100000;h=110000;l=100000;c=0;v=200");
+  EXPECT_EQ(stats.dirtyCount(), 0u);
+
+  // Antes del intervalo no publica aunque haya cambios
+  stats.apply(ev(8, TradeKind::Trade, 210000, 10, 4));
+  EXPECT_EQ(stats.maybePublish(5500), 0u);
+  // Vencido: solo el instrumento que cambió
+  EXPECT_EQ(stats.maybePublish(6000), 1u);
+  ASSERT_EQ(sink.count(), 3u);
+  EXPECT_EQ(sink.at(2).topic, "S.VALE3");
+
+  // Nada dirty: nada que publicar
+  EXPECT_EQ(stats.maybePublish(9000), 0u);
+  EXPECT_EQ(stats.published(), 3u);
+}
+
+TEST(MdStatsEngineTests, CountsOverflowBeyondMaxInstruments) {
+  TextStatsMapper mapper;
+  testsupport::FakePublishSink sink;
+  testsupport::FakeInstrumentTopicMapper topics;
+  MdStatsEngine stats(mapper, sink, topics.get(), 1000, /*maxInstruments=*/2);
+
+  stats.apply(ev(1, TradeKind::Trade, 1, 1));
+  stats.apply(ev(2, TradeKind::Trade, 1, 1));
+  stats.apply(ev(3, TradeKind::Trade, 1, 1));
+  EXPECT_EQ(stats.instruments(), 2u);
+  EXPECT_EQ(stats.overflow(), 1u);
+
+  // Sin topic: se descarta, no queda dirty para siempre
+  EXPECT_EQ(stats.flush(), 0u);
+  EXPECT_EQ(stats.dropped(), 2u);
+  EXPECT_EQ(stats.dirtyCount(), 0u);
+}
+
+TEST(MdStatsEngineTests, RunsOnTradeLaneThreadWithoutPublishingTrades) {
+  TextStatsMapper mapper;
+  testsupport::FakePublishSink sink;
+  testsupport::FakeInstrumentTopicMapper topics{{7, "PETR4"}};
+  MdStatsEngine stats(mapper, sink, topics.get(), /*intervalNs=*/1'000'000);
+
+  MdTradeLane lane(1, mapper, sink, topics.get());
+  lane.setStats(&stats);
+  lane.setPublishTrades(false);
+  lane.start();
+
+  ASSERT_TRUE(lane.tryEnqueue(0, ev(7, TradeKind::Trade, 100000, 100, 1)));
+  ASSERT_TRUE(lane.tryEnqueue(0, ev(7, TradeKind::SettlementPrice, 105000)));
+
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(2000);
+  while (sink.count() < 1 && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  lane.stop(true);
+
+  ASSERT_GE(sink.count(), 1u);
+  for (size_t i = 0; i < sink.count(); ++i)
+    EXPECT_EQ(sink.at(i).shardId, publishing::kStatsChannel); // ningún trade publicado
+  EXPECT_EQ(lane.published(), 0u);
+  EXPECT_EQ(stats.applied(), 2u);
+  EXPECT_EQ(stats.find(7)->settlement, 105000);
+}
@@ -0,0 +1,98 @@
+#include "../../b3-md-connector/src/core/SubscriptionExecutor.hpp"
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace b3::md;
+
+namespace {
+
+  class RecordingHandler final : public IMarketDataHandler {
+   public:
+    void subscribe(uint64_t iid) override {
+      std::lock_guard<std::mutex> g(mu);
+      subscribed.push_back(iid);
+      threads.push_back(std::this_thread::get_id());
+    }
+    void unsubscribe(uint64_t iid) override {
+      std::lock_guard<std::mutex> g(mu);
+      unsubscribed.push_back(iid);
+    }
+
+    std::mutex mu;
+    std::vector<uint64_t> subscribed;
+    std::vector<uint64_t> unsubscribed;
+    std::vector<std::thread::id> threads;
+  };
+
+} // namespace
+
+TEST(SubscriptionExecutorTests, WithoutStartAppliesInline) {
+  RecordingHandler handler;
+  SubscriptionExecutor executor(handler);
+
+  executor.submit({1, 2}, {3});
+  EXPECT_EQ(handler.subscribed, (std::vector<uint64_t>{1, 2}));
+  EXPECT_EQ(handler.unsubscribed, (std::vector<uint64_t>{3}));
+  EXPECT_EQ(handler.threads[0], std::this_thread::get_id());
+}
+
+TEST(SubscriptionExecutorTests, CoalescesPendingTransitionsOffThread) {
+  RecordingHandler handler;
+  SubscriptionExecutor executor(handler);
+  executor.start();
+
+  // Sub + unsub del mismo iid en el mismo batch se anulan
+  executor.submit({1, 2, 3}, {});
+  executor.submit({}, {2});
+  executor.submit({4}, {});
+  executor.waitIdle();
+  executor.stop();
+
+  // Según cuándo drene el thread, 2 puede haberse aplicado y deshecho; 1, 3 y 4 siempre salen
+  std::vector<uint64_t> net = handler.subscribed;
+  for (const auto iid : handler.unsubscribed)
+    std::erase(net, iid);
+  EXPECT_EQ(net, (std::vector<uint64_t>{1, 3, 4}));
+  EXPECT_EQ(executor.subscribeCalls() - executor.unsubscribeCalls(), 3u);
+  EXPECT_EQ(executor.subscribeCalls() + executor.unsubscribeCalls() + executor.coalesced(), 5u);
+  for (const auto id : handler.threads)
+    EXPECT_NE(id, std::this_thread::get_id());
+}
+
+TEST(SubscriptionExecutorTests, HandlerFailureIsReportedNotSwallowed) {
+  class FailingHandler final : public IMarketDataHandler {
+   public:
+    void subscribe(uint64_t iid) override {
+      if (iid == 2)
+        throw std::runtime_error("unknown instrument");
+      subscribed.push_back(iid);
+    }
+    void unsubscribe(uint64_t) override {}
+    std::vector<uint64_t> subscribed;
+  } handler;
+
+  SubscriptionExecutor executor(handler);
+  std::vector<std::pair<uint64_t, bool>> reported;
+  executor.setFailureCallback(
+      [&](uint64_t iid, bool subscribe, const char *) { reported.emplace_back(iid, subscribe); });
+
+  // Inline: devuelve lo que falló y sigue con el resto del batch
+  EXPECT_EQ(executor.submit({1, 2, 3}, {}), (std::vector<uint64_t>{2}));
+  EXPECT_EQ(handler.subscribed, (std::vector<uint64_t>{1, 3}));
+  EXPECT_EQ(executor.failures(), 1u);
+
+  // En el thread del executor: la falla llega por el callback
+  executor.start();
+  EXPECT_TRUE(executor.submit({2}, {}).empty());
+  executor.waitIdle();
+  executor.stop();
+
+  EXPECT_EQ(executor.failures(), 2u);
+  ASSERT_EQ(reported.size(), 2u);
+  EXPECT_EQ(reported[1], (std::pair<uint64_t, bool>{2, true}));
+}
@@ -4,28 +4,38 @@
 //   cmake -S tests/md -B build/tests-md -G Ninja && cmake --build build/tests-md
 //   ./build/tests-md/b3_md_tests --gtest_filter="SubscriptionServerTests.*"
 //
-// Expected: All 4 tests pass, verifying:
+// Expected: All 8 tests pass, verifying:
 //   1. SecurityListRequest returns all instruments from registry
 //   2. Empty registry returns empty list
 //   3. MarketDataSubscription calls handler.subscribe()
 //   4. Invalid symbol returns error and doesn't call handler
+//   5. SecurityList cache is rebuilt only when the registry version changes
+//   6. Filtered SecurityListRequest streams in pages closed by an empty response
+//   7. Prefix ("PETR*") and underlying ("@PETR4") subscriptions expand per instrument
+//   8. Batched symbols: one response, unknown items reported, handler calls via the executor
+//   9. Pattern unsubscribe releases exactly what that client's pattern subscribe took
+//  10. A subscribe the handler rejects is not reported ok and drops its refcount
 
 #include <gtest/gtest.h>
 
 #include "../../b3-md-connector/src/messaging/B3MdSubscriptionServer.hpp"
-#include "../../b3-md-connector/src/mapping/InstrumentRegistry.hpp"
 #include "../../b3-md-connector/src/core/SubscriptionRegistry.hpp"
 #include "../../b3-md-connector/src/core/IMarketDataHandler.hpp"
 
+#include <b3/common/InstrumentRegistry.hpp>
+
 #include <models/messages.pb.h>
 #include <models/messageTypes.h>
 
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 using namespace b3::md;
 using namespace b3::md::messaging;
-using namespace b3::md::mapping;
+using b3::common::InstrumentRegistry;
 using markethub::messaging::WrapperMessage;
 using markethub::messaging::models::MessageTypes;
 
@@ -203,3 +213,334 @@ TEST(SubscriptionServerTests, MarketDataSubscription_InvalidSymbol_ReturnsError)
   // Verificar que el handler NO fue llamado (subscripción rechazada)
   EXPECT_EQ(handler.subscribedIds.size(), 0u) << "Handler should not be called for invalid symbol";
 }
+
+// Test: la SecurityListResponse se arma una vez por versión del registry
+TEST(SubscriptionServerTests, SecurityListRequest_CachedPerRegistryVersion) {
+  InstrumentRegistry registry;
+  registry.upsert(123456, "PETR4");
+
+  SubscriptionRegistry subs;
+  FakeMarketDataHandler handler;
+
+  B3MdSubscriptionServer server("tcp://*:9999", "tcp://*:9998", registry, subs, handler, nullptr);
+
+  WrapperMessage request;
+  request.set_message_id("test-msg-5");
+  request.set_message_type(std::string(MessageTypes::SecurityListRequest));
+  request.mutable_security_list_request()->set_request_id("req-1");
+
+  auto first = server.HandleMessageForTest(request);
+  auto second = server.HandleMessageForTest(request);
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(second->security_list_response().securities().size(), 1u);
+  EXPECT_EQ(server.securityListCache().builds(), 1u);
+
+  // Delta (serie nueva): nueva versión => un solo rebuild
+  registry.upsert(123459, "PETRK300");
+  auto third = server.HandleMessageForTest(request);
+  ASSERT_NE(third, nullptr);
+  EXPECT_EQ(third->security_list_response().securities().size(), 2u);
+  EXPECT_TRUE(third->security_list_response().securities().count("PETRK300") > 0);
+  EXPECT_EQ(server.securityListCache().builds(), 2u);
+  EXPECT_EQ(server.securityListCache().builtVersion(), registry.version());
+}
+
+// Test: filtro por prefijo + paginado en chunks con respuesta vacía final
+TEST(SubscriptionServerTests, SecurityListRequest_FilteredAndPaged) {
+  InstrumentRegistry registry;
+  registry.upsert(123456, "PETR4");
+  registry.upsert(123457, "VALE3");
+  registry.upsert(123458, "PETRK300");
+  registry.upsert(123459, "PETRL300");
+
+  SubscriptionRegistry subs;
+  FakeMarketDataHandler handler;
+
+  B3MdSubscriptionServer server("tcp://*:9999", "tcp://*:9998", registry, subs, handler, nullptr);
+  server.setSecurityListPageSize(2);
+
+  WrapperMessage request;
+  request.set_message_id("test-msg-6");
+  request.set_message_type(std::string(MessageTypes::SecurityListRequest));
+  request.mutable_security_list_request()->set_request_id("req-6");
+  request.mutable_security_list_request()->set_symbol("PETR*");
+
+  auto responses = server.SecurityListResponsesForTest(request);
+  ASSERT_EQ(responses.size(), 3u);
+  EXPECT_EQ(responses[0]->security_list_response().securities().size(), 2u);
+  EXPECT_TRUE(responses[0]->security_list_response().securities().count("PETR4") > 0);
+  EXPECT_EQ(responses[1]->security_list_response().securities().size(), 1u);
+  EXPECT_TRUE(responses[1]->security_list_response().securities().count("PETRL300") > 0);
+  EXPECT_EQ(responses[2]->security_list_response().securities().size(), 0u);
+  for (const auto &r : responses)
+    EXPECT_EQ(r->message_id(), "test-msg-6");
+
+  // Sin matches: una sola respuesta vacía
+  request.mutable_security_list_request()->set_symbol("ITUB*");
+  responses = server.SecurityListResponsesForTest(request);
+  ASSERT_EQ(responses.size(), 1u);
+  EXPECT_EQ(responses[0]->security_list_response().securities().size(), 0u);
+}
+
+// Test: pre-encoded => el snapshot arma solo bytes/entries (sin el mensaje), y al revés
+TEST(SubscriptionServerTests, SecurityListRequest_PreEncodedSnapshotKeepsOneForm) {
+  InstrumentRegistry registry;
+  registry.upsert(123456, "PETR4");
+  registry.upsert(123457, "VALE3");
+  registry.upsert(123458, "PETRK300");
+
+  SubscriptionRegistry subs;
+  FakeMarketDataHandler handler;
+  B3MdSubscriptionServer server("tcp://*:9999", "tcp://*:9998", registry, subs, handler, nullptr);
+  server.setPreEncodedSecurityList(true);
+
+  WrapperMessage request;
+  request.set_message_id("test-msg-7");
+  request.set_message_type(std::string(MessageTypes::SecurityListRequest));
+  request.mutable_security_list_request()->set_request_id("req-7");
+  request.mutable_security_list_request()->set_symbol("PETR*");
+
+  auto responses = server.SecurityListResponsesForTest(request);
+  ASSERT_EQ(responses.size(), 1u);
+  auto snap = server.securityListCache().built();
+  ASSERT_NE(snap, nullptr);
+  EXPECT_TRUE(snap->preEncoded);
+  EXPECT_EQ(snap->entries.size(), 3u);
+  EXPECT_FALSE(snap->bytes.empty());
+  EXPECT_TRUE(snap->message.securities().empty());
+
+  // Volver al modo mensaje descarta el snapshot pre-encoded (misma versión del registry)
+  server.setPreEncodedSecurityList(false);
+  EXPECT_EQ(server.securityListCache().built(), nullptr);
+  responses = server.SecurityListResponsesForTest(request);
+  ASSERT_EQ(responses.size(), 1u);
+  EXPECT_EQ(responses[0]->security_list_response().securities().size(), 2u);
+  snap = server.securityListCache().built();
+  ASSERT_NE(snap, nullptr);
+  EXPECT_FALSE(snap->preEncoded);
+  EXPECT_TRUE(snap->bytes.empty());
+  EXPECT_TRUE(snap->entries.empty());
+  EXPECT_EQ(snap->message.securities().size(), 3u);
+}
+
+// Test: suscripción por prefijo / subyacente expandida a suscripciones por instrumento
+TEST(SubscriptionServerTests, MarketDataSubscription_PrefixAndUnderlying) {
+  InstrumentRegistry registry;
+  registry.upsert(100, "PETR4");
+  registry.upsert(200, "VALE3");
+  for (auto [iid, symbol] : {std::pair<uint64_t, const char *>{101, "PETRK300"},
+                             std::pair<uint64_t, const char *>{102, "PETRL300"}}) {
+    b3::common::InstrumentData d;
+    d.securityId = iid;
+    d.symbol = symbol;
+    d.underlyingSecurityId = 100;
+    registry.upsertFull(iid, d);
+  }
+  // SecurityID >= 2^32 como subyacente: truncado a 32 bits caería sobre PETR4 (100)
+  const uint64_t wideId = (1ull << 32) + 100;
+  registry.upsert(wideId, "WIDE3");
+  {
+    b3::common::InstrumentData d;
+    d.securityId = 103;
+    d.symbol = "WIDEK100";
+    d.underlyingSecurityId = wideId;
+    registry.upsertFull(103, d);
+  }
+
+  SubscriptionRegistry subs;
+  FakeMarketDataHandler handler;
+  B3MdSubscriptionServer server("tcp://*:9999", "tcp://*:9998", registry, subs, handler, nullptr);
+
+  WrapperMessage request;
+  request.set_message_id("test-msg-7");
+  request.set_message_type(std::string(MessageTypes::MarketDataSuscriptionRequest));
+  auto *body = request.mutable_market_data_suscription_request();
+  body->set_request_id("req-7");
+  body->set_subscription_request_type(markethub::messaging::trading::SNAPSHOT_PLUS_UPDATES);
+
+  body->mutable_instrument()->set_symbol("@PETR4");
+  auto resp = server.HandleMessageForTest(request);
+  ASSERT_NE(resp, nullptr);
+  EXPECT_EQ(handler.subscribedIds, (std::vector<uint64_t>{101, 102}));
+
+  body->mutable_instrument()->set_symbol("@WIDE3");
+  server.HandleMessageForTest(request);
+  EXPECT_EQ(handler.subscribedIds, (std::vector<uint64_t>{101, 102, 103}));
+
+  // Prefijo: PETR4 es nuevo, las opciones ya estaban (solo suben el contador)
+  body->mutable_instrument()->set_symbol("PETR*");
+  server.HandleMessageForTest(request);
+  EXPECT_EQ(handler.subscribedIds, (std::vector<uint64_t>{101, 102, 103, 100}));
+  EXPECT_EQ(subs.activeCount(), 4u);
+
+  body->set_subscription_request_type(markethub::messaging::trading::DISABLE_PREVIOUS);
+  server.HandleMessageForTest(request);
+  EXPECT_EQ(handler.unsubscribedIds, (std::vector<uint64_t>{100}));
+  EXPECT_TRUE(subs.isActive(101));
+
+  // Sin matches: error y ninguna llamada al handler
+  body->set_subscription_request_type(markethub::messaging::trading::SNAPSHOT);
+  body->mutable_instrument()->set_symbol("ITUB*");
+  server.HandleMessageForTest(request);
+  EXPECT_EQ(handler.subscribedIds.size(), 4u);
+}
+
+// Test: batch de símbolos en un request, con items rechazados y executor asíncrono
+TEST(SubscriptionServerTests, MarketDataSubscription_BatchThroughExecutor) {
+  InstrumentRegistry registry;
+  registry.upsert(100, "PETR4");
+  registry.upsert(200, "VALE3");
+  registry.upsert(300, "ITUB4");
+
+  SubscriptionRegistry subs;
+  FakeMarketDataHandler handler;
+  SubscriptionExecutor executor(handler);
+  executor.start();
+
+  B3MdSubscriptionServer server("tcp://*:9999", "tcp://*:9998", registry, subs, handler, nullptr);
+  server.setSubscriptionExecutor(&executor);
+
+  WrapperMessage request;
+  request.set_message_id("test-msg-8");
+  request.set_message_type(std::string(MessageTypes::MarketDataSuscriptionRequest));
+  auto *body = request.mutable_market_data_suscription_request();
+  body->set_request_id("req-8");
+  body->set_subscription_request_type(markethub::messaging::trading::SNAPSHOT_PLUS_UPDATES);
+  body->mutable_instrument()->set_symbol("PETR4, VALE3,NOPE3,PETR*");
+
+  auto resp = server.HandleMessageForTest(request);
+  ASSERT_NE(resp, nullptr);
+  ASSERT_TRUE(resp->has_market_data_suscription_response());
+  EXPECT_EQ(subs.activeCount(), 2u); // PETR4 (dos veces en el batch) cuenta una
+
+  executor.waitIdle();
+  executor.stop();
+  EXPECT_EQ(handler.subscribedIds, (std::vector<uint64_t>{100, 200}));
+  EXPECT_EQ(executor.batches(), 1u);
+}
+
+// Test: en un batch, un patrón sin matches se rechaza aunque un item anterior ya haya resuelto
+TEST(SubscriptionServerTests, MarketDataSubscription_BatchRejectsEmptyPatternAfterMatch) {
+  InstrumentRegistry registry;
+  registry.upsert(100, "PETR4");
+
+  SubscriptionRegistry subs;
+  FakeMarketDataHandler handler;
+  B3MdSubscriptionServer server("tcp://*:9999", "tcp://*:9998", registry, subs, handler, nullptr);
+
+  WrapperMessage request;
+  request.set_message_id("test-msg-9");
+  request.set_message_type(std::string(MessageTypes::MarketDataSuscriptionRequest));
+  auto *body = request.mutable_market_data_suscription_request();
+  body->set_request_id("req-9");
+  body->set_subscription_request_type(markethub::messaging::trading::SNAPSHOT_PLUS_UPDATES);
+  body->mutable_instrument()->set_symbol("PETR4,ZZZ*");
+
+  auto resp = server.HandleMessageForTest(request);
+  ASSERT_NE(resp, nullptr);
+  ASSERT_TRUE(resp->has_market_data_suscription_response());
+  EXPECT_EQ(handler.subscribedIds, (std::vector<uint64_t>{100}));
+
+  const auto &r = resp->market_data_suscription_response();
+  if constexpr (requires { r.ok(); }) {
+    EXPECT_FALSE(r.ok());
+  }
+  if constexpr (requires { r.error(); }) {
+    EXPECT_EQ(std::string(r.error()), "Rejected 1 of 2: ZZZ*");
+  }
+}
+
+// Test: el unsubscribe de un patrón suelta lo que ESE cliente tomó, no la expansión actual
+TEST(SubscriptionServerTests, MarketDataSubscription_PatternUnsubscribeReleasesHeldSet) {
+  InstrumentRegistry registry;
+  registry.upsert(100, "PETR4");
+  registry.upsert(101, "PETR3");
+
+  SubscriptionRegistry subs;
+  FakeMarketDataHandler handler;
+  B3MdSubscriptionServer server("tcp://*:9999", "tcp://*:9998", registry, subs, handler, nullptr);
+
+  WrapperMessage request;
+  request.set_message_id("test-msg-10");
+  request.set_client_id("client-a");
+  request.set_message_type(std::string(MessageTypes::MarketDataSuscriptionRequest));
+  auto *body = request.mutable_market_data_suscription_request();
+  body->set_request_id("req-10");
+  body->set_subscription_request_type(markethub::messaging::trading::SNAPSHOT_PLUS_UPDATES);
+  body->mutable_instrument()->set_symbol("PETR*");
+  server.HandleMessageForTest(request);
+  server.HandleMessageForTest(request); // repetido: no toma otra referencia
+  EXPECT_EQ(handler.subscribedIds, (std::vector<uint64_t>{101, 100})); // orden del índice
+
+  // Serie nueva después del subscribe, tomada por otro cliente con el símbolo suelto
+  registry.upsert(102, "PETRX1");
+  request.set_client_id("client-b");
+  body->mutable_instrument()->set_symbol("PETRX1");
+  server.HandleMessageForTest(request);
+  EXPECT_TRUE(subs.isActive(102));
+
+  // client-b nunca se suscribió al patrón: rechazado, sin tocar refcounts
+  body->set_subscription_request_type(markethub::messaging::trading::DISABLE_PREVIOUS);
+  body->mutable_instrument()->set_symbol("PETR*");
+  auto resp = server.HandleMessageForTest(request);
+  ASSERT_NE(resp, nullptr);
+  const auto &r = resp->market_data_suscription_response();
+  if constexpr (requires { r.error(); }) {
+    EXPECT_EQ(std::string(r.error()), "Not subscribed: PETR*");
+  }
+  EXPECT_TRUE(handler.unsubscribedIds.empty());
+
+  // client-a suelta {100, 101}; PETRX1 sigue con la referencia de client-b
+  request.set_client_id("client-a");
+  server.HandleMessageForTest(request);
+  EXPECT_EQ(handler.unsubscribedIds, (std::vector<uint64_t>{101, 100}));
+  EXPECT_TRUE(subs.isActive(102));
+  EXPECT_EQ(subs.activeCount(), 1u);
+}
+
+// Test: si el handler rechaza el subscribe, la respuesta no dice ok y el refcount se descarta
+TEST(SubscriptionServerTests, MarketDataSubscription_HandlerFailureRollsBack) {
+  class RejectingHandler final : public IMarketDataHandler {
+   public:
+    void subscribe(uint64_t iid) override {
+      if (reject)
+        throw std::runtime_error("rejected");
+      subscribedIds.push_back(iid);
+    }
+    void unsubscribe(uint64_t) override {}
+    bool reject{true};
+    std::vector<uint64_t> subscribedIds;
+  } handler;
+
+  InstrumentRegistry registry;
+  registry.upsert(100, "PETR4");
+  SubscriptionRegistry subs;
+  SubscriptionExecutor executor(handler); // sin start(): aplica inline
+  B3MdSubscriptionServer server("tcp://*:9999", "tcp://*:9998", registry, subs, handler, nullptr);
+  server.setSubscriptionExecutor(&executor);
+
+  WrapperMessage request;
+  request.set_message_id("test-msg-11");
+  request.set_message_type(std::string(MessageTypes::MarketDataSuscriptionRequest));
+  auto *body = request.mutable_market_data_suscription_request();
+  body->set_request_id("req-11");
+  body->set_subscription_request_type(markethub::messaging::trading::SNAPSHOT_PLUS_UPDATES);
+  body->mutable_instrument()->set_symbol("PETR4");
+
+  auto resp = server.HandleMessageForTest(request);
+  ASSERT_NE(resp, nullptr);
+  const auto &r = resp->market_data_suscription_response();
+  if constexpr (requires { r.ok(); }) {
+    EXPECT_FALSE(r.ok());
+  }
+  if constexpr (requires { r.error(); }) {
+    EXPECT_EQ(std::string(r.error()), "Handler failed for 1 instrument(s)");
+  }
+  EXPECT_FALSE(subs.isActive(100));
+
+  // El próximo subscribe reintenta el handler (refcount en 0, no "ya suscripto")
+  handler.reject = false;
+  server.HandleMessageForTest(request);
+  EXPECT_EQ(handler.subscribedIds, (std::vector<uint64_t>{100}));
+  EXPECT_TRUE(subs.isActive(100));
+}
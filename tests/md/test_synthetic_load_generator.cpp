@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include "../../b3-md-connector/src/testsupport/SyntheticLoadGenerator.hpp"
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace b3::md;
+using b3::md::testsupport::LoadProfile;
+using b3::md::testsupport::SyntheticLoadGenerator;
+
+TEST(SyntheticLoadGeneratorTests, PresetsShapeTheRateOverTime) {
+  LoadProfile p;
+  ASSERT_TRUE(p.applyPreset("steady"));
+  EXPECT_DOUBLE_EQ(p.multiplierAt(1.0), 1.0);
+
+  ASSERT_TRUE(p.applyPreset("session"));
+  EXPECT_DOUBLE_EQ(p.multiplierAt(0.5), 10.0); // uncross de apertura
+  EXPECT_DOUBLE_EQ(p.multiplierAt(5.0), 3.0);
+  EXPECT_DOUBLE_EQ(p.multiplierAt(12.0), 1.0);
+  EXPECT_DOUBLE_EQ(p.multiplierAt(15.2), p.newsMultiplier);
+  EXPECT_DOUBLE_EQ(p.multiplierAt(16.0), 1.0);
+
+  EXPECT_FALSE(p.applyPreset("bogus"));
+}
+
+TEST(SyntheticLoadGeneratorTests, ProducersOwnDisjointInstrumentsWithZipfSkew) {
+  LoadProfile p;
+  p.updatesPerSec = 40'000;
+  p.producers = 2;
+  p.zipfExponent = 1.2;
+
+  std::vector<uint64_t> ids;
+  for (uint64_t i = 1; i <= 200; ++i) ids.push_back(i * 10);
+  SyntheticLoadGenerator gen(p, ids);
+
+  std::mutex m;
+  std::map<uint32_t, std::set<uint64_t>> byProducer;
+  std::map<uint64_t, uint64_t> perInstrument;
+  std::map<uint64_t, uint64_t> lastRptSeq;
+  bool ordered = true;
+  bool bookOk = true;
+  thread_local uint32_t producer = 0;
+
+  gen.start(
+      [&](const OrdersSnapshot &s) {
+        std::lock_guard<std::mutex> g(m);
+        byProducer[producer].insert(s.instrumentId);
+        ++perInstrument[s.instrumentId];
+        ordered &= s.rptSeq > lastRptSeq[s.instrumentId];
+        lastRptSeq[s.instrumentId] = s.rptSeq;
+        bookOk &= s.bidsCopied > 0 && s.asksCopied > 0 &&
+                  s.bids[0].priceMantissa < s.asks[0].priceMantissa;
+      },
+      [&](uint32_t idx) { producer = idx; });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  gen.stop();
+
+  ASSERT_GT(gen.generated(), 1'000u);
+  EXPECT_TRUE(ordered);
+  EXPECT_TRUE(bookOk);
+
+  // Cada instrumento sale de un solo productor (orden por instrumento = orden de una lane)
+  ASSERT_EQ(byProducer.size(), 2u);
+  for (uint64_t iid : byProducer[0]) EXPECT_EQ(byProducer[1].count(iid), 0u) << iid;
+
+  // Zipf: el instrumento más activo se lleva bastante más que la media
+  uint64_t top = 0;
+  for (const auto &[iid, n] : perInstrument) top = std::max(top, n);
+  EXPECT_GT(top, 10 * gen.generated() / ids.size());
+}
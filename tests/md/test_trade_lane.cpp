@@ -0,0 +1,195 @@
+#include "../../b3-md-connector/src/core/MarketDataEngine.hpp"
+#include "../../b3-md-connector/src/core/MdPublishPipeline.hpp"
+#include "../../b3-md-connector/src/core/MdPublishWorker.hpp"
+#include "../../b3-md-connector/src/core/MdTradeLane.hpp"
+#include "../../b3-md-connector/src/mapping/MdSnapshotMapper.hpp"
+#include "../../b3-md-connector/src/testsupport/FakeInstrumentTopicMapper.hpp"
+#include "FakePublishSink.hpp"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace b3::md;
+using b3::md::publishing::CompactEnvelope;
+
+namespace {
+
+  // Formato texto (no protobuf) para poder verificar el contenido: "id=7;k=TRADE;q=100"
+  class TextTradeMapper final : public b3::md::mapping::MdSnapshotMapper {
+   public:
+    bool mapTradeToEnvelope(const TradeEvent &t, CompactEnvelope &ev, const char *symbol,
+                            std::uint8_t symbolLen) const noexcept override {
+      constexpr size_t kPrefixLen = sizeof(b3::md::mapping::kTradeTopicPrefix) - 1;
+      if (symbolLen == 0 || kPrefixLen + symbolLen > CompactEnvelope::kMaxTopic)
+        return false;
+
+      const int n = std::snprintf(reinterpret_cast<char *>(ev.bytes), CompactEnvelope::kMaxBytes,
+                                  "id=%u;k=%s;q=%lld", t.tradeId, toString(t.kind),
+                                  static_cast<long long>(t.qty));
+      if (n <= 0)
+        return false;
+      ev.size = static_cast<uint16_t>(n);
+
+      std::memcpy(ev.topic, b3::md::mapping::kTradeTopicPrefix, kPrefixLen);
+      std::memcpy(ev.topic + kPrefixLen, symbol, symbolLen);
+      ev.topicLen = static_cast<uint8_t>(kPrefixLen + symbolLen);
+      return true;
+    }
+  };
+
+  TradeEvent makeTrade(uint64_t iid, uint32_t tradeId, TradeKind kind = TradeKind::Trade) {
+    TradeEvent t{};
+    t.instrumentId = iid;
+    t.tradeId = tradeId;
+    t.priceMantissa = 123400;
+    t.qty = 100;
+    t.kind = kind;
+    return t;
+  }
+
+  bool waitForCount(const testsupport::FakePublishSink &sink, size_t n,
+                    std::chrono::milliseconds timeout = std::chrono::milliseconds(2000)) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (sink.count() < n && std::chrono::steady_clock::now() < deadline)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return sink.count() >= n;
+  }
+
+} // namespace
+
+TEST(MdTradeLaneTests, PublishesOnPriorityChannelWithTradeTopic) {
+  TextTradeMapper mapper;
+  testsupport::FakePublishSink sink;
+  testsupport::FakeInstrumentTopicMapper topics{{7, "PETR4"}};
+
+  MdTradeLane lane(1, mapper, sink, topics.get());
+  lane.start();
+
+  ASSERT_TRUE(lane.tryEnqueue(0, makeTrade(7, 11)));
+  ASSERT_TRUE(lane.tryEnqueue(0, makeTrade(7, 11, TradeKind::Bust)));
+  const bool arrived = waitForCount(sink, 2);
+  lane.stop(true);
+  ASSERT_TRUE(arrived);
+
+  const auto first = sink.at(0);
+  EXPECT_TRUE(first.priority);
+  EXPECT_EQ(first.shardId, publishing::kTradeChannel);
+  EXPECT_EQ(first.topic, "T.PETR4");
+  EXPECT_EQ(first.bytes, "id=11;k=TRADE;q=100");
+  EXPECT_EQ(sink.at(1).bytes, "id=11;k=BUST;q=100");
+
+  EXPECT_EQ(lane.enqueued(), 2u);
+  EXPECT_EQ(lane.published(), 2u);
+  EXPECT_EQ(lane.dropped(), 0u);
+}
+
+TEST(MdTradeLaneTests, PreservesFifoAcrossIngressLanes) {
+  TextTradeMapper mapper;
+  testsupport::FakePublishSink sink;
+  testsupport::FakeInstrumentTopicMapper topics{{7, "PETR4"}};
+
+  MdTradeLane lane(1, mapper, sink, topics.get(), /*laneCount=*/2);
+  lane.start();
+
+  // Un solo productor alternando lanes en ráfagas: el consumer mergea por ticket
+  constexpr uint32_t N = 200;
+  for (uint32_t i = 0; i < N; ++i)
+    ASSERT_TRUE(lane.tryEnqueue(0, makeTrade(7, i), /*lane=*/(i / 3) % 2));
+
+  const bool arrived = waitForCount(sink, N);
+  lane.stop(true);
+  ASSERT_TRUE(arrived);
+
+  for (uint32_t i = 0; i < N; ++i) {
+    const std::string expected = "id=" + std::to_string(i) + ";k=TRADE;q=100";
+    ASSERT_EQ(sink.at(i).bytes, expected) << "at " << i;
+  }
+}
+
+TEST(MdTradeLaneTests, CountsDropsForBadShardLaneAndUnknownInstrument) {
+  TextTradeMapper mapper;
+  testsupport::FakePublishSink sink;
+  testsupport::FakeInstrumentTopicMapper topics{{7, "PETR4"}};
+
+  MdTradeLane lane(2, mapper, sink, topics.get());
+
+  EXPECT_FALSE(lane.tryEnqueue(2, makeTrade(7, 1)));
+  EXPECT_FALSE(lane.tryEnqueue(0, makeTrade(7, 2), /*lane=*/1));
+  EXPECT_EQ(lane.laneRejected(), 1u);
+  EXPECT_EQ(lane.dropped(), 2u);
+
+  // Sin topic en el registry: se encola, pero no se publica
+  lane.start();
+  ASSERT_TRUE(lane.tryEnqueue(1, makeTrade(99, 3)));
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(2000);
+  while (lane.dropped() < 3 && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  lane.stop(true);
+
+  EXPECT_EQ(lane.dropped(), 3u);
+  EXPECT_EQ(lane.published(), 0u);
+  EXPECT_EQ(sink.count(), 0u);
+}
+
+TEST(MdTradeLaneTests, FullQueueDropsInsteadOfBlocking) {
+  TextTradeMapper mapper;
+  testsupport::FakePublishSink sink;
+  testsupport::FakeInstrumentTopicMapper topics{{7, "PETR4"}};
+
+  MdTradeLane lane(1, mapper, sink, topics.get(), 1, QueueConfig{4, false});
+
+  uint32_t accepted = 0;
+  for (uint32_t i = 0; i < 16; ++i)
+    accepted += lane.tryEnqueue(0, makeTrade(7, i)) ? 1u : 0u;
+
+  EXPECT_LT(accepted, 16u);
+  EXPECT_EQ(lane.enqueued(), accepted);
+  EXPECT_EQ(lane.dropped(), 16u - accepted);
+}
+
+TEST(MdTradeLaneTests, EngineRoutesTradesAndHonoursRegistryGate) {
+  b3::md::mapping::MdSnapshotMapper bookMapper;
+  TextTradeMapper tradeMapper;
+  testsupport::FakePublishSink sink;
+  testsupport::FakeInstrumentTopicMapper topics{{7, "PETR4"}, {8, "VALE3"}};
+
+  std::vector<std::unique_ptr<MdPublishWorker>> workers;
+  for (uint32_t i = 0; i < 2; ++i)
+    workers.emplace_back(std::make_unique<MdPublishWorker>(i, bookMapper, sink, topics.get()));
+  MdPublishPipeline pipeline(std::move(workers));
+
+  MarketDataEngine engine(pipeline);
+  engine.onTrade(makeTrade(7, 1)); // sin lane: no-op
+
+  MdTradeLane lane(2, tradeMapper, sink, topics.get());
+  lane.start();
+  engine.setTradeLane(&lane);
+
+  std::atomic<bool> ready{false};
+  engine.setRegistryReadyFlag(&ready);
+  engine.onTrade(makeTrade(7, 2));
+  EXPECT_EQ(engine.gatedDrops(), 1u);
+
+  ready.store(true);
+  engine.onTrade(makeTrade(7, 3));
+  engine.onTrade(makeTrade(8, 4));
+  const bool arrived = waitForCount(sink, 2);
+  lane.stop(true);
+  ASSERT_TRUE(arrived);
+
+  EXPECT_EQ(lane.enqueued(), 2u);
+  EXPECT_EQ(engine.tradeDrops(), 0u);
+  EXPECT_EQ(sink.count(), 2u);
+  for (size_t i = 0; i < sink.count(); ++i) {
+    const auto c = sink.at(i);
+    EXPECT_TRUE(c.priority);
+    EXPECT_TRUE(c.topic == "T.PETR4" || c.topic == "T.VALE3") << c.topic;
+  }
+}